@@ -0,0 +1,612 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <unordered_map>
+#include "netlist.h"
+#include "cycle_sim.h"
+
+//and-inverter graph of a netlist: every bit of every combinational node is
+//rebuilt from two input and gates and inverted edges, then simulated cycle
+//based like cycle_sim. While building, gates with the same inputs are shared
+//(structural hashing), gates with constant or repeated inputs fold away and
+//double inversions cancel; afterwards logic nothing observed depends on is
+//dropped. Accepts designs cycle_sim accepts, memories excluded. Nets asked
+//for as sites get gates of their own, so a value forced on one of them
+//reaches its readers only; nets asked for as free are cut from their
+//drivers and set like inputs
+class aig{
+public:
+    //variable*2, lowest bit inverts; variable 0 is constant false
+    using literal = uint32_t;
+    static constexpr literal lit_false = 0;
+    static constexpr literal lit_true = 1;
+
+    struct stats{
+        size_t built = 0;       //and gates created
+        size_t hashed = 0;      //requests answered by an existing gate
+        size_t folded = 0;      //requests answered by a constant or an input
+        size_t removed = 0;     //gates dropped as dead logic
+    };
+    struct and_gate{
+        literal a, b;
+    };
+private:
+    static constexpr literal lit_dead = ~literal(0);  //bit of removed logic
+
+    struct latch{
+        size_t node;
+        std::vector<literal> state, next;
+    };
+
+    const netlist &nl;
+    size_t inputs_count = 0;
+    std::vector<and_gate> ands;     //by variable, inputs and constant are unused
+    std::unordered_map<uint64_t, literal> hashes;
+    std::vector<std::vector<literal>> bits;     //by storage net
+    std::vector<bool> kept;                     //by net, still computed
+    std::vector<bool> freed;                    //by net, cut from driver
+    std::vector<latch> latches;
+    std::vector<uint8_t> values;                //by variable
+    stats counts;
+    uint64_t cycle = 0;
+
+    static literal p_var(const literal &lit){
+        return lit >> 1;
+    }
+
+    literal p_input(){
+        ands.emplace_back(and_gate{lit_false, lit_false});
+        inputs_count++;
+        return literal(ands.size()-1) << 1;
+    }
+
+    literal p_and(literal a, literal b){
+        if(a > b){
+            std::swap(a, b);
+        }
+        if(a == lit_false || a == (b^1)){
+            counts.folded++;
+            return lit_false;
+        }
+        if(a == lit_true || a == b){
+            counts.folded++;
+            return b;
+        }
+        auto key = (uint64_t(a) << 32) | b;
+        auto it = hashes.find(key);
+        if(it != hashes.end()){
+            counts.hashed++;
+            return it->second;
+        }
+        ands.emplace_back(and_gate{a, b});
+        counts.built++;
+        literal result = literal(ands.size()-1) << 1;
+        hashes.emplace(key, result);
+        return result;
+    }
+    //gate passing a literal through, never shared nor folded
+    literal p_site(const literal &lit){
+        ands.emplace_back(and_gate{lit, lit_true});
+        counts.built++;
+        return literal(ands.size()-1) << 1;
+    }
+    literal p_or(const literal &a, const literal &b){
+        return p_and(a^1, b^1)^1;
+    }
+    literal p_xor(const literal &a, const literal &b){
+        return p_or(p_and(a, b^1), p_and(a^1, b));
+    }
+    literal p_mux(const literal &sel, const literal &one, const literal &zero){
+        return p_or(p_and(sel, one), p_and(sel^1, zero));
+    }
+    //whether bits hold given value, bits past their width are zero
+    literal p_equals(const std::vector<literal> &sel, const uint64_t &value){
+        if(sel.size() < 64 && (value >> sel.size()) != 0){
+            return lit_false;
+        }
+        literal result = lit_true;
+        for(size_t i=0; i<sel.size(); i++){
+            result = p_and(result, sel[i] ^ literal(((value >> i) & 1) == 0));
+        }
+        return result;
+    }
+
+    std::vector<literal> p_read(const size_t &net)const{
+        auto &nt = nl.get_nets()[net];
+        auto &storage = bits[nt.storage];
+        return std::vector<literal>(storage.begin()+nt.offset, storage.begin()+nt.offset+nt.width);
+    }
+    void p_write(const size_t &net, const std::vector<literal> &lits){
+        auto &nt = nl.get_nets()[net];
+        for(size_t i=0; i<nt.width; i++){
+            bits[nt.storage][nt.offset+i] = (i < lits.size())? lits[i] : lit_false;
+        }
+    }
+
+    std::vector<literal> p_build(const netlist::node &nd, const size_t &out){
+        auto width = nl.get_nets()[nd.outs[out]].width;
+        std::vector<std::vector<literal>> ins;
+        for(auto &in:nd.ins){
+            ins.emplace_back(p_read(in));
+        }
+        //bit i of input, zero past its width
+        auto in = [&ins](const size_t &n, const size_t &i){
+            return (i < ins[n].size())? ins[n][i] : lit_false;
+        };
+        std::vector<literal> result(width, lit_false);
+        switch(nd.type){
+        case netlist::types_node::t_buf:
+        case netlist::types_node::t_not:
+            for(size_t i=0; i<width; i++){
+                result[i] = in(0, i);
+            }
+            break;
+        case netlist::types_node::t_and:
+        case netlist::types_node::t_nand:
+        case netlist::types_node::t_or:
+        case netlist::types_node::t_nor:
+        case netlist::types_node::t_xor:
+        case netlist::types_node::t_xnor:{
+            bool is_and = nd.type == netlist::types_node::t_and || nd.type == netlist::types_node::t_nand;
+            bool is_or = nd.type == netlist::types_node::t_or || nd.type == netlist::types_node::t_nor;
+            for(size_t i=0; i<width; i++){
+                literal acc = is_and? lit_true : lit_false;
+                for(size_t n=0; n<ins.size(); n++){
+                    acc = is_and? p_and(acc, in(n, i)) : is_or? p_or(acc, in(n, i)) : p_xor(acc, in(n, i));
+                }
+                result[i] = acc;
+            }
+            break;
+        }
+        case netlist::types_node::t_lut:
+            //Shannon expansion, input 0 splits neighbouring rows
+            for(size_t i=0; i<width; i++){
+                std::vector<literal> rows;
+                for(size_t r=0; r < (size_t(1) << ins.size()); r++){
+                    rows.emplace_back(((nd.table >> r) & 1)? lit_true : lit_false);
+                }
+                for(size_t n=0; n<ins.size(); n++){
+                    for(size_t r=0; r<rows.size()/2; r++){
+                        rows[r] = p_mux(in(n, i), rows[2*r+1], rows[2*r]);
+                    }
+                    rows.resize(rows.size()/2);
+                }
+                result[i] = rows[0];
+            }
+            break;
+        case netlist::types_node::t_mux:{
+            auto data = ins.size()-1;
+            for(size_t d=0; d<data; d++){
+                auto selected = p_equals(ins.back(), d);
+                for(size_t i=0; i<width; i++){
+                    result[i] = p_or(result[i], p_and(selected, in(d, i)));
+                }
+            }
+            break;
+        }
+        case netlist::types_node::t_decoder:
+            for(size_t i=0; i<width; i++){
+                result[i] = p_equals(ins[0], i);
+            }
+            break;
+        case netlist::types_node::t_encoder:{
+            //highest set bit wins, "higher" tells a bit above is set
+            literal higher = lit_false;
+            std::vector<literal> highest(ins[0].size());
+            for(size_t i=ins[0].size(); i-- > 0;){
+                highest[i] = p_and(ins[0][i], higher^1);
+                higher = p_or(higher, ins[0][i]);
+            }
+            if(out == 1){
+                result[0] = higher;
+                break;
+            }
+            for(size_t b=0; b<width; b++){
+                for(size_t i=0; i<highest.size(); i++){
+                    if((i >> b) & 1){
+                        result[b] = p_or(result[b], highest[i]);
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("attempt to build and-inverter graph of "+nd.name+
+                ", which has no combinational form");
+        }
+        if(nd.type == netlist::types_node::t_not || nd.type == netlist::types_node::t_nand ||
+            nd.type == netlist::types_node::t_nor || nd.type == netlist::types_node::t_xnor)
+        {
+            for(auto &lit:result){
+                lit ^= 1;
+            }
+        }
+        return result;
+    }
+
+    std::vector<literal> p_next(const netlist::node &nd, const std::vector<literal> &state){
+        auto in = [this, &nd](const size_t &n){
+            return p_read(nd.ins[n]);
+        };
+        std::vector<literal> result = state;
+        switch(nd.type){
+        case netlist::types_node::t_dff:
+            result[0] = in(0).at(0);
+            break;
+        case netlist::types_node::t_register:{
+            auto d = in(0);
+            auto en = in(1).at(0);
+            for(size_t i=0; i<result.size(); i++){
+                result[i] = p_mux(en, (i < d.size())? d[i] : lit_false, state[i]);
+            }
+            break;
+        }
+        case netlist::types_node::t_counter:{
+            auto en = in(0).at(0);
+            auto clr = in(1).at(0);
+            literal carry = lit_true;
+            for(size_t i=0; i<result.size(); i++){
+                auto sum = p_xor(state[i], carry);
+                carry = p_and(state[i], carry);
+                result[i] = p_mux(en, p_and(clr^1, sum), state[i]);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        return result;
+    }
+
+    //drops and gates no kept net or latch depends on and renumbers the rest,
+    //inputs keep their variables
+    void p_remove_dead(const std::vector<size_t> &observed){
+        auto &nets = nl.get_nets();
+        std::vector<bool> live(ands.size(), false);
+        auto mark = [this, &live](const literal &lit){
+            live[p_var(lit)] = true;
+        };
+        for(auto &net:observed){
+            for(auto &lit:p_read(net)){
+                mark(lit);
+            }
+        }
+        for(auto &l:latches){
+            for(auto &lit:l.next){
+                mark(lit);
+            }
+        }
+        //fanins have lower variables, one pass from the top reaches all
+        for(size_t v=ands.size(); v-- > inputs_count+1;){
+            if(live[v]){
+                live[p_var(ands[v].a)] = true;
+                live[p_var(ands[v].b)] = true;
+            }
+        }
+        std::vector<literal> index(ands.size(), lit_dead);
+        std::vector<and_gate> compact;
+        for(size_t v=0; v<ands.size(); v++){
+            if(v > inputs_count && !live[v]){
+                counts.removed++;
+                continue;
+            }
+            index[v] = literal(compact.size()) << 1;
+            compact.emplace_back(ands[v]);
+        }
+        auto remap = [&index](const literal &lit){
+            auto to = index[p_var(lit)];
+            return (to == lit_dead)? lit_dead : to | (lit & 1);
+        };
+        for(size_t v=inputs_count+1; v<compact.size(); v++){
+            compact[v].a = remap(compact[v].a);
+            compact[v].b = remap(compact[v].b);
+        }
+        ands = std::move(compact);
+        hashes.clear();
+        for(auto &storage:bits){
+            for(auto &lit:storage){
+                lit = remap(lit);
+            }
+        }
+        for(auto &l:latches){
+            for(auto &lit:l.next){
+                lit = remap(lit);
+            }
+        }
+        kept.assign(nets.size(), true);
+        for(size_t net=0; net<nets.size(); net++){
+            for(auto &lit:p_read(net)){
+                kept[net] = kept[net] && lit != lit_dead;
+            }
+        }
+    }
+
+    bool p_value(const literal &lit)const{
+        return values[p_var(lit)] ^ (lit & 1);
+    }
+public:
+    //observed are nets whose values are wanted, by default outputs of the
+    //design; constants gives values of input nets that never change; sites
+    //are nets of non-input nodes that get gates of their own; free are nets
+    //of any node that become inputs
+    aig(const netlist &nl, std::vector<size_t> observed = {},
+        const std::unordered_map<size_t, uint64_t> &constants = {},
+        const std::vector<size_t> &sites = {}, const std::vector<size_t> &free = {})
+        :nl(nl)
+    {
+        auto problems = cycle_sim::check(nl);
+        if(!problems.empty()){
+            throw std::runtime_error("attempt to build and-inverter graph of a design that "
+                "cycle_sim does not accept: "+problems[0]);
+        }
+        auto &nets = nl.get_nets();
+        auto &nodes = nl.get_nodes();
+        ands.emplace_back(and_gate{lit_false, lit_false});
+        bits.resize(nets.size());
+        for(size_t net=0; net<nets.size(); net++){
+            if(nets[net].storage == net){
+                bits[net].assign(nets[net].width, lit_false);
+            }
+        }
+        if(observed.empty()){
+            for(auto &n:nl.get_outputs()){
+                observed.insert(observed.end(), nodes[n].outs.begin(), nodes[n].outs.end());
+            }
+        }
+
+        std::vector<bool> is_site(nets.size(), false);
+        for(auto &net:sites){
+            is_site.at(net) = true;
+        }
+        freed.assign(nets.size(), false);
+        for(auto &net:free){
+            if(nets.at(net).storage != net){
+                throw std::runtime_error("attempt to cut net "+nets[net].name+
+                    ", which is a view of another net");
+            }
+            freed[net] = true;
+        }
+        auto write_node = [this, &is_site](const size_t &net, std::vector<literal> lits){
+            if(freed[net]){
+                return;
+            }
+            if(is_site[net]){
+                for(auto &lit:lits){
+                    lit = p_site(lit);
+                }
+            }
+            p_write(net, lits);
+        };
+
+        //inputs and state first, then Kahn's algorithm over combinational edges
+        auto &fanout = nl.get_fanout();
+        std::vector<size_t> pending(nodes.size(), 0), ready;
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].sequential){
+                continue;
+            }
+            for(auto &r:fanout[n]){
+                pending[r]++;
+            }
+        }
+        for(size_t n=0; n<nodes.size(); n++){
+            auto &nd = nodes[n];
+            if(nd.type == netlist::types_node::t_ram || nd.type == netlist::types_node::t_rom){
+                throw std::runtime_error("attempt to build and-inverter graph of memory "+nd.name);
+            }
+            for(auto &net:nd.outs){
+                if(freed[net] && nd.type != netlist::types_node::t_in &&
+                    nd.type != netlist::types_node::t_clock)
+                {
+                    std::vector<literal> lits(nets[net].width);
+                    for(auto &lit:lits){
+                        lit = p_input();
+                    }
+                    p_write(net, lits);
+                }
+            }
+            if(nd.type == netlist::types_node::t_in || nd.type == netlist::types_node::t_clock){
+                auto net = nd.outs[0];
+                auto it = constants.find(net);
+                std::vector<literal> lits(nets[net].width);
+                for(size_t i=0; i<lits.size(); i++){
+                    if(it == constants.end()){
+                        lits[i] = p_input();
+                    }else{
+                        lits[i] = ((it->second >> i) & 1)? lit_true : lit_false;
+                    }
+                }
+                p_write(net, lits);
+            }else if(nd.sequential){
+                latch l;
+                l.node = n;
+                l.state.resize(nets[nd.outs[0]].width);
+                for(auto &lit:l.state){
+                    lit = p_input();
+                }
+                latches.emplace_back(std::move(l));
+            }
+            if(pending[n] == 0){
+                ready.emplace_back(n);
+            }
+        }
+        //after every input, gates of sites must not come between them
+        for(auto &l:latches){
+            auto &nd = nodes[l.node];
+            for(size_t out=0; out<nd.outs.size(); out++){
+                auto lits = l.state;
+                if(nd.type == netlist::types_node::t_dff && out == 1){
+                    lits[0] ^= 1;
+                }
+                write_node(nd.outs[out], lits);
+            }
+        }
+        while(!ready.empty()){
+            auto n = ready.back();
+            ready.pop_back();
+            auto &nd = nodes[n];
+            if(nd.sequential){
+                continue;
+            }
+            if(nd.type != netlist::types_node::t_in && nd.type != netlist::types_node::t_clock){
+                for(size_t out=0; out<nd.outs.size(); out++){
+                    write_node(nd.outs[out], p_build(nd, out));
+                }
+            }
+            for(auto &r:fanout[n]){
+                if(--pending[r] == 0){
+                    ready.emplace_back(r);
+                }
+            }
+        }
+        for(auto &l:latches){
+            l.next = p_next(nodes[l.node], l.state);
+        }
+        p_remove_dead(observed);
+
+        values.assign(ands.size(), 0);
+        for(auto &l:latches){
+            auto seq = dynamic_cast<const elem_sequential*>(nodes[l.node].elem);
+            auto state = seq->get_state().word(0);
+            for(size_t i=0; i<l.state.size(); i++){
+                values[p_var(l.state[i])] = (state >> i) & 1;
+            }
+        }
+        evaluate();
+    }
+
+    //value of an input net, visible after next evaluate or step
+    void set_input(const size_t &net, const uint64_t &value){
+        auto &nt = nl.get_nets().at(net);
+        auto driver = nt.driver;
+        if(!freed[net] && (driver == netlist::npos ||
+            (nl.get_nodes()[driver].type != netlist::types_node::t_in &&
+            nl.get_nodes()[driver].type != netlist::types_node::t_clock)))
+        {
+            throw std::runtime_error("attempt to set net "+nt.name+", which is not an input");
+        }
+        auto lits = p_read(net);
+        for(size_t i=0; i<lits.size(); i++){
+            if(p_var(lits[i]) == 0){
+                throw std::runtime_error("attempt to set input "+nt.name+", which was compiled as constant");
+            }
+            values[p_var(lits[i])] = (value >> i) & 1;
+        }
+    }
+
+    //one pass over and gates, fanins always come first
+    void evaluate(){
+        for(size_t v=inputs_count+1; v<ands.size(); v++){
+            values[v] = p_value(ands[v].a) & p_value(ands[v].b);
+        }
+    }
+
+    //one clock cycle, every latch takes its next state at once
+    void step(){
+        evaluate();
+        std::vector<uint8_t> next;
+        for(auto &l:latches){
+            for(auto &lit:l.next){
+                next.emplace_back(p_value(lit));
+            }
+        }
+        size_t i = 0;
+        for(auto &l:latches){
+            for(auto &lit:l.state){
+                values[p_var(lit)] = next[i++];
+            }
+        }
+        evaluate();
+        cycle++;
+    }
+    void run(const uint64_t &cycles){
+        for(uint64_t i=0; i<cycles; i++){
+            step();
+        }
+    }
+
+    //false for nets whose logic was removed as dead, in any of their bits
+    bool is_kept(const size_t &net)const{
+        return kept.at(net);
+    }
+    //false if logic of bit i of a net was removed as dead
+    bool is_kept(const size_t &net, const size_t &i)const{
+        auto &nt = nl.get_nets().at(net);
+        if(i >= nt.width){
+            throw std::runtime_error("attempt to check bit "+std::to_string(i)+" of net "+nt.name+
+                ", which is "+std::to_string(nt.width)+" bits wide");
+        }
+        return bits[nt.storage][nt.offset+i] != lit_dead;
+    }
+    uint64_t get_value(const size_t &net)const{
+        if(!is_kept(net)){
+            throw std::runtime_error("attempt to read net "+nl.get_nets()[net].name+
+                ", which was removed as dead logic");
+        }
+        uint64_t result = 0;
+        auto lits = p_read(net);
+        for(size_t i=0; i<lits.size(); i++){
+            result |= uint64_t(p_value(lits[i])) << i;
+        }
+        return result;
+    }
+    //value carried by a gate of the sim the netlist was compiled from
+    uint64_t get_gate_value(const size_t &gate_id)const{
+        auto net = nl.find_net(gate_id);
+        if(net == netlist::npos){
+            throw std::runtime_error("attempt to read gate "+std::to_string(gate_id)+
+                ", which is not in netlist");
+        }
+        return get_value(net);
+    }
+    //literal of bit i of a net, lit_false or lit_true if it is constant
+    literal get_literal(const size_t &net, const size_t &i)const{
+        return p_read(net).at(i);
+    }
+
+    //gates by variable, fanins always have lower variables. Constant and
+    //inputs come first and their entries are unused
+    const std::vector<and_gate>& get_ands()const{
+        return ands;
+    }
+    //value of a literal as of last evaluate
+    bool value_of(const literal &lit)const{
+        return p_value(lit);
+    }
+    static literal var_of(const literal &lit){
+        return p_var(lit);
+    }
+    //literals of every state bit and of its next value, latch by latch
+    std::vector<literal> get_state_literals()const{
+        std::vector<literal> result;
+        for(auto &l:latches){
+            result.insert(result.end(), l.state.begin(), l.state.end());
+        }
+        return result;
+    }
+    std::vector<literal> get_next_literals()const{
+        std::vector<literal> result;
+        for(auto &l:latches){
+            result.insert(result.end(), l.next.begin(), l.next.end());
+        }
+        return result;
+    }
+
+    size_t ands_count()const{
+        return ands.size()-inputs_count-1;
+    }
+    size_t get_inputs_count()const{
+        return inputs_count;
+    }
+    const netlist& get_netlist()const{
+        return nl;
+    }
+    const stats& get_stats()const{
+        return counts;
+    }
+    const uint64_t& get_cycle()const{
+        return cycle;
+    }
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "element.h"
+#include "mem_image.h"
 
 class elem_basic:public element{
     using element::insert;
@@ -12,78 +13,919 @@ public:
     {}
 };
 
-class elem_and final :public elem_basic{
-    std::shared_ptr<gate_in> in1, in2;
+//bitwise gate over buses: all gates of the element share one width and
+//inputs are combined a whole 64-bit word at a time
+class elem_bitwise:public elem_basic{
+protected:
     std::shared_ptr<gate_out> out1;
-public:
-    elem_and(const std::string &name, const size_t &parent_id=0)
+    bits::bit_vector result;
+
+    elem_bitwise(const std::string &name, const size_t &ins_count, const size_t &width,
+        const size_t &parent_id)
         :elem_basic(name, parent_id),
         nameable(name, parent_id)
     {
-        in1 = std::make_shared<gate_in>(name+"+in_0", 1, this->get_id());
-        in2 = std::make_shared<gate_in>(name+"+in_1", 1, this->get_id());
-        out1 = std::make_shared<gate_out>(name+"+out_1", 1, this->get_id());
-        element::emplace_back(in1);
-        element::emplace_back(in2);
+        if(ins_count == 0){
+            throw std::runtime_error("attempt to create gate "+name+" without inputs");
+        }
+        for(size_t i=0; i<ins_count; i++){
+            auto in = std::make_shared<gate_in>(name+"+in_"+std::to_string(i), width, this->get_id());
+            element::emplace_back(in);
+        }
+        out1 = std::make_shared<gate_out>(name+"+out_1", width, this->get_id());
         element::emplace_back(out1);
     }
+
+    template<class Op>
+    void p_fold(const Op &op, const bool &invert){
+        if(get_processed()){
+            return;
+        }
+        const gate &first = *ins[0];
+        result = first.get_values();
+        result.resize(out1->get_width());
+        for(size_t i=1; i<ins.size(); i++){
+            const gate &in = *ins[i];
+            auto &vals = in.get_values();
+            auto words = std::min(result.words_size(), vals.words_size());
+            for(size_t w=0; w<words; w++){
+                result.set_word(w, op(result.word(w), vals.word(w)));
+            }
+        }
+        if(invert){
+            result.flip();
+        }
+        out1->pass_value(result);
+        this->processed = true;
+    }
+public:
+    virtual ~elem_bitwise(){}
+
+    bool has_fixed_shape()const override{
+        return true;
+    }
+    //resizes every gate, existing ties to gates of other width are not checked
+    void set_width(const size_t &width){
+        for(auto &gt:gates){
+            gt->set_width(width);
+        }
+    }
+    const size_t& get_width()const{
+        return out1->get_width();
+    }
+};
+
+//takes any number of inputs, so wide reductions need no tree of gates
+class elem_and final :public elem_bitwise{
+public:
+    elem_and(const std::string &name, const size_t &width=1, const size_t &ins_count=2,
+        const size_t &parent_id=0)
+        :elem_bitwise(name, ins_count, width, parent_id),
+        nameable(name, parent_id)
+    {}
     virtual ~elem_and(){}
 
+    void process()override{
+        p_fold([](auto a, auto b){ return a & b; }, false);
+    }
+};
+
+class elem_or final :public elem_bitwise{
+public:
+    elem_or(const std::string &name, const size_t &width=1, const size_t &ins_count=2,
+        const size_t &parent_id=0)
+        :elem_bitwise(name, ins_count, width, parent_id),
+        nameable(name, parent_id)
+    {}
+    ~elem_or(){}
+
+    void process()override{
+        p_fold([](auto a, auto b){ return a | b; }, false);
+    }
+};
+
+class elem_not final :public elem_bitwise{
+public:
+    elem_not(const std::string &name, const size_t &width=1, const size_t &parent_id=0)
+        :elem_bitwise(name, 1, width, parent_id),
+        nameable(name, parent_id)
+    {}
+    ~elem_not(){}
+
+    void process()override{
+        p_fold([](auto a, auto){ return a; }, true);
+    }
+};
+
+class elem_xor final :public elem_bitwise{
+public:
+    elem_xor(const std::string &name, const size_t &width=1, const size_t &ins_count=2,
+        const size_t &parent_id=0)
+        :elem_bitwise(name, ins_count, width, parent_id),
+        nameable(name, parent_id)
+    {}
+    ~elem_xor(){}
+
+    void process()override{
+        p_fold([](auto a, auto b){ return a ^ b; }, false);
+    }
+};
+
+class elem_nand final :public elem_bitwise{
+public:
+    elem_nand(const std::string &name, const size_t &width=1, const size_t &ins_count=2,
+        const size_t &parent_id=0)
+        :elem_bitwise(name, ins_count, width, parent_id),
+        nameable(name, parent_id)
+    {}
+    ~elem_nand(){}
+
+    void process()override{
+        p_fold([](auto a, auto b){ return a & b; }, true);
+    }
+};
+
+class elem_nor final :public elem_bitwise{
+public:
+    elem_nor(const std::string &name, const size_t &width=1, const size_t &ins_count=2,
+        const size_t &parent_id=0)
+        :elem_bitwise(name, ins_count, width, parent_id),
+        nameable(name, parent_id)
+    {}
+    ~elem_nor(){}
+
+    void process()override{
+        p_fold([](auto a, auto b){ return a | b; }, true);
+    }
+};
+
+class elem_xnor final :public elem_bitwise{
+public:
+    elem_xnor(const std::string &name, const size_t &width=1, const size_t &ins_count=2,
+        const size_t &parent_id=0)
+        :elem_bitwise(name, ins_count, width, parent_id),
+        nameable(name, parent_id)
+    {}
+    ~elem_xnor(){}
+
+    void process()override{
+        p_fold([](auto a, auto b){ return a ^ b; }, true);
+    }
+};
+
+//lookup table over buses: bit j of output is bit number
+//in_0[j] | in_1[j] << 1 | ... of table, so k inputs give any function of k bits
+class elem_lut final :public elem_bitwise{
+    uint64_t table;
+public:
+    static constexpr size_t max_ins = 6;
+
+    elem_lut(const std::string &name, const size_t &width=1, const size_t &ins_count=2,
+        const uint64_t &table=0, const size_t &parent_id=0)
+        :elem_bitwise(name, ins_count, width, parent_id),
+        nameable(name, parent_id)
+    {
+        if(ins_count > max_ins){
+            throw std::runtime_error("attempt to create lut "+name+" with "+std::to_string(ins_count)+
+                " inputs, allowed are up to "+std::to_string(max_ins));
+        }
+        set_table(table);
+    }
+    ~elem_lut(){}
+
+    //word of output, in(i) gives word of input i. Folds table one input at
+    //a time, every step halves the rows left
+    template<class In>
+    static uint64_t apply(const uint64_t &table, const size_t &ins_count, const In &in){
+        uint64_t rows[size_t(1) << max_ins];
+        size_t count = size_t(1) << ins_count;
+        for(size_t r=0; r<count; r++){
+            rows[r] = ((table >> r) & 1)? ~uint64_t(0) : 0;
+        }
+        for(size_t i=0; i<ins_count; i++){
+            auto x = in(i);
+            count >>= 1;
+            for(size_t r=0; r<count; r++){
+                rows[r] = (rows[2*r] & ~x) | (rows[2*r+1] & x);
+            }
+        }
+        return rows[0];
+    }
+
+    //bits past 2^ins_count are dropped
+    void set_table(const uint64_t &table){
+        auto rows = size_t(1) << ins.size();
+        this->table = (rows == 64)? table : table & ((uint64_t(1) << rows)-1);
+    }
+    const uint64_t& get_table()const{
+        return table;
+    }
+
+    void process()override{
+        if(get_processed()){
+            return;
+        }
+        const gate &first = *ins[0];
+        result = first.get_values();
+        for(size_t w=0; w<result.words_size(); w++){
+            result.set_word(w, apply(table, ins.size(), [this, &w](const size_t &i){
+                const gate &in = *ins[i];
+                return in.get_values().word(w);
+            }));
+        }
+        out1->pass_value(result);
+        this->processed = true;
+    }
+};
+
+//passes one of 2^sel_width data inputs to the output, select input goes last
+class elem_mux final :public elem_basic{
+    std::shared_ptr<gate_in> sel;
+    std::shared_ptr<gate_out> out1;
+    size_t sel_width;
+public:
+    static constexpr size_t max_sel_width = 8;
+
+    elem_mux(const std::string &name, const size_t &width=1, const size_t &sel_width=1,
+        const size_t &parent_id=0)
+        :elem_basic(name, parent_id),
+        nameable(name, parent_id),
+        sel_width(sel_width)
+    {
+        if(sel_width == 0 || sel_width > max_sel_width){
+            throw std::runtime_error("attempt to create mux "+name+" with select width "+
+                std::to_string(sel_width)+", allowed are 1 to "+std::to_string(max_sel_width));
+        }
+        size_t data_count = size_t(1) << sel_width;
+        for(size_t i=0; i<data_count; i++){
+            auto in = std::make_shared<gate_in>(name+"+in_"+std::to_string(i), width, this->get_id());
+            element::emplace_back(in);
+        }
+        sel = std::make_shared<gate_in>(name+"+sel", sel_width, this->get_id());
+        out1 = std::make_shared<gate_out>(name+"+out_1", width, this->get_id());
+        element::emplace_back(sel);
+        element::emplace_back(out1);
+    }
+    ~elem_mux(){}
+
+    size_t get_sel_width()const{
+        return sel_width;
+    }
+    bool has_fixed_shape()const override{
+        return true;
+    }
+    const size_t& get_width()const{
+        return out1->get_width();
+    }
+
     void process()override{
         if(get_processed()){
             return;
         }
-        out1->pass_value({in1->get_value(0) && in2->get_value(0)});
+        const gate &sel_gt = *sel;
+        auto index = sel_gt.get_values().word(0);
+        if(index < (size_t(1) << sel_width)){
+            const gate &data = *ins[index];
+            out1->pass_value(data.get_values());
+        }else{
+            //select wider than the mux was built with, like netlist::eval
+            out1->pass_value(bits::bit_vector(out1->get_width()));
+        }
         this->processed = true;
     }
 };
 
-class elem_or final :public elem_basic{
-    std::shared_ptr<gate_in> in1, in2;
+//sets the output bit selected by input, output is 2^sel_width bits wide
+class elem_decoder final :public elem_basic{
+    std::shared_ptr<gate_in> in1;
     std::shared_ptr<gate_out> out1;
+    bits::bit_vector result;
 public:
-    elem_or(const std::string &name, const size_t &parent_id=0)
+    static constexpr size_t max_sel_width = 8;
+
+    elem_decoder(const std::string &name, const size_t &sel_width=1, const size_t &parent_id=0)
         :elem_basic(name, parent_id),
         nameable(name, parent_id)
     {
-        in1 = std::make_shared<gate_in>(name+"+in_0", 1, this->get_id());
-        in2 = std::make_shared<gate_in>(name+"+in_1", 1, this->get_id());
-        out1 = std::make_shared<gate_out>(name+"+out_1", 1, this->get_id());
+        if(sel_width == 0 || sel_width > max_sel_width){
+            throw std::runtime_error("attempt to create decoder "+name+" with select width "+
+                std::to_string(sel_width)+", allowed are 1 to "+std::to_string(max_sel_width));
+        }
+        in1 = std::make_shared<gate_in>(name+"+in_0", sel_width, this->get_id());
+        out1 = std::make_shared<gate_out>(name+"+out_1", size_t(1) << sel_width, this->get_id());
         element::emplace_back(in1);
-        element::emplace_back(in2);
         element::emplace_back(out1);
+        result.resize(out1->get_width());
+    }
+    ~elem_decoder(){}
+
+    size_t get_sel_width()const{
+        return in1->get_width();
+    }
+    bool has_fixed_shape()const override{
+        return true;
     }
-    ~elem_or(){}
 
     void process()override{
         if(get_processed()){
             return;
         }
-        out1->pass_value({in1->get_value(0) || in2->get_value(0)});
+        const gate &in = *in1;
+        for(size_t w=0; w<result.words_size(); w++){
+            result.set_word(w, 0);
+        }
+        //select wider than the decoder was built with sets no bit, like elem_mux
+        auto index = in.get_values().word(0);
+        if(index < result.size()){
+            result.set(index, true);
+        }
+        out1->pass_value(result);
         this->processed = true;
     }
 };
 
-class elem_not final :public elem_basic{
+//outputs index of the highest set input bit and whether any bit is set
+class elem_priority_encoder final :public elem_basic{
     std::shared_ptr<gate_in> in1;
+    std::shared_ptr<gate_out> out_index, out_valid;
+    bits::bit_vector index;
+public:
+    //bits needed to hold an index into "width" bits
+    static size_t index_width(const size_t &width){
+        size_t result = 1;
+        while((size_t(1) << result) < width){
+            result++;
+        }
+        return result;
+    }
+
+    elem_priority_encoder(const std::string &name, const size_t &width=2, const size_t &parent_id=0)
+        :elem_basic(name, parent_id),
+        nameable(name, parent_id)
+    {
+        if(width == 0){
+            throw std::runtime_error("attempt to create priority encoder "+name+" with zero width");
+        }
+        in1 = std::make_shared<gate_in>(name+"+in_0", width, this->get_id());
+        out_index = std::make_shared<gate_out>(name+"+out_1", index_width(width), this->get_id());
+        out_valid = std::make_shared<gate_out>(name+"+out_2", 1, this->get_id());
+        element::emplace_back(in1);
+        element::emplace_back(out_index);
+        element::emplace_back(out_valid);
+        index.resize(out_index->get_width());
+    }
+    ~elem_priority_encoder(){}
+
+    const size_t& get_width()const{
+        return in1->get_width();
+    }
+    bool has_fixed_shape()const override{
+        return true;
+    }
+
+    void process()override{
+        if(get_processed()){
+            return;
+        }
+        const gate &in = *in1;
+        auto &vals = in.get_values();
+        size_t found = 0;
+        bool valid = false;
+        for(size_t w=vals.words_size(); w-- > 0 && !valid;){
+            if(auto word = vals.word(w)){
+                found = w*bits::bit_vector::word_bits + 63-__builtin_clzll(word);
+                valid = true;
+            }
+        }
+        index.set_word(0, found);
+        out_index->pass_value(index);
+        out_valid->pass_value({valid});
+        this->processed = true;
+    }
+};
+
+//splits a bus into consecutive slices, least significant first. Slices are
+//forwarded the moment the input changes, so process() has nothing to do
+class elem_splitter final :public elem_basic{
+    std::shared_ptr<gate_in_notify<elem_splitter>> in1;
+    std::vector<size_t> offsets;
+    bits::bit_vector slice;
+public:
+    elem_splitter(const std::string &name, const std::vector<size_t> &parts,
+        const size_t &parent_id=0)
+        :elem_basic(name, parent_id),
+        nameable(name, parent_id)
+    {
+        if(parts.empty()){
+            throw std::runtime_error("attempt to create splitter "+name+" without slices");
+        }
+        size_t width = 0;
+        for(auto &part:parts){
+            if(part == 0){
+                throw std::runtime_error("attempt to create splitter "+name+" with empty slice");
+            }
+            offsets.emplace_back(width);
+            width += part;
+        }
+        in1 = std::make_shared<gate_in_notify<elem_splitter>>(name+"+in_0", width, this, 0);
+        element::emplace_back(in1);
+        for(size_t i=0; i<parts.size(); i++){
+            auto out = std::make_shared<gate_out>(name+"+out_"+std::to_string(i+1), parts[i], this->get_id());
+            element::emplace_back(out);
+        }
+    }
+    //one output per bit
+    elem_splitter(const std::string &name, const size_t &width=2, const size_t &parent_id=0)
+        :elem_splitter(name, std::vector<size_t>(width, 1), parent_id)
+    {}
+    ~elem_splitter(){}
+
+    bool has_fixed_shape()const override{
+        return true;
+    }
+    const size_t& get_width()const{
+        return in1->get_width();
+    }
+    std::vector<size_t> get_parts()const{
+        std::vector<size_t> parts;
+        for(auto &out:outs){
+            parts.emplace_back(out->get_width());
+        }
+        return parts;
+    }
+    //bit of the input where output "place" starts
+    const size_t& get_offset(const size_t &place)const{
+        return offsets.at(place);
+    }
+
+    void on_input(const size_t&){
+        const gate &in = *in1;
+        auto &vals = in.get_values();
+        for(size_t i=0; i<outs.size(); i++){
+            vals.get_slice(offsets[i], outs[i]->get_width(), slice);
+            outs[i]->pass_value(slice);
+        }
+    }
+};
+
+//joins inputs into one bus, first input lands in the least significant bits.
+//Like the splitter it works when an input changes and not when processed
+class elem_merger final :public elem_basic{
+    std::shared_ptr<gate_out> out1;
+    std::vector<size_t> offsets;
+    bits::bit_vector result;
+public:
+    elem_merger(const std::string &name, const std::vector<size_t> &parts,
+        const size_t &parent_id=0)
+        :elem_basic(name, parent_id),
+        nameable(name, parent_id)
+    {
+        if(parts.empty()){
+            throw std::runtime_error("attempt to create merger "+name+" without slices");
+        }
+        size_t width = 0;
+        for(size_t i=0; i<parts.size(); i++){
+            if(parts[i] == 0){
+                throw std::runtime_error("attempt to create merger "+name+" with empty slice");
+            }
+            offsets.emplace_back(width);
+            width += parts[i];
+            auto in = std::make_shared<gate_in_notify<elem_merger>>(
+                name+"+in_"+std::to_string(i), parts[i], this, i);
+            element::emplace_back(in);
+        }
+        out1 = std::make_shared<gate_out>(name+"+out_1", width, this->get_id());
+        element::emplace_back(out1);
+        result.resize(width);
+    }
+    //one input per bit
+    elem_merger(const std::string &name, const size_t &width=2, const size_t &parent_id=0)
+        :elem_merger(name, std::vector<size_t>(width, 1), parent_id)
+    {}
+    ~elem_merger(){}
+
+    bool has_fixed_shape()const override{
+        return true;
+    }
+    const size_t& get_width()const{
+        return out1->get_width();
+    }
+    std::vector<size_t> get_parts()const{
+        std::vector<size_t> parts;
+        for(auto &in:ins){
+            parts.emplace_back(in->get_width());
+        }
+        return parts;
+    }
+    const size_t& get_offset(const size_t &place)const{
+        return offsets.at(place);
+    }
+
+    void on_input(const size_t &place){
+        const gate &in = *ins[place];
+        result.set_slice(offsets[place], in.get_values());
+        out1->pass_value(result);
+    }
+};
+
+//word addressed memory, word i occupies bits [i*data_width, (i+1)*data_width)
+//of one packed buffer so any access is a single slice. Address input goes first
+class elem_memory:public elem_basic{
+protected:
+    std::shared_ptr<gate_in> addr;
     std::shared_ptr<gate_out> out1;
+    size_t addr_width, data_width;
+    bits::bit_vector result;
+
+    elem_memory(const std::string &name, const size_t &addr_width, const size_t &data_width,
+        const size_t &parent_id)
+        :elem_basic(name, parent_id),
+        nameable(name, parent_id),
+        addr_width(addr_width),
+        data_width(data_width)
+    {
+        if(addr_width == 0 || addr_width > max_addr_width){
+            throw std::runtime_error("attempt to create memory "+name+" with address width "+
+                std::to_string(addr_width)+", allowed are 1 to "+std::to_string(max_addr_width));
+        }
+        if(data_width == 0){
+            throw std::runtime_error("attempt to create memory "+name+" with zero data width");
+        }
+        addr = std::make_shared<gate_in>(name+"+addr", addr_width, this->get_id());
+        out1 = std::make_shared<gate_out>(name+"+out_1", data_width, this->get_id());
+    }
+
+    //masked, so a widened address gate can't reach past the last word
+    size_t p_address()const{
+        const gate &gt = *addr;
+        return gt.get_values().word(0) & (get_words_count()-1);
+    }
 public:
-    elem_not(const std::string &name, const size_t &parent_id=0)
+    static constexpr size_t max_addr_width = 24;
+
+    virtual ~elem_memory(){}
+
+    bool has_fixed_shape()const override{
+        return true;
+    }
+    const size_t& get_addr_width()const{
+        return addr_width;
+    }
+    const size_t& get_data_width()const{
+        return data_width;
+    }
+    size_t get_words_count()const{
+        return size_t(1) << get_addr_width();
+    }
+    //word at given address, bits past 64 are dropped
+    virtual uint64_t read_word(const size_t &address)const = 0;
+};
+
+//reads asynchronously, writes data input into addressed word while "we" is high.
+//Ports are addr, data, we
+class elem_ram final :public elem_memory{
+    std::shared_ptr<gate_in> data, we;
+    bits::bit_vector contents;
+public:
+    elem_ram(const std::string &name, const size_t &addr_width=8, const size_t &data_width=8,
+        const size_t &parent_id=0)
+        :elem_memory(name, addr_width, data_width, parent_id),
+        nameable(name, parent_id)
+    {
+        data = std::make_shared<gate_in>(name+"+data", data_width, this->get_id());
+        we = std::make_shared<gate_in>(name+"+we", 1, this->get_id());
+        element::emplace_back(addr);
+        element::emplace_back(data);
+        element::emplace_back(we);
+        element::emplace_back(out1);
+        contents.resize(get_words_count()*data_width);
+    }
+    ~elem_ram(){}
+
+    const bits::bit_vector& get_contents()const{
+        return contents;
+    }
+    void write(const size_t &address, const bits::bit_vector &value){
+        if(address >= get_words_count() || value.size() != data_width){
+            throw std::runtime_error("attempt to write "+std::to_string(value.size())+
+                " bits at address "+std::to_string(address)+" of memory "+get_name());
+        }
+        contents.set_slice(address*data_width, value);
+    }
+    uint64_t read_word(const size_t &address)const override{
+        bits::bit_vector word;
+        contents.get_slice(address*data_width, std::min<size_t>(data_width, 64), word);
+        return word.word(0);
+    }
+
+    void process()override{
+        if(get_processed()){
+            return;
+        }
+        auto address = p_address();
+        const gate &we_gt = *we;
+        if(we_gt.get_value(0)){
+            const gate &data_gt = *data;
+            contents.set_slice(address*data_width, data_gt.get_values());
+        }
+        contents.get_slice(address*data_width, data_width, result);
+        out1->pass_value(result);
+        this->processed = true;
+    }
+};
+
+//contents come from a binary image file laid out like the packed buffer of a
+//ram, a word past the end of image reads as zero. Image is mapped, not copied
+class elem_rom final :public elem_memory{
+    mem_image image;
+public:
+    elem_rom(const std::string &name, const size_t &addr_width=8, const size_t &data_width=8,
+        const std::string &image_path="", const size_t &parent_id=0)
+        :elem_memory(name, addr_width, data_width, parent_id),
+        nameable(name, parent_id)
+    {
+        element::emplace_back(addr);
+        element::emplace_back(out1);
+        if(!image_path.empty()){
+            image.open(image_path);
+        }
+    }
+    ~elem_rom(){}
+
+    void load_image(const std::string &path){
+        image.open(path);
+    }
+    void unload_image(){
+        image.close();
+    }
+    //empty if there is no image
+    const std::string& get_image_path()const{
+        return image.get_path();
+    }
+    uint64_t read_word(const size_t &address)const override{
+        bits::bit_vector word;
+        bits::read_bits(image.data(), image.size(), address*data_width,
+            std::min<size_t>(data_width, 64), word);
+        return word.word(0);
+    }
+
+    void process()override{
+        if(get_processed()){
+            return;
+        }
+        bits::read_bits(image.data(), image.size(), p_address()*data_width, data_width, result);
+        out1->pass_value(result);
+        this->processed = true;
+    }
+};
+
+//state that changes only at a rising edge of clock input, which goes last.
+//Outputs show the state and do not follow inputs in between edges
+class elem_sequential:public elem_basic{
+protected:
+    std::shared_ptr<gate_in> clk;
+    //gates as wide as state, resized with it
+    std::vector<std::shared_ptr<gate>> data_gates;
+    bits::bit_vector state, next;
+    bool last_clk = false;
+
+    elem_sequential(const std::string &name, const size_t &width, const size_t &parent_id)
         :elem_basic(name, parent_id),
         nameable(name, parent_id)
     {
-        in1 = std::make_shared<gate_in>(name+"+in_0", 1, this->get_id());
+        if(width == 0){
+            throw std::runtime_error("attempt to create "+name+" with zero width");
+        }
+        clk = std::make_shared<gate_in>(name+"+clk", 1, this->get_id());
+        state.resize(width);
+        next.resize(width);
+    }
+
+    virtual bool p_enabled()const{
+        return true;
+    }
+    //fills next from inputs and current state
+    virtual void p_next() = 0;
+    virtual void p_drive() = 0;
+public:
+    virtual ~elem_sequential(){}
+
+    bool has_fixed_shape()const override{
+        return true;
+    }
+    //resizes state with data inputs and outputs, clock and control inputs
+    //stay 1 bit wide. Existing ties to gates of other width are not checked
+    void set_width(const size_t &width){
+        if(width == 0){
+            throw std::runtime_error("attempt to set zero width to "+get_name());
+        }
+        state.resize(width);
+        next.resize(width);
+        for(auto &gt:data_gates){
+            gt->set_width(width);
+        }
+    }
+    size_t get_width()const{
+        return state.size();
+    }
+    const bits::bit_vector& get_state()const{
+        return state;
+    }
+    //presets state, outputs show it when processed
+    void set_state(const bits::bit_vector &value){
+        if(value.size() != state.size()){
+            throw std::runtime_error("attempt to set state of width "+std::to_string(value.size())+
+                " to "+get_name()+" with width "+std::to_string(state.size()));
+        }
+        state = value;
+    }
+
+    bool is_sequential()const override{ return true; }
+
+    bool sample()override{
+        const gate &clk_gt = *clk;
+        bool level = clk_gt.get_value(0);
+        bool rising = level && !last_clk;
+        last_clk = level;
+        if(!rising || !p_enabled()){
+            return false;
+        }
+        p_next();
+        return true;
+    }
+    void update()override{
+        std::swap(state, next);
+        p_drive();
+    }
+
+    void process()override{
+        if(get_processed()){
+            return;
+        }
+        p_drive();
+        this->processed = true;
+    }
+};
+
+//ports are d, clk; outputs q and inverted q
+class elem_dff final :public elem_sequential{
+    std::shared_ptr<gate_in> d;
+    std::shared_ptr<gate_out> q, nq;
+    bits::bit_vector inverted;
+protected:
+    void p_next()override{
+        const gate &d_gt = *d;
+        next = d_gt.get_values();
+    }
+    void p_drive()override{
+        q->pass_value(state);
+        inverted = state;
+        inverted.flip();
+        nq->pass_value(inverted);
+    }
+public:
+    elem_dff(const std::string &name, const size_t &parent_id=0)
+        :elem_sequential(name, 1, parent_id),
+        nameable(name, parent_id)
+    {
+        d = std::make_shared<gate_in>(name+"+d", 1, this->get_id());
+        q = std::make_shared<gate_out>(name+"+q", 1, this->get_id());
+        nq = std::make_shared<gate_out>(name+"+nq", 1, this->get_id());
+        element::emplace_back(d);
+        element::emplace_back(clk);
+        element::emplace_back(q);
+        element::emplace_back(nq);
+        data_gates = {d, q, nq};
+    }
+    ~elem_dff(){}
+};
+
+//loads d at a clock edge while enabled, ports are d, en, clk
+class elem_register final :public elem_sequential{
+    std::shared_ptr<gate_in> d, en;
+    std::shared_ptr<gate_out> q;
+protected:
+    bool p_enabled()const override{
+        const gate &en_gt = *en;
+        return en_gt.get_value(0);
+    }
+    void p_next()override{
+        const gate &d_gt = *d;
+        next = d_gt.get_values();
+    }
+    void p_drive()override{
+        q->pass_value(state);
+    }
+public:
+    elem_register(const std::string &name, const size_t &width=8, const size_t &parent_id=0)
+        :elem_sequential(name, width, parent_id),
+        nameable(name, parent_id)
+    {
+        d = std::make_shared<gate_in>(name+"+d", width, this->get_id());
+        en = std::make_shared<gate_in>(name+"+en", 1, this->get_id());
+        q = std::make_shared<gate_out>(name+"+q", width, this->get_id());
+        element::emplace_back(d);
+        element::emplace_back(en);
+        element::emplace_back(clk);
+        element::emplace_back(q);
+        data_gates = {d, q};
+    }
+    ~elem_register(){}
+};
+
+//counts clock edges while enabled and wraps around, clr zeroes it at an
+//enabled edge instead. Ports are en, clr, clk
+class elem_counter final :public elem_sequential{
+    std::shared_ptr<gate_in> en, clr;
+    std::shared_ptr<gate_out> q;
+protected:
+    bool p_enabled()const override{
+        const gate &en_gt = *en;
+        return en_gt.get_value(0);
+    }
+    void p_next()override{
+        const gate &clr_gt = *clr;
+        next = state;
+        if(clr_gt.get_value(0)){
+            for(size_t w=0; w<next.words_size(); w++){
+                next.set_word(w, 0);
+            }
+            return;
+        }
+        for(size_t w=0; w<next.words_size(); w++){
+            auto word = next.word(w)+1;
+            next.set_word(w, word);
+            if(word != 0){
+                break;
+            }
+        }
+    }
+    void p_drive()override{
+        q->pass_value(state);
+    }
+public:
+    elem_counter(const std::string &name, const size_t &width=8, const size_t &parent_id=0)
+        :elem_sequential(name, width, parent_id),
+        nameable(name, parent_id)
+    {
+        en = std::make_shared<gate_in>(name+"+en", 1, this->get_id());
+        clr = std::make_shared<gate_in>(name+"+clr", 1, this->get_id());
+        q = std::make_shared<gate_out>(name+"+q", width, this->get_id());
+        element::emplace_back(en);
+        element::emplace_back(clr);
+        element::emplace_back(clk);
+        element::emplace_back(q);
+        data_gates = {q};
+    }
+    ~elem_counter(){}
+};
+
+//drives its output with a square wave, flipping it every "half_period" ticks
+class elem_clock final :public elem_basic{
+    std::shared_ptr<gate_out> out1;
+    size_t half_period, counter;
+    bool level;
+public:
+    elem_clock(const std::string &name, const size_t &half_period=1, const size_t &parent_id=0)
+        :elem_basic(name, parent_id),
+        nameable(name, parent_id),
+        half_period(half_period),
+        counter(0),
+        level(false)
+    {
+        if(half_period == 0){
+            throw std::runtime_error("clock "+name+" can't have zero half period");
+        }
         out1 = std::make_shared<gate_out>(name+"+out_1", 1, this->get_id());
-        element::emplace_back(in1);
         element::emplace_back(out1);
     }
-    ~elem_not(){}
+    ~elem_clock(){}
+
+    size_t get_half_period()const{
+        return half_period;
+    }
+    void set_half_period(const size_t &half_period){
+        if(half_period == 0){
+            throw std::runtime_error("clock "+get_name()+" can't have zero half period");
+        }
+        this->half_period = half_period;
+    }
+
+    bool may_schedule_work()const override{ return true; }
+    bool has_pending_work()const override { return true; }
+
+    void advance()override{
+        if(++counter >= half_period){
+            counter = 0;
+            level = !level;
+        }
+    }
 
     void process()override{
         if(get_processed()){
             return;
         }
-        out1->pass_value({!in1->get_value(0)});
+        out1->pass_value({level});
         this->processed = true;
     }
 };
@@ -124,11 +966,14 @@ public:
         gt_outer = std::make_shared<Gt_outer>(this->Gt_outer::get_name(), width);
     }
 
-    void set_width(const size_t &width)override         { gt->set_width(width); }
-    const size_t& get_width()const override             { return gt->get_width(); }
-    bool get_value(const size_t &place)const override   { return gt->get_value(place); }
-    const std::vector<bool>& get_values()const override { return gt->get_values(); }
-    std::vector<bool> get_values()override              { return gt->get_values(); }
+    void set_width(const size_t &width)override             { gt->set_width(width); }
+    const size_t& get_width()const override                 { return gt->get_width(); }
+    bool get_value(const size_t &place)const override       { return gt->get_value(place); }
+    const bits::bit_vector& get_values()const override{
+        const gate &g = *gt;
+        return g.get_values();
+    }
+    bits::bit_vector get_values()override                   { return gt->get_values(); }
 
     std::shared_ptr<const gate> find_gate(const size_t &id)const override{
         if(gt->get_id() == id){
@@ -145,6 +990,9 @@ public:
     size_t get_outer_id()const{
         return gt_outer->get_id();
     }
+    std::shared_ptr<Gt_outer> get_outer()const{
+        return gt_outer;
+    }
 };
 class elem_out final :public elem_gate<gate_in, gate_out>{
     using element::get_out;
@@ -163,7 +1011,7 @@ public:
         gt_outer->pass_value(gt->get_values());
     }
 
-    void set_values(const std::vector<bool> &values)override{
+    void set_values(const bits::bit_vector &values)override{
         gt->set_values(values);
     }
 
@@ -204,10 +1052,16 @@ public:
         gt->pass_value(gt_outer->get_values());
     }
 
-    void set_values(const std::vector<bool> &values)override{
+    void set_values(const bits::bit_vector &values)override{
         gt_outer->set_values(values);
     }
 
+    bool may_schedule_work()const override{ return true; }
+    //value was set from outside but not yet passed inside
+    bool has_pending_work()const override{
+        return gt_outer->get_values() != gt->get_values();
+    }
+
     size_t get_ins_size()const override { return 0; }
     size_t get_outs_size()const override{ return 1; }
 
@@ -0,0 +1,225 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "sim.h"
+#include "netlist.h"
+#include "cycle_sim.h"
+#include "bytecode.h"
+
+//one design run under many independent stimulus streams. Netlist and bytecode
+//are compiled once and only read afterwards, every stream has its own copy of
+//values and states. Streams step cycle based like cycle_sim, from the state
+//the design had when compiled, and spread over threads. Rams would be shared
+//by all streams, designs with them are not accepted
+class batch_sim{
+public:
+    //stimulus holds values of inputs, one row per cycle; run fills results
+    //with values of outputs, one row per cycle
+    struct stream{
+        size_t cycles = 0;
+        std::vector<uint64_t> stimulus;
+        std::vector<uint64_t> results;
+    };
+private:
+    struct seq_node{
+        netlist::types_node type;
+        std::vector<size_t> ins;    //without clock
+        std::vector<size_t> outs;
+        uint64_t mask;
+    };
+
+    std::unique_ptr<netlist> own;
+    const netlist &nl;
+    std::unique_ptr<bytecode> program;
+    std::vector<size_t> ins, outs;      //nets
+    std::vector<seq_node> seq;
+    std::vector<uint64_t> initial_values, initial_states;
+
+    uint64_t p_read(const std::vector<uint64_t> &v, const size_t &net)const{
+        auto &nt = nl.get_nets()[net];
+        auto mask = (nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1;
+        return (v[nt.storage] >> nt.offset) & mask;
+    }
+    void p_write(std::vector<uint64_t> &v, const size_t &net, const uint64_t &value)const{
+        auto &nt = nl.get_nets()[net];
+        auto mask = (nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1;
+        auto &word = v[nt.storage];
+        word = (word & ~(mask << nt.offset)) | ((value & mask) << nt.offset);
+    }
+
+    static std::vector<size_t> p_ports(const netlist &nl, const std::vector<size_t> &nodes){
+        std::vector<std::pair<size_t, size_t>> ids;
+        for(auto &n:nodes){
+            auto &nd = nl.get_nodes()[n];
+            if(nd.type != netlist::types_node::t_clock){
+                ids.emplace_back(nd.elem->get_id(), nd.outs[0]);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        std::vector<size_t> result;
+        for(auto &id:ids){
+            result.emplace_back(id.second);
+        }
+        return result;
+    }
+
+    void p_init(){
+        auto problems = cycle_sim::check(nl);
+        if(!problems.empty()){
+            std::string mes = "attempt to run batch of a design that needs events:";
+            for(auto &p:problems){
+                mes += "\n"+p;
+            }
+            throw std::runtime_error(mes);
+        }
+        auto &nodes = nl.get_nodes();
+        initial_values.assign(nl.get_nets().size(), 0);
+        for(auto &nd:nodes){
+            if(nd.type == netlist::types_node::t_ram){
+                throw std::runtime_error("attempt to run batch of a design with ram "+nd.name+
+                    ", which streams would share");
+            }
+            if(!nd.sequential){
+                continue;
+            }
+            seq_node sq{nd.type, std::vector<size_t>(nd.ins.begin(), nd.ins.end()-1), nd.outs, 0};
+            auto width = nl.get_nets()[nd.outs[0]].width;
+            sq.mask = (width == 64)? ~uint64_t(0) : (uint64_t(1) << width)-1;
+            auto state = dynamic_cast<const elem_sequential*>(nd.elem)->get_state().word(0);
+            for(size_t out=0; out<nd.outs.size(); out++){
+                p_write(initial_values, nd.outs[out], netlist::state_out(nd.type, state, out));
+            }
+            initial_states.emplace_back(state);
+            seq.emplace_back(std::move(sq));
+        }
+        for(auto &net:ins){
+            auto driver = nl.get_nets().at(net).driver;
+            if(driver == netlist::npos || nodes[driver].type != netlist::types_node::t_in){
+                throw std::runtime_error("attempt to drive net "+nl.get_nets()[net].name+
+                    " in batch, which is not an input");
+            }
+        }
+        program = std::make_unique<bytecode>(nl);
+        program->run(initial_values.data());
+    }
+
+    //whole stimulus of one stream, v and states are scratch of the worker
+    void p_run(stream &st, std::vector<uint64_t> &v, std::vector<uint64_t> &states,
+        std::vector<uint64_t> &next)const
+    {
+        v = initial_values;
+        states = initial_states;
+        st.results.resize(st.cycles*outs.size());
+        auto row = st.stimulus.data();
+        auto out_row = st.results.data();
+        for(size_t c=0; c<st.cycles; c++, row+=ins.size(), out_row+=outs.size()){
+            for(size_t i=0; i<ins.size(); i++){
+                p_write(v, ins[i], row[i]);
+            }
+            program->run(v.data());
+            for(size_t i=0; i<seq.size(); i++){
+                auto &sq = seq[i];
+                next[i] = netlist::next_state(sq.type, [this, &v, &sq](const size_t &k){
+                    return p_read(v, sq.ins[k]);
+                }, states[i]) & sq.mask;
+            }
+            for(size_t i=0; i<seq.size(); i++){
+                if(next[i] != states[i]){
+                    states[i] = next[i];
+                    for(size_t out=0; out<seq[i].outs.size(); out++){
+                        p_write(v, seq[i].outs[out], netlist::state_out(seq[i].type, states[i], out));
+                    }
+                }
+            }
+            program->run(v.data());
+            for(size_t o=0; o<outs.size(); o++){
+                out_row[o] = p_read(v, outs[o]);
+            }
+        }
+    }
+public:
+    //inputs and outputs of root, in order they were created; the netlist
+    //must outlive it
+    explicit batch_sim(const netlist &nl)
+        :nl(nl),
+        ins(p_ports(nl, nl.get_inputs())),
+        outs(p_ports(nl, nl.get_outputs()))
+    {
+        p_init();
+    }
+    //given input nets, driven by root inputs, and any nets as outputs
+    batch_sim(const netlist &nl, std::vector<size_t> inputs, std::vector<size_t> outputs)
+        :nl(nl),
+        ins(std::move(inputs)),
+        outs(std::move(outputs))
+    {
+        p_init();
+    }
+    //netlist of the sim, kept by the batch
+    explicit batch_sim(class sim &s)
+        :own(std::make_unique<netlist>(s)),
+        nl(*own),
+        ins(p_ports(nl, nl.get_inputs())),
+        outs(p_ports(nl, nl.get_outputs()))
+    {
+        p_init();
+    }
+    batch_sim(const batch_sim&) = delete;
+    batch_sim& operator=(const batch_sim&) = delete;
+
+    //stream of given cycles, stimulus all zero
+    stream make_stream(const size_t &cycles)const{
+        stream st;
+        st.cycles = cycles;
+        st.stimulus.assign(cycles*ins.size(), 0);
+        return st;
+    }
+
+    //every stream from the initial state, threads 0 uses one per core.
+    //Streams are taken one at a time by whichever thread is free
+    void run(std::vector<stream> &streams, size_t threads = 0)const{
+        for(size_t s=0; s<streams.size(); s++){
+            if(streams[s].stimulus.size() != streams[s].cycles*ins.size()){
+                throw std::runtime_error("attempt to run stream "+std::to_string(s)+" of "+
+                    std::to_string(streams[s].cycles)+" cycles with "+
+                    std::to_string(streams[s].stimulus.size())+" stimulus values for "+
+                    std::to_string(ins.size())+" inputs");
+            }
+        }
+        if(threads == 0){
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        threads = std::max<size_t>(1, std::min(threads, streams.size()));
+        std::atomic<size_t> next_stream{0};
+        auto worker = [&](){
+            std::vector<uint64_t> v, states, next(seq.size());
+            for(auto s=next_stream++; s<streams.size(); s=next_stream++){
+                p_run(streams[s], v, states, next);
+            }
+        };
+        std::vector<std::thread> pool;
+        for(size_t t=1; t<threads; t++){
+            pool.emplace_back(worker);
+        }
+        worker();
+        for(auto &t:pool){
+            t.join();
+        }
+    }
+
+    const std::vector<size_t>& get_inputs()const{
+        return ins;
+    }
+    const std::vector<size_t>& get_outputs()const{
+        return outs;
+    }
+    const netlist& get_netlist()const{
+        return nl;
+    }
+};
@@ -1,8 +1,231 @@
 #pragma once
 #include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <iterator>
+#include <initializer_list>
 
 namespace bits{
 
+//packed bits in 64-bit words, bit i lives in word i/64 at position i%64.
+//Bits past size() are always zero, so words compare and combine directly
+class bit_vector{
+public:
+    using word_type = uint64_t;
+    static constexpr size_t word_bits = 64;
+private:
+    std::vector<word_type> m_words;
+    size_t m_size = 0;
+
+    static size_t p_words_for(const size_t &size){
+        return (size+word_bits-1)/word_bits;
+    }
+    void p_clear_tail(){
+        auto tail = m_size%word_bits;
+        if(tail){
+            m_words.back() &= (word_type(1) << tail)-1;
+        }
+    }
+public:
+    class const_iterator{
+        const bit_vector* vec;
+        size_t pos;
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = bool;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = bool;
+
+        const_iterator(const bit_vector* vec, const size_t &pos)
+            :vec(vec),
+            pos(pos)
+        {}
+        bool operator*()const                   { return (*vec)[pos]; }
+        const_iterator& operator++()            { pos++; return *this; }
+        const_iterator operator++(int)          { auto tmp = *this; pos++; return tmp; }
+        const_iterator& operator--()            { pos--; return *this; }
+        const_iterator operator+(difference_type n)const{ return const_iterator(vec, pos+n); }
+        difference_type operator-(const const_iterator &rhs)const{
+            return difference_type(pos)-difference_type(rhs.pos);
+        }
+        bool operator==(const const_iterator &rhs)const{ return pos == rhs.pos && vec == rhs.vec; }
+        bool operator!=(const const_iterator &rhs)const{ return !(*this == rhs); }
+    };
+
+    bit_vector() = default;
+    explicit bit_vector(const size_t &size, const bool &value = false){
+        resize(size, value);
+    }
+    bit_vector(std::initializer_list<bool> list){
+        resize(list.size());
+        size_t i = 0;
+        for(auto bit:list){
+            set(i++, bit);
+        }
+    }
+    bit_vector(const std::vector<bool> &vec){
+        resize(vec.size());
+        for(size_t i=0; i<vec.size(); i++){
+            set(i, vec[i]);
+        }
+    }
+
+    size_t size()const  { return m_size; }
+    bool empty()const   { return m_size == 0; }
+
+    void resize(const size_t &size, const bool &value = false){
+        auto old_size = m_size;
+        m_words.resize(p_words_for(size), value? ~word_type(0) : 0);
+        m_size = size;
+        if(value && old_size < size && old_size%word_bits){
+            m_words[old_size/word_bits] |= ~word_type(0) << (old_size%word_bits);
+        }
+        p_clear_tail();
+    }
+
+    bool operator[](const size_t &i)const{
+        return (m_words[i/word_bits] >> (i%word_bits)) & 1;
+    }
+    bool at(const size_t &i)const{
+        if(i >= m_size){
+            throw std::out_of_range("attempt to read bit "+std::to_string(i)+
+                " of bit_vector with size "+std::to_string(m_size));
+        }
+        return (*this)[i];
+    }
+    void set(const size_t &i, const bool &value){
+        auto mask = word_type(1) << (i%word_bits);
+        if(value){
+            m_words[i/word_bits] |= mask;
+        }else{
+            m_words[i/word_bits] &= ~mask;
+        }
+    }
+
+    size_t words_size()const            { return m_words.size(); }
+    const word_type* data()const        { return m_words.data(); }
+    word_type word(const size_t &w)const{ return m_words[w]; }
+    //bits past size() are dropped
+    void set_word(const size_t &w, const word_type &value){
+        m_words[w] = value;
+        if(w+1 == m_words.size()){
+            p_clear_tail();
+        }
+    }
+
+    bit_vector& operator&=(const bit_vector &rhs){
+        for(size_t w=0; w<m_words.size() && w<rhs.m_words.size(); w++){
+            m_words[w] &= rhs.m_words[w];
+        }
+        return *this;
+    }
+    bit_vector& operator|=(const bit_vector &rhs){
+        for(size_t w=0; w<m_words.size() && w<rhs.m_words.size(); w++){
+            m_words[w] |= rhs.m_words[w];
+        }
+        p_clear_tail();
+        return *this;
+    }
+    bit_vector& operator^=(const bit_vector &rhs){
+        for(size_t w=0; w<m_words.size() && w<rhs.m_words.size(); w++){
+            m_words[w] ^= rhs.m_words[w];
+        }
+        p_clear_tail();
+        return *this;
+    }
+    void flip(){
+        for(auto &w:m_words){
+            w = ~w;
+        }
+        p_clear_tail();
+    }
+
+    //bits [offset, offset+count) into dst, which is resized to count
+    void get_slice(const size_t &offset, const size_t &count, bit_vector &dst)const{
+        dst.resize(count);
+        auto shift = offset%word_bits;
+        auto first = offset/word_bits;
+        for(size_t w=0; w<dst.m_words.size(); w++){
+            auto lo = m_words[first+w] >> shift;
+            auto hi = (shift && first+w+1 < m_words.size())?
+                m_words[first+w+1] << (word_bits-shift) : 0;
+            dst.m_words[w] = lo | hi;
+        }
+        dst.p_clear_tail();
+    }
+    //overwrites bits starting at offset with all bits of src
+    void set_slice(const size_t &offset, const bit_vector &src){
+        auto shift = offset%word_bits;
+        auto first = offset/word_bits;
+        for(size_t w=0; w<src.m_words.size(); w++){
+            auto left = src.m_size - w*word_bits;
+            auto mask = (left >= word_bits)? ~word_type(0) : (word_type(1) << left)-1;
+            auto val = src.m_words[w];
+            m_words[first+w] = (m_words[first+w] & ~(mask << shift)) | (val << shift);
+            if(shift && first+w+1 < m_words.size()){
+                auto hi_mask = mask >> (word_bits-shift);
+                m_words[first+w+1] = (m_words[first+w+1] & ~hi_mask) | (val >> (word_bits-shift));
+            }
+        }
+        p_clear_tail();
+    }
+
+    const_iterator begin()const { return const_iterator(this, 0); }
+    const_iterator end()const   { return const_iterator(this, m_size); }
+
+    std::vector<bool> to_vector()const{
+        return std::vector<bool>(begin(), end());
+    }
+
+    friend bool operator==(const bit_vector &lhs, const bit_vector &rhs){
+        return lhs.m_size == rhs.m_size && lhs.m_words == rhs.m_words;
+    }
+    friend bool operator!=(const bit_vector &lhs, const bit_vector &rhs){
+        return !(lhs == rhs);
+    }
+};
+
+//bits [offset, offset+count) of a little endian byte buffer into dst, bytes
+//past the end of buffer read as zero
+inline void read_bits(const uint8_t *bytes, const size_t &bytes_size, const size_t &offset,
+    const size_t &count, bit_vector &dst)
+{
+    dst.resize(count);
+    auto load = [bytes, bytes_size](const size_t &at){
+        bit_vector::word_type word = 0;
+        for(size_t b=0; b<sizeof(word) && at+b < bytes_size; b++){
+            word |= bit_vector::word_type(bytes[at+b]) << (8*b);
+        }
+        return word;
+    };
+    for(size_t w=0; w<dst.words_size(); w++){
+        auto pos = offset+w*bit_vector::word_bits;
+        auto shift = pos%8;
+        auto word = load(pos/8) >> shift;
+        if(shift){
+            word |= load(pos/8+8) << (bit_vector::word_bits-shift);
+        }
+        dst.set_word(w, word);
+    }
+}
+
+//word of row numbers first to first+63 seen through bit k: bit j is bit k of
+//first+j. Used to count through every input combination 64 rows a word,
+//first is a multiple of 64
+inline uint64_t counting_word(const size_t &k, const uint64_t &first){
+    static const uint64_t low[6] = {
+        0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+        0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000
+    };
+    if(k < 6){
+        return low[k];
+    }
+    return (k < 64 && ((first >> k) & 1))? ~uint64_t(0) : 0;
+}
+
 enum class bit_order{
     LSB,
     MSB
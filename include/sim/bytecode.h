@@ -0,0 +1,649 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <algorithm>
+#include "netlist.h"
+#include "cycle_sim.h"
+
+//combinational part of a netlist as a compact program: a flat array of 32 bit
+//words, an opcode followed by the nets it reads and writes, in level order.
+//Common patterns are fused into one instruction: a not feeding only an and,
+//the xor/and/or cell of a full adder and a mux of two inputs. Fused
+//instructions still write their intermediate nets, so every net keeps its value
+class bytecode{
+public:
+    enum ops : uint32_t{
+        op_halt,
+        op_buf,         //dst, a
+        op_not,         //dst, a
+        op_and2,        //dst, a, b
+        op_or2,
+        op_xor2,
+        op_and,         //dst, count, ins...
+        op_or,
+        op_xor,
+        op_nand,
+        op_nor,
+        op_xnor,
+        op_andn,        //not_dst, dst, a, b; not_dst = ~b, dst = a & ~b
+        op_mux2,        //dst, a, b, sel
+        op_mux,         //dst, count, data..., sel
+        op_decoder,     //dst, sel
+        op_encoder,     //index_dst, valid_dst, a
+        op_lut,         //dst, count, table low, table high, ins...
+        op_full_adder,  //xor_dst, and_ab_dst, and_xc_dst, sum_dst, carry_dst, a, b, c
+        op_rom,         //dst, addr, memory
+        op_ram,         //dst, addr, data, we, memory
+        ops_count
+    };
+private:
+    struct net_ref{
+        uint32_t storage, offset;
+        uint64_t mask;
+    };
+
+    std::vector<uint32_t> code;
+    std::vector<net_ref> refs;
+    std::vector<elem_memory*> memories;
+    size_t fused = 0;
+
+    uint64_t p_read(const uint64_t* v, const uint32_t &net)const{
+        auto &r = refs[net];
+        return (v[r.storage] >> r.offset) & r.mask;
+    }
+    void p_write(uint64_t* v, const uint32_t &net, const uint64_t &value)const{
+        auto &r = refs[net];
+        v[r.storage] = (v[r.storage] & ~(r.mask << r.offset)) | ((value & r.mask) << r.offset);
+    }
+
+    //net is read only by nodes of the group, so writing it late is safe
+    static bool p_internal(const netlist &nl, const size_t &net, const std::vector<size_t> &group){
+        auto &nt = nl.get_nets()[net];
+        if(nt.storage != net || nl.get_sharing(net).size() != 1){
+            return false;
+        }
+        return std::all_of(nt.readers.begin(), nt.readers.end(),
+            [&group](const size_t &r){
+                return std::find(group.begin(), group.end(), r) != group.end();
+            });
+    }
+    static bool p_is(const netlist &nl, const size_t &n, const netlist::types_node &type,
+        const size_t &ins_count)
+    {
+        if(n == netlist::npos){
+            return false;
+        }
+        auto &nd = nl.get_nodes()[n];
+        return nd.type == type && nd.ins.size() == ins_count;
+    }
+    static bool p_same_pair(const std::vector<size_t> &ins, const size_t &a, const size_t &b){
+        return (ins[0] == a && ins[1] == b) || (ins[0] == b && ins[1] == a);
+    }
+
+    //{x, a1, a2, s, c} for an or node c of a full adder: x = a^b, s = x^cin,
+    //c = a1|a2 with a1 = a&b and a2 = x&cin; empty if c is not one
+    static std::vector<size_t> p_full_adder(const netlist &nl, const size_t &c){
+        auto &nodes = nl.get_nodes();
+        auto &nets = nl.get_nets();
+        if(!p_is(nl, c, netlist::types_node::t_or, 2)){
+            return {};
+        }
+        for(size_t swap=0; swap<2; swap++){
+            auto a1 = nets[nodes[c].ins[swap]].driver;
+            auto a2 = nets[nodes[c].ins[1-swap]].driver;
+            if(!p_is(nl, a1, netlist::types_node::t_and, 2) || !p_is(nl, a2, netlist::types_node::t_and, 2)){
+                continue;
+            }
+            for(size_t side=0; side<2; side++){
+                auto x_net = nodes[a2].ins[side];
+                auto cin = nodes[a2].ins[1-side];
+                auto x = nets[x_net].driver;
+                if(!p_is(nl, x, netlist::types_node::t_xor, 2) ||
+                    !p_same_pair(nodes[a1].ins, nodes[x].ins[0], nodes[x].ins[1]))
+                {
+                    continue;
+                }
+                for(auto &s:nets[x_net].readers){
+                    if(s == a2 || !p_is(nl, s, netlist::types_node::t_xor, 2) ||
+                        !p_same_pair(nodes[s].ins, x_net, cin))
+                    {
+                        continue;
+                    }
+                    std::vector<size_t> group = {x, a1, a2, s, c};
+                    auto width = nets[nodes[c].outs[0]].width;
+                    bool fits = p_internal(nl, x_net, group) &&
+                        p_internal(nl, nodes[a1].outs[0], group) &&
+                        p_internal(nl, nodes[a2].outs[0], group) &&
+                        std::all_of(group.begin(), group.end(), [&](const size_t &n){
+                            return std::all_of(nodes[n].ins.begin(), nodes[n].ins.end(),
+                                [&](const size_t &net){
+                                    return nets[net].width == width;
+                                });
+                        });
+                    std::sort(group.begin(), group.end());
+                    if(fits && std::unique(group.begin(), group.end()) == group.end()){
+                        return {x, a1, a2, s, c};
+                    }
+                }
+            }
+        }
+        return {};
+    }
+
+    void p_emit(std::initializer_list<size_t> words){
+        for(auto &w:words){
+            code.emplace_back(static_cast<uint32_t>(w));
+        }
+    }
+    void p_emit_node(const netlist::node &nd){
+        auto op_of = [](const netlist::types_node &type){
+            switch(type){
+            case netlist::types_node::t_and:  return op_and;
+            case netlist::types_node::t_or:   return op_or;
+            case netlist::types_node::t_xor:  return op_xor;
+            case netlist::types_node::t_nand: return op_nand;
+            case netlist::types_node::t_nor:  return op_nor;
+            default:                          return op_xnor;
+            }
+        };
+        auto dst = nd.outs.empty()? 0 : nd.outs[0];
+        switch(nd.type){
+        case netlist::types_node::t_buf:
+            p_emit({op_buf, dst, nd.ins[0]});
+            break;
+        case netlist::types_node::t_not:
+            p_emit({op_not, dst, nd.ins[0]});
+            break;
+        case netlist::types_node::t_and:
+        case netlist::types_node::t_or:
+        case netlist::types_node::t_xor:
+            if(nd.ins.size() == 2){
+                auto op = (nd.type == netlist::types_node::t_and)? op_and2 :
+                    (nd.type == netlist::types_node::t_or)? op_or2 : op_xor2;
+                p_emit({op, dst, nd.ins[0], nd.ins[1]});
+                break;
+            }
+            //fall through
+        case netlist::types_node::t_nand:
+        case netlist::types_node::t_nor:
+        case netlist::types_node::t_xnor:
+            p_emit({op_of(nd.type), dst, nd.ins.size()});
+            code.insert(code.end(), nd.ins.begin(), nd.ins.end());
+            break;
+        case netlist::types_node::t_mux:
+            if(nd.ins.size() == 3){
+                p_emit({op_mux2, dst, nd.ins[0], nd.ins[1], nd.ins[2]});
+                fused++;
+                break;
+            }
+            p_emit({op_mux, dst, nd.ins.size()-1});
+            code.insert(code.end(), nd.ins.begin(), nd.ins.end());
+            break;
+        case netlist::types_node::t_decoder:
+            p_emit({op_decoder, dst, nd.ins[0]});
+            break;
+        case netlist::types_node::t_encoder:
+            p_emit({op_encoder, nd.outs[0], nd.outs[1], nd.ins[0]});
+            break;
+        case netlist::types_node::t_lut:
+            p_emit({op_lut, dst, nd.ins.size(), nd.table & 0xffffffff, nd.table >> 32});
+            code.insert(code.end(), nd.ins.begin(), nd.ins.end());
+            break;
+        case netlist::types_node::t_rom:
+        case netlist::types_node::t_ram:
+            memories.emplace_back(dynamic_cast<elem_memory*>(nd.elem));
+            if(nd.type == netlist::types_node::t_rom){
+                p_emit({op_rom, dst, nd.ins[0], memories.size()-1});
+            }else{
+                p_emit({op_ram, dst, nd.ins[0], nd.ins[1], nd.ins[2], memories.size()-1});
+            }
+            break;
+        default:
+            throw std::runtime_error("attempt to compile "+nd.name+" into bytecode, it is not combinational");
+        }
+    }
+public:
+    //netlist has to pass cycle_sim::check
+    explicit bytecode(const netlist &nl){
+        auto &nets = nl.get_nets();
+        auto &nodes = nl.get_nodes();
+        for(auto &nt:nets){
+            refs.emplace_back(net_ref{static_cast<uint32_t>(nt.storage), static_cast<uint32_t>(nt.offset),
+                (nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1});
+        }
+
+        //groups of fused nodes are ordered as one, led by their last node
+        std::vector<size_t> lead(nodes.size());
+        std::vector<std::vector<size_t>> groups(nodes.size());
+        for(size_t n=0; n<nodes.size(); n++){
+            lead[n] = n;
+        }
+        std::vector<bool> taken(nodes.size(), false);
+        auto take = [&](const std::vector<size_t> &group){
+            if(group.empty() || std::any_of(group.begin(), group.end(), [&taken](const size_t &n){
+                return taken[n];
+            })){
+                return;
+            }
+            for(auto &n:group){
+                taken[n] = true;
+                lead[n] = group.back();
+            }
+            groups[group.back()] = group;
+        };
+        for(size_t n=0; n<nodes.size(); n++){
+            take(p_full_adder(nl, n));
+        }
+        for(size_t n=0; n<nodes.size(); n++){
+            if(!p_is(nl, n, netlist::types_node::t_and, 2)){
+                continue;
+            }
+            for(size_t side=0; side<2; side++){
+                auto inv = nets[nodes[n].ins[side]].driver;
+                if(p_is(nl, inv, netlist::types_node::t_not, 1) &&
+                    nets[nodes[inv].ins[0]].width == nets[nodes[n].outs[0]].width &&
+                    nets[nodes[n].ins[1-side]].width == nets[nodes[n].outs[0]].width &&
+                    p_internal(nl, nodes[n].ins[side], {inv, n}))
+                {
+                    take({inv, n});
+                    break;
+                }
+            }
+        }
+
+        //Kahn's algorithm over groups, single nodes are groups of their own
+        auto &fanout = nl.get_fanout();
+        std::vector<size_t> pending(nodes.size(), 0), ready;
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].sequential){
+                continue;
+            }
+            for(auto &r:fanout[n]){
+                if(lead[r] != lead[n]){
+                    pending[lead[r]]++;
+                }
+            }
+        }
+        for(size_t n=0; n<nodes.size(); n++){
+            if(lead[n] == n && pending[n] == 0){
+                ready.emplace_back(n);
+            }
+        }
+        while(!ready.empty()){
+            auto g = ready.back();
+            ready.pop_back();
+            auto members = groups[g].empty()? std::vector<size_t>{g} : groups[g];
+            auto &nd = nodes[g];
+            if(members.size() == 5){
+                auto &x = nodes[members[0]];
+                auto &a2 = nodes[members[2]];
+                auto x_net = x.outs[0];
+                auto cin = (a2.ins[0] == x_net)? a2.ins[1] : a2.ins[0];
+                p_emit({op_full_adder, x_net, nodes[members[1]].outs[0], a2.outs[0],
+                    nodes[members[3]].outs[0], nd.outs[0], x.ins[0], x.ins[1], cin});
+                fused++;
+            }else if(members.size() == 2){
+                auto &inv = nodes[members[0]];
+                auto a = (nd.ins[0] == inv.outs[0])? nd.ins[1] : nd.ins[0];
+                p_emit({op_andn, inv.outs[0], nd.outs[0], a, inv.ins[0]});
+                fused++;
+            }else if(!nd.sequential && nd.type != netlist::types_node::t_in &&
+                nd.type != netlist::types_node::t_clock)
+            {
+                p_emit_node(nd);
+            }
+            for(auto &m:members){
+                if(nodes[m].sequential){
+                    continue;
+                }
+                for(auto &r:fanout[m]){
+                    if(lead[r] != g && --pending[lead[r]] == 0){
+                        ready.emplace_back(lead[r]);
+                    }
+                }
+            }
+        }
+        code.emplace_back(op_halt);
+    }
+
+    //evaluates every combinational node once, values are words by storage net
+    void run(uint64_t* v)const{
+        const uint32_t* pc = code.data();
+        //threaded dispatch where computed goto is available, a switch otherwise
+#if defined(__GNUC__)
+        static const void* labels[ops_count] = {
+            &&l_op_halt, &&l_op_buf, &&l_op_not, &&l_op_and2, &&l_op_or2, &&l_op_xor2,
+            &&l_op_and, &&l_op_or, &&l_op_xor, &&l_op_nand, &&l_op_nor, &&l_op_xnor,
+            &&l_op_andn, &&l_op_mux2, &&l_op_mux, &&l_op_decoder, &&l_op_encoder, &&l_op_lut,
+            &&l_op_full_adder, &&l_op_rom, &&l_op_ram
+        };
+#define BYTECODE_OP(op) l_##op:
+#define BYTECODE_NEXT goto *labels[*pc++]
+        BYTECODE_NEXT;
+#else
+#define BYTECODE_OP(op) case op:
+#define BYTECODE_NEXT continue
+        while(true) switch(*pc++){
+#endif
+        BYTECODE_OP(op_halt){
+            return;
+        }
+        BYTECODE_OP(op_buf){
+            p_write(v, pc[0], p_read(v, pc[1]));
+            pc += 2;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_not){
+            p_write(v, pc[0], ~p_read(v, pc[1]));
+            pc += 2;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_and2){
+            p_write(v, pc[0], p_read(v, pc[1]) & p_read(v, pc[2]));
+            pc += 3;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_or2){
+            p_write(v, pc[0], p_read(v, pc[1]) | p_read(v, pc[2]));
+            pc += 3;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_xor2){
+            p_write(v, pc[0], p_read(v, pc[1]) ^ p_read(v, pc[2]));
+            pc += 3;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_and){
+            uint64_t result = ~uint64_t(0);
+            for(uint32_t i=0; i<pc[1]; i++){
+                result &= p_read(v, pc[2+i]);
+            }
+            p_write(v, pc[0], result);
+            pc += 2+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_or){
+            uint64_t result = 0;
+            for(uint32_t i=0; i<pc[1]; i++){
+                result |= p_read(v, pc[2+i]);
+            }
+            p_write(v, pc[0], result);
+            pc += 2+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_xor){
+            uint64_t result = 0;
+            for(uint32_t i=0; i<pc[1]; i++){
+                result ^= p_read(v, pc[2+i]);
+            }
+            p_write(v, pc[0], result);
+            pc += 2+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_nand){
+            uint64_t result = ~uint64_t(0);
+            for(uint32_t i=0; i<pc[1]; i++){
+                result &= p_read(v, pc[2+i]);
+            }
+            p_write(v, pc[0], ~result);
+            pc += 2+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_nor){
+            uint64_t result = 0;
+            for(uint32_t i=0; i<pc[1]; i++){
+                result |= p_read(v, pc[2+i]);
+            }
+            p_write(v, pc[0], ~result);
+            pc += 2+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_xnor){
+            uint64_t result = 0;
+            for(uint32_t i=0; i<pc[1]; i++){
+                result ^= p_read(v, pc[2+i]);
+            }
+            p_write(v, pc[0], ~result);
+            pc += 2+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_andn){
+            auto inverted = ~p_read(v, pc[3]);
+            p_write(v, pc[0], inverted);
+            p_write(v, pc[1], p_read(v, pc[2]) & inverted);
+            pc += 4;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_mux2){
+            p_write(v, pc[0], p_read(v, pc[3])? p_read(v, pc[2]) : p_read(v, pc[1]));
+            pc += 4;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_mux){
+            auto sel = p_read(v, pc[2+pc[1]]);
+            p_write(v, pc[0], (sel < pc[1])? p_read(v, pc[2+sel]) : 0);
+            pc += 3+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_decoder){
+            auto sel = p_read(v, pc[1]);
+            p_write(v, pc[0], (sel < 64)? uint64_t(1) << sel : 0);
+            pc += 2;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_encoder){
+            auto word = p_read(v, pc[2]);
+            p_write(v, pc[0], word? 63-__builtin_clzll(word) : 0);
+            p_write(v, pc[1], word != 0);
+            pc += 3;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_lut){
+            auto table = uint64_t(pc[2]) | (uint64_t(pc[3]) << 32);
+            auto ins = pc+4;
+            p_write(v, pc[0], elem_lut::apply(table, pc[1], [this, v, ins](const size_t &i){
+                return p_read(v, ins[i]);
+            }));
+            pc += 4+pc[1];
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_full_adder){
+            auto a = p_read(v, pc[5]);
+            auto b = p_read(v, pc[6]);
+            auto c = p_read(v, pc[7]);
+            auto x = a ^ b;
+            auto and_ab = a & b;
+            auto and_xc = x & c;
+            p_write(v, pc[0], x);
+            p_write(v, pc[1], and_ab);
+            p_write(v, pc[2], and_xc);
+            p_write(v, pc[3], x ^ c);
+            p_write(v, pc[4], and_ab | and_xc);
+            pc += 8;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_rom){
+            p_write(v, pc[0], memories[pc[2]]->read_word(p_read(v, pc[1])));
+            pc += 3;
+            BYTECODE_NEXT;
+        }
+        BYTECODE_OP(op_ram){
+            auto ram = static_cast<elem_ram*>(memories[pc[4]]);
+            auto address = p_read(v, pc[1]);
+            if(p_read(v, pc[3])){
+                bits::bit_vector data(ram->get_data_width());
+                data.set_word(0, p_read(v, pc[2]));
+                ram->write(address, data);
+            }
+            p_write(v, pc[0], ram->read_word(address));
+            pc += 5;
+            BYTECODE_NEXT;
+        }
+#if !defined(__GNUC__)
+        }
+#endif
+#undef BYTECODE_OP
+#undef BYTECODE_NEXT
+    }
+
+    //words of program, opcodes and operands
+    size_t size()const{
+        return code.size();
+    }
+    //instructions standing for a pattern of nodes
+    size_t fused_count()const{
+        return fused;
+    }
+};
+
+//runs a sim from bytecode instead of processing its elements, see
+//sim::set_engine. Accepts trees whose netlist passes cycle_sim::check;
+//sequential elements take edges of the clock as tick sees them. Compiled on
+//first tick after an edit, gates and states of the tree are written back
+//after every tick so the tree stays usable as it is
+class bytecode_engine :public sim_engine{
+    struct seq_node{
+        size_t node;
+        elem_sequential* el;
+        uint64_t state, last_clk;
+    };
+
+    std::unique_ptr<netlist> nl;
+    std::unique_ptr<bytecode> program;
+    std::vector<uint64_t> values;
+    std::vector<std::pair<element*, size_t>> inputs;
+    std::vector<seq_node> seq;
+    std::vector<std::pair<gate_out*, size_t>> gates;
+    bits::bit_vector scratch;
+
+    uint64_t p_read(const size_t &net)const{
+        auto &nt = nl->get_nets()[net];
+        auto mask = (nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1;
+        return (values[nt.storage] >> nt.offset) & mask;
+    }
+    void p_write(const size_t &net, const uint64_t &value){
+        auto &nt = nl->get_nets()[net];
+        auto mask = (nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1;
+        auto &word = values[nt.storage];
+        word = (word & ~(mask << nt.offset)) | ((value & mask) << nt.offset);
+    }
+
+    void p_compile(class sim &s){
+        nl = std::make_unique<netlist>(s);
+        auto problems = cycle_sim::check(*nl);
+        if(!problems.empty()){
+            std::string mes = "attempt to run bytecode engine on a design that needs events:";
+            for(auto &p:problems){
+                mes += "\n"+p;
+            }
+            nl.reset();
+            throw std::runtime_error(mes);
+        }
+        program = std::make_unique<bytecode>(*nl);
+        auto &nodes = nl->get_nodes();
+        values.assign(nl->get_nets().size(), 0);
+        inputs.clear();
+        seq.clear();
+        gates.clear();
+        for(size_t n=0; n<nodes.size(); n++){
+            auto &nd = nodes[n];
+            if(nd.type == netlist::types_node::t_in || nd.type == netlist::types_node::t_clock){
+                inputs.emplace_back(nd.elem, nd.outs[0]);
+            }else if(nd.sequential){
+                auto el = dynamic_cast<elem_sequential*>(nd.elem);
+                const gate &clk = *el->get_in(el->get_ins_size()-1);
+                seq.emplace_back(seq_node{n, el, el->get_state().word(0), clk.get_values().word(0)});
+                for(size_t out=0; out<nd.outs.size(); out++){
+                    p_write(nd.outs[out], netlist::state_out(nd.type, seq.back().state, out));
+                }
+            }
+        }
+        auto add = [this](gate_out* gt){
+            auto net = nl->find_net(gt->get_id());
+            if(net != netlist::npos){
+                gates.emplace_back(gt, net);
+            }
+        };
+        for(auto &el:s){
+            if(dynamic_cast<elem_meta*>(el.get())){
+                continue;
+            }
+            for(size_t k=0; k<el->get_outs_size(); k++){
+                add(el->get_out(k).get());
+            }
+            if(auto el_out = dynamic_cast<elem_out*>(el.get())){
+                add(el_out->get_outer().get());
+            }
+        }
+    }
+
+    //samples every sequential node that sees a rising edge, then updates them
+    bool p_clock_edge(){
+        auto &nodes = nl->get_nodes();
+        std::vector<std::pair<seq_node*, uint64_t>> updating;
+        for(auto &sq:seq){
+            auto &nd = nodes[sq.node];
+            auto clk = p_read(nd.ins.back());
+            if(clk && !sq.last_clk){
+                auto next = netlist::next_state(nd.type, [this, &nd](const size_t &i){
+                    return p_read(nd.ins[i]);
+                }, sq.state);
+                updating.emplace_back(&sq, next);
+            }
+            sq.last_clk = clk;
+        }
+        for(auto &[sq, next]:updating){
+            auto &nd = nodes[sq->node];
+            for(size_t out=0; out<nd.outs.size(); out++){
+                p_write(nd.outs[out], netlist::state_out(nd.type, next, out));
+            }
+            sq->state = p_read(nd.outs[0]);
+            scratch.resize(sq->el->get_width());
+            scratch.set_word(0, sq->state);
+            sq->el->set_state(scratch);
+        }
+        return !updating.empty();
+    }
+public:
+    bool tick(class sim &s)override{
+        if(!program){
+            p_compile(s);
+        }
+        for(auto &[el, net]:inputs){
+            el->reset_processed();
+            el->process();
+            p_write(net, el->get_out(0)->get_values().word(0));
+        }
+        program->run(values.data());
+        bool stable = true;
+        for(size_t rounds=1; p_clock_edge(); rounds++){
+            if(rounds >= s.get_settle_limit()){
+                stable = false;
+                break;
+            }
+            program->run(values.data());
+        }
+        for(auto &[gt, net]:gates){
+            auto value = p_read(net);
+            const gate &g = *gt;
+            if(g.get_values().word(0) != value){
+                scratch.resize(g.get_width());
+                scratch.set_word(0, value);
+                gt->pass_value(scratch);
+            }
+        }
+        return stable;
+    }
+    void invalidate()override{
+        program.reset();
+        nl.reset();
+    }
+
+    //null until first tick after an edit
+    const bytecode* get_program()const{
+        return program.get();
+    }
+};
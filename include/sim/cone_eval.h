@@ -0,0 +1,227 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <unordered_map>
+#include <algorithm>
+#include "netlist.h"
+
+//demand driven evaluation of a netlist: reading a net evaluates only nodes of
+//its fan-in cone and remembers their results, changing an input forgets the
+//results of its fan-out cone. Reading a net again after an input outside of
+//its cone changed costs nothing. There is no time, clocks are plain inputs
+//and sequential nodes hold the state they were compiled with until set_state
+//or step. Rams are evaluated on step whether read or not, so no write is lost
+class cone_eval{
+    const netlist &nl;
+    std::vector<uint64_t> values;   //by storage net
+    std::vector<uint64_t> masks;
+    std::vector<bool> valid;        //per node, outputs are up to date
+    std::vector<bool> visiting;
+    std::vector<std::vector<size_t>> drivers;   //nodes writing bits a net reads
+    std::vector<std::vector<size_t>> deps;      //drivers of all inputs of a node
+    std::unordered_map<size_t, bits::bit_vector> rams;
+    std::vector<uint64_t> states, next;
+    std::vector<size_t> sequential, writable;  //nodes with state, ram nodes
+    size_t evaluated = 0;
+
+    uint64_t p_read(const size_t &net)const{
+        auto &nt = nl.get_nets()[net];
+        return (values[nt.storage] >> nt.offset) & masks[net];
+    }
+    //returns true if value changed
+    bool p_write(const size_t &net, const uint64_t &value){
+        auto &nt = nl.get_nets()[net];
+        auto &word = values[nt.storage];
+        auto updated = (word & ~(masks[net] << nt.offset)) | ((value & masks[net]) << nt.offset);
+        bool changed = updated != word;
+        word = updated;
+        return changed;
+    }
+
+    bool p_computed(const size_t &n)const{
+        auto &nd = nl.get_nodes()[n];
+        return !nd.sequential && nd.type != netlist::types_node::t_in &&
+            nd.type != netlist::types_node::t_clock;
+    }
+
+    //forgets results of every node reading the net and of everything after it,
+    //up to state elements: what they show only changes through set_state
+    void p_invalidate(const size_t &net){
+        auto &nets = nl.get_nets();
+        auto &fanout = nl.get_fanout();
+        std::vector<size_t> stack;
+        for(auto &other:nl.get_sharing(net)){
+            for(auto &r:nets[other].readers){
+                stack.emplace_back(r);
+            }
+        }
+        while(!stack.empty()){
+            auto n = stack.back();
+            stack.pop_back();
+            if(!p_computed(n) || !valid[n]){
+                continue;
+            }
+            valid[n] = false;
+            stack.insert(stack.end(), fanout[n].begin(), fanout[n].end());
+        }
+    }
+
+    void p_evaluate(const size_t &n){
+        auto &nd = nl.get_nodes()[n];
+        auto in = [this, &nd](const size_t &i){
+            return p_read(nd.ins[i]);
+        };
+        if(nd.type == netlist::types_node::t_ram || nd.type == netlist::types_node::t_rom){
+            p_write(nd.outs[0], netlist::eval_memory(nd, in, rams[n]));
+        }else{
+            for(size_t out=0; out<nd.outs.size(); out++){
+                p_write(nd.outs[out], netlist::eval(nd, in, out));
+            }
+        }
+        evaluated++;
+    }
+
+    //evaluates a node after every node of its cone that is not up to date
+    void p_pull(const size_t &start){
+        if(valid[start]){
+            return;
+        }
+        auto &nodes = nl.get_nodes();
+        std::vector<std::pair<size_t, size_t>> calls;   //node, next dependency
+        calls.emplace_back(start, 0);
+        visiting[start] = true;
+        while(!calls.empty()){
+            auto n = calls.back().first;
+            auto i = calls.back().second;
+            if(i < deps[n].size()){
+                calls.back().second++;
+                auto d = deps[n][i];
+                if(valid[d]){
+                    continue;
+                }
+                if(visiting[d]){
+                    for(auto &call:calls){
+                        visiting[call.first] = false;
+                    }
+                    throw std::runtime_error("attempt to evaluate "+nodes[start].name+
+                        ", which depends on itself through "+nodes[d].name);
+                }
+                visiting[d] = true;
+                calls.emplace_back(d, 0);
+                continue;
+            }
+            calls.pop_back();
+            visiting[n] = false;
+            if(!valid[n]){
+                p_evaluate(n);
+                valid[n] = true;
+            }
+        }
+    }
+public:
+    cone_eval(const netlist &nl)
+        :nl(nl)
+    {
+        auto &nets = nl.get_nets();
+        auto &nodes = nl.get_nodes();
+        for(auto &nt:nets){
+            if(nt.width > 64){
+                throw std::runtime_error("attempt to evaluate net "+nt.name+
+                    " of width "+std::to_string(nt.width)+", cone_eval supports up to 64 bits");
+            }
+            masks.emplace_back((nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1);
+        }
+        values.assign(nets.size(), 0);
+        valid.assign(nodes.size(), false);
+        visiting.assign(nodes.size(), false);
+        states.assign(nodes.size(), 0);
+        next.assign(nodes.size(), 0);
+        drivers.resize(nets.size());
+        for(size_t net_id=0; net_id<nets.size(); net_id++){
+            for(auto &other:nl.get_sharing(net_id)){
+                auto d = nets[other].driver;
+                if(d != netlist::npos && p_computed(d)){
+                    drivers[net_id].emplace_back(d);
+                }
+            }
+        }
+        deps.resize(nodes.size());
+        for(size_t n=0; n<nodes.size(); n++){
+            for(auto &in:nodes[n].ins){
+                deps[n].insert(deps[n].end(), drivers[in].begin(), drivers[in].end());
+            }
+            std::sort(deps[n].begin(), deps[n].end());
+            deps[n].erase(std::unique(deps[n].begin(), deps[n].end()), deps[n].end());
+            if(!p_computed(n)){
+                valid[n] = true;
+            }
+            if(nodes[n].sequential){
+                auto seq = dynamic_cast<const elem_sequential*>(nodes[n].elem);
+                set_state(n, seq->get_state().word(0));
+                sequential.emplace_back(n);
+            }else if(nodes[n].type == netlist::types_node::t_ram){
+                rams[n] = dynamic_cast<const elem_ram*>(nodes[n].elem)->get_contents();
+                writable.emplace_back(n);
+            }
+        }
+    }
+
+    //value of a net driven from outside, e.g. by an input or clock node
+    void set_input(const size_t &net, const uint64_t &value){
+        if(p_write(net, value)){
+            p_invalidate(net);
+        }
+    }
+    //state shown by a sequential node
+    void set_state(const size_t &node, const uint64_t &state){
+        auto &nd = nl.get_nodes().at(node);
+        if(!nd.sequential){
+            throw std::runtime_error("attempt to set state of "+nd.name+", which is not sequential");
+        }
+        states[node] = state;
+        for(size_t out=0; out<nd.outs.size(); out++){
+            set_input(nd.outs[out], netlist::state_out(nd.type, state, out));
+        }
+    }
+
+    //one clock cycle like cycle_sim::step: rams take writes of current inputs,
+    //every sequential node samples its inputs, then all of them update and
+    //rams take writes of the new state. Only cones that changed are evaluated
+    void step(){
+        auto &nodes = nl.get_nodes();
+        for(auto &n:writable){
+            p_pull(n);
+        }
+        for(auto &n:sequential){
+            auto &nd = nodes[n];
+            next[n] = netlist::next_state(nd.type, [this, &nd](const size_t &i){
+                return get_value(nd.ins[i]);
+            }, states[n]) & masks[nd.outs[0]];
+        }
+        for(auto &n:sequential){
+            if(next[n] != states[n]){
+                set_state(n, next[n]);
+            }
+        }
+        for(auto &n:writable){
+            p_pull(n);
+        }
+    }
+
+    //evaluates what the net depends on, if it is not known already
+    uint64_t get_value(const size_t &net){
+        for(auto &d:drivers.at(net)){
+            p_pull(d);
+        }
+        return p_read(net);
+    }
+    //nodes evaluated so far, results taken from memory are not counted
+    size_t evaluations()const{
+        return evaluated;
+    }
+    bool is_valid(const size_t &node)const{
+        return valid.at(node);
+    }
+};
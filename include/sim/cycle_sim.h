@@ -0,0 +1,258 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <unordered_map>
+#include <algorithm>
+#include "netlist.h"
+
+//cycle based simulation of a synchronous netlist: a step is one rising edge of
+//the clock, combinational logic is evaluated once per step in levelized order
+//and there is no event queue. Only designs that pass check() are accepted,
+//the netlist must outlive it
+class cycle_sim{
+    const netlist &nl;
+    std::vector<uint64_t> values;   //by storage net
+    std::vector<size_t> storage, offset;
+    std::vector<uint64_t> masks;
+    std::vector<size_t> order;      //combinational nodes, drivers before readers
+    std::vector<size_t> sequential;
+    std::vector<uint64_t> states, next;
+    std::unordered_map<size_t, bits::bit_vector> rams;
+    bool inputs_changed = false;
+    uint64_t cycle = 0;
+
+    uint64_t p_read(const size_t &net)const{
+        return (values[storage[net]] >> offset[net]) & masks[net];
+    }
+    void p_write(const size_t &net, const uint64_t &value){
+        auto &word = values[storage[net]];
+        word = (word & ~(masks[net] << offset[net])) | ((value & masks[net]) << offset[net]);
+    }
+
+    uint64_t p_eval_memory(const size_t &n, const netlist::node &nd){
+        return netlist::eval_memory(nd,
+            [this, &nd](const size_t &i){
+                return p_read(nd.ins[i]);
+            }, rams[n]);
+    }
+
+    void p_drive_state(const size_t &n){
+        auto &nd = nl.get_nodes()[n];
+        for(size_t out=0; out<nd.outs.size(); out++){
+            p_write(nd.outs[out], netlist::state_out(nd.type, states[n], out));
+        }
+    }
+
+    //clock net a node reads, followed back through buffers
+    static size_t p_clock_root(const netlist &nl, size_t net){
+        auto &nets = nl.get_nets();
+        auto &nodes = nl.get_nodes();
+        while(true){
+            auto driver = nets[nets[net].storage].driver;
+            if(nets[net].storage != net || driver == netlist::npos ||
+                nodes[driver].type != netlist::types_node::t_buf)
+            {
+                return net;
+            }
+            net = nodes[driver].ins.at(0);
+        }
+    }
+public:
+    //reasons the netlist needs event semantics, empty if it can run cycle based
+    static std::vector<std::string> check(const netlist &nl){
+        std::vector<std::string> problems;
+        auto &nets = nl.get_nets();
+        auto &nodes = nl.get_nodes();
+        for(auto &loop:nl.get_comb_loops()){
+            problems.emplace_back("combinational loop: "+nl.describe(loop));
+        }
+        for(auto &nt:nets){
+            if(nt.width > 64){
+                problems.emplace_back("net "+nt.name+" is wider than 64 bits");
+            }
+        }
+        size_t clocks = 0;
+        for(auto &nd:nodes){
+            clocks += nd.type == netlist::types_node::t_clock;
+        }
+        if(clocks > 1){
+            problems.emplace_back("design has "+std::to_string(clocks)+" clocks, one is allowed");
+        }
+        //every register is clocked straight from the one clock or input
+        size_t clock = netlist::npos;
+        std::vector<bool> is_clock(nets.size(), false);
+        for(auto &nd:nodes){
+            if(!nd.sequential){
+                continue;
+            }
+            auto root = p_clock_root(nl, nd.ins.back());
+            auto driver = nets[root].driver;
+            bool direct = nets[root].storage == root && driver != netlist::npos &&
+                (nodes[driver].type == netlist::types_node::t_clock ||
+                nodes[driver].type == netlist::types_node::t_in);
+            if(!direct){
+                problems.emplace_back(nd.name+" is clocked by derived signal "+nets[root].name);
+            }else if(clock != netlist::npos && clock != root){
+                problems.emplace_back(nd.name+" is clocked by "+nets[root].name+
+                    ", others by "+nets[clock].name);
+            }else{
+                clock = root;
+            }
+            is_clock[root] = true;
+        }
+        //a clock feeding logic makes values change in between edges
+        for(size_t net_id=0; net_id<nets.size(); net_id++){
+            auto root = p_clock_root(nl, net_id);
+            auto driver = nets[root].driver;
+            bool from_clock = is_clock[root] || (driver != netlist::npos &&
+                nodes[driver].type == netlist::types_node::t_clock);
+            if(!from_clock){
+                continue;
+            }
+            for(auto &r:nets[net_id].readers){
+                auto &nd = nodes[r];
+                bool clock_port = nd.sequential && nd.ins.back() == net_id &&
+                    std::count(nd.ins.begin(), nd.ins.end(), net_id) == 1;
+                if(!clock_port && nd.type != netlist::types_node::t_buf){
+                    problems.emplace_back("clock "+nets[root].name+" feeds logic "+nd.name);
+                }
+            }
+        }
+        return problems;
+    }
+
+    cycle_sim(const netlist &nl)
+        :nl(nl)
+    {
+        auto problems = check(nl);
+        if(!problems.empty()){
+            std::string mes = "attempt to simulate cycle based a design that needs events:";
+            for(auto &p:problems){
+                mes += "\n"+p;
+            }
+            throw std::runtime_error(mes);
+        }
+        auto &nets = nl.get_nets();
+        auto &nodes = nl.get_nodes();
+        for(auto &nt:nets){
+            storage.emplace_back(nt.storage);
+            offset.emplace_back(nt.offset);
+            masks.emplace_back((nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1);
+        }
+        values.assign(nets.size(), 0);
+        states.assign(nodes.size(), 0);
+        next.assign(nodes.size(), 0);
+
+        //Kahn's algorithm over combinational edges, which check() found acyclic
+        auto &fanout = nl.get_fanout();
+        std::vector<size_t> pending(nodes.size(), 0);
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].sequential){
+                continue;
+            }
+            for(auto &r:fanout[n]){
+                pending[r]++;
+            }
+        }
+        std::vector<size_t> ready;
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].sequential){
+                sequential.emplace_back(n);
+                auto seq = dynamic_cast<const elem_sequential*>(nodes[n].elem);
+                states[n] = seq->get_state().word(0);
+                p_drive_state(n);
+            }else if(nodes[n].type == netlist::types_node::t_ram){
+                rams[n] = dynamic_cast<const elem_ram*>(nodes[n].elem)->get_contents();
+            }
+            if(pending[n] == 0){
+                ready.emplace_back(n);
+            }
+        }
+        while(!ready.empty()){
+            auto n = ready.back();
+            ready.pop_back();
+            auto type = nodes[n].type;
+            if(!nodes[n].sequential && type != netlist::types_node::t_in &&
+                type != netlist::types_node::t_clock)
+            {
+                order.emplace_back(n);
+            }
+            if(nodes[n].sequential){
+                continue;
+            }
+            for(auto &r:fanout[n]){
+                if(--pending[r] == 0){
+                    ready.emplace_back(r);
+                }
+            }
+        }
+        evaluate();
+    }
+
+    //value of an input net, visible to logic on next evaluate or step
+    void set_input(const size_t &net, const uint64_t &value){
+        p_write(net, value);
+        inputs_changed = true;
+    }
+
+    //one pass over combinational logic in level order
+    void evaluate(){
+        auto &nodes = nl.get_nodes();
+        for(auto &n:order){
+            auto &nd = nodes[n];
+            if(nd.type == netlist::types_node::t_ram || nd.type == netlist::types_node::t_rom){
+                p_write(nd.outs[0], p_eval_memory(n, nd));
+                continue;
+            }
+            for(size_t out=0; out<nd.outs.size(); out++){
+                p_write(nd.outs[out], netlist::eval(nd,
+                    [this, &nd](const size_t &i){
+                        return p_read(nd.ins[i]);
+                    }, out));
+            }
+        }
+        inputs_changed = false;
+    }
+
+    //one clock cycle: every register samples settled logic, then all of them
+    //update and logic is evaluated once for the new state
+    void step(){
+        if(inputs_changed){
+            evaluate();
+        }
+        auto &nodes = nl.get_nodes();
+        for(auto &n:sequential){
+            auto &nd = nodes[n];
+            next[n] = netlist::next_state(nd.type,
+                [this, &nd](const size_t &i){
+                    return p_read(nd.ins[i]);
+                }, states[n]) & masks[nd.outs[0]];
+        }
+        for(auto &n:sequential){
+            if(next[n] != states[n]){
+                states[n] = next[n];
+                p_drive_state(n);
+            }
+        }
+        evaluate();
+        cycle++;
+    }
+    void run(const uint64_t &cycles){
+        for(uint64_t i=0; i<cycles; i++){
+            step();
+        }
+    }
+
+    uint64_t get_value(const size_t &net)const{
+        return (values[storage.at(net)] >> offset[net]) & masks[net];
+    }
+    const uint64_t& get_cycle()const{
+        return cycle;
+    }
+    //combinational nodes in the order they are evaluated
+    const std::vector<size_t>& get_order()const{
+        return order;
+    }
+};
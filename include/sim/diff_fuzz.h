@@ -0,0 +1,796 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <functional>
+#include <random>
+#include <fstream>
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include "sim.h"
+#include "file_ops.h"
+#include "netlist.h"
+#include "cycle_sim.h"
+#include "bytecode.h"
+#include "aig.h"
+#include "pattern_sim.h"
+#include "timing_sim.h"
+#include "cone_eval.h"
+#include "lut_map.h"
+
+//random synchronous circuit kept as a plain list, so it can be rebuilt after
+//every edit of the shrinker. Combinational items read earlier items only,
+//sequential ones read any item, which gives loops through state but never
+//combinational ones. All sequential items share one clock. Items other than
+//inputs may sit in nested metas, reads across a meta go through its ports
+struct fuzz_design{
+    enum class kinds{
+        k_in,
+        k_and,
+        k_or,
+        k_xor,
+        k_nand,
+        k_nor,
+        k_xnor,
+        k_not,
+        k_mux,      //param is select width
+        k_lut,      //param is table
+        k_decoder,
+        k_encoder,  //index output
+        k_split,    //param is half taken
+        k_merge,
+        k_dff,
+        k_register,
+        k_counter
+    };
+    struct item{
+        kinds kind;
+        size_t width;
+        std::vector<size_t> ins;    //items
+        uint64_t param = 0;
+        size_t meta = 0;            //0 is root, m is the one of metas[m-1]
+    };
+    struct ports{
+        std::vector<elem_in*> ins;      //by input item, in order
+        std::vector<elem_out*> outs;    //by output
+    };
+
+    std::vector<item> items;
+    std::vector<size_t> metas;      //parent of each, 0 is root
+    std::vector<size_t> outputs;    //items
+    std::vector<std::vector<uint64_t>> stimulus;    //per cycle, by item; only inputs use theirs
+
+    static bool is_sequential(const kinds &kind){
+        return kind == kinds::k_dff || kind == kinds::k_register || kind == kinds::k_counter;
+    }
+    std::vector<size_t> inputs()const{
+        std::vector<size_t> result;
+        for(size_t i=0; i<items.size(); i++){
+            if(items[i].kind == kinds::k_in){
+                result.emplace_back(i);
+            }
+        }
+        return result;
+    }
+
+    static fuzz_design generate(std::mt19937_64 &rng, const size_t &items_count = 24,
+        const size_t &cycles = 32)
+    {
+        fuzz_design d;
+        auto random = [&rng](const size_t &n){
+            return size_t(rng()%n);
+        };
+        auto random_width = [&](){
+            return size_t(1) << random(3);
+        };
+        //item of given width among first limit ones, inputs of width 1, 2
+        //and 4 come first so there always is one
+        auto pick = [&](const size_t &width, const size_t &limit){
+            std::vector<size_t> fits;
+            for(size_t i=0; i<limit; i++){
+                if(d.items[i].width == width){
+                    fits.emplace_back(i);
+                }
+            }
+            return fits[random(fits.size())];
+        };
+        auto inputs_count = 3+random(3);
+        for(size_t i=0; i<inputs_count; i++){
+            d.items.emplace_back(item{kinds::k_in, (i < 3)? size_t(1) << i : random_width(), {}});
+        }
+        //metas without state can be tabulated, state goes to root or to the others
+        std::vector<size_t> stateful{0};
+        for(size_t m=random(4); m>0; m--){
+            d.metas.emplace_back(random(d.metas.size()+1));
+            if(random(2)){
+                stateful.emplace_back(d.metas.size());
+            }
+        }
+        while(d.items.size() < std::max(items_count, inputs_count+1)){
+            auto limit = d.items.size();
+            item it{kinds(1+random(size_t(kinds::k_counter))), random_width(), {}};
+            it.meta = is_sequential(it.kind)? stateful[random(stateful.size())] : random(d.metas.size()+1);
+            switch(it.kind){
+            case kinds::k_and:
+            case kinds::k_or:
+            case kinds::k_xor:
+            case kinds::k_nand:
+            case kinds::k_nor:
+            case kinds::k_xnor:
+                for(size_t k=2+random(2); k>0; k--){
+                    it.ins.emplace_back(pick(it.width, limit));
+                }
+                break;
+            case kinds::k_not:
+                it.ins.emplace_back(pick(it.width, limit));
+                break;
+            case kinds::k_mux:
+                it.param = 1+random(2);
+                for(size_t k=0; k<(size_t(1) << it.param); k++){
+                    it.ins.emplace_back(pick(it.width, limit));
+                }
+                it.ins.emplace_back(pick(it.param, limit));
+                break;
+            case kinds::k_lut:
+                for(size_t k=2+random(2); k>0; k--){
+                    it.ins.emplace_back(pick(it.width, limit));
+                }
+                it.param = rng() & ((uint64_t(1) << (size_t(1) << it.ins.size()))-1);
+                break;
+            case kinds::k_decoder:{
+                auto sel = 1+random(2);
+                it.width = size_t(1) << sel;
+                it.ins.emplace_back(pick(sel, limit));
+                break;
+            }
+            case kinds::k_encoder:{
+                auto width = size_t(2) << random(2);
+                it.width = elem_priority_encoder::index_width(width);
+                it.ins.emplace_back(pick(width, limit));
+                break;
+            }
+            case kinds::k_split:{
+                auto width = size_t(2) << random(2);
+                it.width = width/2;
+                it.param = random(2);
+                it.ins.emplace_back(pick(width, limit));
+                break;
+            }
+            case kinds::k_merge:
+                it.width = size_t(2) << random(2);
+                it.ins.emplace_back(pick(it.width/2, limit));
+                it.ins.emplace_back(pick(it.width/2, limit));
+                break;
+            case kinds::k_dff:
+                it.width = 1;
+                break;
+            default:
+                break;
+            }
+            d.items.emplace_back(std::move(it));
+        }
+        for(auto &it:d.items){
+            if(it.kind == kinds::k_dff){
+                it.ins = {pick(1, d.items.size())};
+            }else if(it.kind == kinds::k_register){
+                it.ins = {pick(it.width, d.items.size()), pick(1, d.items.size())};
+            }else if(it.kind == kinds::k_counter){
+                it.ins = {pick(1, d.items.size()), pick(1, d.items.size())};
+            }
+        }
+        for(size_t k=1+random(4); k>0; k--){
+            d.outputs.emplace_back(inputs_count+random(d.items.size()-inputs_count));
+        }
+        d.stimulus.resize(cycles);
+        for(auto &values:d.stimulus){
+            for(auto &it:d.items){
+                values.emplace_back((it.kind == kinds::k_in)? rng() & ((uint64_t(1) << it.width)-1) : 0);
+            }
+        }
+        return d;
+    }
+
+    //elements of the design in a sim: item i is named n<i>, output k o<k>,
+    //meta m m<m>. Ports of a meta are named i<item> and q<item>, the clock
+    //comes in through clk; metas nothing sits in are left out
+    ports build(class sim &s)const{
+        ports result;
+        std::vector<element*> els;
+        bool clocked = false;
+        std::vector<sim::k_tree_it> meta_its(metas.size()+1);
+        std::vector<bool> made(metas.size()+1, false);
+        std::function<sim::k_tree_it(const size_t&)> meta_of = [&](const size_t &m){
+            if(!made[m]){
+                auto el = std::make_unique<elem_meta>("m"+std::to_string(m));
+                auto parent = metas[m-1];
+                meta_its[m] = parent? s.emplace(meta_of(parent), std::move(el)) : s.emplace(std::move(el));
+                made[m] = true;
+            }
+            return meta_its[m];
+        };
+        auto place = [&](const size_t &m, std::unique_ptr<element> el){
+            if(m){
+                s.emplace(meta_of(m), std::move(el));
+            }else{
+                s.emplace(std::move(el));
+            }
+        };
+        for(size_t i=0; i<items.size(); i++){
+            auto &it = items[i];
+            auto name = "n"+std::to_string(i);
+            std::unique_ptr<element> el;
+            switch(it.kind){
+            case kinds::k_in:{
+                auto in = std::make_unique<elem_in>(name, it.width);
+                result.ins.emplace_back(in.get());
+                el = std::move(in);
+                break;
+            }
+            case kinds::k_and:  el = std::make_unique<elem_and>(name, it.width, it.ins.size()); break;
+            case kinds::k_or:   el = std::make_unique<elem_or>(name, it.width, it.ins.size()); break;
+            case kinds::k_xor:  el = std::make_unique<elem_xor>(name, it.width, it.ins.size()); break;
+            case kinds::k_nand: el = std::make_unique<elem_nand>(name, it.width, it.ins.size()); break;
+            case kinds::k_nor:  el = std::make_unique<elem_nor>(name, it.width, it.ins.size()); break;
+            case kinds::k_xnor: el = std::make_unique<elem_xnor>(name, it.width, it.ins.size()); break;
+            case kinds::k_not:  el = std::make_unique<elem_not>(name, it.width); break;
+            case kinds::k_mux:  el = std::make_unique<elem_mux>(name, it.width, it.param); break;
+            case kinds::k_lut:
+                el = std::make_unique<elem_lut>(name, it.width, it.ins.size(), it.param);
+                break;
+            case kinds::k_decoder:
+                el = std::make_unique<elem_decoder>(name, items[it.ins[0]].width);
+                break;
+            case kinds::k_encoder:
+                el = std::make_unique<elem_priority_encoder>(name, items[it.ins[0]].width);
+                break;
+            case kinds::k_split:
+                el = std::make_unique<elem_splitter>(name, std::vector<size_t>{it.width, it.width});
+                break;
+            case kinds::k_merge:
+                el = std::make_unique<elem_merger>(name, std::vector<size_t>{it.width/2, it.width/2});
+                break;
+            case kinds::k_dff:      el = std::make_unique<elem_dff>(name); break;
+            case kinds::k_register: el = std::make_unique<elem_register>(name, it.width); break;
+            case kinds::k_counter:  el = std::make_unique<elem_counter>(name, it.width); break;
+            }
+            clocked |= is_sequential(it.kind);
+            els.emplace_back(el.get());
+            place(it.meta, std::move(el));
+        }
+        gate_out* clk = nullptr;
+        if(clocked){
+            auto el = std::make_unique<elem_clock>("clk", 1);
+            clk = el->get_out(0).get();
+            s.emplace(std::move(el));
+        }
+        //output of item i, or of the clock for items.size(), as seen in meta m
+        auto contains = [this](size_t outer, size_t m){
+            while(m && m != outer){
+                m = metas[m-1];
+            }
+            return m == outer;
+        };
+        std::map<std::pair<size_t, size_t>, gate_out*> seen;
+        std::function<gate_out*(const size_t&, const size_t&)> source = [&](const size_t &i, const size_t &m){
+            auto found = seen.find({i, m});
+            if(found != seen.end()){
+                return found->second;
+            }
+            auto home = (i < items.size())? items[i].meta : 0;
+            gate_out* result = nullptr;
+            if(home == m){
+                result = (i < items.size())?
+                    els[i]->get_out((items[i].kind == kinds::k_split)? items[i].param : 0).get() : clk;
+            }else if(contains(m, home)){
+                auto child = home;
+                while(metas[child-1] != m){
+                    child = metas[child-1];
+                }
+                auto port = std::make_unique<elem_out>("q"+std::to_string(i), items[i].width);
+                source(i, child)->tie_input(port->get_in(0));
+                result = port->get_outer().get();
+                s.emplace(meta_of(child), std::move(port));
+            }else{
+                auto name = (i < items.size())? "i"+std::to_string(i) : std::string("clk");
+                auto port = std::make_unique<elem_in>(name, (i < items.size())? items[i].width : 1);
+                source(i, metas[m-1])->tie_input(port->get_outer());
+                result = port->get_out(0).get();
+                s.emplace(meta_of(m), std::move(port));
+            }
+            seen[{i, m}] = result;
+            return result;
+        };
+        for(size_t i=0; i<items.size(); i++){
+            auto &it = items[i];
+            for(size_t k=0; k<it.ins.size(); k++){
+                source(it.ins[k], it.meta)->tie_input(els[i]->get_in(k));
+            }
+            if(is_sequential(it.kind)){
+                source(items.size(), it.meta)->tie_input(els[i]->get_in(it.ins.size()));
+            }
+        }
+        for(size_t k=0; k<outputs.size(); k++){
+            auto out = std::make_unique<elem_out>("o"+std::to_string(k), items[outputs[k]].width);
+            source(outputs[k], 0)->tie_input(out->get_in(0));
+            result.outs.emplace_back(out.get());
+            s.emplace(std::move(out));
+        }
+        return result;
+    }
+};
+
+//differential testing of simulation engines against sim::tick as reference,
+//which evaluates every element on every pass with no meta skipped.
+//Every engine runs a design over its stimulus and gives values of outputs per
+//cycle; a cycle is inputs set, one tick, which is the rising edge of the clock,
+//outputs read and one more tick for the falling edge. A mismatch is shrunk to
+//a small design that still shows it and can be saved for replay
+class diff_fuzzer{
+public:
+    using trace = std::vector<std::vector<uint64_t>>;   //per cycle, by output
+    struct engine{
+        std::string name;
+        std::function<trace(const fuzz_design&)> run;
+    };
+    struct mismatch{
+        std::string engine;
+        size_t cycle = 0;
+        size_t output = 0;
+        uint64_t expected = 0, actual = 0;
+        std::string what;   //message if the engine threw
+    };
+private:
+    std::vector<engine> engines;
+
+    //sim with an optional engine, pruning, truth tables or skipping of clean
+    //metas, the way a user ticks it
+    static trace p_tick(const fuzz_design &d, std::unique_ptr<sim_engine> eng, const bool &pruning,
+        const bool &tables = false, const bool &scoping = true)
+    {
+        class sim s;
+        auto p = d.build(s);
+        if(eng){
+            s.set_engine(std::move(eng));
+        }
+        s.set_pruning(pruning);
+        s.set_truth_tables(tables);
+        s.set_scoping(scoping);
+        auto inputs = d.inputs();
+        trace result;
+        for(auto &values:d.stimulus){
+            for(size_t i=0; i<inputs.size(); i++){
+                bits::bit_vector v(d.items[inputs[i]].width);
+                v.set_word(0, values[inputs[i]]);
+                p.ins[i]->set_values(v);
+            }
+            s.tick();
+            std::vector<uint64_t> outs;
+            for(auto &out:p.outs){
+                outs.emplace_back(out->get_outer()->get_values().word(0));
+            }
+            result.emplace_back(std::move(outs));
+            s.tick();
+        }
+        return result;
+    }
+
+    static bool p_fails(const std::vector<engine> &engines, const fuzz_design &d,
+        const std::string &name, mismatch &found)
+    {
+        try{
+            for(auto &m:compare(engines, d)){
+                if(m.engine == name){
+                    found = m;
+                    return true;
+                }
+            }
+        }catch(std::exception&){
+            //reference rejects the design, it does not reproduce anything
+        }
+        return false;
+    }
+
+    //design without items no output depends on, indices and stimulus follow
+    static fuzz_design p_prune(const fuzz_design &d){
+        std::vector<bool> live(d.items.size(), false);
+        std::vector<size_t> stack(d.outputs.begin(), d.outputs.end());
+        while(!stack.empty()){
+            auto i = stack.back();
+            stack.pop_back();
+            if(live[i]){
+                continue;
+            }
+            live[i] = true;
+            stack.insert(stack.end(), d.items[i].ins.begin(), d.items[i].ins.end());
+        }
+        std::vector<size_t> index(d.items.size(), 0);
+        fuzz_design result;
+        result.metas = d.metas;
+        for(size_t i=0; i<d.items.size(); i++){
+            if(live[i]){
+                index[i] = result.items.size();
+                result.items.emplace_back(d.items[i]);
+            }
+        }
+        for(auto &it:result.items){
+            for(auto &in:it.ins){
+                in = index[in];
+            }
+        }
+        for(auto &o:d.outputs){
+            result.outputs.emplace_back(index[o]);
+        }
+        for(auto &values:d.stimulus){
+            std::vector<uint64_t> kept;
+            for(size_t i=0; i<d.items.size(); i++){
+                if(live[i]){
+                    kept.emplace_back(values[i]);
+                }
+            }
+            result.stimulus.emplace_back(std::move(kept));
+        }
+        return result;
+    }
+public:
+    //engines to test, built in ones if none given
+    explicit diff_fuzzer(std::vector<engine> engines = {})
+        :engines(std::move(engines))
+    {
+        if(this->engines.empty()){
+            this->engines = default_engines();
+        }
+    }
+
+    const std::vector<engine>& get_engines()const{
+        return engines;
+    }
+    void add_engine(engine e){
+        engines.emplace_back(std::move(e));
+    }
+
+    static trace reference(const fuzz_design &d){
+        return p_tick(d, nullptr, false, false, false);
+    }
+
+    //netlist engine with set_input, step and get_value, made by make from the
+    //netlist of the design or from what transform turns it into
+    template<class Engine>
+    static trace stepped(const fuzz_design &d,
+        const std::function<std::unique_ptr<Engine>(const netlist&)> &make,
+        const std::function<netlist(const netlist&)> &transform = nullptr)
+    {
+        class sim s;
+        auto p = d.build(s);
+        netlist built(s);
+        std::unique_ptr<netlist> transformed;
+        if(transform){
+            transformed = std::make_unique<netlist>(transform(built));
+        }
+        auto &nl = transformed? *transformed : built;
+        auto e = make(nl);
+        auto inputs = d.inputs();
+        trace result;
+        for(auto &values:d.stimulus){
+            for(size_t i=0; i<inputs.size(); i++){
+                e->set_input(nl.find_net(p.ins[i]->get_out(0)->get_id()), values[inputs[i]]);
+            }
+            e->step();
+            std::vector<uint64_t> outs;
+            for(auto &out:p.outs){
+                outs.emplace_back(e->get_value(nl.find_net(out->get_outer()->get_id())));
+            }
+            result.emplace_back(std::move(outs));
+        }
+        return result;
+    }
+
+    //event driven, inputs change a quarter period before the rising edge and
+    //outputs are read a quarter period after it. Logic takes a time unit per
+    //node, so the period is made long enough for the deepest path to settle
+    static trace timed(const fuzz_design &d){
+        class sim s;
+        auto p = d.build(s);
+        netlist nl(s);
+        timing_sim ts(nl);
+        timing_sim::time_type half = 2*(nl.get_nodes().size()+1);
+        ts.set_clock_scale(half);
+        auto inputs = d.inputs();
+        trace result;
+        for(size_t c=0; c<d.stimulus.size(); c++){
+            auto start = 2*half*c;
+            for(size_t i=0; i<inputs.size(); i++){
+                ts.set_input(nl.find_net(p.ins[i]->get_out(0)->get_id()), d.stimulus[c][inputs[i]],
+                    start+half/2);
+            }
+            ts.run_until(start+half+half/2);
+            std::vector<uint64_t> outs;
+            for(auto &out:p.outs){
+                outs.emplace_back(ts.get_value(nl.find_net(out->get_outer()->get_id())));
+            }
+            result.emplace_back(std::move(outs));
+            ts.run_until(start+2*half);
+        }
+        return result;
+    }
+
+    //demand driven, stepped by cone_eval::step, outputs pulled after
+    static trace pulled(const fuzz_design &d){
+        class sim s;
+        auto p = d.build(s);
+        netlist nl(s);
+        cone_eval ce(nl);
+        auto inputs = d.inputs();
+        trace result;
+        for(auto &values:d.stimulus){
+            for(size_t i=0; i<inputs.size(); i++){
+                ce.set_input(nl.find_net(p.ins[i]->get_out(0)->get_id()), values[inputs[i]]);
+            }
+            ce.step();
+            std::vector<uint64_t> outs;
+            for(auto &out:p.outs){
+                outs.emplace_back(ce.get_value(nl.find_net(out->get_outer()->get_id())));
+            }
+            result.emplace_back(std::move(outs));
+        }
+        return result;
+    }
+
+    //pattern_sim stepping its own state in every pattern. Pattern p runs the
+    //stimulus rotated by p%variants cycles; pattern 0 gives the trace, the
+    //rest are checked against tick under their own stimulus and throw if
+    //they differ
+    static trace patterned(const fuzz_design &d, const size_t &variants = 4){
+        class sim s;
+        auto p = d.build(s);
+        netlist nl(s);
+        aig g(nl);
+        pattern_sim ps(g, 1);
+        auto inputs = d.inputs();
+        auto cycles = d.stimulus.size();
+        auto count = std::max<size_t>(1, std::min(variants, cycles));
+        std::vector<fuzz_design> rotated(count, d);
+        std::vector<trace> expected(count);
+        for(size_t v=1; v<count; v++){
+            for(size_t c=0; c<cycles; c++){
+                rotated[v].stimulus[c] = d.stimulus[(c+v)%cycles];
+            }
+            expected[v] = reference(rotated[v]);
+        }
+        trace result;
+        for(size_t c=0; c<cycles; c++){
+            for(size_t i=0; i<inputs.size(); i++){
+                auto net = nl.find_net(p.ins[i]->get_out(0)->get_id());
+                for(size_t b=0; b<d.items[inputs[i]].width; b++){
+                    if(!g.is_kept(net, b)){
+                        continue;
+                    }
+                    uint64_t lane = 0;
+                    for(size_t k=0; k<ps.patterns(); k++){
+                        lane |= ((rotated[k%count].stimulus[c][inputs[i]] >> b) & 1) << k;
+                    }
+                    ps.set_input_lane(net, b, &lane);
+                }
+            }
+            ps.step();
+            std::vector<uint64_t> outs;
+            for(size_t o=0; o<p.outs.size(); o++){
+                auto net = nl.find_net(p.outs[o]->get_outer()->get_id());
+                outs.emplace_back(ps.get_value(net, 0));
+                for(size_t k=1; k<ps.patterns(); k++){
+                    auto want = (k%count)? expected[k%count][c][o] : outs.back();
+                    auto got = ps.get_value(net, k);
+                    if(got != want){
+                        throw std::runtime_error("pattern "+std::to_string(k)+" differs at cycle "+
+                            std::to_string(c)+" output "+std::to_string(o)+": "+std::to_string(want)+
+                            " expected, "+std::to_string(got)+" seen");
+                    }
+                }
+            }
+            result.emplace_back(std::move(outs));
+        }
+        return result;
+    }
+
+    //bytecode engine, pruning and truth tables under tick, cycle_sim on the
+    //netlist and on it mapped to luts, the and-inverter graph, pattern_sim
+    //over it, timing_sim and cone_eval
+    static std::vector<engine> default_engines(){
+        std::vector<engine> result;
+        result.emplace_back(engine{"scoped", [](const fuzz_design &d){
+            return p_tick(d, nullptr, false);
+        }});
+        result.emplace_back(engine{"bytecode", [](const fuzz_design &d){
+            return p_tick(d, std::make_unique<bytecode_engine>(), false);
+        }});
+        result.emplace_back(engine{"pruned", [](const fuzz_design &d){
+            return p_tick(d, nullptr, true);
+        }});
+        result.emplace_back(engine{"truth_tables", [](const fuzz_design &d){
+            return p_tick(d, nullptr, false, true);
+        }});
+        result.emplace_back(engine{"cycle_sim", [](const fuzz_design &d){
+            return stepped<cycle_sim>(d, [](const netlist &nl){
+                return std::make_unique<cycle_sim>(nl);
+            });
+        }});
+        result.emplace_back(engine{"lut_mapped", [](const fuzz_design &d){
+            return stepped<cycle_sim>(d, [](const netlist &nl){
+                return std::make_unique<cycle_sim>(nl);
+            }, [](const netlist &nl){
+                return lut_mapper::map(nl, 4);
+            });
+        }});
+        result.emplace_back(engine{"aig", [](const fuzz_design &d){
+            return stepped<aig>(d, [](const netlist &nl){
+                return std::make_unique<aig>(nl);
+            });
+        }});
+        result.emplace_back(engine{"pattern_sim", [](const fuzz_design &d){
+            return patterned(d);
+        }});
+        result.emplace_back(engine{"timing_sim", [](const fuzz_design &d){
+            return timed(d);
+        }});
+        result.emplace_back(engine{"cone_eval", [](const fuzz_design &d){
+            return pulled(d);
+        }});
+        return result;
+    }
+
+    //every difference of an engine from the reference, first one per engine;
+    //an engine that throws differs at cycle 0
+    static std::vector<mismatch> compare(const std::vector<engine> &engines, const fuzz_design &d){
+        auto expected = reference(d);
+        std::vector<mismatch> result;
+        for(auto &e:engines){
+            trace actual;
+            try{
+                actual = e.run(d);
+            }catch(std::exception &ex){
+                mismatch m;
+                m.engine = e.name;
+                m.what = ex.what();
+                result.emplace_back(m);
+                continue;
+            }
+            if(actual.size() != expected.size()){
+                mismatch m;
+                m.engine = e.name;
+                m.cycle = std::min(actual.size(), expected.size());
+                m.what = "ran "+std::to_string(actual.size())+" cycles of "+std::to_string(expected.size());
+                result.emplace_back(m);
+                continue;
+            }
+            bool found = false;
+            for(size_t c=0; c<expected.size() && !found; c++){
+                for(size_t o=0; o<expected[c].size() && !found; o++){
+                    if(o >= actual[c].size() || actual[c][o] != expected[c][o]){
+                        auto value = (o < actual[c].size())? actual[c][o] : 0;
+                        result.emplace_back(mismatch{e.name, c, o, expected[c][o], value, ""});
+                        found = true;
+                    }
+                }
+            }
+        }
+        return result;
+    }
+    std::vector<mismatch> compare(const fuzz_design &d)const{
+        return compare(engines, d);
+    }
+
+    //smallest design found that still makes the engine of m differ: cycles
+    //past the mismatch and in front of it go, then outputs, then items are
+    //turned into inputs and whatever no output reads is dropped, last inputs
+    //are held at zero. Repeats until nothing more goes; m is updated
+    fuzz_design shrink(fuzz_design d, mismatch &m)const{
+        auto name = m.engine;
+        auto attempt = [&](const fuzz_design &candidate){
+            mismatch found;
+            if(!p_fails(engines, candidate, name, found)){
+                return false;
+            }
+            d = candidate;
+            m = found;
+            return true;
+        };
+        bool changed = true;
+        while(changed){
+            changed = false;
+            if(m.cycle+1 < d.stimulus.size()){
+                auto candidate = d;
+                candidate.stimulus.resize(m.cycle+1);
+                changed |= attempt(candidate);
+            }
+            for(size_t c=0; c+1<d.stimulus.size(); ){
+                auto candidate = d;
+                candidate.stimulus.erase(candidate.stimulus.begin()+c);
+                if(attempt(candidate)){
+                    changed = true;
+                }else{
+                    c++;
+                }
+            }
+            for(size_t o=0; d.outputs.size() > 1 && o<d.outputs.size(); ){
+                auto candidate = d;
+                candidate.outputs.erase(candidate.outputs.begin()+o);
+                if(attempt(p_prune(candidate))){
+                    changed = true;
+                }else{
+                    o++;
+                }
+            }
+            for(size_t i=d.items.size(); i-- > 0; ){
+                if(i >= d.items.size() || d.items[i].kind == fuzz_design::kinds::k_in){
+                    continue;
+                }
+                auto candidate = d;
+                candidate.items[i] = fuzz_design::item{fuzz_design::kinds::k_in, d.items[i].width, {}, 0, 0};
+                changed |= attempt(p_prune(candidate));
+            }
+            for(auto &i:d.inputs()){
+                auto candidate = d;
+                bool zero = true;
+                for(auto &values:candidate.stimulus){
+                    zero &= values[i] == 0;
+                    values[i] = 0;
+                }
+                if(!zero){
+                    changed |= attempt(candidate);
+                }
+            }
+        }
+        return d;
+    }
+
+    //first mismatch of each engine over count random designs, shrunk
+    std::vector<std::pair<fuzz_design, mismatch>> run(const uint64_t &seed, const size_t &count,
+        const size_t &items_count = 24, const size_t &cycles = 32)const
+    {
+        std::mt19937_64 rng(seed);
+        std::vector<std::pair<fuzz_design, mismatch>> result;
+        std::vector<std::string> failed;
+        for(size_t n=0; n<count; n++){
+            auto d = fuzz_design::generate(rng, items_count, cycles);
+            for(auto &m:compare(d)){
+                if(std::find(failed.begin(), failed.end(), m.engine) != failed.end()){
+                    continue;
+                }
+                failed.emplace_back(m.engine);
+                auto shrunk = m;
+                auto small = shrink(d, shrunk);
+                result.emplace_back(std::move(small), shrunk);
+            }
+        }
+        return result;
+    }
+
+    //design as a .sim file elem_file_saver reads back, stimulus next to it
+    //with extension .stim in the form stimulus::load reads
+    static void save(const fuzz_design &d, const std::string &path){
+        class sim s;
+        d.build(s);
+        elem_file_saver saver;
+        saver.save_json(saver.to_json(s.begin(), s.end()), path);
+        auto dot = path.rfind('.');
+        auto slash = path.find_last_of("/\\");
+        auto stim_path = ((dot != std::string::npos && (slash == std::string::npos || dot > slash))?
+            path.substr(0, dot) : path)+".stim";
+        std::ofstream file(stim_path, std::ios::out | std::ios::trunc);
+        if(!file){
+            throw std::runtime_error("attempt to write stimulus "+stim_path+", which can't be opened");
+        }
+        auto inputs = d.inputs();
+        for(size_t i=0; i<inputs.size(); i++){
+            file<<(i? " " : "")<<"n"<<inputs[i];
+        }
+        file<<"\n";
+        for(auto &values:d.stimulus){
+            for(size_t i=0; i<inputs.size(); i++){
+                file<<(i? " " : "")<<values[inputs[i]];
+            }
+            file<<"\n";
+        }
+    }
+};
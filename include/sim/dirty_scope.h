@@ -0,0 +1,37 @@
+#pragma once
+
+//dirty bit of a meta element subtree. Marking a scope marks every scope around
+//it too, so a clean scope guarantees nothing below it has anything to do
+class dirty_scope{
+    dirty_scope* outer = nullptr;
+    bool dirty = true;
+    //every input from outside of subtree comes through an elem_in, otherwise
+    //changes can't be noticed and scope is never clean
+    bool sealed = true;
+public:
+    void mark(){
+        for(auto scope=this; scope; scope=scope->outer){
+            scope->dirty = true;
+        }
+    }
+    //called when subtree is about to be evaluated, unsealed scopes stay dirty
+    void clear(){
+        dirty = !sealed;
+    }
+    bool is_dirty()const{
+        return dirty;
+    }
+
+    void set_outer(dirty_scope* outer){
+        this->outer = outer;
+    }
+    dirty_scope* get_outer()const{
+        return outer;
+    }
+    void set_sealed(const bool &sealed){
+        this->sealed = sealed;
+    }
+    bool is_sealed()const{
+        return sealed;
+    }
+};
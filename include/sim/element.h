@@ -81,6 +81,37 @@ public:
     virtual bool get_processed()const{
         return processed;
     }
+    //gates whose widths follow from how the element was built, like data
+    //and select of a mux, can't be resized one at a time
+    virtual bool has_fixed_shape()const{
+        return false;
+    }
+
+    //elements that can change their outputs without any input changing
+    //(inputs, clocks) return true here, sim keeps them in a sources list
+    virtual bool may_schedule_work()const{
+        return false;
+    }
+    //true if element has to be processed on next tick regardless of its inputs
+    virtual bool has_pending_work()const{
+        return false;
+    }
+    //called on sources once per tick before evaluation, however many
+    //passes it takes to settle; time dependent state changes here
+    virtual void advance(){}
+
+    //edge triggered state, evaluated in two phases once inputs have settled:
+    //sample is called on every sequential element and reads inputs at a clock
+    //edge, then update makes sampled state visible on outputs. Sample returns
+    //false when update has nothing to do, e.g. no edge or enable is low
+    virtual bool is_sequential()const{
+        return false;
+    }
+    virtual bool sample(){
+        return false;
+    }
+    virtual void update(){}
+
     virtual void reset_processed(){
         processed = false;
     }
@@ -0,0 +1,331 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "sim.h"
+#include "netlist.h"
+#include "aig.h"
+#include "pattern_sim.h"
+#include "expression.h"
+
+//every combination of input bits of a sim or of one of its metas. Rows run
+//64 to a word through pattern_sim, chunks of rows spread over threads. Input
+//bits are concatenated in order inputs were created, first one in lowest bits
+//of a row number, outputs are packed likewise. State elements keep their state.
+//Rows are streamed, only table() keeps all of them
+class enumerator{
+public:
+    static constexpr size_t max_ins_width = 32;
+    static constexpr size_t max_outs_width = 64;
+    static constexpr size_t max_table_width = 24;
+
+    struct mismatch{
+        uint64_t row;
+        uint64_t expected, actual;
+    };
+    using reference = std::function<uint64_t(const uint64_t &row)>;
+private:
+    static constexpr size_t chunk_words = 64;
+
+    //gate and name of a port, by id of its element
+    struct port_id{
+        size_t elem_id, gate_id;
+        std::string name;
+        bool operator<(const port_id &other)const{
+            return elem_id < other.elem_id;
+        }
+    };
+
+    netlist nl;
+    std::vector<size_t> ins, outs;      //nets
+    std::vector<std::string> in_names, out_names;
+    size_t ins_width = 0, outs_width = 0;
+    std::unique_ptr<aig> g;
+
+    void p_init(std::vector<port_id> in_ids, std::vector<port_id> out_ids){
+        std::sort(in_ids.begin(), in_ids.end());
+        std::sort(out_ids.begin(), out_ids.end());
+        for(auto &id:in_ids){
+            ins.emplace_back(nl.find_net(id.gate_id));
+            in_names.emplace_back(id.name);
+            ins_width += nl.get_nets()[ins.back()].width;
+        }
+        for(auto &id:out_ids){
+            outs.emplace_back(nl.find_net(id.gate_id));
+            out_names.emplace_back(id.name);
+            outs_width += nl.get_nets()[outs.back()].width;
+        }
+        if(ins_width > max_ins_width){
+            throw std::runtime_error("attempt to enumerate "+std::to_string(ins_width)+
+                " input bits, allowed are up to "+std::to_string(max_ins_width));
+        }
+        if(outs_width > max_outs_width){
+            throw std::runtime_error("attempt to enumerate "+std::to_string(outs_width)+
+                " output bits, allowed are up to "+std::to_string(max_outs_width));
+        }
+        g = std::make_unique<aig>(nl, outs, std::unordered_map<size_t, uint64_t>{},
+            std::vector<size_t>{}, ins);
+    }
+
+    void p_split(uint64_t row, std::vector<uint64_t> &values)const{
+        for(size_t i=0; i<ins.size(); i++){
+            auto width = nl.get_nets()[ins[i]].width;
+            values[i] = (width == 64)? row : row & ((uint64_t(1) << width)-1);
+            row = (width == 64)? 0 : row >> width;
+        }
+    }
+
+    size_t p_words()const{
+        return std::min(chunk_words, std::max<size_t>(1, rows()/64));
+    }
+    size_t p_chunks()const{
+        return (rows()+p_words()*64-1)/(p_words()*64);
+    }
+    size_t p_threads(size_t threads, const size_t &chunks)const{
+        if(threads == 0){
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        return std::max<size_t>(1, std::min(threads, chunks));
+    }
+
+    //calls fn(worker, row, outputs) for rows of chunks from first_chunk up to
+    //end_chunk, rows of one worker only grow. A worker stops once fn returns
+    //false, others stop past that chunk
+    template<class Fn>
+    void p_run(const size_t &threads, const size_t &first_chunk, const size_t &end_chunk, Fn &&fn)const{
+        auto words = p_words();
+        auto rows_count = rows();
+        std::atomic<size_t> next_chunk{first_chunk}, last_chunk{end_chunk};
+        auto worker = [&](const size_t &id){
+            pattern_sim ps(*g, words);
+            std::vector<uint64_t> lane(words), results(outs_width*words);
+            for(auto c=next_chunk++; c<last_chunk; c=next_chunk++){
+                uint64_t first = uint64_t(c)*words*64;
+                size_t k = 0;
+                for(auto &net:ins){
+                    for(size_t i=0; i<nl.get_nets()[net].width; i++, k++){
+                        for(size_t w=0; w<words; w++){
+                            lane[w] = bits::counting_word(k, first+w*64);
+                        }
+                        ps.set_input_lane(net, i, lane.data());
+                    }
+                }
+                ps.evaluate();
+                size_t o = 0;
+                for(auto &net:outs){
+                    for(size_t i=0; i<nl.get_nets()[net].width; i++, o++){
+                        ps.get_lane(net, i, results.data()+o*words);
+                    }
+                }
+                auto count = std::min<uint64_t>(words*64, rows_count-first);
+                for(uint64_t r=0; r<count; r++){
+                    uint64_t value = 0;
+                    for(size_t b=0; b<outs_width; b++){
+                        value |= ((results[b*words+r/64] >> (r%64)) & 1) << b;
+                    }
+                    if(!fn(id, first+r, value)){
+                        auto last = last_chunk.load();
+                        while(c+1 < last && !last_chunk.compare_exchange_weak(last, c+1));
+                        return;
+                    }
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for(size_t t=1; t<p_threads(threads, end_chunk-first_chunk); t++){
+            pool.emplace_back(worker, t);
+        }
+        worker(0);
+        for(auto &t:pool){
+            t.join();
+        }
+    }
+public:
+    //inputs and outputs of root
+    explicit enumerator(sim &s)
+        :nl(s)
+    {
+        std::vector<port_id> in_ids, out_ids;
+        for(auto &n:nl.get_inputs()){
+            auto &nd = nl.get_nodes()[n];
+            in_ids.emplace_back(port_id{nd.elem->get_id(), nl.get_nets()[nd.outs[0]].gate_ids[0], nd.name});
+        }
+        for(auto &n:nl.get_outputs()){
+            auto &nd = nl.get_nodes()[n];
+            out_ids.emplace_back(port_id{nd.elem->get_id(), nl.get_nets()[nd.outs[0]].gate_ids[0], nd.name});
+        }
+        p_init(in_ids, out_ids);
+    }
+    //inputs and outputs of a meta, whatever drives it outside is cut off
+    enumerator(sim &s, const elem_meta* meta)
+        :nl(s)
+    {
+        auto it = s.begin();
+        while(it != s.end() && it->get() != meta){
+            ++it;
+        }
+        if(it == s.end()){
+            throw std::runtime_error("attempt to enumerate meta "+meta->get_name()+", which is not in sim");
+        }
+        std::vector<port_id> in_ids, out_ids;
+        for(auto child = s.children_begin(it); child != s.children_end(it); ++child){
+            if(auto in = dynamic_cast<elem_in*>(child->get())){
+                in_ids.emplace_back(port_id{in->get_id(), in->get_out(0)->get_id(), in->get_name()});
+            }else if(auto out = dynamic_cast<elem_out*>(child->get())){
+                out_ids.emplace_back(port_id{out->get_id(), out->get_outer()->get_id(), out->get_name()});
+            }
+        }
+        p_init(in_ids, out_ids);
+    }
+    enumerator(const enumerator&) = delete;
+    enumerator& operator=(const enumerator&) = delete;
+
+    uint64_t rows()const{
+        return uint64_t(1) << ins_width;
+    }
+    size_t get_ins_width()const{
+        return ins_width;
+    }
+    size_t get_outs_width()const{
+        return outs_width;
+    }
+
+    const std::vector<std::string>& get_input_names()const{
+        return in_names;
+    }
+    const std::vector<std::string>& get_output_names()const{
+        return out_names;
+    }
+
+    //values of every input in a row, and outputs packed from their values
+    std::vector<uint64_t> split_row(const uint64_t &row)const{
+        std::vector<uint64_t> result(ins.size());
+        p_split(row, result);
+        return result;
+    }
+    uint64_t pack_outputs(const std::vector<uint64_t> &values)const{
+        if(values.size() != outs.size()){
+            throw std::runtime_error("attempt to pack "+std::to_string(values.size())+
+                " values into "+std::to_string(outs.size())+" outputs");
+        }
+        uint64_t result = 0;
+        size_t shift = 0;
+        for(size_t o=0; o<outs.size(); o++){
+            auto width = nl.get_nets()[outs[o]].width;
+            auto mask = (width == 64)? ~uint64_t(0) : (uint64_t(1) << width)-1;
+            result |= (values[o] & mask) << shift;
+            shift += width;
+        }
+        return result;
+    }
+
+    //reference from expressions over names of inputs, either one giving all
+    //outputs packed or one per output; usable while the enumerator lives
+    reference expected_by(const std::vector<std::string> &texts)const{
+        if(texts.size() != 1 && texts.size() != outs.size()){
+            throw std::runtime_error("attempt to verify "+std::to_string(outs.size())+
+                " outputs against "+std::to_string(texts.size())+" expressions");
+        }
+        auto exprs = std::make_shared<std::vector<expression>>();
+        for(auto &text:texts){
+            exprs->emplace_back(text, in_names);
+        }
+        auto outs_mask = (outs_width == 64)? ~uint64_t(0) : (uint64_t(1) << outs_width)-1;
+        return [this, exprs, outs_mask](const uint64_t &row){
+            //called for every row, values are split into storage of the thread
+            thread_local std::vector<uint64_t> vars;
+            vars.resize(ins.size());
+            p_split(row, vars);
+            if(exprs->size() == 1){
+                return exprs->front().evaluate(vars) & outs_mask;
+            }
+            std::vector<uint64_t> values;
+            for(auto &e:*exprs){
+                values.emplace_back(e.evaluate(vars));
+            }
+            return pack_outputs(values);
+        };
+    }
+
+    //calls fn(row, outputs) for every row in order, threads 0 uses one per
+    //core. Workers fill a bounded window of rows, fn runs while none does
+    void stream(const std::function<void(const uint64_t &row, const uint64_t &value)> &fn,
+        const size_t &threads = 0)const
+    {
+        auto chunks = p_chunks();
+        auto chunk_rows = p_words()*64;
+        //a few chunks per worker keep them busy to the end of a window
+        auto window = p_threads(threads, chunks)*4;
+        std::vector<uint64_t> buffer(std::min<uint64_t>(window*chunk_rows, rows()));
+        for(size_t first=0; first<chunks; first+=window){
+            auto end = std::min(chunks, first+window);
+            uint64_t base = uint64_t(first)*chunk_rows;
+            p_run(threads, first, end, [&buffer, base](const size_t&, const uint64_t &row, const uint64_t &value){
+                buffer[row-base] = value;
+                return true;
+            });
+            auto count = std::min<uint64_t>(uint64_t(end-first)*chunk_rows, rows()-base);
+            for(uint64_t r=0; r<count; r++){
+                fn(base+r, buffer[r]);
+            }
+        }
+    }
+
+    //outputs of every row, up to max_table_width input bits; wider ones are
+    //to be streamed
+    std::vector<uint64_t> table(const size_t &threads = 0)const{
+        if(ins_width > max_table_width){
+            throw std::runtime_error("attempt to tabulate "+std::to_string(ins_width)+
+                " input bits, allowed are up to "+std::to_string(max_table_width)+", stream them instead");
+        }
+        std::vector<uint64_t> result(rows());
+        p_run(threads, 0, p_chunks(), [&result](const size_t&, const uint64_t &row, const uint64_t &value){
+            result[row] = value;
+            return true;
+        });
+        return result;
+    }
+
+    //first rows, up to limit, whose outputs differ from the reference
+    std::vector<mismatch> verify(const reference &expected, const size_t &limit = 16,
+        const size_t &threads = 0)const
+    {
+        std::vector<mismatch> result;
+        if(limit == 0){
+            return result;
+        }
+        //every worker keeps its first limit ones, the lowest of all are among them
+        std::vector<std::vector<mismatch>> found(p_threads(threads, p_chunks()));
+        p_run(threads, 0, p_chunks(), [&](const size_t &worker, const uint64_t &row, const uint64_t &value){
+            auto want = expected(row);
+            if(want != value){
+                found[worker].emplace_back(mismatch{row, want, value});
+            }
+            return found[worker].size() < limit;
+        });
+        for(auto &f:found){
+            result.insert(result.end(), f.begin(), f.end());
+        }
+        std::sort(result.begin(), result.end(), [](const mismatch &lhs, const mismatch &rhs){
+            return lhs.row < rhs.row;
+        });
+        if(result.size() > limit){
+            result.resize(limit);
+        }
+        return result;
+    }
+    std::vector<mismatch> verify(const std::vector<uint64_t> &expected, const size_t &limit = 16,
+        const size_t &threads = 0)const
+    {
+        if(expected.size() != rows()){
+            throw std::runtime_error("attempt to verify "+std::to_string(rows())+
+                " rows against a table of "+std::to_string(expected.size()));
+        }
+        return verify([&expected](const uint64_t &row){ return expected[row]; }, limit, threads);
+    }
+};
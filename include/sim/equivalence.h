@@ -0,0 +1,406 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <map>
+#include <algorithm>
+#include "sim.h"
+#include "netlist.h"
+#include "aig.h"
+#include "file_ops.h"
+#include "sat_solver.h"
+
+//combinational equivalence of two designs whose inputs and outputs in root
+//match by name. Both are compiled into one and-inverter graph over shared
+//inputs, so logic built alike is merged by structural hashing already.
+//Pairs of outputs left are simulated 64 patterns to a word: over every input
+//combination when there are few input bits, otherwise over random patterns,
+//after which internal gates that simulated alike are proven equal one by one
+//and the outputs last, by a SAT solver
+class equivalence{
+public:
+    enum class verdicts{
+        v_equivalent,
+        v_different,
+        v_unknown       //SAT solver gave up on some output
+    };
+    struct options{
+        size_t exhaustive_bits = 20;    //up to this many input bits every combination is run
+        size_t random_words = 64;       //patterns of random simulation, 64 per word
+        uint64_t seed = 1;
+        uint64_t conflict_limit = 100000;   //per output, 0 for none
+        uint64_t gate_conflict_limit = 100; //per pair of internal gates
+    };
+    struct result{
+        verdicts verdict = verdicts::v_equivalent;
+        std::vector<std::string> differing;     //outputs, as name[bit]
+        std::vector<std::string> unresolved;
+        //values of inputs by name that tell the designs apart
+        std::unordered_map<std::string, uint64_t> counterexample;
+        size_t by_structure = 0;    //output bits built alike
+        size_t by_simulation = 0;   //output bits proven by running every combination
+        size_t by_sat = 0;
+    };
+private:
+    using literal = aig::literal;
+
+    struct port{
+        std::string name;
+        size_t width;
+        std::vector<literal> lits[2];   //of both designs, in the miter
+    };
+
+    std::vector<aig::and_gate> ands;    //miter, variable 0 is constant, then inputs
+    std::unordered_map<uint64_t, literal> hashes;
+    std::vector<port> ins, outs;
+    size_t inputs_count = 0;
+
+    literal p_input(){
+        ands.emplace_back(aig::and_gate{aig::lit_false, aig::lit_false});
+        inputs_count++;
+        return literal(ands.size()-1) << 1;
+    }
+    literal p_and(literal a, literal b){
+        if(a > b){
+            std::swap(a, b);
+        }
+        if(a == aig::lit_false || a == (b^1)){
+            return aig::lit_false;
+        }
+        if(a == aig::lit_true || a == b){
+            return b;
+        }
+        auto key = (uint64_t(a) << 32) | b;
+        auto it = hashes.find(key);
+        if(it != hashes.end()){
+            return it->second;
+        }
+        ands.emplace_back(aig::and_gate{a, b});
+        literal result = literal(ands.size()-1) << 1;
+        hashes.emplace(key, result);
+        return result;
+    }
+
+    //root ports of a design by name
+    static std::unordered_map<std::string, size_t> p_ports(const netlist &nl,
+        const std::vector<size_t> &nodes, const std::string &kind)
+    {
+        std::unordered_map<std::string, size_t> result;
+        for(auto &n:nodes){
+            auto &nd = nl.get_nodes()[n];
+            if(!result.emplace(nd.name, nd.outs[0]).second){
+                throw std::runtime_error("attempt to match "+kind+" "+nd.name+
+                    " by name, design has more than one");
+            }
+        }
+        return result;
+    }
+
+    //inputs of a design no port maps get inputs of their own
+    void p_map_rest(const aig &g, std::unordered_map<literal, literal> &var_map){
+        var_map[0] = aig::lit_false;
+        for(size_t v=1; v<=g.get_inputs_count(); v++){
+            if(!var_map.count(v)){
+                var_map[v] = p_input();
+            }
+        }
+    }
+    //copies the graph of one design in, its inputs already mapped
+    void p_copy(const aig &g, std::unordered_map<literal, literal> &var_map){
+        auto map = [&var_map](const literal &lit){
+            return var_map.at(lit >> 1) ^ (lit & 1);
+        };
+        auto &g_ands = g.get_ands();
+        for(size_t v=g.get_inputs_count()+1; v<g_ands.size(); v++){
+            var_map[v] = p_and(map(g_ands[v].a), map(g_ands[v].b));
+        }
+    }
+
+    //runs words of patterns, "set" fills lanes of inputs
+    template<class Set>
+    std::vector<uint64_t> p_simulate(const size_t &words, Set &&set)const{
+        std::vector<uint64_t> v(ands.size()*words, 0);
+        set(v);
+        for(size_t var=inputs_count+1; var<ands.size(); var++){
+            auto a = v.data()+(ands[var].a >> 1)*words;
+            auto b = v.data()+(ands[var].b >> 1)*words;
+            auto ia = (ands[var].a & 1)? ~uint64_t(0) : 0;
+            auto ib = (ands[var].b & 1)? ~uint64_t(0) : 0;
+            auto dst = v.data()+var*words;
+            for(size_t w=0; w<words; w++){
+                dst[w] = (a[w] ^ ia) & (b[w] ^ ib);
+            }
+        }
+        return v;
+    }
+    static uint64_t p_word(const std::vector<uint64_t> &v, const size_t &words, const literal &lit,
+        const size_t &w)
+    {
+        return v[(lit >> 1)*words+w] ^ ((lit & 1)? ~uint64_t(0) : 0);
+    }
+
+    //input values of one pattern, by name
+    std::unordered_map<std::string, uint64_t> p_pattern(const std::vector<uint64_t> &v,
+        const size_t &words, const size_t &pattern)const
+    {
+        std::unordered_map<std::string, uint64_t> result;
+        for(auto &p:ins){
+            uint64_t value = 0;
+            for(size_t i=0; i<p.width; i++){
+                value |= ((p_word(v, words, p.lits[0][i], pattern/64) >> (pattern%64)) & 1) << i;
+            }
+            result[p.name] = value;
+        }
+        return result;
+    }
+
+    //closes outputs that differ in some pattern, the first pattern found is
+    //kept as counterexample
+    void p_compare(const std::vector<uint64_t> &v, const size_t &words, std::vector<bool> &open,
+        result &res)const
+    {
+        size_t o = 0;
+        for(auto &p:outs){
+            for(size_t i=0; i<p.width; i++, o++){
+                if(!open[o]){
+                    continue;
+                }
+                for(size_t w=0; w<words; w++){
+                    auto diff = p_word(v, words, p.lits[0][i], w) ^ p_word(v, words, p.lits[1][i], w);
+                    if(diff){
+                        if(res.counterexample.empty()){
+                            size_t bit = 0;
+                            while(!((diff >> bit) & 1)){
+                                bit++;
+                            }
+                            res.counterexample = p_pattern(v, words, w*64+bit);
+                        }
+                        res.differing.emplace_back(p.name+"["+std::to_string(i)+"]");
+                        open[o] = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    equivalence(sim &a, sim &b){
+        ands.emplace_back(aig::and_gate{aig::lit_false, aig::lit_false});
+        netlist nl[2] = {netlist(a), netlist(b)};
+        std::unique_ptr<aig> g[2];
+        std::unordered_map<std::string, size_t> in_ports[2], out_ports[2];
+        for(size_t d=0; d<2; d++){
+            g[d] = std::make_unique<aig>(nl[d]);
+            if(!g[d]->get_state_literals().empty()){
+                throw std::runtime_error("attempt to check equivalence of a design with state elements");
+            }
+            in_ports[d] = p_ports(nl[d], nl[d].get_inputs(), "input");
+            out_ports[d] = p_ports(nl[d], nl[d].get_outputs(), "output");
+        }
+        if(out_ports[0].size() != out_ports[1].size()){
+            throw std::runtime_error("attempt to check equivalence of designs with "+
+                std::to_string(out_ports[0].size())+" and "+std::to_string(out_ports[1].size())+" outputs");
+        }
+        //inputs of one design only are free, outputs must all match; every
+        //input is made before any gate
+        std::unordered_map<literal, literal> var_map[2];
+        std::map<std::string, size_t> names;
+        for(size_t d=0; d<2; d++){
+            for(auto &[name, net]:in_ports[d]){
+                auto width = nl[d].get_nets()[net].width;
+                auto it = names.emplace(name, width).first;
+                if(it->second != width){
+                    throw std::runtime_error("attempt to match input "+name+", which differs in width");
+                }
+            }
+        }
+        for(auto &[name, width]:names){
+            port p{name, width, {}};
+            for(size_t i=0; i<width; i++){
+                p.lits[0].emplace_back(p_input());
+                for(size_t d=0; d<2; d++){
+                    auto it = in_ports[d].find(name);
+                    if(it != in_ports[d].end()){
+                        auto lit = g[d]->get_literal(it->second, i);
+                        var_map[d][lit >> 1] = p.lits[0].back() ^ (lit & 1);
+                    }
+                }
+            }
+            p.lits[1] = p.lits[0];
+            ins.emplace_back(std::move(p));
+        }
+        p_map_rest(*g[0], var_map[0]);
+        p_map_rest(*g[1], var_map[1]);
+        p_copy(*g[0], var_map[0]);
+        p_copy(*g[1], var_map[1]);
+        names.clear();
+        for(auto &[name, net]:out_ports[0]){
+            names.emplace(name, net);
+        }
+        for(auto &[name, net]:names){
+            auto other = out_ports[1].find(name);
+            if(other == out_ports[1].end()){
+                throw std::runtime_error("attempt to match output "+name+", which second design lacks");
+            }
+            port p{name, nl[0].get_nets()[net].width, {}};
+            if(nl[1].get_nets()[other->second].width != p.width){
+                throw std::runtime_error("attempt to match output "+name+", which differs in width");
+            }
+            for(size_t i=0; i<p.width; i++){
+                for(size_t d=0; d<2; d++){
+                    auto lit = g[d]->get_literal((d == 0)? net : other->second, i);
+                    p.lits[d].emplace_back(var_map[d].at(lit >> 1) ^ (lit & 1));
+                }
+            }
+            outs.emplace_back(std::move(p));
+        }
+    }
+
+    result p_run(const options &opt){
+        result res;
+        std::vector<bool> open;
+        for(auto &p:outs){
+            for(size_t i=0; i<p.width; i++){
+                open.emplace_back(p.lits[0][i] != p.lits[1][i]);
+                res.by_structure += !open.back();
+            }
+        }
+        if(std::find(open.begin(), open.end(), true) == open.end()){
+            return res;
+        }
+
+        if(inputs_count <= opt.exhaustive_bits){
+            //bit k of pattern j is bit k of j, chunks of 4096 patterns; with
+            //fewer rows than a word, patterns past the last one repeat rows
+            uint64_t rows = uint64_t(1) << inputs_count;
+            size_t words = std::min<uint64_t>(64, std::max<uint64_t>(1, rows/64));
+            for(uint64_t first=0; first<rows; first+=words*64){
+                auto v = p_simulate(words, [&](std::vector<uint64_t> &v){
+                    for(size_t k=0; k<inputs_count; k++){
+                        for(size_t w=0; w<words; w++){
+                            v[(k+1)*words+w] = bits::counting_word(k, first+w*64);
+                        }
+                    }
+                });
+                p_compare(v, words, open, res);
+            }
+            for(size_t o=0; o<open.size(); o++){
+                res.by_simulation += open[o];
+            }
+            res.verdict = res.differing.empty()? verdicts::v_equivalent : verdicts::v_different;
+            return res;
+        }
+
+        std::mt19937_64 rng(opt.seed);
+        auto words = std::max<size_t>(1, opt.random_words);
+        auto v = p_simulate(words, [&](std::vector<uint64_t> &v){
+            for(size_t var=1; var<=inputs_count; var++){
+                for(size_t w=0; w<words; w++){
+                    v[var*words+w] = rng();
+                }
+            }
+        });
+        p_compare(v, words, open, res);
+
+        //one SAT variable per miter variable, constant pinned false
+        sat_solver solver;
+        for(size_t var=0; var<ands.size(); var++){
+            solver.new_var();
+        }
+        solver.add_clause({aig::lit_true});
+        for(size_t var=inputs_count+1; var<ands.size(); var++){
+            literal y = literal(var << 1);
+            solver.add_clause({y^1, ands[var].a});
+            solver.add_clause({y^1, ands[var].b});
+            solver.add_clause({y, ands[var].a^1, ands[var].b^1});
+        }
+        //whether a equals b, learnt as clauses once proven
+        auto prove = [&solver](const literal &a, const literal &b, const uint64_t &limit){
+            auto x = literal(solver.new_var() << 1);
+            solver.add_clause({x^1, a, b});
+            solver.add_clause({x^1, a^1, b^1});
+            auto verdict = solver.solve({x}, limit);
+            if(verdict == sat_solver::results::r_unsat){
+                solver.add_clause({a^1, b});
+                solver.add_clause({a, b^1});
+            }
+            return verdict;
+        };
+
+        //gates with equal or opposite signatures, in order, against the first
+        //of their class; each proof makes those of later gates easier
+        std::unordered_map<std::string, literal> classes;
+        for(size_t var=inputs_count+1; var<ands.size(); var++){
+            bool flip = v[var*words] & 1;
+            std::string key(words*sizeof(uint64_t), '\0');
+            for(size_t w=0; w<words; w++){
+                uint64_t word = v[var*words+w] ^ (flip? ~uint64_t(0) : 0);
+                std::copy(reinterpret_cast<const char*>(&word), reinterpret_cast<const char*>(&word)+sizeof(word),
+                    key.begin()+w*sizeof(uint64_t));
+            }
+            literal lit = literal(var << 1) ^ literal(flip);
+            auto it = classes.find(key);
+            if(it == classes.end()){
+                classes.emplace(std::move(key), lit);
+            }else{
+                prove(it->second, lit, opt.gate_conflict_limit);
+            }
+        }
+
+        size_t o = 0;
+        for(auto &p:outs){
+            for(size_t i=0; i<p.width; i++, o++){
+                if(!open[o]){
+                    continue;
+                }
+                auto verdict = prove(p.lits[0][i], p.lits[1][i], opt.conflict_limit);
+                auto name = p.name+"["+std::to_string(i)+"]";
+                if(verdict == sat_solver::results::r_unsat){
+                    res.by_sat++;
+                }else if(verdict == sat_solver::results::r_unknown){
+                    res.unresolved.emplace_back(name);
+                }else{
+                    res.differing.emplace_back(name);
+                    if(res.counterexample.empty()){
+                        auto model = p_simulate(1, [&](std::vector<uint64_t> &v){
+                            for(size_t var=1; var<=inputs_count; var++){
+                                v[var] = solver.model_value(var)? ~uint64_t(0) : 0;
+                            }
+                        });
+                        res.counterexample = p_pattern(model, 1, 0);
+                    }
+                }
+            }
+        }
+        if(!res.differing.empty()){
+            res.verdict = verdicts::v_different;
+        }else if(!res.unresolved.empty()){
+            res.verdict = verdicts::v_unknown;
+        }
+        return res;
+    }
+public:
+    static result check(sim &a, sim &b, const options &opt){
+        equivalence eq(a, b);
+        return eq.p_run(opt);
+    }
+    static result check(sim &a, sim &b){
+        return check(a, b, options());
+    }
+    //designs saved by elem_file_saver
+    static result check_files(const std::string &path_a, const std::string &path_b,
+        const options &opt)
+    {
+        elem_file_saver saver;
+        class sim a(saver.from_json(saver.load_json(path_a)));
+        class sim b(saver.from_json(saver.load_json(path_b)));
+        return check(a, b, opt);
+    }
+    static result check_files(const std::string &path_a, const std::string &path_b){
+        return check_files(path_a, path_b, options());
+    }
+};
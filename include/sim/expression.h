@@ -0,0 +1,216 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cctype>
+
+//integer expression over named variables, unsigned 64 bit and spelled as in
+//C: numbers in decimal or 0x hex, parentheses, unary ~ ! -, then by falling
+//precedence * / %, + -, << >>, < <= > >=, == !=, &, ^, |, &&, ||. Division
+//by zero and shifts by 64 or more give 0. Kept as postfix code, so evaluating
+//it is one pass with a small stack
+class expression{
+public:
+    enum class ops : uint8_t{
+        op_number,
+        op_variable,
+        op_not, op_lnot, op_neg,
+        op_mul, op_div, op_mod,
+        op_add, op_sub,
+        op_shl, op_shr,
+        op_lt, op_le, op_gt, op_ge,
+        op_eq, op_ne,
+        op_and, op_xor, op_or,
+        op_land, op_lor
+    };
+private:
+    struct instr{
+        ops op;
+        uint64_t value;     //number or variable index
+    };
+    struct binary{
+        const char* text;
+        ops op;
+        int precedence;
+    };
+
+    std::vector<instr> code;
+    size_t depth = 0;       //stack needed
+
+    //parser state
+    std::string text;
+    const std::vector<std::string>* names = nullptr;
+    size_t pos = 0;
+
+    [[noreturn]] void p_fail(const std::string &what)const{
+        throw std::runtime_error("attempt to parse expression \""+text+"\": "+what+
+            " at column "+std::to_string(pos+1));
+    }
+    void p_skip(){
+        while(pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))){
+            pos++;
+        }
+    }
+    bool p_take(const std::string &token){
+        p_skip();
+        if(text.compare(pos, token.size(), token) != 0){
+            return false;
+        }
+        pos += token.size();
+        return true;
+    }
+
+    void p_primary(){
+        p_skip();
+        if(pos >= text.size()){
+            p_fail("operand expected");
+        }
+        auto c = text[pos];
+        if(p_take("(")){
+            p_binary(0);
+            if(!p_take(")")){
+                p_fail("')' expected");
+            }
+        }else if(p_take("~")){
+            p_primary();
+            code.emplace_back(instr{ops::op_not, 0});
+        }else if(p_take("!")){
+            p_primary();
+            code.emplace_back(instr{ops::op_lnot, 0});
+        }else if(p_take("-")){
+            p_primary();
+            code.emplace_back(instr{ops::op_neg, 0});
+        }else if(std::isdigit(static_cast<unsigned char>(c))){
+            size_t used = 0;
+            uint64_t value = 0;
+            try{
+                value = std::stoull(text.substr(pos), &used, 0);
+            }catch(std::exception&){
+                p_fail("number out of range");
+            }
+            pos += used;
+            code.emplace_back(instr{ops::op_number, value});
+        }else if(std::isalpha(static_cast<unsigned char>(c)) || c == '_'){
+            auto start = pos;
+            while(pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')){
+                pos++;
+            }
+            auto name = text.substr(start, pos-start);
+            size_t index = 0;
+            while(index < names->size() && (*names)[index] != name){
+                index++;
+            }
+            if(index == names->size()){
+                pos = start;
+                p_fail("unknown variable "+name);
+            }
+            code.emplace_back(instr{ops::op_variable, index});
+        }else{
+            p_fail(std::string("unexpected '")+c+"'");
+        }
+    }
+    //operators binding tighter than min_precedence, left to right
+    void p_binary(const int &min_precedence){
+        static const binary table[] = {
+            {"||", ops::op_lor, 1}, {"&&", ops::op_land, 2},
+            {"==", ops::op_eq, 6}, {"!=", ops::op_ne, 6},
+            {"<<", ops::op_shl, 8}, {">>", ops::op_shr, 8},
+            {"<=", ops::op_le, 7}, {">=", ops::op_ge, 7}, {"<", ops::op_lt, 7}, {">", ops::op_gt, 7},
+            {"|", ops::op_or, 3}, {"^", ops::op_xor, 4}, {"&", ops::op_and, 5},
+            {"+", ops::op_add, 9}, {"-", ops::op_sub, 9},
+            {"*", ops::op_mul, 10}, {"/", ops::op_div, 10}, {"%", ops::op_mod, 10}
+        };
+        p_primary();
+        while(true){
+            p_skip();
+            const binary* found = nullptr;
+            for(auto &b:table){
+                if(text.compare(pos, std::char_traits<char>::length(b.text), b.text) == 0){
+                    found = &b;
+                    break;
+                }
+            }
+            if(!found || found->precedence <= min_precedence){
+                return;
+            }
+            pos += std::char_traits<char>::length(found->text);
+            p_binary(found->precedence);
+            code.emplace_back(instr{found->op, 0});
+        }
+    }
+public:
+    //variables are referred to by name, evaluate takes values in this order
+    expression(const std::string &text, const std::vector<std::string> &names)
+        :text(text),
+        names(&names)
+    {
+        p_binary(0);
+        p_skip();
+        if(pos != text.size()){
+            p_fail("operator expected");
+        }
+        this->names = nullptr;
+        size_t height = 0;
+        for(auto &in:code){
+            if(in.op == ops::op_number || in.op == ops::op_variable){
+                depth = std::max(depth, ++height);
+            }else if(in.op != ops::op_not && in.op != ops::op_lnot && in.op != ops::op_neg){
+                height--;
+            }
+        }
+    }
+
+    uint64_t evaluate(const std::vector<uint64_t> &variables)const{
+        //expressions are short, a fixed stack avoids allocating per call
+        uint64_t small[32] = {};
+        std::vector<uint64_t> large;
+        uint64_t* stack = small;
+        if(depth > 32){
+            large.resize(depth);
+            stack = large.data();
+        }
+        size_t top = 0;
+        for(auto &in:code){
+            if(in.op == ops::op_number){
+                stack[top++] = in.value;
+                continue;
+            }
+            if(in.op == ops::op_variable){
+                stack[top++] = variables.at(in.value);
+                continue;
+            }
+            auto &a = stack[top-1];
+            switch(in.op){
+            case ops::op_not:   a = ~a; continue;
+            case ops::op_lnot:  a = !a; continue;
+            case ops::op_neg:   a = uint64_t(0)-a; continue;
+            default:            break;
+            }
+            auto b = stack[--top];
+            auto &l = stack[top-1];
+            switch(in.op){
+            case ops::op_mul:   l *= b; break;
+            case ops::op_div:   l = b? l/b : 0; break;
+            case ops::op_mod:   l = b? l%b : 0; break;
+            case ops::op_add:   l += b; break;
+            case ops::op_sub:   l -= b; break;
+            case ops::op_shl:   l = (b < 64)? l << b : 0; break;
+            case ops::op_shr:   l = (b < 64)? l >> b : 0; break;
+            case ops::op_lt:    l = l < b; break;
+            case ops::op_le:    l = l <= b; break;
+            case ops::op_gt:    l = l > b; break;
+            case ops::op_ge:    l = l >= b; break;
+            case ops::op_eq:    l = l == b; break;
+            case ops::op_ne:    l = l != b; break;
+            case ops::op_and:   l &= b; break;
+            case ops::op_xor:   l ^= b; break;
+            case ops::op_or:    l |= b; break;
+            case ops::op_land:  l = l && b; break;
+            case ops::op_lor:   l = l || b; break;
+            default:            break;
+            }
+        }
+        return stack[0];
+    }
+};
@@ -0,0 +1,290 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <memory>
+#include <istream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "aig.h"
+
+//values of input nets cycle by cycle. In text form the first line names the
+//inputs of root, every following line gives their values for one cycle in
+//decimal or 0x hex; '#' starts a comment
+struct stimulus{
+    std::vector<size_t> nets;
+    std::vector<std::vector<uint64_t>> cycles;
+
+    static stimulus parse(std::istream &in, const netlist &nl){
+        stimulus result;
+        bool header = true;
+        std::string line;
+        size_t line_no = 0;
+        while(std::getline(in, line)){
+            line_no++;
+            line = line.substr(0, line.find('#'));
+            std::istringstream words(line);
+            std::vector<std::string> tokens;
+            std::string token;
+            while(words >> token){
+                tokens.emplace_back(token);
+            }
+            if(tokens.empty()){
+                continue;
+            }
+            if(header){
+                for(auto &name:tokens){
+                    result.nets.emplace_back(p_find_input(nl, name));
+                }
+                header = false;
+                continue;
+            }
+            if(tokens.size() != result.nets.size()){
+                throw std::runtime_error("attempt to read stimulus line "+std::to_string(line_no)+
+                    " with "+std::to_string(tokens.size())+" values for "+
+                    std::to_string(result.nets.size())+" inputs");
+            }
+            std::vector<uint64_t> values;
+            for(auto &t:tokens){
+                size_t used = 0;
+                try{
+                    values.emplace_back(std::stoull(t, &used, 0));
+                }catch(std::exception&){
+                    used = 0;
+                }
+                if(used != t.size()){
+                    throw std::runtime_error("attempt to read stimulus line "+std::to_string(line_no)+
+                        ", \""+t+"\" is not a number");
+                }
+            }
+            result.cycles.emplace_back(std::move(values));
+        }
+        return result;
+    }
+    static stimulus load(const std::string &path, const netlist &nl){
+        std::ifstream file(path, std::ios::in);
+        if(!file){
+            throw std::runtime_error("attempt to open stimulus "+path+", which can't be read");
+        }
+        return parse(file, nl);
+    }
+private:
+    static size_t p_find_input(const netlist &nl, const std::string &name){
+        for(auto &n:nl.get_inputs()){
+            auto &nd = nl.get_nodes()[n];
+            if(nd.name == name && nd.type == netlist::types_node::t_in){
+                return nd.outs[0];
+            }
+        }
+        throw std::runtime_error("attempt to drive input "+name+", which is not in root");
+    }
+};
+
+//stuck-at fault simulation. Every bit of every net driven by a node may be
+//stuck at 0 or at 1; a fault is detected once an observed net differs from
+//the good machine. Faults run 64 at a time, one faulty machine per bit of a
+//word over the and-inverter graph, and groups of 64 spread over threads.
+//Nets that are views of others share their faults
+class fault_sim{
+public:
+    struct fault{
+        size_t net;
+        size_t bit;
+        bool stuck;
+        bool detected = false;
+        uint64_t cycle = 0;     //first cycle that showed it
+    };
+    struct report{
+        size_t faults = 0;
+        size_t detected = 0;
+        size_t unobservable = 0;    //on logic no observed net depends on
+        double coverage()const{
+            return faults? double(detected)/double(faults) : 1.0;
+        }
+    };
+private:
+    const netlist &nl;
+    std::vector<size_t> observed;
+    std::vector<fault> faults;
+    std::unique_ptr<aig> g;
+    std::vector<aig::literal> observed_lits;
+
+    static std::vector<size_t> p_fault_nets(const netlist &nl){
+        std::vector<size_t> result;
+        auto &nets = nl.get_nets();
+        for(size_t net=0; net<nets.size(); net++){
+            auto &nt = nets[net];
+            if(nt.storage != net || nt.driver == netlist::npos ||
+                nl.get_nodes()[nt.driver].type == netlist::types_node::t_clock)
+            {
+                continue;
+            }
+            result.emplace_back(net);
+        }
+        return result;
+    }
+
+    //runs stimulus with given faults injected one per lane, fills "observed"
+    //values of lane 0 per cycle when asked to
+    void p_run(const std::vector<size_t> &group, const stimulus &stim,
+        std::vector<std::vector<bool>> *record, const std::vector<std::vector<bool>> *reference)
+    {
+        auto &ands = g->get_ands();
+        auto first = g->get_inputs_count()+1;
+        std::vector<uint64_t> v(ands.size(), 0), keep(ands.size(), ~uint64_t(0)), set(ands.size(), 0);
+        for(size_t var=1; var<first; var++){
+            v[var] = g->value_of(aig::literal(var << 1))? ~uint64_t(0) : 0;
+        }
+        for(size_t lane=0; lane<group.size(); lane++){
+            auto &f = faults[group[lane]];
+            auto lit = g->get_literal(f.net, f.bit);
+            auto var = aig::var_of(lit);
+            auto bit = uint64_t(1) << lane;
+            keep[var] &= ~bit;
+            if(f.stuck ^ bool(lit & 1)){
+                set[var] |= bit;
+            }
+        }
+        auto word = [&v](const aig::literal &lit){
+            return v[aig::var_of(lit)] ^ ((lit & 1)? ~uint64_t(0) : 0);
+        };
+        auto all = (group.size() == 64)? ~uint64_t(0) : (uint64_t(1) << group.size())-1;
+        uint64_t detected = 0;
+        auto state = g->get_state_literals();
+        auto next = g->get_next_literals();
+        std::vector<uint64_t> latched(next.size());
+        for(size_t c=0; c<stim.cycles.size() && (!reference || detected != all); c++){
+            for(size_t i=0; i<stim.nets.size(); i++){
+                auto width = nl.get_nets()[stim.nets[i]].width;
+                for(size_t b=0; b<width; b++){
+                    auto lit = g->get_literal(stim.nets[i], b);
+                    v[aig::var_of(lit)] = (((stim.cycles[c][i] >> b) & 1) ^ (lit & 1))? ~uint64_t(0) : 0;
+                }
+            }
+            for(size_t var=1; var<first; var++){
+                v[var] = (v[var] & keep[var]) | set[var];
+            }
+            for(size_t var=first; var<ands.size(); var++){
+                v[var] = ((word(ands[var].a) & word(ands[var].b)) & keep[var]) | set[var];
+            }
+            if(record){
+                std::vector<bool> values;
+                for(auto &lit:observed_lits){
+                    values.emplace_back(word(lit) & 1);
+                }
+                record->emplace_back(std::move(values));
+            }
+            if(reference){
+                uint64_t diff = 0;
+                for(size_t o=0; o<observed_lits.size(); o++){
+                    diff |= word(observed_lits[o]) ^ ((*reference)[c][o]? ~uint64_t(0) : 0);
+                }
+                auto fresh = diff & all & ~detected;
+                for(size_t lane=0; lane<group.size(); lane++){
+                    if((fresh >> lane) & 1){
+                        faults[group[lane]].detected = true;
+                        faults[group[lane]].cycle = c;
+                    }
+                }
+                detected |= fresh;
+            }
+            for(size_t i=0; i<next.size(); i++){
+                latched[i] = word(next[i]);
+            }
+            for(size_t i=0; i<state.size(); i++){
+                v[aig::var_of(state[i])] = latched[i];
+            }
+        }
+    }
+public:
+    //observed are nets a fault has to reach, by default outputs of the design
+    fault_sim(const netlist &nl, std::vector<size_t> observed = {})
+        :nl(nl),
+        observed(std::move(observed))
+    {
+        auto &nodes = nl.get_nodes();
+        if(this->observed.empty()){
+            for(auto &n:nl.get_outputs()){
+                this->observed.insert(this->observed.end(), nodes[n].outs.begin(), nodes[n].outs.end());
+            }
+        }
+        std::vector<size_t> sites;
+        for(auto &net:p_fault_nets(nl)){
+            if(nodes[nl.get_nets()[net].driver].type != netlist::types_node::t_in){
+                sites.emplace_back(net);
+            }
+            for(size_t bit=0; bit<nl.get_nets()[net].width; bit++){
+                faults.emplace_back(fault{net, bit, false});
+                faults.emplace_back(fault{net, bit, true});
+            }
+        }
+        g = std::make_unique<aig>(nl, this->observed, std::unordered_map<size_t, uint64_t>{}, sites);
+        for(auto &net:this->observed){
+            for(size_t bit=0; bit<nl.get_nets()[net].width; bit++){
+                observed_lits.emplace_back(g->get_literal(net, bit));
+            }
+        }
+    }
+
+    //simulates every fault over the stimulus from the initial state of the
+    //design, threads 0 uses one per core
+    report run(const stimulus &stim, size_t threads = 0){
+        std::vector<std::vector<bool>> reference;
+        p_run({}, stim, &reference, nullptr);
+
+        report result;
+        std::vector<std::vector<size_t>> groups;
+        for(size_t i=0; i<faults.size(); i++){
+            auto &f = faults[i];
+            f.detected = false;
+            f.cycle = 0;
+            result.faults++;
+            if(!g->is_kept(f.net, f.bit)){
+                result.unobservable++;
+                continue;
+            }
+            if(groups.empty() || groups.back().size() == 64){
+                groups.emplace_back();
+            }
+            groups.back().emplace_back(i);
+        }
+
+        if(threads == 0){
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        threads = std::min(threads, groups.size());
+        std::atomic<size_t> next_group{0};
+        auto worker = [&](){
+            for(auto i=next_group++; i<groups.size(); i=next_group++){
+                p_run(groups[i], stim, nullptr, &reference);
+            }
+        };
+        std::vector<std::thread> pool;
+        for(size_t t=1; t<threads; t++){
+            pool.emplace_back(worker);
+        }
+        worker();
+        for(auto &t:pool){
+            t.join();
+        }
+
+        for(auto &f:faults){
+            result.detected += f.detected;
+        }
+        return result;
+    }
+    report run(const std::string &stimulus_path, const size_t &threads = 0){
+        return run(stimulus::load(stimulus_path, nl), threads);
+    }
+
+    const std::vector<fault>& get_faults()const{
+        return faults;
+    }
+    const std::vector<size_t>& get_observed()const{
+        return observed;
+    }
+};
@@ -25,7 +25,23 @@ class elem_file_saver{
         t_or,
         t_not,
         t_in,
-        t_out
+        t_out,
+        t_clock,
+        t_xor,
+        t_nand,
+        t_nor,
+        t_xnor,
+        t_mux,
+        t_decoder,
+        t_encoder,
+        t_splitter,
+        t_merger,
+        t_ram,
+        t_rom,
+        t_dff,
+        t_register,
+        t_counter,
+        t_lut
     };
 
     static types_gate p_gate_to_type(const gate* gt){
@@ -39,17 +55,6 @@ class elem_file_saver{
         return types_gate::t_gt_in; //unreachable
     }
 
-    static std::shared_ptr<gate> p_type_to_gate(types_gate type, const std::string name){
-        if(type == types_gate::t_gt_in){
-            return std::make_shared<gate_in>(name);
-        }else if(type == types_gate::t_gt_out){
-            return std::make_shared<gate_out>(name);
-        }else{
-            throw std::runtime_error("unknown type of gate to make gate");
-        }
-        return nullptr; //unreachable
-    }
-
     static types_elem p_elem_to_type(const element* elem){
         using namespace sim_helpers;
         if(dynamic_cast<const elem_meta*>(elem)){
@@ -64,90 +69,275 @@ class elem_file_saver{
             return types_elem::t_in;
         }else if(dynamic_cast<const elem_out*>(elem)){
             return types_elem::t_out;
+        }else if(dynamic_cast<const elem_clock*>(elem)){
+            return types_elem::t_clock;
+        }else if(dynamic_cast<const elem_xor*>(elem)){
+            return types_elem::t_xor;
+        }else if(dynamic_cast<const elem_nand*>(elem)){
+            return types_elem::t_nand;
+        }else if(dynamic_cast<const elem_nor*>(elem)){
+            return types_elem::t_nor;
+        }else if(dynamic_cast<const elem_xnor*>(elem)){
+            return types_elem::t_xnor;
+        }else if(dynamic_cast<const elem_mux*>(elem)){
+            return types_elem::t_mux;
+        }else if(dynamic_cast<const elem_decoder*>(elem)){
+            return types_elem::t_decoder;
+        }else if(dynamic_cast<const elem_priority_encoder*>(elem)){
+            return types_elem::t_encoder;
+        }else if(dynamic_cast<const elem_splitter*>(elem)){
+            return types_elem::t_splitter;
+        }else if(dynamic_cast<const elem_merger*>(elem)){
+            return types_elem::t_merger;
+        }else if(dynamic_cast<const elem_ram*>(elem)){
+            return types_elem::t_ram;
+        }else if(dynamic_cast<const elem_rom*>(elem)){
+            return types_elem::t_rom;
+        }else if(dynamic_cast<const elem_dff*>(elem)){
+            return types_elem::t_dff;
+        }else if(dynamic_cast<const elem_register*>(elem)){
+            return types_elem::t_register;
+        }else if(dynamic_cast<const elem_counter*>(elem)){
+            return types_elem::t_counter;
+        }else if(dynamic_cast<const elem_lut*>(elem)){
+            return types_elem::t_lut;
         }else{
             throw std::runtime_error("unknown type of element to make element_type");
         }
         return types_elem::t_meta; //unreachable
     }
 
-    static std::unique_ptr<element> p_type_to_elem(const types_elem &type, const std::string &name){
+    //constructor arguments that shape the element, gates are made from them
+    static nlohmann::json p_elem_to_params(const element* elem){
+        nlohmann::json params = nlohmann::json::object();
+        if(auto cast = dynamic_cast<const elem_lut*>(elem)){
+            params["width"] = cast->get_width();
+            params["ins"] = cast->get_ins_size();
+            params["table"] = cast->get_table();
+        }else if(auto cast = dynamic_cast<const elem_bitwise*>(elem)){
+            params["width"] = cast->get_width();
+            params["ins"] = cast->get_ins_size();
+        }else if(auto cast = dynamic_cast<const elem_in*>(elem)){
+            params["width"] = cast->get_width();
+        }else if(auto cast = dynamic_cast<const elem_out*>(elem)){
+            params["width"] = cast->get_width();
+        }else if(auto cast = dynamic_cast<const elem_clock*>(elem)){
+            params["half_period"] = cast->get_half_period();
+        }else if(auto cast = dynamic_cast<const elem_mux*>(elem)){
+            params["width"] = cast->get_width();
+            params["sel_width"] = cast->get_sel_width();
+        }else if(auto cast = dynamic_cast<const elem_decoder*>(elem)){
+            params["sel_width"] = cast->get_sel_width();
+        }else if(auto cast = dynamic_cast<const elem_priority_encoder*>(elem)){
+            params["width"] = cast->get_width();
+        }else if(auto cast = dynamic_cast<const elem_splitter*>(elem)){
+            params["parts"] = cast->get_parts();
+        }else if(auto cast = dynamic_cast<const elem_merger*>(elem)){
+            params["parts"] = cast->get_parts();
+        }else if(auto cast = dynamic_cast<const elem_memory*>(elem)){
+            params["addr_width"] = cast->get_addr_width();
+            params["data_width"] = cast->get_data_width();
+            //rom contents stay in their image file, ram contents are not kept
+            if(auto rom = dynamic_cast<const elem_rom*>(elem)){
+                params["image"] = rom->get_image_path();
+            }
+        }else if(auto cast = dynamic_cast<const elem_sequential*>(elem)){
+            params["width"] = cast->get_width();
+        }
+        return params;
+    }
+
+    static std::unique_ptr<element> p_type_to_elem(const types_elem &type, const std::string &name,
+        const nlohmann::json &params)
+    {
+        size_t width = params.value("width", 1);
+        size_t ins = params.value("ins", 2);
         if(type == types_elem::t_meta){
             return std::make_unique<elem_meta>(name);
         }else if(type == types_elem::t_and){
-            return std::make_unique<elem_and>(name);
+            return std::make_unique<elem_and>(name, width, ins);
         }else if(type == types_elem::t_or){
-            return std::make_unique<elem_or>(name);
+            return std::make_unique<elem_or>(name, width, ins);
         }else if(type == types_elem::t_not){
-            return std::make_unique<elem_not>(name);
+            return std::make_unique<elem_not>(name, width);
         }else if(type == types_elem::t_in){
-            return std::make_unique<elem_in>(name);
+            return std::make_unique<elem_in>(name, width);
         }else if(type == types_elem::t_out){
-            return std::make_unique<elem_out>(name);
+            return std::make_unique<elem_out>(name, width);
+        }else if(type == types_elem::t_clock){
+            return std::make_unique<elem_clock>(name, params.value("half_period", 1));
+        }else if(type == types_elem::t_xor){
+            return std::make_unique<elem_xor>(name, width, ins);
+        }else if(type == types_elem::t_nand){
+            return std::make_unique<elem_nand>(name, width, ins);
+        }else if(type == types_elem::t_nor){
+            return std::make_unique<elem_nor>(name, width, ins);
+        }else if(type == types_elem::t_xnor){
+            return std::make_unique<elem_xnor>(name, width, ins);
+        }else if(type == types_elem::t_mux){
+            return std::make_unique<elem_mux>(name, width, params.value("sel_width", 1));
+        }else if(type == types_elem::t_decoder){
+            return std::make_unique<elem_decoder>(name, params.value("sel_width", 1));
+        }else if(type == types_elem::t_encoder){
+            return std::make_unique<elem_priority_encoder>(name, params.value("width", 2));
+        }else if(type == types_elem::t_splitter){
+            return std::make_unique<elem_splitter>(name, params.at("parts").get<std::vector<size_t>>());
+        }else if(type == types_elem::t_merger){
+            return std::make_unique<elem_merger>(name, params.at("parts").get<std::vector<size_t>>());
+        }else if(type == types_elem::t_ram){
+            return std::make_unique<elem_ram>(name, params.value("addr_width", 8),
+                params.value("data_width", 8));
+        }else if(type == types_elem::t_rom){
+            return std::make_unique<elem_rom>(name, params.value("addr_width", 8),
+                params.value("data_width", 8), params.value("image", std::string()));
+        }else if(type == types_elem::t_dff){
+            auto dff = std::make_unique<elem_dff>(name);
+            if(width != 1){
+                dff->set_width(width);
+            }
+            return dff;
+        }else if(type == types_elem::t_register){
+            return std::make_unique<elem_register>(name, params.value("width", 8));
+        }else if(type == types_elem::t_counter){
+            return std::make_unique<elem_counter>(name, params.value("width", 8));
+        }else if(type == types_elem::t_lut){
+            return std::make_unique<elem_lut>(name, width, ins, params.value("table", uint64_t(0)));
         }else{
             throw std::runtime_error("unknown type of element_type to make element");
         }
         return nullptr; //unreachable
     }
 
-k_tree_ retie(std::vector<std::unique_ptr<element>>& elems){
-    auto root_it = std::find_if(elems.begin(), elems.end(), 
-        [](const auto &el){
-            return el->get_id() == 0;
-    });
-    auto index = std::distance(root_it, elems.begin());
-    auto root = std::move(elems.at(index));
-    elems.erase(root_it);
+    //gate on the other side of a meta boundary, owned by elem_in and elem_out
+    static std::shared_ptr<gate> p_outer(const element* elem){
+        if(auto cast = dynamic_cast<const elem_in*>(elem)){
+            return cast->get_outer();
+        }else if(auto cast = dynamic_cast<const elem_out*>(elem)){
+            return cast->get_outer();
+        }
+        return nullptr;
+    }
+
+    static std::shared_ptr<gate_in> p_find_in(element* elem, const size_t &id){
+        for(size_t i=0; i<elem->get_ins_size(); i++){
+            auto in = elem->get_in(i);
+            if(in->get_id() == id){
+                return in;
+            }
+        }
+        auto outer = std::dynamic_pointer_cast<gate_in>(p_outer(elem));
+        if(outer && outer->get_id() == id){
+            return outer;
+        }
+        return nullptr;
+    }
 
-    k_tree_ tree(std::move(root));
-    for(auto &el:elems){
-        for(auto &out:el->get_outs()){
-            //replace all "tied" placeholders in an out with real ins of other elements
-            for(auto &tied:out->get_tied()){
-                //get placeholder ids
-                auto tied_id = tied->get_id();
-                auto tied_parent_id = tied->get_parent_id();
-                //search placeholder parent
-                auto el_it = std::find_if(elems.begin(), elems.end(),
-                    [&tied_parent_id](const auto &el){
-                        return el->get_id() == tied_parent_id;
-                    });
-                if(el_it == elems.end()){
-                    auto mes = "input id="+std::to_string(tied_id)+
-                        " tied to an unknown element id="+std::to_string(tied_parent_id);
-                    throw std::runtime_error(mes);
-                }
-                //search real input in placeholder's parent
-                auto &el_parent = *el_it;
-                auto in_it = std::find_if(el_parent->get_ins_begin(), el_parent->get_ins_end(),
-                    [&tied_id](const auto &gt){
-                        return gt->get_id() == tied_id;
-                    });
-                if(in_it == el_parent->get_ins_end()){
-                    auto mes = "element id="+std::to_string(tied_parent_id)+
-                        " has no gate_in id="+std::to_string(tied_id);
-                    throw std::runtime_error(mes);
-                }
-                //retie
-                tied = *in_it;
+    struct tie_info{
+        std::shared_ptr<gate_out> out;
+        size_t in_id, in_parent_id;
+    };
+
+    //gates are made by element constructor, file only gives their ids back.
+    //Width of a gate is kept unless the element fixes the shape of its gates.
+    //Files saved before shapes were stored have widths set gate by gate, there
+    //such an element keeps the default shape of its type
+    static void p_adopt_gate(const element* elem, const std::shared_ptr<gate> &gt,
+        const nlohmann::json &j, std::vector<tie_info> &ties, const bool &shaped)
+    {
+        gt->id = j.at("id");
+        gt->parent_id = j.at("parent_id");
+        gt->set_name(j.at("name"));
+        size_t width = j.at("width");
+        if(gt->get_width() != width && (shaped || !elem->has_fixed_shape())){
+            if(elem->has_fixed_shape()){
+                auto mes = "element "+elem->get_name()+" id="+std::to_string(elem->get_id())+
+                    " has gate id="+std::to_string(gt->get_id())+" of width "+std::to_string(width)+
+                    ", its type makes it "+std::to_string(gt->get_width())+" wide";
+                throw std::runtime_error(mes);
+            }
+            gt->set_width(width);
+        }
+        if(j.contains("tied")){
+            auto gt_out = std::dynamic_pointer_cast<gate_out>(gt);
+            std::vector<std::pair<size_t, size_t>> ids;
+            j.at("tied").get_to(ids);
+            for(auto &p:ids){
+                ties.push_back({gt_out, p.first, p.second});
             }
         }
     }
-    //restore elements hierarchy in tree
-    for(auto &el:elems){
-        auto parent_id = el->get_parent_id();
+
+k_tree_ retie(std::vector<std::unique_ptr<element>>& elems, const std::vector<tie_info> &ties,
+    const std::vector<std::vector<size_t>> &meta_gates)
+{
+    auto find_elem = [&elems](const size_t &id){
+        return std::find_if(elems.begin(), elems.end(),
+            [&id](const auto &el){
+                return el && el->get_id() == id;
+            });
+    };
+    for(auto &t:ties){
+        auto el_it = find_elem(t.in_parent_id);
+        if(el_it == elems.end()){
+            auto mes = "input id="+std::to_string(t.in_id)+
+                " tied to an unknown element id="+std::to_string(t.in_parent_id);
+            throw std::runtime_error(mes);
+        }
+        auto in = p_find_in(el_it->get(), t.in_id);
+        if(!in){
+            auto mes = "element id="+std::to_string(t.in_parent_id)+
+                " has no gate_in id="+std::to_string(t.in_id);
+            throw std::runtime_error(mes);
+        }
+        t.out->tie_input(in);
+    }
+    //meta elements share gates of their elem_in and elem_out children
+    for(size_t i=0; i<elems.size(); i++){
+        for(auto &gt_id:meta_gates[i]){
+            auto child = std::find_if(elems.begin(), elems.end(),
+                [&gt_id](const auto &el){
+                    auto outer = p_outer(el.get());
+                    return outer && outer->get_id() == gt_id;
+                });
+            if(child == elems.end()){
+                auto mes = "element id="+std::to_string(elems[i]->get_id())+
+                    " has gate id="+std::to_string(gt_id)+" of no child";
+                throw std::runtime_error(mes);
+            }
+            auto outer = p_outer(child->get());
+            if(auto in = std::dynamic_pointer_cast<gate_in>(outer)){
+                elems[i]->emplace_back(in);
+            }else{
+                elems[i]->emplace_back(std::dynamic_pointer_cast<gate_out>(outer));
+            }
+        }
+    }
+    //first element is the root, parents always come before children
+    k_tree_ tree(std::move(elems.at(0)));
+    for(size_t i=1; i<elems.size(); i++){
+        auto parent_id = elems[i]->get_parent_id();
         auto it = std::find_if(tree.begin(), tree.end(),
             [&parent_id](const auto &el){
                 return el->get_id() == parent_id;
         });
-        if(it != tree.end()){
-            tree.child_append(it, std::move(el));
+        if(it == tree.end()){
+            auto mes = "element id="+std::to_string(elems[i]->get_id())+
+                " has unknown parent id="+std::to_string(parent_id);
+            throw std::runtime_error(mes);
         }
+        tree.child_append(it, std::move(elems[i]));
     }
     return tree;
 }
 
 public:
 
+//type and constructor arguments of an element as text, equal for elements
+//that differ only by name and ties
+static std::string shape_of(const element* elem){
+    return std::to_string(static_cast<int>(p_elem_to_type(elem)))+p_elem_to_params(elem).dump();
+}
+
 template<class It>
 auto to_json(It beg, It end){
     using namespace sim_helpers;
@@ -172,22 +362,26 @@ auto to_json(It beg, It end){
         }
         return gt_info;
     };
-    auto elem_to_json = [&gate_to_json](const auto &elem){
+    auto elem_to_json = [&gate_to_json](const element* elem){
         nlohmann::json result{
             {"id", elem->get_id()},
             {"parent_id", elem->get_parent_id()},
-            {"name", elem->name},
+            {"name", elem->get_name()},
             {"type", p_elem_to_type(elem)},
+            {"params", p_elem_to_params(elem)},
             };
         std::vector<nlohmann::json> ins,outs;
-        for(auto &gt:elem->ins){
-            ins.emplace_back(gate_to_json(gt.get()));
+        for(size_t i=0; i<elem->get_ins_size(); i++){
+            ins.emplace_back(gate_to_json(elem->get_in(i).get()));
         }
-        for(auto &gt:elem->outs){
-            outs.emplace_back(gate_to_json(gt.get()));
+        for(size_t i=0; i<elem->get_outs_size(); i++){
+            outs.emplace_back(gate_to_json(elem->get_out(i).get()));
         }
         result["ins"] = std::move(ins);
         result["outs"] = std::move(outs);
+        if(auto outer = p_outer(elem)){
+            result["outer"] = gate_to_json(outer.get());
+        }
         return result;
     };
     nlohmann::json result;
@@ -200,39 +394,46 @@ auto to_json(It beg, It end){
 }
 
 auto from_json(const nlohmann::json &j){
-    auto gate_from_json = [this](const nlohmann::json& j) {
-        auto type = j.at("type");
-        auto gt = p_type_to_gate(type, j.at("name"));
-        gt->id = j.at("id");
-        gt->parent_id = j.at("parent_id");
-        gt->width = j.at("width");
-        if(type == types_gate::t_gt_out){
-            auto gt_out = std::dynamic_pointer_cast<gate_out>(gt);
-            std::vector<std::pair<size_t, size_t>> placeholders;
-            j.at("tied").get_to(placeholders);
-            for(auto &p:placeholders){
-                auto in = std::make_shared<gate_in>("placeholder", 1, p.second);
-                in->id = p.first;
-                gt_out->tie_input(in);
-            }
-        }
-        return gt;
-    };
-    auto elem_from_json = [this, &gate_from_json](const nlohmann::json& j) {
-        auto el = p_type_to_elem(j.at("type"), j.at("name"));
+    std::vector<tie_info> ties;
+    std::vector<std::vector<size_t>> meta_gates;
+    size_t max_id = 0;
+    auto elem_from_json = [&](const nlohmann::json& j) {
+        auto type = j.at("type").get<types_elem>();
+        bool shaped = j.contains("params");
+        auto params = shaped? j.at("params") : nlohmann::json::object();
+        auto el = p_type_to_elem(type, j.at("name"), params);
         el->id = j.at("id");
         el->parent_id = j.at("parent_id");
-        auto &ins = el->get_ins();
-        auto &outs = el->get_outs();
-        ins.clear();
-        outs.clear();
-        for(auto &j_obj:j.at("ins")){
-            auto gt = gate_from_json(j_obj);
-            ins.emplace_back(std::dynamic_pointer_cast<gate_in>(gt));
+        max_id = std::max(max_id, el->get_id());
+        auto &j_ins = j.at("ins");
+        auto &j_outs = j.at("outs");
+        meta_gates.emplace_back();
+        if(type == types_elem::t_meta){
+            for(auto &j_obj:j_ins){
+                meta_gates.back().emplace_back(j_obj.at("id"));
+            }
+            for(auto &j_obj:j_outs){
+                meta_gates.back().emplace_back(j_obj.at("id"));
+            }
+            return el;
+        }
+        if(j_ins.size() != el->get_ins_size() || j_outs.size() != el->get_outs_size()){
+            auto mes = "element "+el->get_name()+" id="+std::to_string(el->get_id())+
+                " has gates that do not match its type";
+            throw std::runtime_error(mes);
         }
-        for(auto &j_obj:j.at("outs")){
-            auto gt = gate_from_json(j_obj);
-            outs.emplace_back(std::dynamic_pointer_cast<gate_out>(gt));
+        for(size_t i=0; i<el->get_ins_size(); i++){
+            p_adopt_gate(el.get(), el->get_in(i), j_ins[i], ties, shaped);
+            max_id = std::max(max_id, el->get_in(i)->get_id());
+        }
+        for(size_t i=0; i<el->get_outs_size(); i++){
+            p_adopt_gate(el.get(), el->get_out(i), j_outs[i], ties, shaped);
+            max_id = std::max(max_id, el->get_out(i)->get_id());
+        }
+        auto outer = p_outer(el.get());
+        if(outer && j.contains("outer")){
+            p_adopt_gate(el.get(), outer, j.at("outer"), ties, shaped);
+            max_id = std::max(max_id, outer->get_id());
         }
         return el;
     };
@@ -240,7 +441,12 @@ auto from_json(const nlohmann::json &j){
     for(const auto &j_obj:j){
         elems.emplace_back(elem_from_json(j_obj));
     }
-    k_tree_ tree = retie(elems);
+    if(elems.empty()){
+        throw std::runtime_error("attempt to load a file without elements");
+    }
+    //elements made after loading must not reuse ids from the file
+    nameable::id_assigner::get_instance().reserve(max_id);
+    k_tree_ tree = retie(elems, ties, meta_gates);
     return tree;
 }
 
@@ -4,12 +4,13 @@
 #include "nameable.h"
 #include "helpers.h"
 #include "logger.h"
+#include "bit_math.h"
 
 class gate:virtual public nameable{
 protected:
     friend class elem_file_saver;
     size_t width;
-    std::vector<bool> values;
+    bits::bit_vector values;
 
     logger& lg;
 
@@ -25,6 +26,12 @@ public:
     }
     virtual ~gate(){}
 
+    //counts value changes made by current thread, lets sim notice a fixpoint
+    static size_t& changes_counter(){
+        thread_local size_t counter = 0;
+        return counter;
+    }
+
     virtual void set_width(const size_t &width){
         this->width = width;
         values.resize(width);
@@ -35,21 +42,26 @@ public:
     virtual bool get_value(const size_t &place)const{
         return values.at(place);
     }
-    virtual const std::vector<bool>& get_values()const{
+    virtual const bits::bit_vector& get_values()const{
         return values;
     }
-    virtual std::vector<bool> get_values(){
+    virtual bits::bit_vector get_values(){
         return values;
     }
 
-    virtual void set_values(const std::vector<bool> &values){
+    virtual void set_values(const bits::bit_vector &values){
         if(values.size() != this->width){
             auto mes = "attempt to assign value of width "+std::to_string(values.size())+
                 " to a gate "+get_name()+" with width "+std::to_string(width);
             throw std::runtime_error(mes);
         }
-        log("got value "+sim_helpers::to_str(values));
-        this->values = values;
+        if(lg.enabled()){
+            log("got value "+sim_helpers::to_str(values));
+        }
+        if(this->values != values){
+            changes_counter()++;
+            this->values = values;
+        }
     }
 
     friend bool operator==(const gate &lhs, const gate &rhs){
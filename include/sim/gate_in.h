@@ -1,5 +1,6 @@
 #pragma once
 #include "gate.h"
+#include "dirty_scope.h"
 
 class gate_in:public gate{
 public:
@@ -15,8 +16,9 @@ class gate_in_active:public gate_in{
     friend class elem_meta;
     friend class elem_file_saver;
 
-    bool m_active;
-    Parent* parent;
+    bool m_active = false;
+    Parent* parent = nullptr;
+    dirty_scope* scope = nullptr;   //of the meta this gate leads into
 public:
     gate_in_active(const std::string &name, const size_t &width, Parent *parent)
         :gate_in(name, width, parent->get_id()),
@@ -37,8 +39,17 @@ public:
         return m_active;
     }
 
-    void set_values(const std::vector<bool> &value)override{
+    void set_scope(dirty_scope* scope){
+        this->scope = scope;
+    }
+
+    void set_values(const bits::bit_vector &value)override{
+        auto &changes = changes_counter();
+        auto before = changes;
         gate::set_values(value);
+        if(scope && changes != before){
+            scope->mark();
+        }
         if(m_active && parent){
             parent->process();
         }
@@ -58,4 +69,27 @@ public:
     friend bool operator!=(const gate_in_active &lhs, const gate_in_active &rhs){
         return !(lhs == rhs);
     }
-};
\ No newline at end of file
+};
+//tells its element about a new value the moment it arrives, so elements that
+//only move bits around need no process() pass to follow their inputs
+template<class Parent>
+class gate_in_notify:public gate_in{
+    Parent* parent;
+    size_t place;
+public:
+    gate_in_notify(const std::string &name, const size_t &width, Parent *parent, const size_t &place)
+        :gate_in(name, width, parent->get_id()),
+        nameable(name, parent->get_id()),
+        parent(parent),
+        place(place)
+    {}
+
+    void set_values(const bits::bit_vector &values)override{
+        auto &changes = changes_counter();
+        auto before = changes;
+        gate::set_values(values);
+        if(changes != before){
+            parent->on_input(place);
+        }
+    }
+};
@@ -22,12 +22,14 @@ public:
     void pass_value()const{
         auto &val = this->get_values();
         for(auto &in:ins){
-            log("passing value "+sim_helpers::to_str(val)+
-                " to gate id:"+std::to_string(in->get_id()));
+            if(lg.enabled()){
+                log("passing value "+sim_helpers::to_str(val)+
+                    " to gate id:"+std::to_string(in->get_id()));
+            }
             in->set_values(val);
         }
     }
-    void pass_value(const std::vector<bool> &val){
+    void pass_value(const bits::bit_vector &val){
         set_values(val);
         pass_value();
     }
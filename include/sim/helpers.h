@@ -4,7 +4,8 @@
 
 namespace sim_helpers{
 
-inline std::string to_str(const std::vector<bool> &vec){
+template<class Bits>
+inline std::string to_str(const Bits &vec){
     std::string result(vec.size(), '0');
     for(size_t i=0; i<vec.size(); i++){
         result.at(i) = vec.at(i)?'1':'0';
@@ -332,6 +332,13 @@ public:
         p_copy(rhs);
     }
 
+    //steals nodes, rhs is left empty
+    k_tree(k_tree<T, node_allocator> &&rhs){
+        p_init();
+        std::swap(m_root, rhs.m_root);
+        std::swap(m_foot, rhs.m_foot);
+    }
+
     ~k_tree(){
         clear();
         m_alloc_.deallocate(m_root,1);
@@ -343,6 +350,14 @@ public:
         }
         return (*this);
     }
+    inline auto& operator=(k_tree<T, node_allocator> &&rhs) {
+        if(this != &rhs) {
+            clear();
+            std::swap(m_root, rhs.m_root);
+            std::swap(m_foot, rhs.m_foot);
+        }
+        return (*this);
+    }
 
     inline auto root() const {
         return depth_first_node_first_iterator(m_root->neighbour_next);//ISSUE:why?
@@ -1,16 +1,29 @@
 #pragma once
 #include <optional>
+#include <atomic>
 #include <iostream>
 #include <sstream>
 #include <string>
 
 class logger{
+    std::atomic<bool> m_enabled{true};
     logger(){}
 public:
     void log(const std::string &name, const std::string &str){
+        if(!enabled()){
+            return;
+        }
         std::cout<<name<<":\t"<<str<<"\n";
     }
 
+    //callers should skip building messages when logging is off
+    bool enabled()const{
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+    void set_enabled(bool enabled){
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
     ~logger(){
         std::cout.flush();
     }
@@ -0,0 +1,200 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include "netlist.h"
+
+//technology mapping: packs clusters of bitwise gates into lookup tables of up
+//to k inputs, the way synthesis does for an FPGA. Works on a copy of the
+//netlist, the sim tree stays as it is for editing and the mapped netlist runs
+//on any engine. A cluster is a fanout-free cone: a gate takes in the gate
+//driving one of its inputs when it is the only reader of that net and the cone
+//keeps at most k leaf nets. Nets inside a cluster are not computed anymore,
+//find_net gives npos for them
+class lut_mapper{
+    static bool p_mappable(const netlist &nl, const size_t &n){
+        auto &nd = nl.nodes[n];
+        switch(nd.type){
+        case netlist::types_node::t_buf:
+        case netlist::types_node::t_and:
+        case netlist::types_node::t_or:
+        case netlist::types_node::t_not:
+        case netlist::types_node::t_xor:
+        case netlist::types_node::t_nand:
+        case netlist::types_node::t_nor:
+        case netlist::types_node::t_xnor:
+        case netlist::types_node::t_lut:
+            break;
+        default:
+            return false;
+        }
+        //bitwise only, each bit of the bus is a lane of the same table
+        auto width = nl.nets[nd.outs.at(0)].width;
+        return std::all_of(nd.ins.begin(), nd.ins.end(),
+            [&nl, &width](const size_t &net_id){
+                return nl.nets[net_id].width == width;
+            });
+    }
+
+    //net can disappear inside the cluster of its only reader
+    static bool p_absorbable(const netlist &nl, const size_t &net_id, const size_t &reader){
+        auto &nt = nl.nets[net_id];
+        if(nt.storage != net_id || nl.sharing[net_id].size() != 1){
+            return false;
+        }
+        return std::all_of(nt.readers.begin(), nt.readers.end(),
+            [&reader](const size_t &r){
+                return r == reader;
+            });
+    }
+
+public:
+    static netlist map(const netlist &nl, const size_t &k = elem_lut::max_ins){
+        if(k == 0 || k > elem_lut::max_ins){
+            throw std::runtime_error("attempt to map into luts of "+std::to_string(k)+
+                " inputs, allowed are 1 to "+std::to_string(elem_lut::max_ins));
+        }
+        auto &nodes = nl.nodes;
+        auto &nets = nl.nets;
+        auto count = nodes.size();
+
+        //Kahn's algorithm, nodes of combinational loops never get ready
+        std::vector<size_t> pending(count, 0), order;
+        for(size_t n=0; n<count; n++){
+            for(auto &r:nl.fanout[n]){
+                pending[r]++;
+            }
+        }
+        for(size_t n=0; n<count; n++){
+            if(pending[n] == 0){
+                order.emplace_back(n);
+            }
+        }
+        for(size_t i=0; i<order.size(); i++){
+            auto n = order[i];
+            if(nodes[n].sequential){
+                continue;
+            }
+            for(auto &r:nl.fanout[n]){
+                if(--pending[r] == 0 && !nodes[r].sequential){
+                    order.emplace_back(r);
+                }
+            }
+        }
+
+        //buffers passing a clock on stay, a lut there would derive the clock
+        std::vector<bool> clocking(count, false);
+        for(auto &nd:nodes){
+            if(!nd.sequential){
+                continue;
+            }
+            for(auto net_id = nd.ins.back(); nets[net_id].storage == net_id; ){
+                auto d = nets[net_id].driver;
+                if(d == netlist::npos || nodes[d].type != netlist::types_node::t_buf || clocking[d]){
+                    break;
+                }
+                clocking[d] = true;
+                net_id = nodes[d].ins.at(0);
+            }
+        }
+
+        std::vector<size_t> position(count, netlist::npos);
+        for(size_t i=0; i<order.size(); i++){
+            position[order[i]] = i;
+        }
+        std::vector<std::vector<size_t>> leaves(count), members(count);
+        std::vector<bool> absorbed(count, false), fits(count, false);
+        for(auto &n:order){
+            if(nodes[n].sequential || clocking[n] || !p_mappable(nl, n)){
+                continue;
+            }
+            auto &lv = leaves[n];
+            for(auto &net_id:nodes[n].ins){
+                if(std::find(lv.begin(), lv.end(), net_id) == lv.end()){
+                    lv.emplace_back(net_id);
+                }
+            }
+            members[n].emplace_back(n);
+            fits[n] = lv.size() <= k;
+            if(!fits[n]){
+                continue;
+            }
+            for(auto &net_id:nodes[n].ins){
+                auto d = nets[net_id].driver;
+                if(d == netlist::npos || !fits[d] || absorbed[d] || !p_absorbable(nl, net_id, n)){
+                    continue;
+                }
+                auto merged = lv;
+                merged.erase(std::find(merged.begin(), merged.end(), net_id));
+                for(auto &leaf:leaves[d]){
+                    if(std::find(merged.begin(), merged.end(), leaf) == merged.end()){
+                        merged.emplace_back(leaf);
+                    }
+                }
+                if(merged.size() > k){
+                    continue;
+                }
+                lv = std::move(merged);
+                members[n].insert(members[n].end(), members[d].begin(), members[d].end());
+                absorbed[d] = true;
+            }
+        }
+
+        netlist result = nl;
+        std::vector<size_t> index(count, netlist::npos);
+        std::vector<netlist::node> mapped;
+        std::vector<uint64_t> words(nets.size(), 0);
+        for(size_t n=0; n<count; n++){
+            if(absorbed[n]){
+                for(auto &net_id:nodes[n].outs){
+                    result.nets[net_id].driver = netlist::npos;
+                    result.nets[net_id].gate_ids.clear();
+                }
+                continue;
+            }
+            index[n] = mapped.size();
+            mapped.emplace_back(nodes[n]);
+            if(members[n].size() < 2){
+                continue;
+            }
+            //every row of the table at once, leaf i holds pattern of bit i
+            for(size_t i=0; i<leaves[n].size(); i++){
+                words[leaves[n][i]] = bits::counting_word(i, 0);
+            }
+            auto cluster = members[n];
+            std::sort(cluster.begin(), cluster.end(), [&position](const size_t &a, const size_t &b){
+                return position[a] < position[b];
+            });
+            for(auto &m:cluster){
+                auto &nd = nodes[m];
+                words[nd.outs[0]] = netlist::eval(nd, [&words, &nd](const size_t &i){
+                    return words[nd.ins[i]];
+                });
+            }
+            auto rows = size_t(1) << leaves[n].size();
+            auto &nd = mapped.back();
+            nd.type = netlist::types_node::t_lut;
+            nd.ins = leaves[n];
+            nd.table = words[nd.outs[0]];
+            if(rows < 64){
+                nd.table &= (uint64_t(1) << rows)-1;
+            }
+        }
+        for(auto &nt:result.nets){
+            if(nt.driver != netlist::npos){
+                nt.driver = index[nt.driver];
+            }
+        }
+        for(auto &n:result.inputs){
+            n = index[n];
+        }
+        for(auto &n:result.outputs){
+            n = index[n];
+        }
+        result.nodes = std::move(mapped);
+        result.p_index();
+        result.p_find_comb_loops();
+        return result;
+    }
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <cstdint>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define SIM_MEM_IMAGE_MMAP
+#endif
+
+//read-only contents of a binary file. Mapped into memory where the platform
+//allows it, so a large image costs no load time and pages in on first read
+class mem_image{
+    std::string path;
+    const uint8_t *bytes = nullptr;
+    size_t bytes_size = 0;
+    std::vector<uint8_t> buffer;    //copy of the file where mapping is not available
+#ifdef SIM_MEM_IMAGE_MMAP
+    void *mapped = nullptr;
+#endif
+
+    void p_release(){
+#ifdef SIM_MEM_IMAGE_MMAP
+        if(mapped){
+            munmap(mapped, bytes_size);
+            mapped = nullptr;
+        }
+#endif
+        buffer.clear();
+        bytes = nullptr;
+        bytes_size = 0;
+        path.clear();
+    }
+public:
+    mem_image() = default;
+    explicit mem_image(const std::string &path){
+        open(path);
+    }
+    ~mem_image(){
+        p_release();
+    }
+    mem_image(const mem_image&) = delete;
+    mem_image& operator=(const mem_image&) = delete;
+
+    void open(const std::string &path){
+        p_release();
+#ifdef SIM_MEM_IMAGE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            throw std::runtime_error("attempt to open memory image "+path+", which can't be read");
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0){
+            ::close(fd);
+            throw std::runtime_error("attempt to open memory image "+path+", which can't be read");
+        }
+        bytes_size = static_cast<size_t>(st.st_size);
+        if(bytes_size){
+            mapped = mmap(nullptr, bytes_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapped == MAP_FAILED){
+                mapped = nullptr;
+                bytes_size = 0;
+                ::close(fd);
+                throw std::runtime_error("attempt to map memory image "+path+", which failed");
+            }
+            bytes = static_cast<const uint8_t*>(mapped);
+        }
+        ::close(fd);
+#else
+        std::ifstream file(path, std::ios::binary);
+        if(!file){
+            throw std::runtime_error("attempt to open memory image "+path+", which can't be read");
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        bytes = buffer.data();
+        bytes_size = buffer.size();
+#endif
+        this->path = path;
+    }
+    void close(){
+        p_release();
+    }
+
+    bool is_open()const{
+        return !path.empty();
+    }
+    const std::string& get_path()const{
+        return path;
+    }
+    const uint8_t* data()const{
+        return bytes;
+    }
+    size_t size()const{
+        return bytes_size;
+    }
+};
@@ -3,14 +3,22 @@
 #include <memory>
 #include "element.h"
 #include "basic_elements.h"
+#include "dirty_scope.h"
 
 class sim;
+//container of elements, sim skips its whole subtree while scope is clean
 class elem_meta:public element{
-public:
-protected:
+    dirty_scope scope;
 public:
     elem_meta(const std::string &name, const size_t &parent_id=0)
         :element(name, parent_id),
         nameable(name, parent_id)
     {}
+
+    dirty_scope& get_scope(){
+        return scope;
+    }
+    const dirty_scope& get_scope()const{
+        return scope;
+    }
 };
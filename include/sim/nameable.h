@@ -5,6 +5,7 @@ class nameable{
     friend class elem_file_saver;
     friend class elem_in;
     friend class elem_out;
+    friend class sim;
     std::string name;
     size_t id, parent_id;
 
@@ -21,6 +22,12 @@ class nameable{
             last_id++;
             return last_id;
         }
+        //ids up to given one are taken, e.g. by loaded elements
+        void reserve(const size_t &id){
+            if(last_id == size_t(-1) || last_id < id){
+                last_id = id;
+            }
+        }
     };
 public:
     nameable(const std::string &name, const size_t &parent_id) {
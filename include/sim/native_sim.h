@@ -0,0 +1,375 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <dlfcn.h>
+#include <stdlib.h>
+#include "netlist.h"
+#include "cycle_sim.h"
+
+//ahead of time compiled simulation of a frozen design: the netlist becomes a
+//straight-line C++ source, every node one bitwise expression over words of an
+//array, which is built into a shared library by the system compiler and
+//loaded with dlopen. Steps like cycle_sim and accepts the same designs;
+//rom contents are read once, later changes to the sim are not seen
+class native_sim{
+    using evaluate_fn = void (*)(uint64_t*, uint64_t* const*);
+    using drive_fn = void (*)(uint64_t*, const uint64_t*);
+    using step_fn = void (*)(uint64_t*, uint64_t*, uint64_t* const*);
+
+    const netlist &nl;
+    std::string source;
+    std::filesystem::path dir;
+    void* handle = nullptr;
+    evaluate_fn p_evaluate_fn = nullptr;
+    drive_fn p_drive_fn = nullptr;
+    step_fn p_step_fn = nullptr;
+    std::vector<uint64_t> values;   //by storage net
+    std::vector<uint64_t> states;   //by sequential node, in order of nodes
+    std::vector<std::vector<uint64_t>> memories;    //by memory node, in order of nodes
+    std::vector<uint64_t*> memory_ptrs;
+    bool inputs_changed = false;
+    uint64_t cycle = 0;
+
+    static std::string p_hex(const uint64_t &value){
+        std::ostringstream ss;
+        ss<<"0x"<<std::hex<<value<<"ull";
+        return ss.str();
+    }
+    static uint64_t p_mask(const size_t &width){
+        return (width == 64)? ~uint64_t(0) : (uint64_t(1) << width)-1;
+    }
+    static std::string p_read(const netlist &nl, const size_t &net){
+        auto &nt = nl.get_nets()[net];
+        return "((v["+std::to_string(nt.storage)+"] >> "+std::to_string(nt.offset)+") & "+
+            p_hex(p_mask(nt.width))+")";
+    }
+    static std::string p_write(const netlist &nl, const size_t &net, const std::string &expr){
+        auto &nt = nl.get_nets()[net];
+        auto word = "v["+std::to_string(nt.storage)+"]";
+        auto mask = p_mask(nt.width);
+        return "    "+word+" = ("+word+" & "+p_hex(~(mask << nt.offset))+") | (("+expr+
+            ") & "+p_hex(mask)+") << "+std::to_string(nt.offset)+";\n";
+    }
+    //name as a line comment; a backslash at its end would splice the next
+    //line of source into the comment, so it goes with control characters
+    static std::string p_comment(const std::string &name){
+        std::string result = "    //";
+        for(auto &c:name){
+            auto u = static_cast<unsigned char>(c);
+            result += (c == '\\' || u < 0x20 || u == 0x7f)? ' ' : c;
+        }
+        return result+"\n";
+    }
+
+    //expression of output "out" of a combinational node, muxes and luts read
+    //their inputs from array x, see p_list
+    static std::string p_expression(const netlist &nl, const netlist::node &nd, const size_t &out,
+        const size_t &memory)
+    {
+        auto in = [&nl, &nd](const size_t &i){
+            return p_read(nl, nd.ins[i]);
+        };
+        auto fold = [&nd, &in](const std::string &op){
+            std::string result = in(0);
+            for(size_t i=1; i<nd.ins.size(); i++){
+                result += " "+op+" "+in(i);
+            }
+            return result;
+        };
+        switch(nd.type){
+        case netlist::types_node::t_buf:
+            return in(0);
+        case netlist::types_node::t_not:
+            return "~"+in(0);
+        case netlist::types_node::t_and:
+            return fold("&");
+        case netlist::types_node::t_or:
+            return fold("|");
+        case netlist::types_node::t_xor:
+            return fold("^");
+        case netlist::types_node::t_nand:
+            return "~("+fold("&")+")";
+        case netlist::types_node::t_nor:
+            return "~("+fold("|")+")";
+        case netlist::types_node::t_xnor:
+            return "~("+fold("^")+")";
+        case netlist::types_node::t_mux:
+            return "sel_mux("+in(nd.ins.size()-1)+", "+std::to_string(nd.ins.size()-1)+", x)";
+        case netlist::types_node::t_decoder:
+            return "decode("+in(0)+")";
+        case netlist::types_node::t_encoder:
+            return (out == 1)? "uint64_t("+in(0)+" != 0)" : "encode("+in(0)+")";
+        case netlist::types_node::t_lut:
+            return "lut("+p_hex(nd.table)+", "+std::to_string(nd.ins.size())+", x)";
+        case netlist::types_node::t_rom:
+            return "m["+std::to_string(memory)+"]["+in(0)+"]";
+        case netlist::types_node::t_ram:
+            return "ram(m["+std::to_string(memory)+"], "+in(0)+", "+in(1)+", "+in(2)+")";
+        default:
+            throw std::runtime_error("attempt to generate code for "+nd.name+", which is not combinational");
+        }
+    }
+
+    //declaration of x for a mux or lut, empty for other nodes
+    static std::string p_list(const netlist &nl, const netlist::node &nd){
+        size_t count = 0;
+        if(nd.type == netlist::types_node::t_mux){
+            count = nd.ins.size()-1;
+        }else if(nd.type == netlist::types_node::t_lut){
+            count = nd.ins.size();
+        }
+        if(count == 0){
+            return "";
+        }
+        std::string result = "    const uint64_t x[] = {";
+        for(size_t i=0; i<count; i++){
+            result += ((i == 0)? "" : ", ")+p_read(nl, nd.ins[i]);
+        }
+        return result+"};\n";
+    }
+
+    //next state of a sequential node, st is its current one
+    static std::string p_next_state(const netlist &nl, const netlist::node &nd, const std::string &st){
+        auto in = [&nl, &nd](const size_t &i){
+            return p_read(nl, nd.ins[i]);
+        };
+        switch(nd.type){
+        case netlist::types_node::t_dff:
+            return in(0);
+        case netlist::types_node::t_register:
+            return "("+in(1)+")? "+in(0)+" : "+st;
+        case netlist::types_node::t_counter:
+            return "("+in(0)+")? (("+in(1)+")? 0 : "+st+"+1) : "+st;
+        default:
+            return st;
+        }
+    }
+
+    static std::vector<size_t> p_indices(const netlist &nl, const bool &sequential){
+        std::vector<size_t> result(nl.get_nodes().size(), netlist::npos);
+        size_t count = 0;
+        for(size_t n=0; n<result.size(); n++){
+            auto &nd = nl.get_nodes()[n];
+            bool memory = nd.type == netlist::types_node::t_ram || nd.type == netlist::types_node::t_rom;
+            if(sequential? nd.sequential : memory){
+                result[n] = count++;
+            }
+        }
+        return result;
+    }
+    //compiles source in a fresh temporary directory and loads the library.
+    //The directory is made by mkdtemp, private to this user, as a predictable
+    //one in a shared temp could be made first and the library swapped
+    void p_load(const std::string &compiler, const std::string &flags){
+        auto pattern = (std::filesystem::temp_directory_path()/"native_sim_XXXXXX").string();
+        if(!mkdtemp(pattern.data())){
+            throw std::runtime_error("attempt to create a build directory for generated circuit in "+
+                std::filesystem::temp_directory_path().string()+" failed");
+        }
+        dir = pattern;
+        auto src_path = dir/"circuit.cpp";
+        auto lib_path = dir/"circuit.so";
+        {
+            std::ofstream file(src_path);
+            file<<source;
+            if(!file){
+                throw std::runtime_error("attempt to write generated source to "+src_path.string()+" failed");
+            }
+        }
+        auto command = compiler+" "+flags+" -shared -fPIC -o \""+lib_path.string()+"\" \""+
+            src_path.string()+"\"";
+        if(std::system(command.c_str()) != 0){
+            throw std::runtime_error("attempt to compile generated circuit failed: "+command);
+        }
+        handle = dlopen(lib_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if(!handle){
+            throw std::runtime_error(std::string("attempt to load compiled circuit failed: ")+dlerror());
+        }
+        p_evaluate_fn = reinterpret_cast<evaluate_fn>(dlsym(handle, "circuit_evaluate"));
+        p_drive_fn = reinterpret_cast<drive_fn>(dlsym(handle, "circuit_drive"));
+        p_step_fn = reinterpret_cast<step_fn>(dlsym(handle, "circuit_step"));
+        if(!p_evaluate_fn || !p_drive_fn || !p_step_fn){
+            throw std::runtime_error("attempt to load compiled circuit without its entry points");
+        }
+    }
+    //state and memories from the sim, then outputs of that state
+    void p_init(){
+        auto &nodes = nl.get_nodes();
+        values.assign(nl.get_nets().size(), 0);
+        for(auto &nd:nodes){
+            if(nd.sequential){
+                states.emplace_back(dynamic_cast<const elem_sequential*>(nd.elem)->get_state().word(0));
+            }else if(nd.type == netlist::types_node::t_ram || nd.type == netlist::types_node::t_rom){
+                auto mem = dynamic_cast<const elem_memory*>(nd.elem);
+                std::vector<uint64_t> words(mem->get_words_count());
+                for(size_t a=0; a<words.size(); a++){
+                    words[a] = mem->read_word(a);
+                }
+                memories.emplace_back(std::move(words));
+            }
+        }
+        for(auto &words:memories){
+            memory_ptrs.emplace_back(words.data());
+        }
+        p_drive_fn(values.data(), states.data());
+        evaluate();
+    }
+    void p_release(){
+        if(handle){
+            dlclose(handle);
+        }
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        handle = nullptr;
+    }
+public:
+    //C++ source with extern "C" circuit_evaluate, circuit_drive and circuit_step
+    static std::string emit(const netlist &nl){
+        auto &nodes = nl.get_nodes();
+        auto order = cycle_sim(nl).get_order();
+        auto seq = p_indices(nl, true);
+        auto mem = p_indices(nl, false);
+        std::string src =
+            "//generated by native_sim, v holds words of storage nets, s states of\n"
+            "//sequential nodes and m contents of memories\n"
+            "#include <cstdint>\n\n"
+            "static inline uint64_t sel_mux(uint64_t sel, uint64_t count, const uint64_t* data){\n"
+            "    return (sel < count)? data[sel] : 0;\n"
+            "}\n"
+            "static inline uint64_t decode(uint64_t sel){\n"
+            "    return (sel < 64)? uint64_t(1) << sel : 0;\n"
+            "}\n"
+            "static inline uint64_t encode(uint64_t word){\n"
+            "    return word? 63-__builtin_clzll(word) : 0;\n"
+            "}\n"
+            "static inline uint64_t lut(uint64_t table, unsigned ins_count, const uint64_t* x){\n"
+            "    uint64_t rows[64];\n"
+            "    unsigned count = 1u << ins_count;\n"
+            "    for(unsigned r=0; r<count; r++){\n"
+            "        rows[r] = ((table >> r) & 1)? ~uint64_t(0) : 0;\n"
+            "    }\n"
+            "    for(unsigned i=0; i<ins_count; i++){\n"
+            "        count >>= 1;\n"
+            "        for(unsigned r=0; r<count; r++){\n"
+            "            rows[r] = (rows[2*r] & ~x[i]) | (rows[2*r+1] & x[i]);\n"
+            "        }\n"
+            "    }\n"
+            "    return rows[0];\n"
+            "}\n"
+            "static inline uint64_t ram(uint64_t* words, uint64_t addr, uint64_t data, uint64_t we){\n"
+            "    if(we){\n"
+            "        words[addr] = data;\n"
+            "    }\n"
+            "    return words[addr];\n"
+            "}\n\n"
+            "extern \"C\" void circuit_evaluate(uint64_t* v, uint64_t* const* m){\n"
+            "    (void)m;\n";
+        for(auto &n:order){
+            auto &nd = nodes[n];
+            auto list = p_list(nl, nd);
+            src += p_comment(nd.name)+(list.empty()? "" : "    {\n"+list);
+            for(size_t out=0; out<nd.outs.size(); out++){
+                src += p_write(nl, nd.outs[out], p_expression(nl, nd, out, mem[n]));
+            }
+            src += list.empty()? "" : "    }\n";
+        }
+        src += "}\n\n"
+            "extern \"C\" void circuit_drive(uint64_t* v, const uint64_t* s){\n"
+            "    (void)v;\n"
+            "    (void)s;\n";
+        for(size_t n=0; n<nodes.size(); n++){
+            if(seq[n] == netlist::npos){
+                continue;
+            }
+            auto &nd = nodes[n];
+            auto st = "s["+std::to_string(seq[n])+"]";
+            for(size_t out=0; out<nd.outs.size(); out++){
+                bool inverted = nd.type == netlist::types_node::t_dff && out == 1;
+                src += p_write(nl, nd.outs[out], inverted? "~"+st : st);
+            }
+        }
+        //every register samples before any of them updates
+        src += "}\n\n"
+            "extern \"C\" void circuit_step(uint64_t* v, uint64_t* s, uint64_t* const* m){\n";
+        std::string update;
+        for(size_t n=0; n<nodes.size(); n++){
+            if(seq[n] == netlist::npos){
+                continue;
+            }
+            auto &nd = nodes[n];
+            auto i = std::to_string(seq[n]);
+            src += "    uint64_t next_"+i+" = ("+p_next_state(nl, nd, "s["+i+"]")+") & "+
+                p_hex(p_mask(nl.get_nets()[nd.outs[0]].width))+";\n";
+            update += "    s["+i+"] = next_"+i+";\n";
+        }
+        src += update+
+            "    circuit_drive(v, s);\n"
+            "    circuit_evaluate(v, m);\n"
+            "}\n";
+        return src;
+    }
+
+    //compiler is run as "<compiler> <flags> -shared -fPIC", files are kept
+    //in a temporary directory until destruction
+    native_sim(const netlist &nl, const std::string &compiler = "c++", const std::string &flags = "-O2")
+        :nl(nl)
+    {
+        source = emit(nl);
+        //destructor won't run for a throwing constructor
+        try{
+            p_load(compiler, flags);
+            p_init();
+        }catch(...){
+            p_release();
+            throw;
+        }
+    }
+    native_sim(const native_sim&) = delete;
+    native_sim& operator=(const native_sim&) = delete;
+    ~native_sim(){
+        p_release();
+    }
+
+    //value of an input net, visible to logic on next evaluate or step
+    void set_input(const size_t &net, const uint64_t &value){
+        auto &nt = nl.get_nets().at(net);
+        auto mask = p_mask(nt.width);
+        auto &word = values[nt.storage];
+        word = (word & ~(mask << nt.offset)) | ((value & mask) << nt.offset);
+        inputs_changed = true;
+    }
+    void evaluate(){
+        p_evaluate_fn(values.data(), memory_ptrs.data());
+        inputs_changed = false;
+    }
+    //one clock cycle, same as cycle_sim::step
+    void step(){
+        if(inputs_changed){
+            evaluate();
+        }
+        p_step_fn(values.data(), states.data(), memory_ptrs.data());
+        cycle++;
+    }
+    void run(const uint64_t &cycles){
+        for(uint64_t i=0; i<cycles; i++){
+            step();
+        }
+    }
+
+    uint64_t get_value(const size_t &net)const{
+        auto &nt = nl.get_nets().at(net);
+        return (values[nt.storage] >> nt.offset) & p_mask(nt.width);
+    }
+    const uint64_t& get_cycle()const{
+        return cycle;
+    }
+    const std::string& get_source()const{
+        return source;
+    }
+};
@@ -0,0 +1,587 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include "sim.h"
+
+//flat view of a sim: basic elements become nodes, gate_outs become nets and
+//meta elements only add a prefix to names. Splitters and mergers become no
+//node at all, their nets are slices of one storage net instead. Compiled once
+//from a live sim, the tree itself is left untouched and keeps being used for editing
+class netlist{
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    enum class types_node{
+        t_in,       //undriven elem_in, value comes from outside
+        t_buf,      //elem_in fed from outside of its meta, elem_out
+        t_and,
+        t_or,
+        t_not,
+        t_xor,
+        t_nand,
+        t_nor,
+        t_xnor,
+        t_mux,      //data inputs first, select last
+        t_decoder,
+        t_encoder,  //outputs index of highest set bit and valid flag
+        t_clock,
+        t_ram,      //addr, data, we; contents are state of the engine, see elem_ram
+        t_rom,      //addr; contents are read through elem_rom
+        t_dff,      //d, clk; outputs q and inverted q
+        t_register, //d, en, clk
+        t_counter,  //en, clr, clk
+        t_lut       //bitwise lookup table, see elem_lut
+    };
+    static constexpr size_t types_count = 19;
+
+    struct net{
+        std::string name;
+        size_t width;
+        size_t driver = npos;           //node, npos for undriven net that stays zero
+        std::vector<size_t> readers;    //nodes
+        std::vector<size_t> gate_ids;   //every gate carrying this value, driver first
+        size_t storage = npos;          //net holding the bits, itself unless it is a slice
+        size_t offset = 0;              //first bit within storage
+    };
+
+    struct node{
+        types_node type;
+        std::string name;
+        element* elem;
+        std::vector<size_t> ins, outs;  //nets
+        //outputs are state and don't follow inputs within a tick
+        bool sequential = false;
+        uint64_t table = 0;             //of a t_lut, input 0 selects lowest bit
+    };
+private:
+    friend class lut_mapper;
+
+    std::vector<net> nets;
+    std::vector<node> nodes;
+    std::vector<size_t> inputs, outputs;    //nodes of elem_in and elem_out directly in root
+    std::vector<std::vector<size_t>> fanout;    //combinational node to node edges
+    std::vector<std::vector<size_t>> comb_loops;
+    std::unordered_map<size_t, size_t> net_by_gate;
+    std::vector<std::vector<size_t>> sharing;   //nets with overlapping bits of same storage
+
+    struct wire{
+        element* elem;
+        size_t in_net = npos, out_net = npos;   //the bus side
+        std::vector<size_t> slice_nets;
+    };
+
+    struct gates_of_node{
+        std::vector<std::shared_ptr<gate_in>> ins;
+        std::vector<std::shared_ptr<gate_out>> outs;
+        std::string prefix;
+        bool top;
+    };
+
+    static types_node p_elem_to_type(const element* el){
+        if(dynamic_cast<const elem_in*>(el)){
+            return types_node::t_in;
+        }else if(dynamic_cast<const elem_out*>(el)){
+            return types_node::t_buf;
+        }else if(dynamic_cast<const elem_and*>(el)){
+            return types_node::t_and;
+        }else if(dynamic_cast<const elem_or*>(el)){
+            return types_node::t_or;
+        }else if(dynamic_cast<const elem_not*>(el)){
+            return types_node::t_not;
+        }else if(dynamic_cast<const elem_xor*>(el)){
+            return types_node::t_xor;
+        }else if(dynamic_cast<const elem_nand*>(el)){
+            return types_node::t_nand;
+        }else if(dynamic_cast<const elem_nor*>(el)){
+            return types_node::t_nor;
+        }else if(dynamic_cast<const elem_xnor*>(el)){
+            return types_node::t_xnor;
+        }else if(dynamic_cast<const elem_mux*>(el)){
+            return types_node::t_mux;
+        }else if(dynamic_cast<const elem_decoder*>(el)){
+            return types_node::t_decoder;
+        }else if(dynamic_cast<const elem_priority_encoder*>(el)){
+            return types_node::t_encoder;
+        }else if(dynamic_cast<const elem_clock*>(el)){
+            return types_node::t_clock;
+        }else if(dynamic_cast<const elem_ram*>(el)){
+            return types_node::t_ram;
+        }else if(dynamic_cast<const elem_rom*>(el)){
+            return types_node::t_rom;
+        }else if(dynamic_cast<const elem_dff*>(el)){
+            return types_node::t_dff;
+        }else if(dynamic_cast<const elem_register*>(el)){
+            return types_node::t_register;
+        }else if(dynamic_cast<const elem_counter*>(el)){
+            return types_node::t_counter;
+        }else if(dynamic_cast<const elem_lut*>(el)){
+            return types_node::t_lut;
+        }
+        throw std::runtime_error("element "+el->get_name()+" has no netlist counterpart");
+        return types_node::t_buf; //unreachable
+    }
+
+    template<class It>
+    void p_collect(sim &s, const It &it, const std::string &prefix, bool top,
+        std::vector<gates_of_node> &gates, std::vector<std::pair<element*, std::string>> &wires)
+    {
+        for(auto child = s.children_begin(it); child != s.children_end(it); ++child){
+            auto &el = *child;
+            if(dynamic_cast<elem_meta*>(el.get())){
+                p_collect(s, child, prefix+el->get_name()+"/", false, gates, wires);
+                continue;
+            }
+            if(dynamic_cast<elem_splitter*>(el.get()) || dynamic_cast<elem_merger*>(el.get())){
+                wires.emplace_back(el.get(), prefix);
+                continue;
+            }
+            node nd;
+            nd.type = p_elem_to_type(el.get());
+            nd.name = prefix+el->get_name();
+            nd.elem = el.get();
+            nd.sequential = el->is_sequential();
+            if(auto lut = dynamic_cast<elem_lut*>(el.get())){
+                nd.table = lut->get_table();
+            }
+            gates_of_node g;
+            g.prefix = prefix;
+            g.top = top;
+            if(auto el_in = dynamic_cast<elem_in*>(el.get())){
+                g.ins.emplace_back(el_in->get_outer());
+                g.outs.emplace_back(el_in->get_out(0));
+            }else if(auto el_out = dynamic_cast<elem_out*>(el.get())){
+                g.ins.emplace_back(el_out->get_in(0));
+                g.outs.emplace_back(el_out->get_outer());
+            }else{
+                for(size_t i=0; i<el->get_ins_size(); i++){
+                    g.ins.emplace_back(el->get_in(i));
+                }
+                for(size_t i=0; i<el->get_outs_size(); i++){
+                    g.outs.emplace_back(el->get_out(i));
+                }
+            }
+            nodes.emplace_back(std::move(nd));
+            gates.emplace_back(std::move(g));
+        }
+    }
+
+    size_t p_out_net(const std::shared_ptr<gate_out> &gt, const std::string &prefix,
+        const size_t &driver, std::unordered_map<const gate*, size_t> &net_by_in)
+    {
+        net nt;
+        nt.name = prefix+gt->get_name();
+        nt.width = gt->get_width();
+        nt.driver = driver;
+        nt.gate_ids.emplace_back(gt->get_id());
+        for(auto &in:gt->get_tied()){
+            net_by_in[in.get()] = nets.size();
+            nt.gate_ids.emplace_back(in->get_id());
+        }
+        nets.emplace_back(std::move(nt));
+        return nets.size()-1;
+    }
+    size_t p_in_net(const std::shared_ptr<gate_in> &gt, const std::string &prefix,
+        const std::unordered_map<const gate*, size_t> &net_by_in)
+    {
+        auto it = net_by_in.find(gt.get());
+        if(it != net_by_in.end()){
+            return it->second;
+        }
+        net nt;
+        nt.name = prefix+gt->get_name();
+        nt.width = gt->get_width();
+        nt.gate_ids.emplace_back(gt->get_id());
+        nets.emplace_back(std::move(nt));
+        return nets.size()-1;
+    }
+
+    //makes every net of a splitter or merger a slice of the bus net. A net can
+    //be a slice of one bus only, a second merger gets a buffer node instead
+    void p_link_wires(const std::vector<wire> &wires){
+        std::vector<size_t> parent(nets.size(), npos);
+        for(auto &w:wires){
+            if(auto spl = dynamic_cast<elem_splitter*>(w.elem)){
+                for(size_t i=0; i<w.slice_nets.size(); i++){
+                    parent[w.slice_nets[i]] = w.in_net;
+                    nets[w.slice_nets[i]].offset = spl->get_offset(i);
+                }
+            }
+        }
+        for(auto &w:wires){
+            auto mrg = dynamic_cast<elem_merger*>(w.elem);
+            if(!mrg){
+                continue;
+            }
+            for(size_t i=0; i<w.slice_nets.size(); i++){
+                auto net_id = w.slice_nets[i];
+                if(net_id == w.out_net){
+                    throw std::runtime_error("merger "+nets[w.out_net].name+" is fed by its own output");
+                }
+                if(parent[net_id] != npos){
+                    node nd;
+                    nd.type = types_node::t_buf;
+                    nd.name = nets[w.out_net].name+"+in_"+std::to_string(i);
+                    nd.elem = w.elem;
+                    nd.ins.emplace_back(net_id);
+                    net nt;
+                    nt.name = nd.name;
+                    nt.width = nets[net_id].width;
+                    nt.driver = nodes.size();
+                    nd.outs.emplace_back(nets.size());
+                    net_id = nets.size();
+                    nets.emplace_back(std::move(nt));
+                    nodes.emplace_back(std::move(nd));
+                    parent.emplace_back(npos);
+                }
+                parent[net_id] = w.out_net;
+                nets[net_id].offset = mrg->get_offset(i);
+            }
+        }
+        //follow chains of slices down to the net that really holds the bits
+        for(size_t net_id=0; net_id<nets.size(); net_id++){
+            auto storage = net_id;
+            size_t offset = 0, steps = 0;
+            while(parent[storage] != npos){
+                if(++steps > nets.size()){
+                    throw std::runtime_error("splitters and mergers around net "+
+                        nets[net_id].name+" form a loop");
+                }
+                offset += nets[storage].offset;
+                storage = parent[storage];
+            }
+            nets[net_id].storage = storage;
+            nets[net_id].offset = offset;
+        }
+    }
+
+    void p_build(sim &s){
+        std::vector<gates_of_node> gates;
+        std::vector<std::pair<element*, std::string>> wire_elems;
+        p_collect(s, s.root(), "", true, gates, wire_elems);
+
+        //every output of a node is a net, ties tell which inputs read it
+        std::unordered_map<const gate*, size_t> net_by_in;
+        for(size_t n=0; n<nodes.size(); n++){
+            for(auto &gt:gates[n].outs){
+                nodes[n].outs.emplace_back(p_out_net(gt, gates[n].prefix, n, net_by_in));
+            }
+        }
+        std::vector<wire> wires;
+        for(auto &[el, prefix]:wire_elems){
+            wire w;
+            w.elem = el;
+            if(dynamic_cast<elem_splitter*>(el)){
+                for(size_t i=0; i<el->get_outs_size(); i++){
+                    w.slice_nets.emplace_back(p_out_net(el->get_out(i), prefix, npos, net_by_in));
+                }
+            }else{
+                w.out_net = p_out_net(el->get_out(0), prefix, npos, net_by_in);
+            }
+            wires.emplace_back(std::move(w));
+        }
+        for(size_t i=0; i<wires.size(); i++){
+            auto el = wires[i].elem;
+            if(dynamic_cast<elem_splitter*>(el)){
+                wires[i].in_net = p_in_net(el->get_in(0), wire_elems[i].second, net_by_in);
+            }else{
+                for(size_t j=0; j<el->get_ins_size(); j++){
+                    wires[i].slice_nets.emplace_back(p_in_net(el->get_in(j), wire_elems[i].second, net_by_in));
+                }
+            }
+        }
+        for(size_t n=0; n<nodes.size(); n++){
+            for(auto &gt:gates[n].ins){
+                nodes[n].ins.emplace_back(p_in_net(gt, gates[n].prefix, net_by_in));
+            }
+        }
+        auto count = nodes.size();
+        p_link_wires(wires);
+        //a net is driven if any net sharing its storage has a driver
+        std::vector<bool> driven(nets.size(), false);
+        for(auto &nt:nets){
+            if(nt.driver != npos){
+                driven[nt.storage] = true;
+            }
+        }
+        for(size_t n=0; n<count; n++){
+            if(nodes[n].type == types_node::t_in){
+                //elem_in fed by a driven net is just a buffer between metas
+                if(driven[nets[nodes[n].ins.at(0)].storage]){
+                    nodes[n].type = types_node::t_buf;
+                }else{
+                    nodes[n].ins.clear();
+                }
+                if(gates[n].top){
+                    inputs.emplace_back(n);
+                }
+            }else if(gates[n].top && dynamic_cast<elem_out*>(nodes[n].elem)){
+                outputs.emplace_back(n);
+            }
+        }
+        p_index();
+    }
+
+    //readers, gate lookup, sharing and fanout from nodes and nets
+    void p_index(){
+        for(auto &nt:nets){
+            nt.readers.clear();
+        }
+        for(size_t n=0; n<nodes.size(); n++){
+            for(auto &net_id:nodes[n].ins){
+                nets[net_id].readers.emplace_back(n);
+            }
+        }
+        net_by_gate.clear();
+        for(size_t net_id=0; net_id<nets.size(); net_id++){
+            for(auto &gt_id:nets[net_id].gate_ids){
+                net_by_gate[gt_id] = net_id;
+            }
+        }
+        std::vector<std::vector<size_t>> slices(nets.size());
+        for(size_t net_id=0; net_id<nets.size(); net_id++){
+            slices[nets[net_id].storage].emplace_back(net_id);
+        }
+        sharing.assign(nets.size(), {});
+        for(size_t net_id=0; net_id<nets.size(); net_id++){
+            auto &nt = nets[net_id];
+            for(auto &other:slices[nt.storage]){
+                auto &ot = nets[other];
+                if(ot.offset < nt.offset+nt.width && nt.offset < ot.offset+ot.width){
+                    sharing[net_id].emplace_back(other);
+                }
+            }
+        }
+        fanout.assign(nodes.size(), {});
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].sequential){
+                continue;
+            }
+            for(auto &net_id:nodes[n].outs){
+                for(auto &other:sharing[net_id]){
+                    auto &readers = nets[other].readers;
+                    fanout[n].insert(fanout[n].end(), readers.begin(), readers.end());
+                }
+            }
+        }
+    }
+
+    //Tarjan's strongly connected components, iterative to survive deep circuits
+    void p_find_comb_loops(){
+        comb_loops.clear();
+        auto count = nodes.size();
+        size_t counter = 0;
+        std::vector<size_t> index(count, npos), low(count, 0);
+        std::vector<bool> on_stack(count, false);
+        std::vector<size_t> stack;
+        std::vector<std::pair<size_t, size_t>> calls; //node, next fanout edge
+        auto visit = [&](size_t v){
+            index[v] = low[v] = counter++;
+            stack.emplace_back(v);
+            on_stack[v] = true;
+            calls.emplace_back(v, 0);
+        };
+        for(size_t start=0; start<count; start++){
+            if(index[start] != npos){
+                continue;
+            }
+            visit(start);
+            while(!calls.empty()){
+                auto v = calls.back().first;
+                auto e = calls.back().second;
+                if(e < fanout[v].size()){
+                    calls.back().second++;
+                    auto w = fanout[v][e];
+                    if(index[w] == npos){
+                        visit(w);
+                    }else if(on_stack[w]){
+                        low[v] = std::min(low[v], index[w]);
+                    }
+                    continue;
+                }
+                calls.pop_back();
+                if(!calls.empty()){
+                    auto u = calls.back().first;
+                    low[u] = std::min(low[u], low[v]);
+                }
+                if(low[v] != index[v]){
+                    continue;
+                }
+                std::vector<size_t> scc;
+                size_t w;
+                do{
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = false;
+                    scc.emplace_back(w);
+                }while(w != v);
+                bool self_loop = std::find(fanout[v].begin(), fanout[v].end(), v) != fanout[v].end();
+                if(scc.size() > 1 || self_loop){
+                    std::reverse(scc.begin(), scc.end());
+                    comb_loops.emplace_back(std::move(scc));
+                }
+            }
+        }
+    }
+public:
+    //word of output "out" of a combinational node, "in" gives word of input i.
+    //Bits past the width of output net are garbage and have to be masked.
+    //Memories need their contents and give zero here, engines evaluate them
+    //through elem_memory::read_word or a copy of elem_ram contents
+    template<class In>
+    static uint64_t eval(const types_node &type, const size_t &ins_count, const In &in,
+        const size_t &out = 0)
+    {
+        uint64_t result = 0;
+        switch(type){
+        case types_node::t_mux:{
+            auto sel = in(ins_count-1);
+            return (sel < ins_count-1)? in(sel) : 0;
+        }
+        case types_node::t_decoder:{
+            auto sel = in(0);
+            return (sel < 64)? uint64_t(1) << sel : 0;
+        }
+        case types_node::t_encoder:{
+            auto word = in(0);
+            if(out == 1){
+                return word != 0;
+            }
+            return word? 63-__builtin_clzll(word) : 0;
+        }
+        case types_node::t_in:
+        case types_node::t_clock:
+        case types_node::t_ram:
+        case types_node::t_rom:
+        case types_node::t_dff:
+        case types_node::t_register:
+        case types_node::t_counter:
+        case types_node::t_lut:
+            break;
+        case types_node::t_buf:
+            result = in(0);
+            break;
+        case types_node::t_and:
+        case types_node::t_nand:
+            result = ~uint64_t(0);
+            for(size_t i=0; i<ins_count; i++){
+                result &= in(i);
+            }
+            break;
+        case types_node::t_or:
+        case types_node::t_nor:
+            for(size_t i=0; i<ins_count; i++){
+                result |= in(i);
+            }
+            break;
+        case types_node::t_xor:
+        case types_node::t_xnor:
+            for(size_t i=0; i<ins_count; i++){
+                result ^= in(i);
+            }
+            break;
+        case types_node::t_not:
+            result = in(0);
+            break;
+        }
+        if(type == types_node::t_not || type == types_node::t_nand ||
+            type == types_node::t_nor || type == types_node::t_xnor)
+        {
+            result = ~result;
+        }
+        return result;
+    }
+
+    //same for a node, lookup tables included
+    template<class In>
+    static uint64_t eval(const node &nd, const In &in, const size_t &out = 0){
+        if(nd.type == types_node::t_lut){
+            return elem_lut::apply(nd.table, nd.ins.size(), in);
+        }
+        return eval(nd.type, nd.ins.size(), in, out);
+    }
+
+    //state a sequential node takes at a rising edge of its clock, which is
+    //its last input. Bits past the width of state are garbage
+    template<class In>
+    static uint64_t next_state(const types_node &type, const In &in, const uint64_t &state){
+        switch(type){
+        case types_node::t_dff:
+            return in(0);
+        case types_node::t_register:
+            return in(1)? in(0) : state;
+        case types_node::t_counter:
+            if(!in(0)){
+                return state;
+            }
+            return in(1)? 0 : state+1;
+        default:
+            return state;
+        }
+    }
+    //word of output "out" of a sequential node holding given state
+    static uint64_t state_out(const types_node &type, const uint64_t &state, const size_t &out){
+        if(type == types_node::t_dff && out == 1){
+            return ~state;
+        }
+        return state;
+    }
+
+    //word a memory node outputs, "in" gives word of input i. A ram writes data
+    //first while we is high; contents is the engine's copy of ram contents
+    template<class In>
+    static uint64_t eval_memory(const node &nd, const In &in, bits::bit_vector &contents){
+        auto mem = dynamic_cast<const elem_memory*>(nd.elem);
+        auto address = in(0);
+        if(nd.type == types_node::t_rom){
+            return mem->read_word(address);
+        }
+        auto data_width = mem->get_data_width();
+        if(in(2)){
+            bits::bit_vector value(data_width);
+            value.set_word(0, in(1));
+            contents.set_slice(address*data_width, value);
+        }
+        bits::bit_vector word;
+        contents.get_slice(address*data_width, data_width, word);
+        return word.word(0);
+    }
+
+    netlist(sim &s){
+        p_build(s);
+        p_find_comb_loops();
+    }
+
+    const std::vector<net>& get_nets()const          { return nets; }
+    const std::vector<node>& get_nodes()const        { return nodes; }
+    const std::vector<size_t>& get_inputs()const     { return inputs; }
+    const std::vector<size_t>& get_outputs()const    { return outputs; }
+    const std::vector<std::vector<size_t>>& get_fanout()const   { return fanout; }
+    //nets whose bits overlap those of given net, itself included
+    const std::vector<size_t>& get_sharing(const size_t &net)const{ return sharing.at(net); }
+    //groups of nodes that feed each other without passing any state element
+    const std::vector<std::vector<size_t>>& get_comb_loops()const{ return comb_loops; }
+
+    //net that carries value of given gate, npos if gate is not in netlist
+    size_t find_net(const size_t &gate_id)const{
+        auto it = net_by_gate.find(gate_id);
+        if(it == net_by_gate.end()){
+            return npos;
+        }
+        return it->second;
+    }
+
+    std::string describe(const std::vector<size_t> &group)const{
+        std::string result;
+        for(auto &n:group){
+            if(!result.empty()){
+                result += " -> ";
+            }
+            result += nodes.at(n).name;
+        }
+        return result;
+    }
+};
@@ -0,0 +1,287 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <algorithm>
+#include "aig.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PATTERN_SIM_X86
+#endif
+
+//many input patterns at once over an and-inverter graph: every variable holds
+//a lane of words, bit p of the lane is its value in pattern p. Evaluation is
+//one batch of and gates with inverted edges over the gathered lanes, which
+//covers and, or, xor and not of the netlist. The batch runs through the
+//widest kernel the cpu has, picked at runtime: avx-512, avx2, sse2 or scalar.
+//Lanes of 4 or 8 words give 256 or 512 patterns per gate at once. Latches
+//of the graph are state per pattern, step clocks every pattern on its own
+class pattern_sim{
+public:
+    enum class kernels{
+        k_scalar,
+        k_sse2,
+        k_avx2,
+        k_avx512
+    };
+private:
+    struct op{
+        uint32_t dst, a, b;     //variables
+        uint64_t invert_a, invert_b;    //all ones for an inverted edge
+    };
+    using kernel_fn = void (*)(const op*, const size_t&, uint64_t*, const size_t&);
+
+    const aig &g;
+    size_t words;
+    std::vector<op> ops;
+    std::vector<uint64_t> lanes;    //by variable, "words" each
+    std::vector<aig::literal> state_lits, next_lits;
+    std::vector<uint64_t> latched;
+    kernels kernel;
+    kernel_fn run;
+
+    static void p_scalar(const op* ops, const size_t &count, uint64_t* v, const size_t &words){
+        for(size_t i=0; i<count; i++){
+            auto &o = ops[i];
+            auto dst = v+o.dst*words;
+            auto a = v+o.a*words;
+            auto b = v+o.b*words;
+            for(size_t w=0; w<words; w++){
+                dst[w] = (a[w] ^ o.invert_a) & (b[w] ^ o.invert_b);
+            }
+        }
+    }
+#ifdef PATTERN_SIM_X86
+    __attribute__((target("sse2")))
+    static void p_sse2(const op* ops, const size_t &count, uint64_t* v, const size_t &words){
+        for(size_t i=0; i<count; i++){
+            auto &o = ops[i];
+            auto dst = v+o.dst*words;
+            auto a = v+o.a*words;
+            auto b = v+o.b*words;
+            auto ma = _mm_set1_epi64x(static_cast<long long>(o.invert_a));
+            auto mb = _mm_set1_epi64x(static_cast<long long>(o.invert_b));
+            size_t w = 0;
+            for(; w+2<=words; w+=2){
+                auto va = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+w)), ma);
+                auto vb = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b+w)), mb);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+w), _mm_and_si128(va, vb));
+            }
+            for(; w<words; w++){
+                dst[w] = (a[w] ^ o.invert_a) & (b[w] ^ o.invert_b);
+            }
+        }
+    }
+    __attribute__((target("avx2")))
+    static void p_avx2(const op* ops, const size_t &count, uint64_t* v, const size_t &words){
+        for(size_t i=0; i<count; i++){
+            auto &o = ops[i];
+            auto dst = v+o.dst*words;
+            auto a = v+o.a*words;
+            auto b = v+o.b*words;
+            auto ma = _mm256_set1_epi64x(static_cast<long long>(o.invert_a));
+            auto mb = _mm256_set1_epi64x(static_cast<long long>(o.invert_b));
+            size_t w = 0;
+            for(; w+4<=words; w+=4){
+                auto va = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a+w)), ma);
+                auto vb = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b+w)), mb);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+w), _mm256_and_si256(va, vb));
+            }
+            for(; w<words; w++){
+                dst[w] = (a[w] ^ o.invert_a) & (b[w] ^ o.invert_b);
+            }
+        }
+    }
+    __attribute__((target("avx512f")))
+    static void p_avx512(const op* ops, const size_t &count, uint64_t* v, const size_t &words){
+        for(size_t i=0; i<count; i++){
+            auto &o = ops[i];
+            auto dst = v+o.dst*words;
+            auto a = v+o.a*words;
+            auto b = v+o.b*words;
+            auto ma = _mm512_set1_epi64(static_cast<long long>(o.invert_a));
+            auto mb = _mm512_set1_epi64(static_cast<long long>(o.invert_b));
+            size_t w = 0;
+            for(; w+8<=words; w+=8){
+                auto va = _mm512_xor_si512(_mm512_loadu_si512(a+w), ma);
+                auto vb = _mm512_xor_si512(_mm512_loadu_si512(b+w), mb);
+                _mm512_storeu_si512(dst+w, _mm512_and_si512(va, vb));
+            }
+            for(; w<words; w++){
+                dst[w] = (a[w] ^ o.invert_a) & (b[w] ^ o.invert_b);
+            }
+        }
+    }
+#endif
+
+    static kernel_fn p_kernel(const kernels &k){
+        switch(k){
+#ifdef PATTERN_SIM_X86
+        case kernels::k_sse2:   return p_sse2;
+        case kernels::k_avx2:   return p_avx2;
+        case kernels::k_avx512: return p_avx512;
+#endif
+        default:                return p_scalar;
+        }
+    }
+
+    void p_check_pattern(const size_t &pattern)const{
+        if(pattern >= patterns()){
+            throw std::runtime_error("attempt to access pattern "+std::to_string(pattern)+
+                " of "+std::to_string(patterns()));
+        }
+    }
+    //variable and inversion of bit i of a net, which has to be kept
+    aig::literal p_literal(const size_t &net, const size_t &i)const{
+        if(!g.is_kept(net, i)){
+            throw std::runtime_error("attempt to access bit "+std::to_string(i)+" of net "+
+                std::to_string(net)+", which was removed as dead logic");
+        }
+        return g.get_literal(net, i);
+    }
+public:
+    static bool supported(const kernels &k){
+        switch(k){
+        case kernels::k_scalar:
+            return true;
+#ifdef PATTERN_SIM_X86
+        case kernels::k_sse2:
+            return __builtin_cpu_supports("sse2");
+        case kernels::k_avx2:
+            return __builtin_cpu_supports("avx2");
+        case kernels::k_avx512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+        }
+    }
+    static kernels best_kernel(){
+        for(auto k:{kernels::k_avx512, kernels::k_avx2, kernels::k_sse2}){
+            if(supported(k)){
+                return k;
+            }
+        }
+        return kernels::k_scalar;
+    }
+    static std::string kernel_name(const kernels &k){
+        switch(k){
+        case kernels::k_sse2:   return "sse2";
+        case kernels::k_avx2:   return "avx2";
+        case kernels::k_avx512: return "avx512";
+        default:                return "scalar";
+        }
+    }
+
+    //words per lane, patterns are 64 times that; every lane starts with the
+    //value the graph had last evaluated, in all patterns
+    pattern_sim(const aig &g, const size_t &words = 8)
+        :g(g),
+        words(words),
+        kernel(best_kernel()),
+        run(p_kernel(kernel))
+    {
+        if(words == 0){
+            throw std::runtime_error("attempt to simulate patterns with lanes of zero words");
+        }
+        auto &ands = g.get_ands();
+        lanes.assign(ands.size()*words, 0);
+        auto first = g.get_inputs_count()+1;
+        for(size_t v=1; v<first; v++){
+            auto value = g.value_of(aig::literal(v << 1))? ~uint64_t(0) : 0;
+            std::fill(lanes.begin()+v*words, lanes.begin()+(v+1)*words, value);
+        }
+        for(size_t v=first; v<ands.size(); v++){
+            auto &gate = ands[v];
+            ops.emplace_back(op{static_cast<uint32_t>(v), aig::var_of(gate.a), aig::var_of(gate.b),
+                (gate.a & 1)? ~uint64_t(0) : 0, (gate.b & 1)? ~uint64_t(0) : 0});
+        }
+        state_lits = g.get_state_literals();
+        next_lits = g.get_next_literals();
+        latched.resize(next_lits.size()*words);
+        evaluate();
+    }
+
+    size_t patterns()const{
+        return words*64;
+    }
+    kernels get_kernel()const{
+        return kernel;
+    }
+    void set_kernel(const kernels &k){
+        if(!supported(k)){
+            throw std::runtime_error("attempt to use "+kernel_name(k)+" kernel, cpu does not support it");
+        }
+        kernel = k;
+        run = p_kernel(k);
+    }
+
+    //bit i of an input net for every pattern, "words" words
+    void set_input_lane(const size_t &net, const size_t &i, const uint64_t* lane){
+        auto lit = p_literal(net, i);
+        auto v = aig::var_of(lit);
+        if(v == 0 || v > g.get_inputs_count()){
+            throw std::runtime_error("attempt to set bit "+std::to_string(i)+" of net "+
+                std::to_string(net)+", which is not an input");
+        }
+        auto invert = (lit & 1)? ~uint64_t(0) : 0;
+        for(size_t w=0; w<words; w++){
+            lanes[v*words+w] = lane[w] ^ invert;
+        }
+    }
+    //value of an input net in one pattern
+    void set_input(const size_t &net, const size_t &pattern, const uint64_t &value){
+        p_check_pattern(pattern);
+        auto width = g.get_netlist().get_nets().at(net).width;
+        std::vector<uint64_t> lane(words);
+        for(size_t i=0; i<width; i++){
+            get_lane(net, i, lane.data());
+            auto bit = uint64_t(1) << (pattern%64);
+            lane[pattern/64] = ((value >> i) & 1)? lane[pattern/64] | bit : lane[pattern/64] & ~bit;
+            set_input_lane(net, i, lane.data());
+        }
+    }
+
+    void evaluate(){
+        run(ops.data(), ops.size(), lanes.data(), words);
+    }
+
+    //one clock cycle in every pattern, like aig::step: every latch takes the
+    //lane of its next state at once
+    void step(){
+        evaluate();
+        for(size_t i=0; i<next_lits.size(); i++){
+            auto invert = (next_lits[i] & 1)? ~uint64_t(0) : 0;
+            auto src = lanes.data()+aig::var_of(next_lits[i])*words;
+            for(size_t w=0; w<words; w++){
+                latched[i*words+w] = src[w] ^ invert;
+            }
+        }
+        for(size_t i=0; i<state_lits.size(); i++){
+            std::copy(latched.begin()+i*words, latched.begin()+(i+1)*words,
+                lanes.begin()+aig::var_of(state_lits[i])*words);
+        }
+        evaluate();
+    }
+
+    void get_lane(const size_t &net, const size_t &i, uint64_t* lane)const{
+        auto lit = p_literal(net, i);
+        auto invert = (lit & 1)? ~uint64_t(0) : 0;
+        auto src = lanes.data()+aig::var_of(lit)*words;
+        for(size_t w=0; w<words; w++){
+            lane[w] = src[w] ^ invert;
+        }
+    }
+    uint64_t get_value(const size_t &net, const size_t &pattern)const{
+        p_check_pattern(pattern);
+        auto width = g.get_netlist().get_nets().at(net).width;
+        uint64_t result = 0;
+        for(size_t i=0; i<width; i++){
+            auto lit = p_literal(net, i);
+            auto word = lanes[aig::var_of(lit)*words+pattern/64] ^ ((lit & 1)? ~uint64_t(0) : 0);
+            result |= ((word >> (pattern%64)) & 1) << i;
+        }
+        return result;
+    }
+};
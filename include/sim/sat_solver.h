@@ -0,0 +1,364 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+//small CDCL solver: two watched literals, first-UIP clause learning,
+//decisions by activity with saved phases, restarts on the Luby sequence.
+//Literals are variable*2 with the lowest bit negating, as in aig
+class sat_solver{
+public:
+    using literal = uint32_t;
+    enum class results{
+        r_sat,
+        r_unsat,
+        r_unknown
+    };
+private:
+    static constexpr uint8_t v_false = 0;
+    static constexpr uint8_t v_true = 1;
+    static constexpr uint8_t v_undef = 2;
+    static constexpr size_t none = ~size_t(0);
+
+    std::vector<std::vector<literal>> clauses;  //watched literals first
+    std::vector<std::vector<size_t>> watches;   //by literal, clauses to visit once it holds
+    std::vector<uint8_t> assigns, phases, model, seen;     //by variable
+    std::vector<size_t> levels, reasons;
+    std::vector<double> activity;
+    std::vector<size_t> heap, heap_index;       //unassigned variables, most active first
+    std::vector<literal> trail;
+    std::vector<size_t> trail_lim;              //trail size at each decision
+    size_t qhead = 0;
+    double bump = 1.0;
+    bool unsat = false;
+    uint64_t conflicts = 0;
+
+    uint8_t p_value(const literal &lit)const{
+        auto a = assigns[lit >> 1];
+        return (a == v_undef)? v_undef : a ^ uint8_t(lit & 1);
+    }
+    size_t p_level()const{
+        return trail_lim.size();
+    }
+    void p_assign(const literal &lit, const size_t &reason){
+        auto var = lit >> 1;
+        assigns[var] = uint8_t((lit & 1) == 0);
+        levels[var] = p_level();
+        reasons[var] = reason;
+        trail.emplace_back(lit);
+    }
+
+    bool p_before(const size_t &a, const size_t &b)const{
+        return activity[a] > activity[b];
+    }
+    void p_heap_up(size_t i){
+        auto var = heap[i];
+        while(i > 0 && p_before(var, heap[(i-1)/2])){
+            heap[i] = heap[(i-1)/2];
+            heap_index[heap[i]] = i;
+            i = (i-1)/2;
+        }
+        heap[i] = var;
+        heap_index[var] = i;
+    }
+    void p_heap_down(size_t i){
+        auto var = heap[i];
+        while(2*i+1 < heap.size()){
+            auto child = 2*i+1;
+            if(child+1 < heap.size() && p_before(heap[child+1], heap[child])){
+                child++;
+            }
+            if(!p_before(heap[child], var)){
+                break;
+            }
+            heap[i] = heap[child];
+            heap_index[heap[i]] = i;
+            i = child;
+        }
+        heap[i] = var;
+        heap_index[var] = i;
+    }
+    void p_heap_insert(const size_t &var){
+        if(heap_index[var] != none){
+            return;
+        }
+        heap.emplace_back(var);
+        p_heap_up(heap.size()-1);
+    }
+    size_t p_heap_pop(){
+        auto var = heap[0];
+        heap_index[var] = none;
+        heap[0] = heap.back();
+        heap.pop_back();
+        if(!heap.empty()){
+            p_heap_down(0);
+        }
+        return var;
+    }
+    void p_bump(const size_t &var){
+        activity[var] += bump;
+        if(activity[var] > 1e100){
+            for(auto &a:activity){
+                a *= 1e-100;
+            }
+            bump *= 1e-100;
+        }
+        if(heap_index[var] != none){
+            p_heap_up(heap_index[var]);
+        }
+    }
+
+    void p_cancel_until(const size_t &level){
+        if(p_level() <= level){
+            return;
+        }
+        for(auto i=trail.size(); i-- > trail_lim[level];){
+            auto var = trail[i] >> 1;
+            phases[var] = assigns[var];
+            assigns[var] = v_undef;
+            p_heap_insert(var);
+        }
+        trail.resize(trail_lim[level]);
+        trail_lim.resize(level);
+        qhead = trail.size();
+    }
+
+    void p_watch(const size_t &c){
+        watches[clauses[c][0]^1].emplace_back(c);
+        watches[clauses[c][1]^1].emplace_back(c);
+    }
+
+    //clause that became false, none if every implication went through
+    size_t p_propagate(){
+        while(qhead < trail.size()){
+            auto p = trail[qhead++];
+            auto false_lit = p^1;
+            auto &ws = watches[p];
+            size_t i = 0, j = 0;
+            while(i < ws.size()){
+                auto c = ws[i++];
+                auto &cl = clauses[c];
+                if(cl[0] == false_lit){
+                    std::swap(cl[0], cl[1]);
+                }
+                if(p_value(cl[0]) == v_true){
+                    ws[j++] = c;
+                    continue;
+                }
+                bool moved = false;
+                for(size_t k=2; k<cl.size(); k++){
+                    if(p_value(cl[k]) != v_false){
+                        std::swap(cl[1], cl[k]);
+                        watches[cl[1]^1].emplace_back(c);
+                        moved = true;
+                        break;
+                    }
+                }
+                if(moved){
+                    continue;
+                }
+                ws[j++] = c;
+                if(p_value(cl[0]) == v_false){
+                    while(i < ws.size()){
+                        ws[j++] = ws[i++];
+                    }
+                    ws.resize(j);
+                    qhead = trail.size();
+                    return c;
+                }
+                p_assign(cl[0], c);
+            }
+            ws.resize(j);
+        }
+        return none;
+    }
+
+    //learnt clause with the asserting literal first, and level to return to
+    std::vector<literal> p_analyze(size_t conflict, size_t &back_level){
+        std::vector<literal> learnt(1);
+        size_t path = 0;
+        literal p = 0;
+        bool first = true;
+        auto index = trail.size();
+        do{
+            auto &cl = clauses[conflict];
+            for(size_t k=first? 0 : 1; k<cl.size(); k++){
+                auto var = cl[k] >> 1;
+                if(seen[var] || levels[var] == 0){
+                    continue;
+                }
+                seen[var] = 1;
+                p_bump(var);
+                if(levels[var] >= p_level()){
+                    path++;
+                }else{
+                    learnt.emplace_back(cl[k]);
+                }
+            }
+            while(!seen[trail[--index] >> 1]);
+            p = trail[index];
+            conflict = reasons[p >> 1];
+            seen[p >> 1] = 0;
+            path--;
+            first = false;
+        }while(path > 0);
+        learnt[0] = p^1;
+        back_level = 0;
+        for(size_t k=1; k<learnt.size(); k++){
+            seen[learnt[k] >> 1] = 0;
+            if(levels[learnt[k] >> 1] > back_level){
+                back_level = levels[learnt[k] >> 1];
+                std::swap(learnt[1], learnt[k]);
+            }
+        }
+        return learnt;
+    }
+
+    static uint64_t p_luby(uint64_t i){
+        //i-th element, from 0, of 1 1 2 1 1 2 4 ...
+        uint64_t size = 1, seq = 0;
+        while(size < i+1){
+            seq++;
+            size = 2*size+1;
+        }
+        while(size-1 != i){
+            size = (size-1)/2;
+            seq--;
+            i %= size;
+        }
+        return uint64_t(1) << seq;
+    }
+public:
+    size_t new_var(){
+        auto var = assigns.size();
+        assigns.emplace_back(v_undef);
+        phases.emplace_back(v_false);
+        seen.emplace_back(0);
+        levels.emplace_back(0);
+        reasons.emplace_back(none);
+        activity.emplace_back(0.0);
+        heap_index.emplace_back(none);
+        watches.resize(2*assigns.size());
+        p_heap_insert(var);
+        return var;
+    }
+    size_t vars_count()const{
+        return assigns.size();
+    }
+
+    //false once clauses alone can't be satisfied
+    bool add_clause(std::vector<literal> lits){
+        if(unsat){
+            return false;
+        }
+        p_cancel_until(0);
+        std::sort(lits.begin(), lits.end());
+        std::vector<literal> kept;
+        for(size_t i=0; i<lits.size(); i++){
+            auto value = p_value(lits[i]);
+            if(value == v_true || (i+1 < lits.size() && lits[i+1] == (lits[i]^1))){
+                return true;
+            }
+            if(value == v_undef && (kept.empty() || kept.back() != lits[i])){
+                kept.emplace_back(lits[i]);
+            }
+        }
+        if(kept.empty()){
+            unsat = true;
+            return false;
+        }
+        if(kept.size() == 1){
+            p_assign(kept[0], none);
+            if(p_propagate() != none){
+                unsat = true;
+            }
+            return !unsat;
+        }
+        clauses.emplace_back(std::move(kept));
+        p_watch(clauses.size()-1);
+        return true;
+    }
+
+    //whether clauses hold with assumptions true; r_unknown once conflicts
+    //reach the limit, 0 for no limit
+    results solve(const std::vector<literal> &assumptions = {}, const uint64_t &conflict_limit = 0){
+        if(unsat){
+            return results::r_unsat;
+        }
+        p_cancel_until(0);
+        if(p_propagate() != none){
+            unsat = true;
+            return results::r_unsat;
+        }
+        uint64_t spent = 0, restart = 0, until_restart = 100*p_luby(0);
+        while(true){
+            auto conflict = p_propagate();
+            if(conflict != none){
+                conflicts++;
+                spent++;
+                if(p_level() == 0){
+                    unsat = true;
+                    return results::r_unsat;
+                }
+                size_t back_level;
+                auto learnt = p_analyze(conflict, back_level);
+                p_cancel_until(back_level);
+                if(learnt.size() == 1){
+                    p_assign(learnt[0], none);
+                }else{
+                    clauses.emplace_back(std::move(learnt));
+                    p_watch(clauses.size()-1);
+                    p_assign(clauses.back()[0], clauses.size()-1);
+                }
+                bump /= 0.95;
+                continue;
+            }
+            if(conflict_limit && spent >= conflict_limit){
+                p_cancel_until(0);
+                return results::r_unknown;
+            }
+            if(spent >= until_restart){
+                p_cancel_until(0);
+                until_restart = spent+100*p_luby(++restart);
+            }
+            literal next = 0;
+            bool decided = false;
+            while(p_level() < assumptions.size()){
+                auto a = assumptions[p_level()];
+                auto value = p_value(a);
+                if(value == v_false){
+                    p_cancel_until(0);
+                    return results::r_unsat;
+                }
+                trail_lim.emplace_back(trail.size());
+                if(value == v_undef){
+                    next = a;
+                    decided = true;
+                    break;
+                }
+            }
+            if(!decided){
+                while(!heap.empty() && assigns[heap[0]] != v_undef){
+                    p_heap_pop();
+                }
+                if(heap.empty()){
+                    model = assigns;
+                    p_cancel_until(0);
+                    return results::r_sat;
+                }
+                auto var = p_heap_pop();
+                next = literal(var << 1) | literal(phases[var] != v_true);
+                trail_lim.emplace_back(trail.size());
+            }
+            p_assign(next, none);
+        }
+    }
+
+    //value of a variable in the last satisfying assignment
+    bool model_value(const size_t &var)const{
+        return model.at(var) == v_true;
+    }
+    uint64_t get_conflicts()const{
+        return conflicts;
+    }
+};
@@ -2,19 +2,566 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "meta_element.h"
 #include "element.h"
 #include "basic_elements.h"
 #include "file_ops.h"
+#include "truth_table.h"
 #include "k_tree.h"
 
+class sim;
+
+//evaluates a sim in place of processing its elements one by one, see
+//sim::set_engine. Sim advances sources before every tick of the engine
+class sim_engine{
+public:
+    virtual ~sim_engine(){}
+    //settles the circuit and takes clock edges, returns true if it is stable
+    virtual bool tick(sim &s) = 0;
+    //tree was edited, anything compiled from it is stale
+    virtual void invalidate() = 0;
+};
+
 class sim{
 public:
     using k_tree_ = tree_ns::k_tree<std::unique_ptr<element>>;
     using k_tree_it = k_tree_::depth_first_node_first_iterator;
 
+    struct settle_result{
+        bool stable = true;
+        size_t passes = 0;
+        //"name(id)" of every gate_out that still changed in the last allowed pass
+        std::vector<std::string> oscillating;
+        //elements processed, those in skipped meta subtrees are not counted
+        size_t processed = 0;
+    };
 private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    //tree flattened in evaluation order, a meta knows where its subtree ends
+    //and is skipped as a whole while its scope is clean
+    struct scheduled{
+        element* el;
+        dirty_scope* scope;     //of this element if it is a meta
+        size_t end;             //one past last element of subtree
+        size_t meta;            //entry of enclosing meta, npos for none
+        size_t block;           //tabulated block of a meta, npos for none
+        bool pruned;            //nothing observed depends on it, not evaluated
+    };
+    //combinational meta evaluated by a table lookup
+    struct block{
+        std::shared_ptr<truth_table> table;
+        std::vector<size_t> ins;    //entries of its elem_in children
+    };
+
     k_tree_ elems;
+    //evaluation passes a tick may take to reach a stable state
+    size_t settle_limit = 100;
+    settle_result last_settle;
+    //set when last tick changed no gate, next ticks are skipped until
+    //an input changes, a source schedules work or the tree is edited
+    bool quiescent = false;
+    std::vector<element*> sources;
+    std::vector<element*> sequential;
+    std::vector<dirty_scope*> source_scopes, sequential_scopes;
+    std::vector<size_t> updating;
+    std::vector<scheduled> schedule;
+    std::vector<std::pair<size_t, size_t>> open_scopes;     //entry, changes when entered
+    bool sources_valid = false;
+    bool tabulating = false;
+    truth_tables tables;
+    std::vector<block> blocks;
+    bits::bit_vector table_bits;
+    bool pruning = false;
+    bool scoping = true;
+    std::unordered_set<size_t> watched;     //gate ids
+    std::unique_ptr<sim_engine> engine;
+
+    inline dirty_scope* scope_of(const size_t &entry)const{
+        auto meta = schedule[entry].meta;
+        return (meta == npos)? nullptr : schedule[meta].scope;
+    }
+
+    inline void schedule_subtree(const k_tree_::iterator_base &it, const size_t &meta){
+        auto el = it->get();
+        auto at = schedule.size();
+        schedule.emplace_back(scheduled{el, nullptr, 0, meta, npos, false});
+        auto inner = meta;
+        if(auto el_meta = dynamic_cast<elem_meta*>(el)){
+            auto &scope = el_meta->get_scope();
+            scope.set_outer((meta == npos)? nullptr : schedule[meta].scope);
+            scope.set_sealed(true);
+            scope.mark();
+            schedule[at].scope = &scope;
+            inner = at;
+        }
+        for(auto c_it=elems.children_begin(it); c_it!=elems.children_end(it); ++c_it){
+            schedule_subtree(c_it, inner);
+        }
+        schedule[at].end = schedule.size();
+    }
+
+    //calls f(driver entry, output place, gate_in) for every tie. Gates on meta
+    //boundaries belong to the elem_in or elem_out they lead to
+    template<class F>
+    inline void for_each_tie(const F &f)const{
+        for(size_t i=0; i<schedule.size(); i++){
+            auto el = schedule[i].el;
+            if(schedule[i].scope){
+                continue;
+            }
+            for(size_t k=0; k<el->get_outs_size(); k++){
+                for(auto &in:el->get_out(k)->get_tied()){
+                    f(i, k, in.get());
+                }
+            }
+            if(auto el_out = dynamic_cast<elem_out*>(el)){
+                for(auto &in:el_out->get_outer()->get_tied()){
+                    f(i, 0, in.get());
+                }
+            }
+        }
+    }
+    inline std::unordered_map<const gate*, size_t> map_readers()const{
+        std::unordered_map<const gate*, size_t> readers;
+        for(size_t i=0; i<schedule.size(); i++){
+            auto el = schedule[i].el;
+            if(schedule[i].scope){
+                continue;
+            }
+            for(size_t k=0; k<el->get_ins_size(); k++){
+                readers[el->get_in(k).get()] = i;
+            }
+            if(auto el_in = dynamic_cast<elem_in*>(el)){
+                readers[el_in->get_outer().get()] = i;
+            }
+        }
+        return readers;
+    }
+
+    //a scope with an input tied straight from outside, bypassing elem_in,
+    //can't notice it change and stays dirty
+    inline void seal_scopes(const std::unordered_map<const gate*, size_t> &readers){
+        for_each_tie([this, &readers](const size_t &driver, const size_t&, const gate* in){
+            auto found = readers.find(in);
+            if(found == readers.end() || dynamic_cast<elem_in*>(schedule[found->second].el)){
+                return;
+            }
+            for(auto m=schedule[found->second].meta;
+                m != npos && !(m <= driver && driver < schedule[m].end);
+                m=schedule[m].meta)
+            {
+                schedule[m].scope->set_sealed(false);
+            }
+        });
+    }
+
+    //true if subtree of a meta has no state, no memory, no loop and only
+    //elem_in sources. Rom contents can change without the table seeing it
+    inline bool is_combinational(const size_t &entry,
+        const std::unordered_map<const gate*, size_t> &readers)const
+    {
+        auto end = schedule[entry].end;
+        for(size_t i=entry+1; i<end; i++){
+            auto el = schedule[i].el;
+            if(el->is_sequential() || dynamic_cast<const elem_memory*>(el) ||
+                (el->may_schedule_work() && !dynamic_cast<const elem_in*>(el)))
+            {
+                return false;
+            }
+        }
+        //Kahn's algorithm over ties within subtree
+        std::vector<std::vector<size_t>> fanout(end-entry);
+        std::vector<size_t> pending(end-entry, 0);
+        for_each_tie([&](const size_t &driver, const size_t&, const gate* in){
+            auto found = readers.find(in);
+            if(driver <= entry || driver >= end || found == readers.end() ||
+                found->second <= entry || found->second >= end)
+            {
+                return;
+            }
+            fanout[driver-entry].emplace_back(found->second-entry);
+            pending[found->second-entry]++;
+        });
+        std::vector<size_t> ready;
+        for(size_t i=1; i<pending.size(); i++){
+            if(pending[i] == 0){
+                ready.emplace_back(i);
+            }
+        }
+        size_t done = 0;
+        while(!ready.empty()){
+            auto i = ready.back();
+            ready.pop_back();
+            done++;
+            for(auto &r:fanout[i]){
+                if(--pending[r] == 0){
+                    ready.emplace_back(r);
+                }
+            }
+        }
+        return done == end-entry-1;
+    }
+
+    //shape of every element of subtree and ties between them, blocks with
+    //equal signatures compute the same function and share a truth table
+    inline std::string signature(const size_t &entry,
+        const std::unordered_map<const gate*, std::pair<size_t, size_t>> &drivers,
+        const std::unordered_map<const gate*, size_t> &readers)const
+    {
+        auto end = schedule[entry].end;
+        auto local = [&entry, &end](const size_t &i){
+            return (i > entry && i < end)? std::to_string(i-entry) : std::string("-");
+        };
+        auto driver_of = [&](const gate* in){
+            auto found = drivers.find(in);
+            if(found == drivers.end() || found->second.first <= entry || found->second.first >= end){
+                return std::string("-");
+            }
+            return local(found->second.first)+"."+std::to_string(found->second.second);
+        };
+        std::string result;
+        for(size_t i=entry; i<end; i++){
+            auto el = schedule[i].el;
+            result += elem_file_saver::shape_of(el)+"(";
+            if(schedule[i].scope){
+                //order of boundary gates
+                for(size_t k=0; k<el->get_ins_size(); k++){
+                    auto found = readers.find(el->get_in(k).get());
+                    result += ((found == readers.end())? "-" : local(found->second))+",";
+                }
+                result += "/";
+                for(size_t k=0; k<el->get_outs_size(); k++){
+                    for(size_t j=i+1; j<schedule[i].end; j++){
+                        auto el_out = dynamic_cast<elem_out*>(schedule[j].el);
+                        if(el_out && el_out->get_outer() == el->get_out(k)){
+                            result += local(j);
+                        }
+                    }
+                    result += ",";
+                }
+            }else if(auto el_in = dynamic_cast<elem_in*>(el)){
+                result += driver_of(el_in->get_outer().get());
+            }else{
+                for(size_t k=0; k<el->get_ins_size(); k++){
+                    result += driver_of(el->get_in(k).get())+",";
+                }
+            }
+            result += ")";
+        }
+        return result;
+    }
+
+    //gives truth tables to outermost combinational metas with few input bits
+    inline void tabulate_blocks(const std::unordered_map<const gate*, size_t> &readers){
+        blocks.clear();
+        if(tabulating){
+            std::unordered_map<const gate*, std::pair<size_t, size_t>> drivers;
+            for_each_tie([&drivers](const size_t &driver, const size_t &place, const gate* in){
+                drivers[in] = {driver, place};
+            });
+            for(size_t i=0; i<schedule.size(); i++){
+                auto el = schedule[i].el;
+                //root is left alone, elements in it are watched from outside
+                if(!schedule[i].scope || schedule[i].meta == npos || !schedule[i].scope->is_sealed() ||
+                    el->get_outs_size() == 0)
+                {
+                    continue;
+                }
+                size_t ins_width = 0, outs_width = 0;
+                for(size_t k=0; k<el->get_ins_size(); k++){
+                    ins_width += el->get_in(k)->get_width();
+                }
+                for(size_t k=0; k<el->get_outs_size(); k++){
+                    outs_width += el->get_out(k)->get_width();
+                }
+                if(ins_width > truth_table::max_ins_width || !is_combinational(i, readers)){
+                    continue;
+                }
+                block blk;
+                blk.table = tables.get(signature(i, drivers, readers), ins_width, outs_width);
+                for(size_t j=i+1; j<schedule[i].end; j++){
+                    if(schedule[j].meta == i && dynamic_cast<elem_in*>(schedule[j].el)){
+                        blk.ins.emplace_back(j);
+                    }
+                }
+                schedule[i].block = blocks.size();
+                blocks.emplace_back(std::move(blk));
+                i = schedule[i].end-1;
+            }
+        }
+        tables.prune();
+    }
+
+    //leaves out of evaluation every element that no elem_out of root and no
+    //watched gate depends on, a meta goes once nothing in its subtree is left
+    inline void prune_dead(const std::unordered_map<const gate*, size_t> &readers){
+        if(!pruning){
+            return;
+        }
+        std::vector<std::vector<size_t>> drivers(schedule.size());
+        for_each_tie([&drivers, &readers](const size_t &driver, const size_t&, const gate* in){
+            auto found = readers.find(in);
+            if(found != readers.end()){
+                drivers[found->second].emplace_back(driver);
+            }
+        });
+        auto is_watched = [this](const gate* gt){
+            return watched.count(gt->get_id()) != 0;
+        };
+        std::vector<bool> live(schedule.size(), false);
+        std::vector<size_t> stack;
+        for(size_t i=0; i<schedule.size(); i++){
+            auto el = schedule[i].el;
+            if(schedule[i].scope){
+                continue;
+            }
+            auto el_out = dynamic_cast<elem_out*>(el);
+            bool observed = el_out && schedule[i].meta == 0;
+            for(size_t k=0; k<el->get_ins_size() && !observed; k++){
+                observed = is_watched(el->get_in(k).get());
+            }
+            for(size_t k=0; k<el->get_outs_size() && !observed; k++){
+                observed = is_watched(el->get_out(k).get());
+            }
+            if(el_out){
+                observed = observed || is_watched(el_out->get_outer().get());
+            }else if(auto el_in = dynamic_cast<elem_in*>(el)){
+                observed = observed || is_watched(el_in->get_outer().get());
+            }
+            if(observed){
+                live[i] = true;
+                stack.emplace_back(i);
+            }
+        }
+        while(!stack.empty()){
+            auto i = stack.back();
+            stack.pop_back();
+            for(auto &d:drivers[i]){
+                if(!live[d]){
+                    live[d] = true;
+                    stack.emplace_back(d);
+                }
+            }
+        }
+        //children come after their meta
+        live[0] = true;
+        for(size_t i=schedule.size(); i-- > 1;){
+            if(live[i]){
+                live[schedule[i].meta] = true;
+            }
+        }
+        for(size_t i=0; i<schedule.size(); i++){
+            schedule[i].pruned = !live[i];
+        }
+    }
+
+    inline void collect_sources(){
+        if(!sources_valid){
+            schedule.clear();
+            schedule_subtree(elems.root(), npos);
+            auto readers = map_readers();
+            seal_scopes(readers);
+            tabulate_blocks(readers);
+            prune_dead(readers);
+            sources.clear();
+            sequential.clear();
+            source_scopes.clear();
+            sequential_scopes.clear();
+            for(size_t i=0; i<schedule.size(); i++){
+                auto el = schedule[i].el;
+                //a pruned input is never processed and would keep
+                //work pending forever
+                if(el->may_schedule_work() && !schedule[i].pruned){
+                    sources.emplace_back(el);
+                    source_scopes.emplace_back(scope_of(i));
+                }
+                if(el->is_sequential() && !schedule[i].pruned){
+                    sequential.emplace_back(el);
+                    sequential_scopes.emplace_back(scope_of(i));
+                }
+                if(auto el_in = dynamic_cast<elem_in*>(el)){
+                    el_in->get_outer()->set_scope(scope_of(i));
+                }
+            }
+            sources_valid = true;
+        }
+    }
+    inline const std::vector<element*>& get_sources(){
+        collect_sources();
+        return sources;
+    }
+    inline const std::vector<element*>& get_sequential(){
+        collect_sources();
+        return sequential;
+    }
+
+    inline bool has_pending_work(){
+        auto &sources = get_sources();
+        return std::any_of(sources.begin(), sources.end(),
+            [](const element* el){
+                return el->has_pending_work();
+            });
+    }
+
+    inline auto snapshot_outs(){
+        std::vector<std::pair<std::shared_ptr<gate_out>, bits::bit_vector>> result;
+        for(auto &el:elems){
+            for(size_t i=0; i<el->get_outs_size(); i++){
+                auto gt = el->get_out(i);
+                result.emplace_back(gt, gt->get_values());
+            }
+        }
+        return result;
+    }
+
+    inline void close_scope(){
+        auto &[entry, changes_then] = open_scopes.back();
+        if(gate::changes_counter() != changes_then){
+            schedule[entry].scope->mark();
+        }
+        open_scopes.pop_back();
+    }
+
+    //inputs are carried inside by elem_in children only, outputs come from the
+    //table or, for a combination not seen yet, from settling the subtree
+    inline void evaluate_block(const size_t &entry){
+        auto &item = schedule[entry];
+        auto el = item.el;
+        auto &table = *blocks[item.block].table;
+        size_t row = 0, shift = 0;
+        for(size_t k=0; k<el->get_ins_size(); k++){
+            const gate &in = *el->get_in(k);
+            row |= static_cast<size_t>(in.get_values().word(0)) << shift;
+            shift += in.get_width();
+        }
+        if(table.has(row)){
+            for(auto &j:blocks[item.block].ins){
+                schedule[j].el->reset_processed();
+                schedule[j].el->process();
+            }
+            last_settle.processed += blocks[item.block].ins.size()+1;
+            size_t offset = 0;
+            for(size_t k=0; k<el->get_outs_size(); k++){
+                auto out = el->get_out(k);
+                table.get(row, offset, out->get_width(), table_bits);
+                out->pass_value(table_bits);
+                offset += out->get_width();
+            }
+            return;
+        }
+        auto &changes = gate::changes_counter();
+        bool stable = false;
+        for(size_t pass=0; pass<settle_limit && !stable; pass++){
+            auto changes_before = changes;
+            for(size_t j=entry+1; j<item.end; j++){
+                schedule[j].el->reset_processed();
+                schedule[j].el->process();
+            }
+            last_settle.processed += item.end-entry;
+            stable = changes == changes_before;
+        }
+        if(!stable){
+            item.scope->mark();
+            return;
+        }
+        size_t offset = 0;
+        for(size_t k=0; k<el->get_outs_size(); k++){
+            const gate &out = *el->get_out(k);
+            table.set(row, offset, out.get_values());
+            offset += out.get_width();
+        }
+        table.set_known(row);
+    }
+
+    //one pass over all elements, returns true if any gate changed. Subtree
+    //of a clean meta is skipped while scoping is on, a meta that changed
+    //nothing is left clean
+    inline bool evaluate(){
+        collect_sources();
+        auto &changes = gate::changes_counter();
+        auto changes_before = changes;
+        for(size_t i=0; i<schedule.size();){
+            while(!open_scopes.empty() && schedule[open_scopes.back().first].end == i){
+                close_scope();
+            }
+            auto &item = schedule[i];
+            if(item.pruned){
+                i = item.scope? item.end : i+1;
+                continue;
+            }
+            if(item.scope){
+                if(scoping && !item.scope->is_dirty()){
+                    i = item.end;
+                    continue;
+                }
+                item.scope->clear();
+                if(item.block != npos){
+                    evaluate_block(i);
+                    i = item.end;
+                    continue;
+                }
+                open_scopes.emplace_back(i, changes);
+            }
+            item.el->reset_processed();
+            item.el->process();
+            last_settle.processed++;
+            i++;
+        }
+        while(!open_scopes.empty()){
+            close_scope();
+        }
+        return changes != changes_before;
+    }
+
+    //evaluates until no gate changes or settle limit is hit, returns true if stable
+    inline bool settle(){
+        size_t passes = 0;
+        bool changed = true;
+        while(changed && passes+1 < settle_limit){
+            changed = evaluate();
+            passes++;
+        }
+        if(changed && settle_limit == 1){
+            changed = evaluate();
+            passes++;
+        }else if(changed){
+            //last allowed pass, whatever changes in it oscillates
+            auto before = snapshot_outs();
+            changed = evaluate();
+            passes++;
+            for(auto &[gt, val]:before){
+                if(gt->get_values() != val){
+                    last_settle.oscillating.emplace_back(gt->get_name()+
+                        "("+std::to_string(gt->get_id())+")");
+                }
+            }
+        }
+        last_settle.passes += passes;
+        return !changed;
+    }
+
+    //samples all sequential elements before updating any, so each of them
+    //sees state from before the edge. Disabled ones are not updated at all
+    inline bool clock_edge(){
+        updating.clear();
+        auto &seq = get_sequential();
+        for(size_t i=0; i<seq.size(); i++){
+            if(seq[i]->sample()){
+                updating.emplace_back(i);
+            }
+        }
+        for(auto &i:updating){
+            seq[i]->update();
+            if(sequential_scopes[i]){
+                sequential_scopes[i]->mark();
+            }
+        }
+        return !updating.empty();
+    }
 public:
     sim(k_tree_::value_type&& root){
         elems.set_root(std::move(root));
@@ -40,13 +587,159 @@ public:
         return elems.depth_first_node_first_end();
     }
 
-    inline void tick(){
-        for(auto &el:elems){
-            el->reset_processed();
+    template<class It>
+    inline auto children_begin(const It &it){
+        return elems.children_begin(it);
+    }
+
+    template<class It>
+    inline auto children_end(const It &it){
+        return elems.children_end(it);
+    }
+
+    //advances sources once, then evaluates until no gate changes or
+    //settle limit is hit. Sequential elements then take clock edges and
+    //circuit settles again, until no edge is left; each round counts
+    //against settle limit as well. Returns false if circuit was quiescent
+    //and nothing was evaluated, see get_last_settle for oscillations
+    inline bool tick(){
+        if(quiescent && !has_pending_work()){
+            return false;
         }
-        for(auto &el:elems){
-            el->process();
+        auto &srcs = get_sources();
+        for(size_t i=0; i<srcs.size(); i++){
+            srcs[i]->advance();
+            if(source_scopes[i] && srcs[i]->has_pending_work()){
+                source_scopes[i]->mark();
+            }
+        }
+        last_settle = settle_result();
+        if(engine){
+            last_settle.passes = 1;
+            last_settle.stable = engine->tick(*this);
+            quiescent = last_settle.stable;
+            return true;
+        }
+        bool stable = settle();
+        for(size_t rounds=1; clock_edge(); rounds++){
+            if(rounds >= settle_limit){
+                //e.g. a flip-flop clocked by its own inverted output
+                if(settle_limit > 1){
+                    for(auto &i:updating){
+                        auto el = sequential[i];
+                        last_settle.oscillating.emplace_back(el->get_name()+
+                            "("+std::to_string(el->get_id())+")");
+                    }
+                }
+                stable = false;
+                break;
+            }
+            stable = settle();
+        }
+        last_settle.stable = stable;
+        quiescent = stable;
+        return true;
+    }
+
+    inline const settle_result& get_last_settle()const{
+        return last_settle;
+    }
+    inline size_t get_settle_limit()const{
+        return settle_limit;
+    }
+    //1 gives single pass ticks, where a value moves at most one
+    //element further against evaluation order per tick
+    inline void set_settle_limit(const size_t &limit){
+        if(limit == 0){
+            throw std::runtime_error("settle limit can't be zero");
+        }
+        settle_limit = limit;
+    }
+
+    //true if circuit reached a fixpoint and no source has work scheduled
+    inline bool is_quiescent(){
+        return quiescent && !has_pending_work();
+    }
+
+    //forces next tick to evaluate everything, call after changing
+    //gates or ties directly, emplace and erase do it on their own
+    inline void wake(){
+        quiescent = false;
+        sources_valid = false;
+        if(engine){
+            engine->invalidate();
+        }
+    }
+
+    //ticks are evaluated by given engine, e.g. bytecode_engine, instead of
+    //processing elements; null goes back to processing them
+    inline void set_engine(std::unique_ptr<sim_engine> engine){
+        this->engine = std::move(engine);
+        wake();
+    }
+    inline sim_engine* get_engine()const{
+        return engine.get();
+    }
+
+    //skips subtrees of metas nothing has changed in since their last
+    //evaluation, on by default; off evaluates every element on every pass
+    inline void set_scoping(const bool &enabled){
+        scoping = enabled;
+        wake();
+    }
+    inline bool get_scoping()const{
+        return scoping;
+    }
+
+    //evaluates sealed combinational metas of up to truth_table::max_ins_width
+    //input bits by a table lookup. A table row is filled the first time its
+    //inputs show up and metas of equal structure share one table. Gates
+    //inside such metas are not kept up to date, only their outputs are
+    inline void set_truth_tables(const bool &enabled){
+        tabulating = enabled;
+        wake();
+    }
+    inline bool get_truth_tables()const{
+        return tabulating;
+    }
+    inline size_t tabulated_blocks(){
+        collect_sources();
+        return blocks.size();
+    }
+    inline const truth_tables& get_tables()const{
+        return tables;
+    }
+
+    //stops evaluating logic whose values can't be seen: elements that no
+    //elem_out of root and no watched gate depends on. Their gates keep
+    //stale values, watch the gates shown to the user
+    inline void set_pruning(const bool &enabled){
+        pruning = enabled;
+        wake();
+    }
+    inline bool get_pruning()const{
+        return pruning;
+    }
+    inline void watch(const size_t &gate_id){
+        if(watched.insert(gate_id).second && pruning){
+            wake();
+        }
+    }
+    inline void unwatch(const size_t &gate_id){
+        if(watched.erase(gate_id) && pruning){
+            wake();
+        }
+    }
+    //ids of elements left out of evaluation, metas included
+    inline std::vector<size_t> get_pruned(){
+        collect_sources();
+        std::vector<size_t> result;
+        for(auto &item:schedule){
+            if(item.pruned){
+                result.emplace_back(item.el->get_id());
+            }
         }
+        return result;
     }
 
     inline k_tree_it get_by_id(const size_t &id){
@@ -72,6 +765,7 @@ public:
 
     template<class It>
     It erase(It it){
+        wake();
         return elems.erase(it);
     }
 
@@ -81,7 +775,9 @@ public:
     }
 
     inline k_tree_it emplace(const k_tree_it& it, k_tree_::value_type&& val){
+        wake();
         auto &el = (*it);
+        val->parent_id = el->get_id();
         if(dynamic_cast<elem_meta*>(el.get())){
             auto el_in = dynamic_cast<elem_in*>(val.get());
             auto el_out = dynamic_cast<elem_out*>(val.get());
@@ -0,0 +1,358 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include "sim.h"
+#include "netlist.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+//runs sim::tick on a worker thread. Input changes come through a lock-free queue,
+//gate values are published as snapshots that can be read without locking.
+//The worker either ticks on request or runs freely at a target rate, a free
+//run goes idle while the sim is quiescent and resumes on next input or request
+class sim_runner{
+public:
+    using snapshot = std::unordered_map<size_t, bits::bit_vector>;
+    using clock = std::chrono::steady_clock;
+private:
+    struct input_change{
+        size_t id;
+        bits::bit_vector values;
+    };
+
+    class sim &sim_;
+    std::function<void()> on_publish;
+
+    spsc_queue<input_change, 1024> inputs;
+    spsc_queue<std::string, 64> errors;
+    triple_buffer<snapshot> snapshots;
+
+    std::mutex sim_mtx; //held by worker while ticking and by owner while editing
+    std::mutex wake_mtx;
+    std::condition_variable wake_cv;
+    std::atomic<bool> pending{false}, stopping{false}, force_tick{false};
+    std::atomic<bool> quiescent{false};
+    bool idle = false; //free run waits for input, owned by worker
+    bool unsettled_reported = false; //owned by worker, reset by request_tick
+    std::atomic<size_t> edit_waiters{0};
+
+    //free-running state, rates are in ticks per second, zero target means unlimited
+    std::atomic<bool> running{false}, restart_pacing{false};
+    std::atomic<double> target_rate{0.}, achieved_rate{0.};
+    clock::time_point pace_start, rate_start, last_publish;
+    size_t pace_ticks = 0, rate_ticks = 0;
+    //snapshots are meant for a display, there is no use in publishing them per tick
+    const clock::duration publish_interval = std::chrono::milliseconds(8);
+    //worker releases the sim at least this often so edits are not starved
+    const clock::duration batch_interval = std::chrono::milliseconds(2);
+
+    std::thread worker;
+
+    void notify(){
+        {
+            std::lock_guard<std::mutex> lk(wake_mtx);
+        }
+        wake_cv.notify_one();
+    }
+    void wake(){
+        pending.store(true, std::memory_order_release);
+        notify();
+    }
+
+    void apply(const input_change &in){
+        auto it = sim_.get_by_id(in.id);
+        if(it == sim_.end()){
+            auto mes = "attempt to set value of element id="+std::to_string(in.id)+
+                ", which is not in sim";
+            throw std::runtime_error(mes);
+        }
+        auto el_in = dynamic_cast<elem_in*>(it->get());
+        if(!el_in){
+            auto mes = "attempt to set value of element "+(*it)->get_name()+
+                ", which is not an input";
+            throw std::runtime_error(mes);
+        }
+        el_in->set_values(in.values);
+    }
+
+    //reports a tick that hit settle limit once, until next request_tick
+    void check_settled(){
+        auto &res = sim_.get_last_settle();
+        if(res.stable || unsettled_reported || sim_.get_settle_limit() == 1){
+            return;
+        }
+        unsettled_reported = true;
+        auto mes = "circuit did not settle in "+std::to_string(res.passes)+" passes";
+        if(!res.oscillating.empty()){
+            mes += ", oscillating:";
+            for(auto &name:res.oscillating){
+                mes += " "+name;
+            }
+        }
+        netlist nl(sim_);
+        for(auto &loop:nl.get_comb_loops()){
+            mes += "\ncombinational loop: "+nl.describe(loop);
+        }
+        errors.try_push(mes);
+    }
+
+    void fill(snapshot &snap){
+        snap.clear();
+        for(auto &el:sim_){
+            for(size_t i=0; i<el->get_ins_size(); i++){
+                auto gt = el->get_in(i);
+                snap[gt->get_id()] = gt->get_values();
+            }
+            for(size_t i=0; i<el->get_outs_size(); i++){
+                auto gt = el->get_out(i);
+                snap[gt->get_id()] = gt->get_values();
+            }
+        }
+    }
+
+    void step(){
+        {
+            std::lock_guard<std::mutex> lk(sim_mtx);
+            try{
+                if(force_tick.exchange(false, std::memory_order_acq_rel)){
+                    sim_.wake();
+                    unsettled_reported = false;
+                }
+                while(auto in = inputs.try_pop()){
+                    apply(*in);
+                }
+                sim_.tick();
+                check_settled();
+                quiescent.store(sim_.is_quiescent(), std::memory_order_release);
+            }catch(std::runtime_error &e){
+                errors.try_push(e.what());
+            }
+            fill(snapshots.back_buffer());
+        }
+        snapshots.publish();
+        last_publish = clock::now();
+        if(on_publish){
+            on_publish();
+        }
+    }
+
+    size_t ticks_due(const clock::time_point &now, const double &rate)const{
+        std::chrono::duration<double> elapsed = now - pace_start;
+        return static_cast<size_t>(elapsed.count()*rate)+1;
+    }
+
+    void run_batch(){
+        auto now = clock::now();
+        if(restart_pacing.exchange(false, std::memory_order_acq_rel)){
+            pace_start = rate_start = now;
+            pace_ticks = rate_ticks = 0;
+        }
+        auto rate = target_rate.load(std::memory_order_relaxed);
+        auto due = (rate > 0.)? ticks_due(now, rate) : SIZE_MAX;
+        {
+            std::lock_guard<std::mutex> lk(sim_mtx);
+            auto batch_end = now + batch_interval;
+            try{
+                if(force_tick.exchange(false, std::memory_order_acq_rel)){
+                    sim_.wake();
+                    unsettled_reported = false;
+                }
+                //unlimited runs read the clock once per 64 ticks, it is not free at these rates
+                for(size_t i=1; pace_ticks < due; i++){
+                    while(auto in = inputs.try_pop()){
+                        apply(*in);
+                    }
+                    if(!sim_.tick() || sim_.is_quiescent()){
+                        idle = true;
+                        break;
+                    }
+                    check_settled();
+                    pace_ticks++;
+                    rate_ticks++;
+                    if(rate > 0. || i % 64 == 0){
+                        now = clock::now();
+                        if(now >= batch_end ||
+                            edit_waiters.load(std::memory_order_acquire) ||
+                            !running.load(std::memory_order_relaxed))
+                        {
+                            break;
+                        }
+                        if(rate > 0.){
+                            due = ticks_due(now, rate);
+                        }
+                    }
+                }
+            }catch(std::runtime_error &e){
+                errors.try_push(e.what());
+                running.store(false, std::memory_order_release);
+            }
+            now = clock::now();
+            if(idle || now - last_publish >= publish_interval){
+                fill(snapshots.back_buffer());
+                snapshots.publish();
+                last_publish = now;
+            }
+        }
+        quiescent.store(idle, std::memory_order_release);
+        if(idle){
+            //time spent idle should not be caught up after wake up
+            achieved_rate.store(0., std::memory_order_relaxed);
+            restart_pacing.store(true, std::memory_order_release);
+            return;
+        }
+        std::chrono::duration<double> rate_elapsed = now - rate_start;
+        if(rate_elapsed.count() >= 0.5){
+            achieved_rate.store(rate_ticks/rate_elapsed.count(), std::memory_order_relaxed);
+            rate_start = now;
+            rate_ticks = 0;
+        }
+        while(edit_waiters.load(std::memory_order_acquire)){
+            std::this_thread::yield();
+        }
+        if(rate > 0. && pace_ticks >= due){
+            //ahead of schedule, sleep until next tick is due but stay responsive
+            auto next = pace_start + std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(pace_ticks/rate));
+            auto latest = clock::now() + std::chrono::milliseconds(10);
+            std::unique_lock<std::mutex> lk(wake_mtx);
+            wake_cv.wait_until(lk, std::min(next, latest), [this](){
+                return stopping.load(std::memory_order_acquire) ||
+                    !running.load(std::memory_order_acquire) ||
+                    restart_pacing.load(std::memory_order_acquire);
+            });
+        }
+    }
+
+    void loop(){
+        while(true){
+            {
+                std::unique_lock<std::mutex> lk(wake_mtx);
+                wake_cv.wait(lk, [this](){
+                    return pending.load(std::memory_order_acquire) ||
+                        (running.load(std::memory_order_acquire) && !idle) ||
+                        stopping.load(std::memory_order_acquire);
+                });
+            }
+            if(stopping.load(std::memory_order_acquire)){
+                return;
+            }
+            if(pending.exchange(false, std::memory_order_acq_rel)){
+                idle = false;
+            }
+            if(running.load(std::memory_order_acquire)){
+                run_batch();
+                if(!running.load(std::memory_order_acquire)){
+                    //paused, publish the exact state it stopped in
+                    achieved_rate.store(0., std::memory_order_relaxed);
+                    {
+                        std::lock_guard<std::mutex> lk(sim_mtx);
+                        fill(snapshots.back_buffer());
+                    }
+                    snapshots.publish();
+                    if(on_publish){
+                        on_publish();
+                    }
+                }
+            }else{
+                step();
+            }
+        }
+    }
+public:
+    //on_publish is called from the worker thread after every new snapshot
+    sim_runner(class sim &s, std::function<void()> on_publish = nullptr)
+        :sim_(s),
+        on_publish(std::move(on_publish))
+    {
+        worker = std::thread(&sim_runner::loop, this);
+    }
+    ~sim_runner(){
+        stopping.store(true, std::memory_order_release);
+        notify();
+        worker.join();
+    }
+    sim_runner(const sim_runner&) = delete;
+    sim_runner& operator=(const sim_runner&) = delete;
+
+    //must be called from one thread only
+    void set_input(const size_t &id, bits::bit_vector values){
+        input_change in{id, std::move(values)};
+        while(!inputs.try_push(in)){
+            wake();
+            std::this_thread::yield();
+        }
+        wake();
+    }
+    //ticks even if sim is quiescent, use after editing the tree
+    void request_tick(){
+        force_tick.store(true, std::memory_order_release);
+        wake();
+    }
+
+    //swaps the engine evaluating ticks, null goes back to processing elements
+    void set_engine(std::unique_ptr<sim_engine> engine){
+        {
+            auto lk = lock_for_edit();
+            sim_.set_engine(std::move(engine));
+        }
+        request_tick();
+    }
+
+    //ticks continuously at given rate, zero means as fast as possible.
+    //While running on_publish is not called, sample with acquire_snapshot instead
+    void run(const double &ticks_per_sec = 0.){
+        target_rate.store(std::max(ticks_per_sec, 0.), std::memory_order_relaxed);
+        restart_pacing.store(true, std::memory_order_release);
+        running.store(true, std::memory_order_release);
+        wake();
+    }
+    void pause(){
+        running.store(false, std::memory_order_release);
+        notify();
+    }
+    bool is_running()const{
+        return running.load(std::memory_order_acquire);
+    }
+    double get_target_rate()const{
+        return target_rate.load(std::memory_order_relaxed);
+    }
+    //measured ticks per second while running, zero when paused or idle
+    double get_rate()const{
+        return achieved_rate.load(std::memory_order_relaxed);
+    }
+    //true if last tick left the circuit stable and nothing is scheduled
+    bool is_quiescent()const{
+        return quiescent.load(std::memory_order_acquire);
+    }
+
+    //blocks the worker until returned lock is released; take it before
+    //changing the structure of the sim (adding, erasing, tying, resizing)
+    std::unique_lock<std::mutex> lock_for_edit(){
+        edit_waiters.fetch_add(1, std::memory_order_acq_rel);
+        std::unique_lock<std::mutex> lk(sim_mtx);
+        edit_waiters.fetch_sub(1, std::memory_order_acq_rel);
+        return lk;
+    }
+
+    //reader side, must be called from one thread only
+    const snapshot& acquire_snapshot(){
+        snapshots.acquire();
+        return snapshots.front_buffer();
+    }
+    const snapshot& get_snapshot()const{
+        return snapshots.front_buffer();
+    }
+    std::optional<std::string> take_error(){
+        return errors.try_pop();
+    }
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <optional>
+#include <cstddef>
+
+//lock-free ring buffer for exactly one producer thread and one consumer thread
+template<class T, size_t Capacity>
+class spsc_queue{
+    static_assert(Capacity >= 2, "spsc_queue needs capacity of at least 2");
+
+    std::array<T, Capacity> buf;
+    alignas(64) std::atomic<size_t> head{0}; //next slot to read, owned by consumer
+    alignas(64) std::atomic<size_t> tail{0}; //next slot to write, owned by producer
+
+    static size_t next(size_t pos){
+        return (pos+1 == Capacity)? 0 : pos+1;
+    }
+public:
+    bool try_push(T val){
+        auto t = tail.load(std::memory_order_relaxed);
+        auto n = next(t);
+        if(n == head.load(std::memory_order_acquire)){
+            return false; //full
+        }
+        buf[t] = std::move(val);
+        tail.store(n, std::memory_order_release);
+        return true;
+    }
+
+    std::optional<T> try_pop(){
+        auto h = head.load(std::memory_order_relaxed);
+        if(h == tail.load(std::memory_order_acquire)){
+            return std::nullopt; //empty
+        }
+        std::optional<T> result(std::move(buf[h]));
+        head.store(next(h), std::memory_order_release);
+        return result;
+    }
+
+    bool empty()const{
+        return head.load(std::memory_order_acquire) ==
+            tail.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,351 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include "netlist.h"
+#include "timing_wheel.h"
+
+//event driven simulation of a netlist where every node has a propagation delay,
+//so glitches and races show up instead of being resolved within one tick.
+//Nets are at most 64 bits wide and start at zero, the netlist must outlive it.
+//Values are kept per storage net, a slice reads and writes its bits in place
+class timing_sim{
+public:
+    using time_type = uint64_t;
+
+    enum class delay_model{
+        transport,  //every change of inputs reaches the output, glitches included
+        inertial    //pulses shorter than node delay are swallowed
+    };
+
+    struct change{
+        time_type time;
+        size_t net;
+        uint64_t value;
+    };
+private:
+    struct event{
+        uint32_t net;
+        uint32_t gen;
+        uint64_t value;
+    };
+
+    const netlist &nl;
+    timing_wheel<event> wheel;
+    delay_model model;
+    std::vector<uint64_t> values, projected, masks;    //values by storage, rest by net
+    std::vector<uint32_t> gens;         //bumped to cancel pending events of a net
+    std::vector<time_type> delays;      //per node
+    std::vector<bool> delay_set;        //delay was given for this very node
+    std::array<time_type, netlist::types_count> kind_delays;
+    std::vector<size_t> dirty;
+    std::vector<bool> is_dirty;
+    time_type time = 0;
+    time_type clock_scale = 100;        //time units per clock half period tick
+    size_t delta_limit = 1000;
+    size_t events_count = 0;
+    bool tracing = false;
+    std::vector<change> trace;
+    std::unordered_map<size_t, bits::bit_vector> rams;  //contents by node, copied at start
+    std::vector<uint64_t> states;       //per sequential node
+    std::vector<bool> last_clk;
+    std::vector<time_type> flips;       //last flip per clock node
+
+    static size_t p_kind(const netlist::types_node &type){
+        return static_cast<size_t>(type);
+    }
+
+    uint64_t p_read(const size_t &net)const{
+        auto &nt = nl.get_nets()[net];
+        return (values[nt.storage] >> nt.offset) & masks[net];
+    }
+
+    uint64_t p_eval_memory(const size_t &n, const netlist::node &nd){
+        return netlist::eval_memory(nd,
+            [this, &nd](const size_t &i){
+                return p_read(nd.ins[i]);
+            }, rams[n]);
+    }
+
+    uint64_t p_eval(const size_t &n, const size_t &out){
+        auto &nd = nl.get_nodes()[n];
+        if(nd.type == netlist::types_node::t_ram || nd.type == netlist::types_node::t_rom){
+            return p_eval_memory(n, nd) & masks[nd.outs[out]];
+        }
+        auto result = netlist::eval(nd,
+            [this, &nd](const size_t &i){
+                return p_read(nd.ins[i]);
+            }, out);
+        return result & masks[nd.outs[out]];
+    }
+
+    void p_drive(const size_t &net, const uint64_t &value, const time_type &at){
+        if(model == delay_model::inertial && projected[net] != p_read(net)){
+            //a change is still on its way, newer value replaces it
+            gens[net]++;
+            projected[net] = p_read(net);
+        }
+        if(value == projected[net]){
+            return;
+        }
+        projected[net] = value;
+        wheel.schedule(at, event{static_cast<uint32_t>(net), gens[net], value});
+    }
+
+    void p_schedule_clock(const size_t &n, const time_type &from){
+        auto &nd = nl.get_nodes()[n];
+        auto clk = dynamic_cast<const elem_clock*>(nd.elem);
+        auto net = nd.outs.at(0);
+        auto at = from + clk->get_half_period()*clock_scale;
+        flips[n] = from;
+        auto value = projected[net] ^ 1;
+        projected[net] = value;
+        wheel.schedule(at, event{static_cast<uint32_t>(net), gens[net], value});
+    }
+
+    void p_mark(const size_t &n){
+        if(!is_dirty[n]){
+            is_dirty[n] = true;
+            dirty.emplace_back(n);
+        }
+    }
+
+    void p_apply(const event &ev){
+        events_count++;
+        if(ev.gen != gens[ev.net] || p_read(ev.net) == ev.value){
+            return;
+        }
+        auto &nets = nl.get_nets();
+        auto &nt = nets[ev.net];
+        auto &storage = values[nt.storage];
+        storage = (storage & ~(masks[ev.net] << nt.offset)) | (ev.value << nt.offset);
+        if(tracing){
+            trace.emplace_back(change{wheel.now(), ev.net, ev.value});
+        }
+        for(auto &other:nl.get_sharing(ev.net)){
+            for(auto &n:nets[other].readers){
+                p_mark(n);
+            }
+        }
+        if(nt.driver != netlist::npos &&
+            nl.get_nodes()[nt.driver].type == netlist::types_node::t_clock)
+        {
+            p_schedule_clock(nt.driver, wheel.now());
+        }
+    }
+
+    void p_drive_state(const size_t &n, const time_type &at){
+        auto &nd = nl.get_nodes()[n];
+        for(size_t out=0; out<nd.outs.size(); out++){
+            auto value = netlist::state_out(nd.type, states[n], out) & masks[nd.outs[out]];
+            p_drive(nd.outs[out], value, at);
+        }
+    }
+
+    //sequential node changes state at a rising clock only, and does so right
+    //when clock rises, so it samples d as it was before the edge
+    void p_clock(const size_t &n, const netlist::node &nd, const time_type &now){
+        bool level = p_read(nd.ins.back()) & 1;
+        bool rising = level && !last_clk[n];
+        last_clk[n] = level;
+        if(!rising){
+            return;
+        }
+        auto next = netlist::next_state(nd.type,
+            [this, &nd](const size_t &i){
+                return p_read(nd.ins[i]);
+            }, states[n]);
+        next &= masks[nd.outs[0]];
+        if(next != states[n]){
+            states[n] = next;
+            p_drive_state(n, now+delays[n]);
+        }
+    }
+
+    void p_evaluate_dirty(){
+        auto &nodes = nl.get_nodes();
+        auto now = wheel.now();
+        for(size_t i=0; i<dirty.size(); i++){
+            auto n = dirty[i];
+            is_dirty[n] = false;
+            auto &nd = nodes[n];
+            if(nd.ins.empty()){
+                continue;
+            }
+            if(nd.sequential){
+                p_clock(n, nd, now);
+                continue;
+            }
+            for(size_t out=0; out<nd.outs.size(); out++){
+                p_drive(nd.outs[out], p_eval(n, out), now+delays[n]);
+            }
+        }
+        dirty.clear();
+    }
+public:
+    timing_sim(const netlist &nl, const delay_model &model = delay_model::transport)
+        :nl(nl),
+        model(model)
+    {
+        //wires take no time, logic takes one unit
+        kind_delays.fill(1);
+        kind_delays[p_kind(netlist::types_node::t_in)] = 0;
+        kind_delays[p_kind(netlist::types_node::t_buf)] = 0;
+        kind_delays[p_kind(netlist::types_node::t_clock)] = 0;
+        auto &nets = nl.get_nets();
+        auto &nodes = nl.get_nodes();
+        for(auto &nt:nets){
+            if(nt.width > 64){
+                throw std::runtime_error("attempt to simulate net "+nt.name+
+                    " of width "+std::to_string(nt.width)+", timing_sim supports up to 64 bits");
+            }
+            masks.emplace_back((nt.width == 64)? ~uint64_t(0) : (uint64_t(1) << nt.width)-1);
+        }
+        values.assign(nets.size(), 0);
+        projected.assign(nets.size(), 0);
+        gens.assign(nets.size(), 0);
+        is_dirty.assign(nodes.size(), false);
+        states.assign(nodes.size(), 0);
+        last_clk.assign(nodes.size(), false);
+        flips.assign(nodes.size(), 0);
+        delay_set.assign(nodes.size(), false);
+        for(size_t n=0; n<nodes.size(); n++){
+            delays.emplace_back(kind_delays[p_kind(nodes[n].type)]);
+            if(nodes[n].type == netlist::types_node::t_ram){
+                rams[n] = dynamic_cast<const elem_ram*>(nodes[n].elem)->get_contents();
+            }
+        }
+        //power up: every node sees all zero inputs once, clocks start ticking
+        //and sequential nodes show their state, taken from the elements
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].type == netlist::types_node::t_clock){
+                p_schedule_clock(n, 0);
+            }else if(nodes[n].sequential){
+                auto seq = dynamic_cast<const elem_sequential*>(nodes[n].elem);
+                states[n] = seq->get_state().word(0);
+                p_drive_state(n, 0);
+            }else{
+                p_mark(n);
+            }
+        }
+        p_evaluate_dirty();
+    }
+
+    //delay of every node of a kind that has no delay of its own
+    void set_delay(const netlist::types_node &type, const time_type &delay){
+        kind_delays[p_kind(type)] = delay;
+        auto &nodes = nl.get_nodes();
+        for(size_t n=0; n<nodes.size(); n++){
+            if(!delay_set[n] && nodes[n].type == type){
+                delays[n] = delay;
+            }
+        }
+    }
+    void set_node_delay(const size_t &node, const time_type &delay){
+        delays.at(node) = delay;
+        delay_set.at(node) = true;
+    }
+    void set_delay(const element* el, const time_type &delay){
+        auto &nodes = nl.get_nodes();
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].elem == el){
+                set_node_delay(n, delay);
+                return;
+            }
+        }
+        throw std::runtime_error("attempt to set delay of element "+el->get_name()+
+            ", which is not in netlist");
+    }
+    const time_type& get_node_delay(const size_t &node)const{
+        return delays.at(node);
+    }
+    //clock with half period h flips every h*scale time units; the pending
+    //flip of a running clock moves to h*scale after its last one, or to now
+    void set_clock_scale(const time_type &scale){
+        clock_scale = scale;
+        auto &nodes = nl.get_nodes();
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].type != netlist::types_node::t_clock){
+                continue;
+            }
+            auto net = nodes[n].outs.at(0);
+            gens[net]++;
+            projected[net] = p_read(net);
+            auto period = dynamic_cast<const elem_clock*>(nodes[n].elem)->get_half_period()*scale;
+            p_schedule_clock(n, std::max(flips[n], time-std::min(time, period)));
+        }
+    }
+    //changes a single point in time may take before zero delay loop is assumed
+    void set_delta_limit(const size_t &limit){
+        delta_limit = limit;
+    }
+
+    //schedules a value on a net, normally one driven by an input node
+    void set_input(const size_t &net, const uint64_t &value, const time_type &at){
+        if(at < time){
+            throw std::runtime_error("attempt to set input at "+std::to_string(at)+
+                ", simulation is already at "+std::to_string(time));
+        }
+        auto masked = value & masks.at(net);
+        projected[net] = masked;
+        wheel.schedule(at, event{static_cast<uint32_t>(net), gens[net], masked});
+    }
+    void set_input(const size_t &net, const uint64_t &value){
+        set_input(net, value, time);
+    }
+
+    //processes every event up to and including given time
+    void run_until(const time_type &until){
+        if(until < time){
+            return;
+        }
+        time_type last = wheel.now();
+        size_t deltas = 0;
+        while(wheel.advance(until)){
+            auto now = wheel.now();
+            deltas = (now == last)? deltas+1 : 0;
+            last = now;
+            if(deltas > delta_limit){
+                throw std::runtime_error("circuit did not settle at time "+std::to_string(now)+
+                    " after "+std::to_string(delta_limit)+" zero delay steps");
+            }
+            wheel.take_due([this](const event &ev){
+                p_apply(ev);
+            });
+            p_evaluate_dirty();
+        }
+        time = until;
+    }
+    void run_for(const time_type &duration){
+        run_until(time+duration);
+    }
+
+    const time_type& get_time()const{
+        return time;
+    }
+    uint64_t get_value(const size_t &net)const{
+        auto &nt = nl.get_nets().at(net);
+        return (values[nt.storage] >> nt.offset) & masks[net];
+    }
+    size_t pending_events()const{
+        return wheel.size();
+    }
+    //events taken from the wheel so far, cancelled ones included
+    size_t processed_events()const{
+        return events_count;
+    }
+
+    //records every net change, off by default as it grows without bound
+    void set_tracing(const bool &enabled){
+        tracing = enabled;
+    }
+    const std::vector<change>& get_trace()const{
+        return trace;
+    }
+    void clear_trace(){
+        trace.clear();
+    }
+};
@@ -0,0 +1,207 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+//hierarchical timing wheel: 4 levels of 256 slots cover 2^32 time units ahead
+//of now, later events wait in an overflow list. Scheduling is O(1), an event
+//moves down a level at most 3 times before it is due. Events due at the same
+//time are taken in the order they were scheduled
+template<class T>
+class timing_wheel{
+public:
+    using time_type = uint64_t;
+private:
+    static constexpr size_t slot_bits = 8;
+    static constexpr size_t slots = size_t(1) << slot_bits;
+    static constexpr time_type slot_mask = slots-1;
+    static constexpr size_t levels = 4;
+    static constexpr size_t span_bits = slot_bits*levels;
+    static constexpr uint32_t nil = UINT32_MAX;
+
+    struct entry{
+        time_type time;
+        T value;
+        uint32_t next;
+    };
+    struct list{
+        uint32_t head = nil, tail = nil;
+    };
+
+    std::vector<entry> pool;
+    uint32_t free_head = nil;
+    std::array<std::array<list, slots>, levels> wheel;
+    std::array<std::array<uint64_t, slots/64>, levels> occupied{};
+    list overflow;
+    time_type now_ = 0;
+    size_t count = 0;
+
+    static void p_append(std::vector<entry> &pool, list &l, const uint32_t &idx){
+        pool[idx].next = nil;
+        if(l.tail == nil){
+            l.head = idx;
+        }else{
+            pool[l.tail].next = idx;
+        }
+        l.tail = idx;
+    }
+
+    void p_file(const uint32_t &idx){
+        auto t = pool[idx].time;
+        for(size_t level=0; level<levels; level++){
+            auto shift = slot_bits*level;
+            if((t >> (shift+slot_bits)) != (now_ >> (shift+slot_bits))){
+                continue;
+            }
+            auto s = (t >> shift) & slot_mask;
+            p_append(pool, wheel[level][s], idx);
+            occupied[level][s/64] |= uint64_t(1) << (s%64);
+            return;
+        }
+        p_append(pool, overflow, idx);
+    }
+
+    list p_detach(const size_t &level, const size_t &s){
+        auto l = wheel[level][s];
+        wheel[level][s] = list();
+        occupied[level][s/64] &= ~(uint64_t(1) << (s%64));
+        return l;
+    }
+
+    //first occupied slot at or after "from", slots if there is none
+    size_t p_find(const size_t &level, const size_t &from)const{
+        for(size_t w=from/64; w<slots/64; w++){
+            auto bits = occupied[level][w];
+            if(w == from/64){
+                bits &= ~uint64_t(0) << (from%64);
+            }
+            if(bits){
+                return w*64+__builtin_ctzll(bits);
+            }
+        }
+        return slots;
+    }
+
+    //re-files a list against current time, entries land on lower levels
+    void p_refile(list l){
+        for(auto idx=l.head; idx!=nil;){
+            auto next = pool[idx].next;
+            p_file(idx);
+            idx = next;
+        }
+    }
+
+    void p_set_now(const time_type &t){
+        bool wrapped = (t >> span_bits) != (now_ >> span_bits);
+        now_ = t;
+        if(wrapped){
+            auto l = overflow;
+            overflow = list();
+            p_refile(l);
+        }
+    }
+public:
+    time_type now()const{
+        return now_;
+    }
+    size_t size()const{
+        return count;
+    }
+    bool empty()const{
+        return count == 0;
+    }
+
+    void schedule(const time_type &time, T value){
+        if(time < now_){
+            throw std::runtime_error("attempt to schedule event at "+std::to_string(time)+
+                ", which is before current time "+std::to_string(now_));
+        }
+        uint32_t idx;
+        if(free_head != nil){
+            idx = free_head;
+            free_head = pool[idx].next;
+            pool[idx].time = time;
+            pool[idx].value = std::move(value);
+        }else{
+            if(pool.size() == nil){
+                throw std::runtime_error("attempt to schedule more than "+
+                    std::to_string(nil)+" events");
+            }
+            idx = static_cast<uint32_t>(pool.size());
+            pool.push_back(entry{time, std::move(value), nil});
+        }
+        p_file(idx);
+        count++;
+    }
+
+    //moves now to the earliest scheduled event and returns true, if that is
+    //later than limit moves now to limit instead and returns false
+    bool advance(const time_type &limit = UINT64_MAX){
+        while(count){
+            auto s = p_find(0, now_ & slot_mask);
+            if(s != slots){
+                auto t = (now_ & ~slot_mask) | s;
+                if(t > limit){
+                    break;
+                }
+                now_ = t;
+                return true;
+            }
+            bool found = false, beyond = false;
+            for(size_t level=1; level<levels && !found; level++){
+                auto shift = slot_bits*level;
+                auto idx = (now_ >> shift) & slot_mask;
+                s = (idx+1 < slots)? p_find(level, idx+1) : slots;
+                if(s == slots){
+                    continue;
+                }
+                found = true;
+                auto start = ((now_ >> (shift+slot_bits)) << (shift+slot_bits)) |
+                    (time_type(s) << shift);
+                if(start > limit){
+                    beyond = true;
+                    break;
+                }
+                now_ = start;
+                p_refile(p_detach(level, s));
+            }
+            if(beyond){
+                break;
+            }
+            if(found){
+                continue;
+            }
+            //wheel is empty, jump to earliest overflow event
+            auto earliest = UINT64_MAX;
+            for(auto idx=overflow.head; idx!=nil; idx=pool[idx].next){
+                earliest = std::min(earliest, pool[idx].time);
+            }
+            if(earliest > limit){
+                break;
+            }
+            p_set_now(earliest);
+        }
+        if(limit > now_){
+            p_set_now(limit);
+        }
+        return false;
+    }
+
+    //calls f for every event due now, in scheduling order. Events f schedules
+    //for current time are not included, they are taken by next call
+    template<class F>
+    void take_due(F &&f){
+        auto l = p_detach(0, now_ & slot_mask);
+        for(auto idx=l.head; idx!=nil;){
+            auto next = pool[idx].next;
+            T value = std::move(pool[idx].value);
+            pool[idx].next = free_head;
+            free_head = idx;
+            count--;
+            f(value);
+            idx = next;
+        }
+    }
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+//one writer fills back buffer and publishes it, one reader acquires the latest
+//published buffer; neither side ever waits for the other
+template<class T>
+class triple_buffer{
+    static constexpr uint8_t index_mask = 0b011;
+    static constexpr uint8_t fresh_bit = 0b100;
+
+    std::array<T, 3> bufs;
+    uint8_t back = 0;                   //owned by writer
+    std::atomic<uint8_t> middle{1};     //exchanged between writer and reader
+    uint8_t front = 2;                  //owned by reader
+public:
+    T& back_buffer(){
+        return bufs[back];
+    }
+    void publish(){
+        auto prev = middle.exchange(back | fresh_bit, std::memory_order_acq_rel);
+        back = prev & index_mask;
+    }
+
+    //returns true if a newer buffer was published since last acquire
+    bool acquire(){
+        if(!(middle.load(std::memory_order_relaxed) & fresh_bit)){
+            return false;
+        }
+        auto prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & index_mask;
+        return true;
+    }
+    const T& front_buffer()const{
+        return bufs[front];
+    }
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include "bit_math.h"
+
+//outputs of a combinational block for every combination of its input bits,
+//filled lazily as combinations show up. Input bits are concatenated in order
+//of the block's inputs, first one in lowest bits, outputs are stored likewise
+class truth_table{
+    size_t ins_width, outs_width;
+    bits::bit_vector rows;
+    std::vector<bool> known;
+    size_t known_count = 0;
+public:
+    static constexpr size_t max_ins_width = 16;
+
+    truth_table(const size_t &ins_width, const size_t &outs_width)
+        :ins_width(ins_width),
+        outs_width(outs_width)
+    {
+        if(ins_width > max_ins_width){
+            throw std::runtime_error("attempt to make truth table of "+std::to_string(ins_width)+
+                " input bits, allowed are up to "+std::to_string(max_ins_width));
+        }
+        known.assign(size_t(1) << ins_width, false);
+        rows.resize(known.size()*outs_width);
+    }
+
+    bool has(const size_t &row)const{
+        return known[row];
+    }
+    //bits [offset, offset+count) of outputs for a row into dst
+    void get(const size_t &row, const size_t &offset, const size_t &count, bits::bit_vector &dst)const{
+        rows.get_slice(row*outs_width+offset, count, dst);
+    }
+    void set(const size_t &row, const size_t &offset, const bits::bit_vector &src){
+        rows.set_slice(row*outs_width+offset, src);
+    }
+    void set_known(const size_t &row){
+        if(!known[row]){
+            known[row] = true;
+            known_count++;
+        }
+    }
+
+    size_t get_ins_width()const{
+        return ins_width;
+    }
+    size_t get_outs_width()const{
+        return outs_width;
+    }
+    size_t known_rows()const{
+        return known_count;
+    }
+};
+
+//tables by signature of the block they describe, every instance of a block
+//fills and reads the same one
+class truth_tables{
+    std::unordered_map<std::string, std::shared_ptr<truth_table>> tables;
+public:
+    std::shared_ptr<truth_table> get(const std::string &signature, const size_t &ins_width,
+        const size_t &outs_width)
+    {
+        auto &table = tables[signature];
+        if(!table){
+            table = std::make_shared<truth_table>(ins_width, outs_width);
+        }
+        return table;
+    }
+    //drops tables no block refers to anymore, e.g. of blocks that were edited
+    void prune(){
+        for(auto it=tables.begin(); it!=tables.end();){
+            it = (it->second.use_count() == 1)? tables.erase(it) : std::next(it);
+        }
+    }
+    void clear(){
+        tables.clear();
+    }
+    size_t size()const{
+        return tables.size();
+    }
+};
@@ -17,7 +17,10 @@ private:
 private slots:
 	void open_action();
 	void save_action();
+	void rate_action();
+	void show_rate(double ticks_per_sec, bool quiescent);
 signals:
 	void open_signal(QString path);
 	void save_signal(QString path);
+	void rate_signal(double ticks_per_sec);
 };
\ No newline at end of file
@@ -3,10 +3,12 @@
 #include <QWidget>
 #include <QDebug>
 #include <QPoint>
+#include <QTimer>
 #include <optional>
 #include <vector>
 #include "draw_widget.h"
 #include "sim/sim.h"
+#include "sim/sim_runner.h"
 #include "sim/element.h"
 #include "sim/k_tree.h"
 #include "sim_ui_glue.h"
@@ -28,6 +30,11 @@ class sim_interface : public draw_widget {
     std::shared_ptr<gate_view> gate_view_1, gate_view_2;
 
     class sim sim;
+    sim_runner runner;
+    //repaints at display rate while sim runs freely, never per tick
+    QTimer frame_timer;
+    double sim_rate = 0.;
+    bool log_was_enabled = true;
 
     size_t w=1000, h=1000,
         default_elem_width=50,
@@ -59,6 +66,12 @@ class sim_interface : public draw_widget {
     void draw_and(QPainter &p, int x, int y, int w, int h);
     void draw_or(QPainter &p, int x, int y, int w, int h);
     void draw_not(QPainter &p, int x, int y, int w, int h);
+    void draw_xor(QPainter &p, int x, int y, int w, int h);
+    void draw_bubble(QPainter &p, int x, int y, int w, int h);
+    void draw_mux(QPainter &p, int x, int y, int w, int h);
+    void draw_labeled(QPainter &p, int x, int y, int w, int h, const QString &label);
+    void draw_bus(QPainter &p, int x, int y, int w, int h, bool merging);
+    void draw_clock(QPainter &p, int x, int y, int w, int h);
     void draw_meta(QPainter &p, int x, int y, int w, int h);
     void draw_out(QPainter &p, int x, int y, int w, int h);
     void draw_in(QPainter &p, int x, int y, int w, int h);
@@ -72,6 +85,7 @@ class sim_interface : public draw_widget {
         this->mode = mode::create;
         auto elem = std::make_unique<Elem>(name);
         auto root_id = this->glue.get_root()->id;
+        auto lock = runner.lock_for_edit();
         auto &ref = *sim.emplace(std::move(elem));
         this->view = elem_to_view(ref);
         this->view->st == elem_view::state::creating;
@@ -97,15 +111,36 @@ public slots:
     void add_elem_and();
     void add_elem_or();
     void add_elem_not();
+    void add_elem_xor();
+    void add_elem_nand();
+    void add_elem_nor();
+    void add_elem_xnor();
+    void add_elem_mux();
+    void add_elem_decoder();
+    void add_elem_encoder();
+    void add_elem_splitter();
+    void add_elem_merger();
+    void add_elem_ram();
+    void add_elem_rom();
+    void add_elem_lut();
+    void add_elem_dff();
+    void add_elem_register();
+    void add_elem_counter();
+    void add_elem_clock();
     void add_elem_in();
     void add_elem_out();
     void add_elem_meta();
     void save_sim(QString path);
     void load_sim(QString path);
+    void set_running(bool running);
+    void set_sim_rate(double ticks_per_sec);
+    void step_sim();
 
     void slot_propery_changed(const prop_pair* prop);
     void showContextMenu(const QPoint &p);
 private slots:
+    void on_sim_published();
+    void on_frame();
     void delete_item_cm();
     void cut_item_cm();
     void delete_items_cm();
@@ -114,4 +149,6 @@ private slots:
 signals:
     void element_selected(std::shared_ptr<elem_view> view);
     void element_changed(std::shared_ptr<elem_view> view);
+    void sim_rate_changed(double ticks_per_sec, bool quiescent);
+    void sim_running_changed(bool running);
 };
\ No newline at end of file
@@ -76,6 +76,26 @@ struct elem_view:view{
 struct elem_view_and:elem_view{};
 struct elem_view_or:elem_view{};
 struct elem_view_not:elem_view{};
+struct elem_view_xor:elem_view{};
+struct elem_view_nand:elem_view{};
+struct elem_view_nor:elem_view{};
+struct elem_view_xnor:elem_view{};
+struct elem_view_mux:elem_view{};
+struct elem_view_decoder:elem_view{};
+struct elem_view_encoder:elem_view{};
+struct elem_view_splitter:elem_view{};
+struct elem_view_merger:elem_view{};
+struct elem_view_ram:elem_view{};
+struct elem_view_dff:elem_view{};
+struct elem_view_register:elem_view{};
+struct elem_view_counter:elem_view{};
+struct elem_view_rom:elem_view{
+    std::string image;
+};
+struct elem_view_lut:elem_view{
+    std::string table;  //hex
+};
+struct elem_view_clock:elem_view{};
 struct elem_view_gate:elem_view{};
 struct elem_view_in:elem_view_gate{
     std::shared_ptr<gate_view_in> gt_outer;
@@ -1,5 +1,6 @@
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QInputDialog>
 #include "mainwindow.h"
 #include "prop_pair.h"
 #include "ui_mainwindow.h"
@@ -16,6 +17,38 @@ MainWindow::MainWindow(QWidget *parent)
 		sim_iface, &sim_interface::add_elem_or);
 	connect(ui->btn_not, &QPushButton::pressed,
 		sim_iface, &sim_interface::add_elem_not);
+	connect(ui->btn_xor, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_xor);
+	connect(ui->btn_nand, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_nand);
+	connect(ui->btn_nor, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_nor);
+	connect(ui->btn_xnor, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_xnor);
+	connect(ui->btn_mux, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_mux);
+	connect(ui->btn_decoder, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_decoder);
+	connect(ui->btn_encoder, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_encoder);
+	connect(ui->btn_splitter, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_splitter);
+	connect(ui->btn_merger, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_merger);
+	connect(ui->btn_ram, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_ram);
+	connect(ui->btn_rom, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_rom);
+	connect(ui->btn_lut, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_lut);
+	connect(ui->btn_dff, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_dff);
+	connect(ui->btn_register, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_register);
+	connect(ui->btn_counter, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_counter);
+	connect(ui->btn_clock, &QPushButton::pressed,
+		sim_iface, &sim_interface::add_elem_clock);
 	connect(ui->btn_in, &QPushButton::pressed,
 		sim_iface, &sim_interface::add_elem_in);
 	connect(ui->btn_out, &QPushButton::pressed,
@@ -34,6 +67,18 @@ MainWindow::MainWindow(QWidget *parent)
 		sim_iface, &sim_interface::load_sim);
 	connect(this, &MainWindow::save_signal,
 		sim_iface, &sim_interface::save_sim);
+	connect(ui->actionRun, &QAction::toggled,
+		sim_iface, &sim_interface::set_running);
+	connect(ui->actionStep, &QAction::triggered,
+		sim_iface, &sim_interface::step_sim);
+	connect(ui->actionRate, &QAction::triggered,
+		this, &MainWindow::rate_action);
+	connect(this, &MainWindow::rate_signal,
+		sim_iface, &sim_interface::set_sim_rate);
+	connect(sim_iface, &sim_interface::sim_running_changed,
+		ui->actionRun, &QAction::setChecked);
+	connect(sim_iface, &sim_interface::sim_rate_changed,
+		this, &MainWindow::show_rate);
 }
 
 MainWindow::~MainWindow(){
@@ -53,4 +98,24 @@ void MainWindow::save_action(){
 	auto path = QFileDialog::getSaveFileName(this, "Save file", QDir::currentPath(),
 		tr("Sim (*.sim);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
 	emit save_signal(path);
+}
+void MainWindow::rate_action(){
+	bool ok = false;
+	auto rate = QInputDialog::getDouble(this, tr("Simulation rate"),
+		tr("Ticks per second, 0 for as fast as possible"), 0., 0., 1e9, 1, &ok);
+	if(!ok){
+		return;
+	}
+	emit rate_signal(rate);
+}
+void MainWindow::show_rate(double ticks_per_sec, bool quiescent){
+	if(quiescent){
+		ui->statusbar->showMessage(tr("stable, idle"));
+		return;
+	}
+	if(ticks_per_sec <= 0.){
+		ui->statusbar->clearMessage();
+		return;
+	}
+	ui->statusbar->showMessage(tr("%1 ticks/s").arg(ticks_per_sec, 0, 'f', 0));
 }
\ No newline at end of file
@@ -81,6 +81,34 @@ properties::properties(QWidget* parent)
     }); 
     prop->hide();
 
+    prop = props.emplace_back(new prop_pair("image", "Image", this));
+    prop->set_getter([](auto view){
+        auto cast = std::dynamic_pointer_cast<elem_view_rom>(view);
+        return cast? QString::fromStdString(cast->image) : QString();
+    }); 
+    prop->set_setter([prop](auto view){
+        auto le = prop->get_line_edit();
+        auto cast = std::dynamic_pointer_cast<elem_view_rom>(view);
+        if(cast){
+            cast->image = le->text().toStdString();
+        }
+    }); 
+    prop->hide();
+
+    prop = props.emplace_back(new prop_pair("table", "Table (hex)", this));
+    prop->set_getter([](auto view){
+        auto cast = std::dynamic_pointer_cast<elem_view_lut>(view);
+        return cast? QString::fromStdString(cast->table) : QString();
+    }); 
+    prop->set_setter([prop](auto view){
+        auto le = prop->get_line_edit();
+        auto cast = std::dynamic_pointer_cast<elem_view_lut>(view);
+        if(cast){
+            cast->table = le->text().toStdString();
+        }
+    }); 
+    prop->hide();
+
     for(auto prop:props){
         this->scroll_layout->addWidget(prop);
         connect(prop, &prop_pair::text_changed, 
@@ -112,6 +140,10 @@ void properties::update_props(const std::shared_ptr<elem_view> &view){
             }else{
                 prop->QWidget::setHidden(true);
             }
+        }else if(name == "image"){
+            prop->QWidget::setHidden(!std::dynamic_pointer_cast<elem_view_rom>(view));
+        }else if(name == "table"){
+            prop->QWidget::setHidden(!std::dynamic_pointer_cast<elem_view_lut>(view));
         }
     }
 }
@@ -9,9 +9,11 @@
 #include <QAction>
 #include <QPen>
 #include <filesystem>
+#include <sstream>
 
 void sim_interface::connect_gates(std::shared_ptr<gate_view> gate_view_1, std::shared_ptr<gate_view> gate_view_2){
     bool valid = false;
+    auto lock = runner.lock_for_edit();
     auto gt_1_parent_it = sim.get_by_id(gate_view_1->parent->id);
     auto gt_2_parent_it = sim.get_by_id(gate_view_2->parent->id);
     auto gt_1 = (*gt_1_parent_it)->find_gate(gate_view_1->id);
@@ -39,6 +41,7 @@ void sim_interface::connect_gates(std::shared_ptr<gate_view> gate_view_1, std::s
 }
 
 std::shared_ptr<elem_view> sim_interface::elem_to_view(size_t id){
+    auto lock = runner.lock_for_edit();
     const auto &el_it = sim.get_by_id(id);
     return elem_to_view(*el_it);
 }
@@ -60,6 +63,44 @@ std::shared_ptr<elem_view> sim_interface::elem_to_view(const std::unique_ptr<ele
         view = std::make_shared<elem_view_or>();
     }else if(dynamic_cast<class elem_not*>(elem.get())){
         view = std::make_shared<elem_view_not>();
+    }else if(dynamic_cast<class elem_xor*>(elem.get())){
+        view = std::make_shared<elem_view_xor>();
+    }else if(dynamic_cast<class elem_nand*>(elem.get())){
+        view = std::make_shared<elem_view_nand>();
+    }else if(dynamic_cast<class elem_nor*>(elem.get())){
+        view = std::make_shared<elem_view_nor>();
+    }else if(dynamic_cast<class elem_xnor*>(elem.get())){
+        view = std::make_shared<elem_view_xnor>();
+    }else if(dynamic_cast<class elem_mux*>(elem.get())){
+        view = std::make_shared<elem_view_mux>();
+    }else if(dynamic_cast<class elem_decoder*>(elem.get())){
+        view = std::make_shared<elem_view_decoder>();
+    }else if(dynamic_cast<class elem_priority_encoder*>(elem.get())){
+        view = std::make_shared<elem_view_encoder>();
+    }else if(dynamic_cast<class elem_splitter*>(elem.get())){
+        view = std::make_shared<elem_view_splitter>();
+    }else if(dynamic_cast<class elem_merger*>(elem.get())){
+        view = std::make_shared<elem_view_merger>();
+    }else if(dynamic_cast<class elem_ram*>(elem.get())){
+        view = std::make_shared<elem_view_ram>();
+    }else if(dynamic_cast<class elem_dff*>(elem.get())){
+        view = std::make_shared<elem_view_dff>();
+    }else if(dynamic_cast<class elem_register*>(elem.get())){
+        view = std::make_shared<elem_view_register>();
+    }else if(dynamic_cast<class elem_counter*>(elem.get())){
+        view = std::make_shared<elem_view_counter>();
+    }else if(auto rom = dynamic_cast<class elem_rom*>(elem.get())){
+        auto rom_view = std::make_shared<elem_view_rom>();
+        rom_view->image = rom->get_image_path();
+        view = rom_view;
+    }else if(auto lut = dynamic_cast<class elem_lut*>(elem.get())){
+        auto lut_view = std::make_shared<elem_view_lut>();
+        std::stringstream hex;
+        hex<<std::hex<<lut->get_table();
+        lut_view->table = hex.str();
+        view = lut_view;
+    }else if(dynamic_cast<class elem_clock*>(elem.get())){
+        view = std::make_shared<elem_view_clock>();
     }else if(dynamic_cast<class elem_meta*>(elem.get())){
         view = std::make_shared<elem_view_meta>();
     }
@@ -192,6 +233,55 @@ void sim_interface::draw_not(QPainter &p, int x, int y, int w, int h){
     path.lineTo(x, y);
     p.drawPath(path);
 }
+void sim_interface::draw_xor(QPainter &p, int x, int y, int w, int h){
+    draw_or(p, x+w/8, y, w-w/8, h);
+    QPainterPath path;
+    path.moveTo(x, y);
+    path.quadTo(x+w/2, y+h/2, x, y+h);
+    p.drawPath(path);
+}
+//negation circle at the output side
+void sim_interface::draw_bubble(QPainter &p, int x, int y, int w, int h){
+    auto d = std::max(4, h/5);
+    p.drawEllipse(x+w-d, y+h/2-d/2, d, d);
+}
+void sim_interface::draw_mux(QPainter &p, int x, int y, int w, int h){
+    QPainterPath path;
+    path.moveTo(x, y);
+    path.lineTo(x+w, y+h/4);
+    path.lineTo(x+w, y+h/4*3);
+    path.lineTo(x, y+h);
+    path.lineTo(x, y);
+    p.drawPath(path);
+}
+void sim_interface::draw_labeled(QPainter &p, int x, int y, int w, int h, const QString &label){
+    QRectF rect(x, y, w, h); 
+    p.drawRect(rect);
+    p.drawText(rect, Qt::AlignCenter, label);
+}
+//bar on the bus side with a line fanning out to every slice
+void sim_interface::draw_bus(QPainter &p, int x, int y, int w, int h, bool merging){
+    int bar = merging? x+w : x;
+    int fan = merging? x : x+w;
+    p.drawLine(bar, y, bar, y+h);
+    p.drawLine(bar, y+h/2, (bar+fan)/2, y+h/2);
+    for(int i=0; i<4; i++){
+        int slice_y = y+h/8+h/4*i;
+        p.drawLine((bar+fan)/2, y+h/2, fan, slice_y);
+    }
+}
+void sim_interface::draw_clock(QPainter &p, int x, int y, int w, int h){
+    QRectF rect(x, y, w, h); 
+    p.drawRect(rect);
+    QPainterPath path;
+    path.moveTo(x+w/5, y+h/3*2);
+    path.lineTo(x+w/5, y+h/3);
+    path.lineTo(x+w/2, y+h/3);
+    path.lineTo(x+w/2, y+h/3*2);
+    path.lineTo(x+w/5*4, y+h/3*2);
+    path.lineTo(x+w/5*4, y+h/3);
+    p.drawPath(path);
+}
 void sim_interface::draw_meta(QPainter &p, int x, int y, int w, int h){
     QRectF rect(x, y, w, h); 
     p.drawRect(rect);
@@ -227,6 +317,44 @@ void sim_interface::draw_elem_view(QPainter &pnt, const std::shared_ptr<elem_vie
         draw_or(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
     }else if(std::dynamic_pointer_cast<elem_view_not>(view)){
         draw_not(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
+    }else if(std::dynamic_pointer_cast<elem_view_xor>(view)){
+        draw_xor(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
+    }else if(std::dynamic_pointer_cast<elem_view_nand>(view)){
+        auto bubble = draw_h/5;
+        draw_and(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w-bubble, draw_h); 
+        draw_bubble(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
+    }else if(std::dynamic_pointer_cast<elem_view_nor>(view)){
+        auto bubble = draw_h/5;
+        draw_or(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w-bubble, draw_h); 
+        draw_bubble(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
+    }else if(std::dynamic_pointer_cast<elem_view_xnor>(view)){
+        auto bubble = draw_h/5;
+        draw_xor(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w-bubble, draw_h); 
+        draw_bubble(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
+    }else if(std::dynamic_pointer_cast<elem_view_mux>(view)){
+        draw_mux(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
+    }else if(std::dynamic_pointer_cast<elem_view_decoder>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "DEC"); 
+    }else if(std::dynamic_pointer_cast<elem_view_encoder>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "PRI"); 
+    }else if(std::dynamic_pointer_cast<elem_view_splitter>(view)){
+        draw_bus(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, false); 
+    }else if(std::dynamic_pointer_cast<elem_view_merger>(view)){
+        draw_bus(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, true); 
+    }else if(std::dynamic_pointer_cast<elem_view_ram>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "RAM"); 
+    }else if(std::dynamic_pointer_cast<elem_view_rom>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "ROM"); 
+    }else if(std::dynamic_pointer_cast<elem_view_lut>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "LUT"); 
+    }else if(std::dynamic_pointer_cast<elem_view_dff>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "D"); 
+    }else if(std::dynamic_pointer_cast<elem_view_register>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "REG"); 
+    }else if(std::dynamic_pointer_cast<elem_view_counter>(view)){
+        draw_labeled(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h, "CTR"); 
+    }else if(std::dynamic_pointer_cast<elem_view_clock>(view)){
+        draw_clock(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
     }else if(std::dynamic_pointer_cast<elem_view_meta>(view)){
         draw_meta(pnt, this->default_gate_w/2, this->default_gate_h/2, draw_w, draw_h); 
     }else{
@@ -247,23 +375,19 @@ void sim_interface::draw_elem_view(QPainter &pnt, const std::shared_ptr<elem_vie
     pnt.end();
 
     if(std::dynamic_pointer_cast<elem_view_gate>(view)){
-        auto &gt_parent = *sim.get_by_id(view->id);
-        std::shared_ptr<gate> gt;
-        for(auto gt_v_it = view->gates_in.begin(); !gt && gt_v_it != view->gates_in.end(); gt_v_it++){
-            auto &gt_v = *gt_v_it;
-            auto gt_tmp = gt_parent->find_gate(gt_v->id);
-            if(gt_tmp){
-                gt = std::move(gt_tmp);
-            }
+        //values come from the last snapshot published by the sim thread
+        auto &snap = runner.get_snapshot();
+        auto snap_it = snap.end();
+        for(auto gt_v_it = view->gates_in.begin(); snap_it == snap.end() && gt_v_it != view->gates_in.end(); gt_v_it++){
+            snap_it = snap.find((*gt_v_it)->id);
         }
-        for(auto gt_v_it = view->gates_out.begin(); !gt && gt_v_it != view->gates_out.end(); gt_v_it++){
-            auto &gt_v = *gt_v_it;
-            auto gt_tmp = gt_parent->find_gate(gt_v->id);
-            if(gt_tmp){
-                gt = std::move(gt_tmp);
-            }
+        for(auto gt_v_it = view->gates_out.begin(); snap_it == snap.end() && gt_v_it != view->gates_out.end(); gt_v_it++){
+            snap_it = snap.find((*gt_v_it)->id);
+        }
+        bits::bit_vector bit_val;
+        if(snap_it != snap.end()){
+            bit_val = snap_it->second;
         }
-        auto bit_val = gt->get_values();
         QString txt;
         txt.reserve(bit_val.size());
         for(const auto &bit:bit_val){
@@ -294,7 +418,10 @@ void sim_interface::draw_elem_view(QPainter &pnt, const std::shared_ptr<elem_vie
 
 sim_interface::sim_interface(QWidget* parent)
     :draw_widget(parent),
-    glue(sim_ui_glue::get_instance())
+    glue(sim_ui_glue::get_instance()),
+    runner(sim, [this](){
+        QMetaObject::invokeMethod(this, "on_sim_published", Qt::QueuedConnection);
+    })
 {
     this->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, &QWidget::customContextMenuRequested,
@@ -302,22 +429,69 @@ sim_interface::sim_interface(QWidget* parent)
     //setFocus();
     QWidget::setMouseTracking(true);
     mode = mode::still;
+    frame_timer.setInterval(16);
+    connect(&frame_timer, &QTimer::timeout,
+            this, &sim_interface::on_frame);
 }
 sim_interface::~sim_interface(){}
 
 void sim_interface::try_tick(){
-    try{
-        sim.tick();
-    }catch(std::runtime_error &e){
-        QMessageBox::critical(this, "Error!", QString::fromStdString(e.what()));
+    runner.request_tick();
+}
+
+void sim_interface::on_sim_published(){
+    if(frame_timer.isActive() && !runner.is_running()){
+        //worker stopped on its own, e.g. a tick threw
+        set_running(false);
+        emit sim_running_changed(false);
+    }
+    while(auto err = runner.take_error()){
+        QMessageBox::critical(this, "Error!", QString::fromStdString(*err));
+    }
+    update();
+}
+
+void sim_interface::on_frame(){
+    emit sim_rate_changed(runner.get_rate(), runner.is_quiescent());
+    update();
+}
+
+void sim_interface::set_running(bool running){
+    auto &lg = logger::get_instance();
+    if(running && !frame_timer.isActive()){
+        //logging every value change would flood stdout at these rates
+        log_was_enabled = lg.enabled();
+        lg.set_enabled(false);
+        runner.run(sim_rate);
+        frame_timer.start();
+    }else if(!running && frame_timer.isActive()){
+        runner.pause();
+        frame_timer.stop();
+        lg.set_enabled(log_was_enabled);
+        emit sim_rate_changed(0., false);
+    }
+}
+
+void sim_interface::set_sim_rate(double ticks_per_sec){
+    sim_rate = ticks_per_sec;
+    if(runner.is_running()){
+        runner.run(sim_rate);
+    }
+}
+
+void sim_interface::step_sim(){
+    if(!runner.is_running()){
+        runner.request_tick();
     }
 }
 
 void sim_interface::delete_item_cm(){
     auto &id =this->view->id;
     glue.del_view(id);
+    auto lock = runner.lock_for_edit();
     auto el = sim.get_by_id(id);
     sim.erase(el);
+    try_tick();
     this->view = nullptr;
     emit element_selected(nullptr);
     update();
@@ -327,6 +501,7 @@ void sim_interface::cut_item_cm(){
     update();
 }
 void sim_interface::delete_items_cm(){
+    auto lock = runner.lock_for_edit();
     for(auto el:selected_views){
         glue.del_view(el->id);
         auto el_it = sim.get_by_id(el->id);
@@ -336,6 +511,7 @@ void sim_interface::delete_items_cm(){
             emit element_selected(nullptr);
         }
     }
+    try_tick();
     update();
 }
 void sim_interface::cut_items_cm(){
@@ -347,8 +523,12 @@ void sim_interface::cut_items_cm(){
 void sim_interface::go_up_cm(){
     auto root = glue.get_root();
     std::shared_ptr<elem_view> view = root;
-    place_gates_in(view, *sim.get_by_id(root->id));
-    place_gates_out(view, *sim.get_by_id(root->id));
+    {
+        auto lock = runner.lock_for_edit();
+        auto &ref = *sim.get_by_id(root->id);
+        place_gates_in(view, ref);
+        place_gates_out(view, ref);
+    }
     if(root->parent){
         auto meta_cast = std::dynamic_pointer_cast<elem_view_meta>(root->parent);
         dive_into_meta(meta_cast);
@@ -471,22 +651,22 @@ void sim_interface::dive_into_meta(std::shared_ptr<elem_view_meta> value){
 void sim_interface::set_in_value(std::shared_ptr<elem_view_in> view){
     int input = QInputDialog::getInt(this, "input devimal value", "input decimal value to pass");
     auto bits = bits::to_bits(input);
-    class elem_in* elem_in;
+    size_t out_width;
     try{
+        auto lock = runner.lock_for_edit();
         auto &ref = *sim.get_by_id(view->id);
-        elem_in = dynamic_cast<class elem_in*>(ref.get());
+        out_width = dynamic_cast<class elem_in*>(ref.get())->get_width();
     }catch(std::out_of_range &e){
         qWarning()<<"something went wrong:"<<e.what();
         return;
     }
-    auto out_width = elem_in->get_width();
     if(bits.size() > out_width){
         //TODO:warning
         bits.erase(bits.begin()+out_width, bits.end());
     }else if(bits.size() < out_width){
         bits.resize(out_width);
     }
-    elem_in->set_values(bits);
+    runner.set_input(view->id, std::move(bits));
 }
 
 void sim_interface::mousePressEvent(QMouseEvent *e){
@@ -503,7 +683,9 @@ void sim_interface::mousePressEvent(QMouseEvent *e){
             mode = mode::select;
             view->st = elem_view::state::selected;
             emit element_selected(view);
+            try_tick();
         }else if(e->buttons() & Qt::RightButton){
+            auto lock = runner.lock_for_edit();
             auto el_it = sim.get_by_id(this->view->id);
             sim.erase(el_it);
             view = nullptr;
@@ -651,6 +833,7 @@ void sim_interface::keyReleaseEvent(QKeyEvent* e){
 }
 
 void sim_interface::paintEvent(QPaintEvent *e) {
+    runner.acquire_snapshot();
     draw_widget::clean();
     auto x = this->cam.x;
     auto y = this->cam.y;
@@ -681,9 +864,29 @@ void sim_interface::slot_propery_changed(const prop_pair* prop){
         prop->set_view_value(this->view);
         auto gate_cast = std::dynamic_pointer_cast<gate_view>(view);
         if(gate_cast && prop->name() == "bit_w"){
-            auto view_parent_it = sim.get_by_id(view->parent->id);
-            auto gt = (*view_parent_it)->find_gate(view->id);
-            gt->set_width(gate_cast->bit_width);
+            bool rejected = false;
+            {
+                auto lock = runner.lock_for_edit();
+                auto view_parent_it = sim.get_by_id(view->parent->id);
+                auto gt = (*view_parent_it)->find_gate(view->id);
+                //bitwise gates keep one width for all their gates
+                if(auto bitwise = dynamic_cast<elem_bitwise*>(view_parent_it->get())){
+                    bitwise->set_width(gate_cast->bit_width);
+                }else if((*view_parent_it)->has_fixed_shape()){
+                    gate_cast->bit_width = gt->get_width();
+                    rejected = true;
+                }else{
+                    gt->set_width(gate_cast->bit_width);
+                }
+            }
+            //dialog is modal, runner must not wait on the lock while it is open
+            if(rejected){
+                QMessageBox::critical(this, "Error!",
+                    "width of this gate is set by the element it belongs to");
+                update();
+                return;
+            }
+            try_tick();
             auto func = [this, &gate_cast](std::shared_ptr<gate_view> gt){
                 gt->bit_width = gate_cast->bit_width;
                 for(auto &cn:gt->conn){
@@ -705,6 +908,30 @@ void sim_interface::slot_propery_changed(const prop_pair* prop){
                 func(gt_in);
             }
         }
+        auto rom_cast = std::dynamic_pointer_cast<elem_view_rom>(view);
+        if(rom_cast && prop->name() == "image"){
+            try{
+                auto lock = runner.lock_for_edit();
+                auto rom = dynamic_cast<elem_rom*>(sim.get_by_id(view->id)->get());
+                rom->load_image(rom_cast->image);
+                sim.wake();
+            }catch(std::runtime_error &e){
+                QMessageBox::critical(this, "Error!", e.what());
+            }
+            try_tick();
+        }
+        auto lut_cast = std::dynamic_pointer_cast<elem_view_lut>(view);
+        if(lut_cast && prop->name() == "table"){
+            try{
+                auto lock = runner.lock_for_edit();
+                auto lut = dynamic_cast<elem_lut*>(sim.get_by_id(view->id)->get());
+                lut->set_table(std::stoull(lut_cast->table, nullptr, 16));
+                sim.wake();
+            }catch(std::logic_error &e){
+                QMessageBox::critical(this, "Error!", "table is not a hex number");
+            }
+            try_tick();
+        }
         update();
     }
 }
@@ -718,6 +945,54 @@ void sim_interface::add_elem_or(){
 void sim_interface::add_elem_not(){
     create_elem<elem_not>("not");
 }
+void sim_interface::add_elem_xor(){
+    create_elem<elem_xor>("xor");
+}
+void sim_interface::add_elem_nand(){
+    create_elem<elem_nand>("nand");
+}
+void sim_interface::add_elem_nor(){
+    create_elem<elem_nor>("nor");
+}
+void sim_interface::add_elem_xnor(){
+    create_elem<elem_xnor>("xnor");
+}
+void sim_interface::add_elem_mux(){
+    create_elem<elem_mux>("mux");
+}
+void sim_interface::add_elem_decoder(){
+    create_elem<elem_decoder>("decoder");
+}
+void sim_interface::add_elem_encoder(){
+    create_elem<elem_priority_encoder>("encoder");
+}
+void sim_interface::add_elem_splitter(){
+    create_elem<elem_splitter>("splitter");
+}
+void sim_interface::add_elem_merger(){
+    create_elem<elem_merger>("merger");
+}
+void sim_interface::add_elem_ram(){
+    create_elem<elem_ram>("ram");
+}
+void sim_interface::add_elem_rom(){
+    create_elem<elem_rom>("rom");
+}
+void sim_interface::add_elem_lut(){
+    create_elem<elem_lut>("lut");
+}
+void sim_interface::add_elem_dff(){
+    create_elem<elem_dff>("dff");
+}
+void sim_interface::add_elem_register(){
+    create_elem<elem_register>("register");
+}
+void sim_interface::add_elem_counter(){
+    create_elem<elem_counter>("counter");
+}
+void sim_interface::add_elem_clock(){
+    create_elem<elem_clock>("clock");
+}
 void sim_interface::add_elem_in(){
     create_elem<elem_in>("in");
 }
@@ -730,7 +1005,11 @@ void sim_interface::add_elem_meta(){
 void sim_interface::save_sim(QString path){
     std::filesystem::path std_path = path.toStdString();
     elem_file_saver saver;
-    auto json = saver.to_json(sim.begin(), sim.end());
+    nlohmann::json json;
+    {
+        auto lock = runner.lock_for_edit();
+        json = saver.to_json(sim.begin(), sim.end());
+    }
     saver.save_json(json, std_path);
 }
 void sim_interface::load_sim(QString path){
@@ -738,5 +1017,6 @@ void sim_interface::load_sim(QString path){
     elem_file_saver loader;
     auto json = loader.load_json(std_path);
     class sim tmp(loader.from_json(json)); // to avoid name collision
+    auto lock = runner.lock_for_edit();
     this->sim = std::move(tmp);
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/aig.h"
+#include "sim/cycle_sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that redundant logic reduces to a single and gate...";
+    {
+        //y = ((!!a & b) | (a & b)) ^ ((c | nothing) & zero), and a dead xor
+        class sim s;
+        auto a = std::make_unique<elem_in>("a");
+        auto b = std::make_unique<elem_in>("b");
+        auto c = std::make_unique<elem_in>("c");
+        auto zero = std::make_unique<elem_in>("zero");
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto not2 = std::make_unique<elem_not>("not2");
+        auto and1 = std::make_unique<elem_and>("and1");
+        auto and2 = std::make_unique<elem_and>("and2");
+        auto or1 = std::make_unique<elem_or>("or1");
+        auto or2 = std::make_unique<elem_or>("or2");
+        auto and3 = std::make_unique<elem_and>("and3");
+        auto xor1 = std::make_unique<elem_xor>("xor1");
+        auto dead = std::make_unique<elem_xor>("dead");
+        auto y = std::make_unique<elem_out>("y");
+        a->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(not2->get_in(0));
+        not2->get_out(0)->tie_input(and1->get_in(0));
+        b->get_out(0)->tie_input(and1->get_in(1));
+        a->get_out(0)->tie_input(and2->get_in(0));
+        b->get_out(0)->tie_input(and2->get_in(1));
+        and1->get_out(0)->tie_input(or1->get_in(0));
+        and2->get_out(0)->tie_input(or1->get_in(1));
+        c->get_out(0)->tie_input(or2->get_in(0));
+        or2->get_out(0)->tie_input(and3->get_in(0));
+        zero->get_out(0)->tie_input(and3->get_in(1));
+        or1->get_out(0)->tie_input(xor1->get_in(0));
+        and3->get_out(0)->tie_input(xor1->get_in(1));
+        xor1->get_out(0)->tie_input(y->get_in(0));
+        a->get_out(0)->tie_input(dead->get_in(0));
+        c->get_out(0)->tie_input(dead->get_in(1));
+        auto a_id = a->get_out(0)->get_id();
+        auto b_id = b->get_out(0)->get_id();
+        auto c_id = c->get_out(0)->get_id();
+        auto zero_id = zero->get_out(0)->get_id();
+        auto and1_id = and1->get_out(0)->get_id();
+        auto dead_id = dead->get_out(0)->get_id();
+        auto y_id = y->get_in(0)->get_id();
+        s.emplace(std::move(a));
+        s.emplace(std::move(b));
+        s.emplace(std::move(c));
+        s.emplace(std::move(zero));
+        s.emplace(std::move(not1));
+        s.emplace(std::move(not2));
+        s.emplace(std::move(and1));
+        s.emplace(std::move(and2));
+        s.emplace(std::move(or1));
+        s.emplace(std::move(or2));
+        s.emplace(std::move(and3));
+        s.emplace(std::move(xor1));
+        s.emplace(std::move(dead));
+        s.emplace(std::move(y));
+
+        netlist nl(s);
+        auto zero_net = nl.find_net(zero_id);
+        aig g(nl, {}, {{zero_net, 0}});
+        assert(g.ands_count() == 1);
+        assert(g.get_stats().hashed > 0);
+        assert(g.get_stats().removed > 0);
+        assert(!g.is_kept(nl.find_net(dead_id)));
+        assert(g.is_kept(nl.find_net(and1_id)));
+        bool thrown = false;
+        try{
+            g.set_input(zero_net, 1);
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+
+        cycle_sim cs(nl);
+        size_t ids[] = {a_id, b_id, c_id};
+        for(uint64_t v=0; v<8; v++){
+            for(size_t i=0; i<3; i++){
+                g.set_input(nl.find_net(ids[i]), (v >> i) & 1);
+                cs.set_input(nl.find_net(ids[i]), (v >> i) & 1);
+            }
+            g.evaluate();
+            cs.evaluate();
+            assert(g.get_gate_value(y_id) == cs.get_value(nl.find_net(y_id)));
+            assert(g.get_gate_value(y_id) == ((v & 3) == 3));
+            assert(g.get_gate_value(and1_id) == cs.get_value(nl.find_net(and1_id)));
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that wide combinational elements match cycle based run...";
+    {
+        //mux of 4 bytes selected by two bits, decoder and priority encoder of
+        //the selected byte, lut majority over three of the bytes
+        class sim s;
+        std::vector<size_t> in_ids;
+        auto mux = std::make_unique<elem_mux>("mux", 8, 2);
+        auto sel = std::make_unique<elem_in>("sel", 2);
+        auto enc = std::make_unique<elem_priority_encoder>("enc", 8);
+        auto dec = std::make_unique<elem_decoder>("dec", 3);
+        auto lut = std::make_unique<elem_lut>("lut", 8, 3, 0xe8);
+        std::vector<size_t> observed_ids;
+        for(size_t i=0; i<4; i++){
+            auto in = std::make_unique<elem_in>("d"+std::to_string(i), 8);
+            in->get_out(0)->tie_input(mux->get_in(i));
+            if(i < 3){
+                in->get_out(0)->tie_input(lut->get_in(i));
+            }
+            in_ids.emplace_back(in->get_out(0)->get_id());
+            s.emplace(std::move(in));
+        }
+        sel->get_out(0)->tie_input(mux->get_in(4));
+        mux->get_out(0)->tie_input(enc->get_in(0));
+        enc->get_out(0)->tie_input(dec->get_in(0));
+        in_ids.emplace_back(sel->get_out(0)->get_id());
+        observed_ids = {mux->get_out(0)->get_id(), enc->get_out(0)->get_id(),
+            enc->get_out(1)->get_id(), dec->get_out(0)->get_id(), lut->get_out(0)->get_id()};
+        s.emplace(std::move(sel));
+        s.emplace(std::move(mux));
+        s.emplace(std::move(enc));
+        s.emplace(std::move(dec));
+        s.emplace(std::move(lut));
+
+        netlist nl(s);
+        std::vector<size_t> observed;
+        for(auto &id:observed_ids){
+            observed.emplace_back(nl.find_net(id));
+        }
+        aig g(nl, observed);
+        cycle_sim cs(nl);
+        std::mt19937_64 rng(41);
+        for(size_t round=0; round<200; round++){
+            for(auto &id:in_ids){
+                auto value = rng() >> (rng() % 64);
+                g.set_input(nl.find_net(id), value);
+                cs.set_input(nl.find_net(id), value);
+            }
+            g.evaluate();
+            cs.evaluate();
+            for(auto &net:observed){
+                assert(g.get_value(net) == cs.get_value(net));
+            }
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that registers and counters step like cycle based run...";
+    {
+        class sim s;
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto en = std::make_unique<elem_in>("en");
+        auto clr = std::make_unique<elem_in>("clr");
+        auto cnt = std::make_unique<elem_counter>("cnt", 8);
+        auto acc = std::make_unique<elem_register>("acc", 8);
+        auto split = std::make_unique<elem_splitter>("split", std::vector<size_t>{4, 4});
+        auto merge = std::make_unique<elem_merger>("merge", std::vector<size_t>{4, 4});
+        auto xor3 = std::make_unique<elem_xor>("xor3", 8, 3);
+        clk->get_out(0)->tie_input(cnt->get_in(2));
+        clk->get_out(0)->tie_input(acc->get_in(2));
+        en->get_out(0)->tie_input(cnt->get_in(0));
+        en->get_out(0)->tie_input(acc->get_in(1));
+        clr->get_out(0)->tie_input(cnt->get_in(1));
+        acc->get_out(0)->tie_input(xor3->get_in(0));
+        cnt->get_out(0)->tie_input(xor3->get_in(1));
+        acc->get_out(0)->tie_input(split->get_in(0));
+        split->get_out(0)->tie_input(merge->get_in(1));
+        split->get_out(1)->tie_input(merge->get_in(0));
+        merge->get_out(0)->tie_input(xor3->get_in(2));
+        xor3->get_out(0)->tie_input(acc->get_in(0));
+        auto en_id = en->get_out(0)->get_id();
+        auto clr_id = clr->get_out(0)->get_id();
+        auto acc_id = acc->get_out(0)->get_id();
+        auto cnt_id = cnt->get_out(0)->get_id();
+        s.emplace(std::move(clk));
+        s.emplace(std::move(en));
+        s.emplace(std::move(clr));
+        s.emplace(std::move(cnt));
+        s.emplace(std::move(acc));
+        s.emplace(std::move(split));
+        s.emplace(std::move(merge));
+        s.emplace(std::move(xor3));
+
+        netlist nl(s);
+        auto acc_net = nl.find_net(acc_id);
+        auto cnt_net = nl.find_net(cnt_id);
+        aig g(nl, {acc_net, cnt_net});
+        cycle_sim cs(nl);
+        g.set_input(nl.find_net(en_id), 1);
+        cs.set_input(nl.find_net(en_id), 1);
+        for(size_t cycle=0; cycle<60; cycle++){
+            uint64_t clear = cycle % 17 == 16;
+            g.set_input(nl.find_net(clr_id), clear);
+            cs.set_input(nl.find_net(clr_id), clear);
+            g.step();
+            cs.step();
+            assert(g.get_value(acc_net) == cs.get_value(acc_net));
+            assert(g.get_value(cnt_net) == cs.get_value(cnt_net));
+        }
+        assert(g.get_cycle() == 60);
+    }
+    std::cout<<" done\n";
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/cycle_sim.h"
+#include "sim/batch_sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+//acc = acc ^ count ^ (acc with swapped nibbles), en and clr driving both
+void build(class sim &s){
+    auto clk = std::make_unique<elem_clock>("clk", 1);
+    auto en = std::make_unique<elem_in>("en");
+    auto clr = std::make_unique<elem_in>("clr");
+    auto cnt = std::make_unique<elem_counter>("cnt", 8);
+    auto acc = std::make_unique<elem_register>("acc", 8);
+    auto split = std::make_unique<elem_splitter>("split", std::vector<size_t>{4, 4});
+    auto merge = std::make_unique<elem_merger>("merge", std::vector<size_t>{4, 4});
+    auto xor3 = std::make_unique<elem_xor>("xor3", 8, 3);
+    auto q = std::make_unique<elem_out>("q", 8);
+    auto c = std::make_unique<elem_out>("c", 8);
+    clk->get_out(0)->tie_input(cnt->get_in(2));
+    clk->get_out(0)->tie_input(acc->get_in(2));
+    en->get_out(0)->tie_input(cnt->get_in(0));
+    en->get_out(0)->tie_input(acc->get_in(1));
+    clr->get_out(0)->tie_input(cnt->get_in(1));
+    acc->get_out(0)->tie_input(xor3->get_in(0));
+    cnt->get_out(0)->tie_input(xor3->get_in(1));
+    acc->get_out(0)->tie_input(split->get_in(0));
+    split->get_out(0)->tie_input(merge->get_in(1));
+    split->get_out(1)->tie_input(merge->get_in(0));
+    merge->get_out(0)->tie_input(xor3->get_in(2));
+    xor3->get_out(0)->tie_input(acc->get_in(0));
+    acc->get_out(0)->tie_input(q->get_in(0));
+    cnt->get_out(0)->tie_input(c->get_in(0));
+    s.emplace(std::move(clk));
+    s.emplace(std::move(en));
+    s.emplace(std::move(clr));
+    s.emplace(std::move(cnt));
+    s.emplace(std::move(acc));
+    s.emplace(std::move(split));
+    s.emplace(std::move(merge));
+    s.emplace(std::move(xor3));
+    s.emplace(std::move(q));
+    s.emplace(std::move(c));
+}
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that every stream steps like its own cycle based run...";
+    {
+        class sim s;
+        build(s);
+        netlist nl(s);
+        batch_sim batch(nl);
+        assert(batch.get_inputs().size() == 2);
+        assert(batch.get_outputs().size() == 2);
+        std::mt19937_64 rng(50);
+        std::vector<batch_sim::stream> streams;
+        for(size_t k=0; k<200; k++){
+            auto st = batch.make_stream(1+rng()%80);
+            for(auto &v:st.stimulus){
+                v = (rng()%5 != 0);
+            }
+            streams.emplace_back(std::move(st));
+        }
+        auto single = streams;
+        batch.run(streams, 4);
+        batch.run(single, 1);
+        for(size_t k=0; k<streams.size(); k++){
+            auto &st = streams[k];
+            assert(st.results == single[k].results);
+            assert(st.results.size() == st.cycles*2);
+            cycle_sim cs(nl);
+            for(size_t c=0; c<st.cycles; c++){
+                cs.set_input(batch.get_inputs()[0], st.stimulus[c*2]);
+                cs.set_input(batch.get_inputs()[1], st.stimulus[c*2+1]);
+                cs.step();
+                assert(st.results[c*2] == cs.get_value(batch.get_outputs()[0]));
+                assert(st.results[c*2+1] == cs.get_value(batch.get_outputs()[1]));
+            }
+        }
+        //streams start over from the state the design was compiled in
+        auto again = single;
+        batch.run(again, 3);
+        for(size_t k=0; k<again.size(); k++){
+            assert(again[k].results == single[k].results);
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that batch of a sim takes inputs and outputs in order of creation...";
+    {
+        class sim s;
+        build(s);
+        batch_sim batch(s);
+        auto &nodes = batch.get_netlist().get_nodes();
+        auto &nets = batch.get_netlist().get_nets();
+        assert(nodes[nets[batch.get_inputs()[0]].driver].name == "en");
+        assert(nodes[nets[batch.get_inputs()[1]].driver].name == "clr");
+        //enabled every cycle, cleared on the third: counter reads 1 2 0 1
+        std::vector<batch_sim::stream> streams(1, batch.make_stream(4));
+        streams[0].stimulus = {1, 0, 1, 0, 1, 1, 1, 0};
+        batch.run(streams);
+        assert(streams[0].results[1] == 1);
+        assert(streams[0].results[3] == 2);
+        assert(streams[0].results[5] == 0);
+        assert(streams[0].results[7] == 1);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that batch rejects rams, non inputs and short stimulus...";
+    {
+        class sim s;
+        build(s);
+        netlist nl(s);
+        batch_sim batch(nl);
+        std::vector<batch_sim::stream> streams(1, batch.make_stream(3));
+        streams[0].stimulus.pop_back();
+        bool thrown = false;
+        try{
+            batch.run(streams);
+        }catch(std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+
+        thrown = false;
+        try{
+            batch_sim driven(nl, {batch.get_outputs()[0]}, {});
+        }catch(std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+
+        class sim with_ram;
+        auto addr = std::make_unique<elem_in>("addr", 4);
+        auto data = std::make_unique<elem_in>("data", 8);
+        auto we = std::make_unique<elem_in>("we");
+        auto ram = std::make_unique<elem_ram>("ram", 4, 8);
+        addr->get_out(0)->tie_input(ram->get_in(0));
+        data->get_out(0)->tie_input(ram->get_in(1));
+        we->get_out(0)->tie_input(ram->get_in(2));
+        with_ram.emplace(std::move(addr));
+        with_ram.emplace(std::move(data));
+        with_ram.emplace(std::move(we));
+        with_ram.emplace(std::move(ram));
+        thrown = false;
+        try{
+            batch_sim rejected(with_ram);
+        }catch(std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+    return 0;
+}
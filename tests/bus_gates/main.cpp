@@ -0,0 +1,83 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+template<class Elem, class Op>
+void check_gate(std::mt19937 &gen, const size_t &width, const Op &op){
+    Elem el("el", width);
+    std::vector<bool> a(width), b(width), expected(width);
+    for(size_t i=0; i<width; i++){
+        a[i] = gen()%2;
+        b[i] = gen()%2;
+        expected[i] = op(a[i], b[i]);
+    }
+    el.get_in(0)->set_values(a);
+    if(el.get_ins_size() > 1){
+        el.get_in(1)->set_values(b);
+    }
+    el.process();
+    assert(el.get_out(0)->get_values() == bits::bit_vector(expected));
+}
+
+int main(){
+    logger::get_instance().set_enabled(false);
+    std::mt19937 gen(7);
+
+    std::cout<<"asserting that bit_vector keeps bits past size zero...";
+    {
+        bits::bit_vector vec(70, true);
+        assert(vec.words_size() == 2);
+        assert(vec.word(1) == 0b111111);
+        vec.flip();
+        assert(vec == bits::bit_vector(70));
+        vec.resize(130, true);
+        assert(!vec[69] && vec[70] && vec[129]);
+        assert(vec.word(2) == 0b11);
+        vec.set(0, true);
+        assert(vec.at(0) && vec.to_vector().size() == 130);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that gates work on whole buses...";
+    for(size_t width:{1, 8, 64, 65, 200}){
+        check_gate<elem_and>(gen, width, [](bool a, bool b){ return a && b; });
+        check_gate<elem_or>(gen, width, [](bool a, bool b){ return a || b; });
+        check_gate<elem_not>(gen, width, [](bool a, bool){ return !a; });
+        check_gate<elem_xor>(gen, width, [](bool a, bool b){ return a != b; });
+        check_gate<elem_nand>(gen, width, [](bool a, bool b){ return !(a && b); });
+        check_gate<elem_nor>(gen, width, [](bool a, bool b){ return !(a || b); });
+        check_gate<elem_xnor>(gen, width, [](bool a, bool b){ return a == b; });
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that set_width resizes every gate...";
+    {
+        elem_xor el("xor1");
+        el.set_width(32);
+        assert(el.get_width() == 32);
+        assert(el.get_in(0)->get_width() == 32);
+        assert(el.get_in(1)->get_width() == 32);
+        assert(el.get_out(0)->get_width() == 32);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that netlist evaluates new kinds...";
+    {
+        using types = netlist::types_node;
+        uint64_t ins[2] = {0b1100, 0b1010};
+        auto in = [&ins](const size_t &i){ return ins[i]; };
+        assert((netlist::eval(types::t_xor, 2, in) & 0xf) == 0b0110);
+        assert((netlist::eval(types::t_nand, 2, in) & 0xf) == 0b0111);
+        assert((netlist::eval(types::t_nor, 2, in) & 0xf) == 0b0001);
+        assert((netlist::eval(types::t_xnor, 2, in) & 0xf) == 0b1001);
+
+        class sim sim;
+        sim.emplace(std::make_unique<elem_nor>("nor1", 16));
+        netlist nl(sim);
+        assert(nl.get_nodes().at(0).type == types::t_nor);
+        assert(nl.get_nets().at(nl.get_nodes().at(0).outs.at(0)).width == 16);
+    }
+    std::cout<<" done\n";
+}
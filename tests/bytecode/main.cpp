@@ -0,0 +1,155 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/bytecode.h"
+#include "sim/sim_runner.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <chrono>
+
+struct design{
+    std::vector<elem_in*> ins;
+    std::vector<gate_out*> outs;    //every gate_out, in order of creation
+};
+
+//4 bit ripple carry adder of full adder cells, its carry masked by an
+//inverted hold through an and, a 2:1 mux between that and the lowest sum bit
+//feeding a flip-flop, and a counter, all on one clock
+design build(class sim &s){
+    design d;
+    auto add_in = [&](const std::string &name){
+        auto in = std::make_unique<elem_in>(name);
+        auto ptr = in.get();
+        d.ins.emplace_back(ptr);
+        d.outs.emplace_back(ptr->get_out(0).get());
+        s.emplace(std::move(in));
+        return ptr->get_out(0).get();
+    };
+    auto add = [&](std::unique_ptr<element> el){
+        for(size_t k=0; k<el->get_outs_size(); k++){
+            d.outs.emplace_back(el->get_out(k).get());
+        }
+        auto ptr = el.get();
+        s.emplace(std::move(el));
+        return ptr;
+    };
+    auto carry = add_in("cin");
+    gate_out* sum0 = nullptr;
+    for(int i=0; i<4; i++){
+        auto n = std::to_string(i);
+        auto a = add_in("a"+n);
+        auto b = add_in("b"+n);
+        auto x1 = add(std::make_unique<elem_xor>("x1_"+n));
+        auto x2 = add(std::make_unique<elem_xor>("x2_"+n));
+        auto and1 = add(std::make_unique<elem_and>("and1_"+n));
+        auto and2 = add(std::make_unique<elem_and>("and2_"+n));
+        auto or1 = add(std::make_unique<elem_or>("or1_"+n));
+        a->tie_input(x1->get_in(0));
+        b->tie_input(x1->get_in(1));
+        x1->get_out(0)->tie_input(x2->get_in(0));
+        carry->tie_input(x2->get_in(1));
+        a->tie_input(and1->get_in(0));
+        b->tie_input(and1->get_in(1));
+        x1->get_out(0)->tie_input(and2->get_in(0));
+        carry->tie_input(and2->get_in(1));
+        and1->get_out(0)->tie_input(or1->get_in(0));
+        and2->get_out(0)->tie_input(or1->get_in(1));
+        carry = or1->get_out(0).get();
+        if(!sum0){
+            sum0 = x2->get_out(0).get();
+        }
+    }
+    auto hold = add_in("hold");
+    auto sel = add_in("sel");
+    auto not1 = add(std::make_unique<elem_not>("not1"));
+    auto and3 = add(std::make_unique<elem_and>("and3"));
+    auto mux = add(std::make_unique<elem_mux>("mux"));
+    auto clk = add(std::make_unique<elem_clock>("clk", 1));
+    auto dff = add(std::make_unique<elem_dff>("dff"));
+    auto cnt = add(std::make_unique<elem_counter>("cnt", 4));
+    auto out = std::make_unique<elem_out>("q");
+    hold->tie_input(not1->get_in(0));
+    carry->tie_input(and3->get_in(0));
+    not1->get_out(0)->tie_input(and3->get_in(1));
+    sum0->tie_input(mux->get_in(0));
+    and3->get_out(0)->tie_input(mux->get_in(1));
+    sel->tie_input(mux->get_in(2));
+    mux->get_out(0)->tie_input(dff->get_in(0));
+    clk->get_out(0)->tie_input(dff->get_in(1));
+    sel->tie_input(cnt->get_in(0));
+    hold->tie_input(cnt->get_in(1));
+    clk->get_out(0)->tie_input(cnt->get_in(2));
+    dff->get_out(0)->tie_input(out->get_in(0));
+    d.outs.emplace_back(out->get_outer().get());
+    s.emplace(std::move(out));
+    return d;
+}
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that bytecode engine ticks like element processing...";
+    {
+        class sim tree, compiled;
+        auto d_tree = build(tree);
+        auto d_compiled = build(compiled);
+        auto engine = std::make_unique<bytecode_engine>();
+        auto engine_ptr = engine.get();
+        compiled.set_engine(std::move(engine));
+        std::mt19937 rng(44);
+        for(size_t t=0; t<200; t++){
+            for(size_t i=0; i<d_tree.ins.size(); i++){
+                bool value = rng() & 1;
+                d_tree.ins[i]->set_values({value});
+                d_compiled.ins[i]->set_values({value});
+            }
+            tree.tick();
+            compiled.tick();
+            for(size_t i=0; i<d_tree.outs.size(); i++){
+                assert(d_tree.outs[i]->get_values() == d_compiled.outs[i]->get_values());
+            }
+        }
+        //four full adders, an and-not and a 2:1 mux
+        assert(engine_ptr->get_program()->fused_count() == 6);
+        compiled.set_engine(nullptr);
+        assert(compiled.get_engine() == nullptr);
+        compiled.tick();
+        tree.tick();
+        for(size_t i=0; i<d_tree.outs.size(); i++){
+            assert(d_tree.outs[i]->get_values() == d_compiled.outs[i]->get_values());
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that headless runner ticks with bytecode engine...";
+    {
+        class sim s;
+        auto in = std::make_unique<elem_in>("in1");
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto in_id = in->get_id();
+        auto not_id = not1->get_out(0)->get_id();
+        in->get_out(0)->tie_input(not1->get_in(0));
+        s.emplace(std::move(in));
+        s.emplace(std::move(not1));
+        sim_runner runner(s);
+        runner.set_engine(std::make_unique<bytecode_engine>());
+        auto wait_value = [&](bool expected){
+            bool ok = false;
+            for(int i=0; i<500 && !ok; i++){
+                auto &snap = runner.acquire_snapshot();
+                auto it = snap.find(not_id);
+                ok = it != snap.end() && it->second.at(0) == expected;
+                if(!ok){
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+            assert(ok);
+        };
+        wait_value(true);
+        runner.set_input(in_id, {true});
+        wait_value(false);
+        assert(!runner.take_error());
+    }
+    std::cout<<" done\n";
+    return 0;
+}
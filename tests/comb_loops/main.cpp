@@ -0,0 +1,113 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that not tied to itself oscillates...";
+    {
+        class sim sim;
+        auto not_elem = std::make_unique<elem_not>("not1");
+        not_elem->get_out(0)->tie_input(not_elem->get_in(0));
+        auto out_id = not_elem->get_out(0)->get_id();
+        sim.emplace(std::move(not_elem));
+        sim.set_settle_limit(10);
+        sim.tick();
+        auto &res = sim.get_last_settle();
+        assert(!res.stable);
+        assert(res.passes == 10);
+        auto name = "not1+out_1("+std::to_string(out_id)+")";
+        assert(std::find(res.oscillating.begin(), res.oscillating.end(), name) != res.oscillating.end());
+        netlist nl(sim);
+        assert(nl.get_comb_loops().size() == 1);
+        assert(nl.describe(nl.get_comb_loops().at(0)) == "not1");
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that reverse ordered chain settles in one tick...";
+    {
+        class sim sim;
+        auto in = std::make_unique<elem_in>("in1");
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto not2 = std::make_unique<elem_not>("not2");
+        auto not3 = std::make_unique<elem_not>("not3");
+        auto out = std::make_unique<elem_out>("out1");
+        in->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(not2->get_in(0));
+        not2->get_out(0)->tie_input(not3->get_in(0));
+        not3->get_out(0)->tie_input(out->get_in(0));
+        auto out_ptr = out.get();
+        sim.emplace(std::move(in));
+        sim.emplace(std::move(out));
+        sim.emplace(std::move(not3));
+        sim.emplace(std::move(not2));
+        sim.emplace(std::move(not1));
+        sim.tick();
+        assert(sim.get_last_settle().stable);
+        assert(out_ptr->get_value(0) == true);
+        netlist nl(sim);
+        assert(nl.get_comb_loops().empty());
+        assert(nl.get_inputs().size() == 1);
+        assert(nl.get_outputs().size() == 1);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that latch is a loop but settles...";
+    {
+        //two or+not pairs, cross coupled: set/reset latch
+        class sim sim;
+        auto set = std::make_unique<elem_in>("set");
+        auto reset = std::make_unique<elem_in>("reset");
+        auto or1 = std::make_unique<elem_or>("or1");
+        auto or2 = std::make_unique<elem_or>("or2");
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto not2 = std::make_unique<elem_not>("not2");
+        reset->get_out(0)->tie_input(or1->get_in(0));
+        set->get_out(0)->tie_input(or2->get_in(0));
+        or1->get_out(0)->tie_input(not1->get_in(0));
+        or2->get_out(0)->tie_input(not2->get_in(0));
+        not1->get_out(0)->tie_input(or2->get_in(1));
+        not2->get_out(0)->tie_input(or1->get_in(1));
+        auto set_ptr = set.get();
+        auto q = not1.get();
+        sim.emplace(std::move(set));
+        sim.emplace(std::move(reset));
+        sim.emplace(std::move(or1));
+        sim.emplace(std::move(or2));
+        sim.emplace(std::move(not1));
+        sim.emplace(std::move(not2));
+        set_ptr->set_values({true});
+        sim.tick();
+        assert(sim.get_last_settle().stable);
+        assert(q->get_out(0)->get_value(0) == true);
+        set_ptr->set_values({false});
+        sim.tick();
+        assert(sim.get_last_settle().stable);
+        assert(q->get_out(0)->get_value(0) == true);
+        netlist nl(sim);
+        assert(nl.get_comb_loops().size() == 1);
+        assert(nl.get_comb_loops().at(0).size() == 4);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that loops through metas are named by path...";
+    {
+        class sim sim;
+        auto meta_it = sim.emplace(std::make_unique<elem_meta>("m"));
+        auto in = std::make_unique<elem_in>("in");
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto out = std::make_unique<elem_out>("out");
+        in->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(out->get_in(0));
+        out->get_outer()->tie_input(in->get_outer());
+        sim.emplace(meta_it, std::move(in));
+        sim.emplace(meta_it, std::move(not1));
+        sim.emplace(meta_it, std::move(out));
+        netlist nl(sim);
+        assert(nl.get_comb_loops().size() == 1);
+        assert(nl.describe(nl.get_comb_loops().at(0)) == "m/in -> m/not1 -> m/out");
+    }
+    std::cout<<" done\n";
+}
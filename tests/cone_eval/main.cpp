@@ -0,0 +1,170 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/cone_eval.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    //two independent chains of 100 inverters each, a and b
+    class sim s;
+    size_t in_ids[2], out_ids[2];
+    std::string names[2] = {"a", "b"};
+    for(int c=0; c<2; c++){
+        auto in = std::make_unique<elem_in>(names[c]+"_in", 8);
+        in_ids[c] = in->get_out(0)->get_id();
+        gate_out* prev = in->get_out(0).get();
+        s.emplace(std::move(in));
+        for(int i=0; i<100; i++){
+            auto not1 = std::make_unique<elem_not>(names[c]+std::to_string(i), 8);
+            prev->tie_input(not1->get_in(0));
+            prev = not1->get_out(0).get();
+            s.emplace(std::move(not1));
+        }
+        out_ids[c] = prev->get_id();
+    }
+    netlist nl(s);
+    auto a_in = nl.find_net(in_ids[0]), b_in = nl.find_net(in_ids[1]);
+    auto a_out = nl.find_net(out_ids[0]), b_out = nl.find_net(out_ids[1]);
+
+    std::cout<<"asserting that reading a net evaluates its cone only...";
+    {
+        cone_eval ce(nl);
+        ce.set_input(a_in, 0x0f);
+        assert(ce.get_value(a_out) == 0x0f);
+        assert(ce.evaluations() == 100);
+        //remembered
+        assert(ce.get_value(a_out) == 0x0f);
+        assert(ce.evaluations() == 100);
+        //other chain does not touch this one
+        ce.set_input(b_in, 0xff);
+        assert(ce.get_value(a_out) == 0x0f);
+        assert(ce.evaluations() == 100);
+        assert(ce.get_value(b_out) == 0xff);
+        assert(ce.evaluations() == 200);
+        //same value changes nothing
+        ce.set_input(a_in, 0x0f);
+        assert(ce.get_value(a_out) == 0x0f);
+        assert(ce.evaluations() == 200);
+        ce.set_input(a_in, 0x3c);
+        assert(ce.get_value(a_out) == 0x3c);
+        assert(ce.evaluations() == 300);
+        //halfway down only the upper half is evaluated
+        auto &nodes = nl.get_nodes();
+        size_t middle = 0;
+        for(size_t n=0; n<nodes.size(); n++){
+            if(nodes[n].name == "a49"){
+                middle = nodes[n].outs[0];
+            }
+        }
+        ce.set_input(a_in, 0x01);
+        assert(ce.get_value(middle) == 0x01);
+        assert(ce.evaluations() == 350);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that inputs do not invalidate past state elements...";
+    {
+        //in -> not -> dff d, dff q -> not
+        class sim s;
+        auto in = std::make_unique<elem_in>("in");
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto clk = std::make_unique<elem_clock>("clk");
+        auto dff = std::make_unique<elem_dff>("dff");
+        auto not2 = std::make_unique<elem_not>("not2");
+        auto in_id = in->get_out(0)->get_id();
+        auto out_id = not2->get_out(0)->get_id();
+        auto d_id = not1->get_out(0)->get_id();
+        in->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(dff->get_in(0));
+        clk->get_out(0)->tie_input(dff->get_in(1));
+        dff->get_out(0)->tie_input(not2->get_in(0));
+        s.emplace(std::move(in));
+        s.emplace(std::move(not1));
+        s.emplace(std::move(clk));
+        s.emplace(std::move(dff));
+        s.emplace(std::move(not2));
+        netlist nl(s);
+        cone_eval ce(nl);
+        size_t dff_node = 0, not2_node = 0;
+        for(size_t n=0; n<nl.get_nodes().size(); n++){
+            if(nl.get_nodes()[n].name == "dff"){
+                dff_node = n;
+            }else if(nl.get_nodes()[n].name == "not2"){
+                not2_node = n;
+            }
+        }
+        assert(ce.get_value(nl.find_net(out_id)) == 1);
+        assert(ce.get_value(nl.find_net(d_id)) == 1);
+        auto count = ce.evaluations();
+        ce.set_input(nl.find_net(in_id), 1);
+        assert(ce.is_valid(dff_node));
+        assert(ce.is_valid(not2_node));
+        assert(ce.get_value(nl.find_net(out_id)) == 1);
+        assert(ce.evaluations() == count);
+        assert(ce.get_value(nl.find_net(d_id)) == 0);
+        //new state does
+        ce.set_state(dff_node, 1);
+        assert(!ce.is_valid(not2_node));
+        assert(ce.get_value(nl.find_net(out_id)) == 0);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that ram writes nobody reads are kept over steps...";
+    {
+        class sim s;
+        auto addr = std::make_unique<elem_in>("addr", 2);
+        auto data = std::make_unique<elem_in>("data", 4);
+        auto we = std::make_unique<elem_in>("we");
+        auto ram = std::make_unique<elem_ram>("ram", 2, 4);
+        auto addr_id = addr->get_out(0)->get_id();
+        auto data_id = data->get_out(0)->get_id();
+        auto we_id = we->get_out(0)->get_id();
+        auto out_id = ram->get_out(0)->get_id();
+        addr->get_out(0)->tie_input(ram->get_in(0));
+        data->get_out(0)->tie_input(ram->get_in(1));
+        we->get_out(0)->tie_input(ram->get_in(2));
+        s.emplace(std::move(addr));
+        s.emplace(std::move(data));
+        s.emplace(std::move(we));
+        s.emplace(std::move(ram));
+        netlist nl(s);
+        cone_eval ce(nl);
+        ce.set_input(nl.find_net(addr_id), 1);
+        ce.set_input(nl.find_net(data_id), 9);
+        ce.set_input(nl.find_net(we_id), 1);
+        ce.step();
+        ce.set_input(nl.find_net(we_id), 0);
+        ce.set_input(nl.find_net(data_id), 0);
+        ce.set_input(nl.find_net(addr_id), 2);
+        ce.step();
+        assert(ce.get_value(nl.find_net(out_id)) == 0);
+        ce.set_input(nl.find_net(addr_id), 1);
+        ce.step();
+        assert(ce.get_value(nl.find_net(out_id)) == 9);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that a loop in the cone is reported...";
+    {
+        class sim s;
+        auto in = std::make_unique<elem_in>("in");
+        auto or1 = std::make_unique<elem_or>("or1");
+        auto out_id = or1->get_out(0)->get_id();
+        in->get_out(0)->tie_input(or1->get_in(0));
+        or1->get_out(0)->tie_input(or1->get_in(1));
+        s.emplace(std::move(in));
+        s.emplace(std::move(or1));
+        netlist nl(s);
+        cone_eval ce(nl);
+        bool thrown = false;
+        try{
+            ce.get_value(nl.find_net(out_id));
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+}
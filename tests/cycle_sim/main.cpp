@@ -0,0 +1,109 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/cycle_sim.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    //acc = acc ^ count ^ (acc with swapped nibbles), one clock for both registers
+    class sim s;
+    auto clk = std::make_unique<elem_clock>("clk", 1);
+    auto en = std::make_unique<elem_in>("en");
+    auto clr = std::make_unique<elem_in>("clr");
+    auto cnt = std::make_unique<elem_counter>("cnt", 8);
+    auto acc = std::make_unique<elem_register>("acc", 8);
+    auto split = std::make_unique<elem_splitter>("split", std::vector<size_t>{4, 4});
+    auto merge = std::make_unique<elem_merger>("merge", std::vector<size_t>{4, 4});
+    auto xor3 = std::make_unique<elem_xor>("xor3", 8, 3);
+    clk->get_out(0)->tie_input(cnt->get_in(2));
+    clk->get_out(0)->tie_input(acc->get_in(2));
+    en->get_out(0)->tie_input(cnt->get_in(0));
+    en->get_out(0)->tie_input(acc->get_in(1));
+    clr->get_out(0)->tie_input(cnt->get_in(1));
+    acc->get_out(0)->tie_input(xor3->get_in(0));
+    cnt->get_out(0)->tie_input(xor3->get_in(1));
+    acc->get_out(0)->tie_input(split->get_in(0));
+    split->get_out(0)->tie_input(merge->get_in(1));
+    split->get_out(1)->tie_input(merge->get_in(0));
+    merge->get_out(0)->tie_input(xor3->get_in(2));
+    xor3->get_out(0)->tie_input(acc->get_in(0));
+    auto en_ptr = en.get();
+    auto acc_ptr = acc.get();
+    auto en_id = en->get_out(0)->get_id();
+    auto acc_id = acc->get_out(0)->get_id();
+    s.emplace(std::move(clk));
+    s.emplace(std::move(en));
+    s.emplace(std::move(clr));
+    s.emplace(std::move(cnt));
+    s.emplace(std::move(acc));
+    s.emplace(std::move(split));
+    s.emplace(std::move(merge));
+    s.emplace(std::move(xor3));
+
+    std::cout<<"asserting that cycle based run matches tick based one...";
+    {
+        netlist nl(s);
+        assert(cycle_sim::check(nl).empty());
+        cycle_sim cs(nl);
+        auto acc_net = nl.find_net(acc_id);
+        cs.set_input(nl.find_net(en_id), 1);
+        en_ptr->set_values({true});
+        //clock rises on every other tick, first time on first one
+        for(size_t cycle=0; cycle<50; cycle++){
+            s.tick();
+            cs.step();
+            assert(cs.get_value(acc_net) == acc_ptr->get_out(0)->get_values().word(0));
+            s.tick();
+        }
+        assert(cs.get_cycle() == 50);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that designs needing events are rejected...";
+    {
+        auto rejected = [](sim &s){
+            netlist nl(s);
+            bool thrown = false;
+            try{
+                cycle_sim cs(nl);
+            }catch(std::runtime_error &e){
+                thrown = true;
+            }
+            return thrown && !cycle_sim::check(nl).empty();
+        };
+        {
+            //register clocked by inverted clock
+            class sim s;
+            auto clk = std::make_unique<elem_clock>("clk", 1);
+            auto not1 = std::make_unique<elem_not>("not1");
+            auto ff = std::make_unique<elem_dff>("ff");
+            clk->get_out(0)->tie_input(not1->get_in(0));
+            not1->get_out(0)->tie_input(ff->get_in(1));
+            s.emplace(std::move(clk));
+            s.emplace(std::move(not1));
+            s.emplace(std::move(ff));
+            assert(rejected(s));
+        }
+        {
+            //clock used as data
+            class sim s;
+            auto clk = std::make_unique<elem_clock>("clk", 1);
+            auto ff = std::make_unique<elem_dff>("ff");
+            clk->get_out(0)->tie_input(ff->get_in(0));
+            clk->get_out(0)->tie_input(ff->get_in(1));
+            s.emplace(std::move(clk));
+            s.emplace(std::move(ff));
+            assert(rejected(s));
+        }
+        {
+            class sim s;
+            auto not1 = std::make_unique<elem_not>("not1");
+            not1->get_out(0)->tie_input(not1->get_in(0));
+            s.emplace(std::move(not1));
+            assert(rejected(s));
+        }
+    }
+    std::cout<<" done\n";
+}
@@ -0,0 +1,109 @@
+#include "sim/sim.h"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    //y = a & b, next to scratch logic that drives nothing: a chain of nots
+    //and a meta whose output is not tied anywhere
+    class sim sim;
+    auto a = std::make_unique<elem_in>("a");
+    auto b = std::make_unique<elem_in>("b");
+    auto and1 = std::make_unique<elem_and>("and1");
+    auto y = std::make_unique<elem_out>("y");
+    a->get_out(0)->tie_input(and1->get_in(0));
+    b->get_out(0)->tie_input(and1->get_in(1));
+    and1->get_out(0)->tie_input(y->get_in(0));
+    std::vector<size_t> scratch_ids;
+    gate_out* prev = a->get_out(0).get();
+    for(int i=0; i<20; i++){
+        auto not1 = std::make_unique<elem_not>("not"+std::to_string(i));
+        prev->tie_input(not1->get_in(0));
+        prev = not1->get_out(0).get();
+        scratch_ids.emplace_back(not1->get_id());
+        sim.emplace(std::move(not1));
+    }
+    auto last_not = prev;
+    auto meta_it = sim.emplace(std::make_unique<elem_meta>("scratch"));
+    auto m_in = std::make_unique<elem_in>("m_in");
+    auto m_not = std::make_unique<elem_not>("m_not");
+    auto m_out = std::make_unique<elem_out>("m_out");
+    m_in->get_out(0)->tie_input(m_not->get_in(0));
+    m_not->get_out(0)->tie_input(m_out->get_in(0));
+    b->get_out(0)->tie_input(m_in->get_outer());
+    auto meta_id = (*meta_it)->get_id();
+    sim.emplace(meta_it, std::move(m_in));
+    sim.emplace(meta_it, std::move(m_not));
+    sim.emplace(meta_it, std::move(m_out));
+    auto a_ptr = a.get();
+    auto b_ptr = b.get();
+    auto y_ptr = y.get();
+    sim.emplace(std::move(a));
+    sim.emplace(std::move(b));
+    sim.emplace(std::move(and1));
+    sim.emplace(std::move(y));
+
+    std::cout<<"asserting that logic driving nothing is not evaluated...";
+    {
+        assert(sim.get_pruned().empty());
+        a_ptr->set_values({true});
+        b_ptr->set_values({true});
+        sim.tick();
+        auto full = sim.get_last_settle().processed;
+
+        sim.set_pruning(true);
+        auto pruned = sim.get_pruned();
+        for(auto &id:scratch_ids){
+            assert(std::count(pruned.begin(), pruned.end(), id) == 1);
+        }
+        assert(std::count(pruned.begin(), pruned.end(), meta_id) == 1);
+        assert(pruned.size() == scratch_ids.size()+4);
+        b_ptr->set_values({false});
+        sim.tick();
+        assert(y_ptr->get_outer()->get_value(0) == false);
+        b_ptr->set_values({true});
+        sim.tick();
+        assert(y_ptr->get_outer()->get_value(0) == true);
+        assert(sim.get_last_settle().processed*4 < full);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that watched gates are kept up to date...";
+    {
+        sim.watch(last_not->get_id());
+        assert(sim.get_pruned().size() == 4);
+        a_ptr->set_values({false});
+        sim.tick();
+        assert(last_not->get_value(0) == false);
+        a_ptr->set_values({true});
+        sim.tick();
+        assert(last_not->get_value(0) == true);
+        sim.unwatch(last_not->get_id());
+        assert(sim.get_pruned().size() == scratch_ids.size()+4);
+        sim.set_pruning(false);
+        assert(sim.get_pruned().empty());
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that changes of pruned inputs let circuit go quiescent...";
+    {
+        auto unused = std::make_unique<elem_in>("unused");
+        auto unused_ptr = unused.get();
+        sim.emplace(std::move(unused));
+        sim.set_pruning(true);
+        auto pruned = sim.get_pruned();
+        assert(std::count(pruned.begin(), pruned.end(), unused_ptr->get_id()) == 1);
+        while(sim.tick());
+        assert(sim.is_quiescent());
+        unused_ptr->set_values({true});
+        b_ptr->set_values({false});
+        assert(sim.tick());
+        assert(y_ptr->get_outer()->get_value(0) == false);
+        assert(sim.is_quiescent());
+        assert(!sim.tick());
+    }
+    std::cout<<" done\n";
+    return 0;
+}
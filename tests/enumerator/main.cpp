@@ -0,0 +1,181 @@
+#include "sim/sim.h"
+#include "sim/enumerator.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that outputs of root are enumerated...";
+    {
+        class sim s;
+        auto a = std::make_unique<elem_in>("a");
+        auto b = std::make_unique<elem_in>("b");
+        auto and1 = std::make_unique<elem_and>("and1");
+        auto y = std::make_unique<elem_out>("y");
+        a->get_out(0)->tie_input(and1->get_in(0));
+        b->get_out(0)->tie_input(and1->get_in(1));
+        and1->get_out(0)->tie_input(y->get_in(0));
+        s.emplace(std::move(a));
+        s.emplace(std::move(b));
+        s.emplace(std::move(and1));
+        s.emplace(std::move(y));
+        enumerator en(s);
+        assert(en.rows() == 4);
+        assert(en.table() == std::vector<uint64_t>({0, 0, 0, 1}));
+        assert(en.verify(std::vector<uint64_t>{0, 0, 0, 1}).empty());
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that a meta is enumerated apart from what drives it...";
+    {
+        //y = (a & b) ^ c on 6 bit buses, a driven by an inverter outside
+        class sim s;
+        auto src = std::make_unique<elem_in>("src", 6);
+        auto not1 = std::make_unique<elem_not>("not1", 6);
+        auto meta_it = s.emplace(std::make_unique<elem_meta>("block"));
+        auto meta = dynamic_cast<elem_meta*>(meta_it->get());
+        auto a = std::make_unique<elem_in>("a", 6);
+        auto b = std::make_unique<elem_in>("b", 6);
+        auto c = std::make_unique<elem_in>("c", 6);
+        auto and1 = std::make_unique<elem_and>("and1", 6);
+        auto xor1 = std::make_unique<elem_xor>("xor1", 6);
+        auto y = std::make_unique<elem_out>("y", 6);
+        src->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(a->get_outer());
+        a->get_out(0)->tie_input(and1->get_in(0));
+        b->get_out(0)->tie_input(and1->get_in(1));
+        and1->get_out(0)->tie_input(xor1->get_in(0));
+        c->get_out(0)->tie_input(xor1->get_in(1));
+        xor1->get_out(0)->tie_input(y->get_in(0));
+        s.emplace(std::move(src));
+        s.emplace(std::move(not1));
+        s.emplace(meta_it, std::move(a));
+        s.emplace(meta_it, std::move(b));
+        s.emplace(meta_it, std::move(c));
+        s.emplace(meta_it, std::move(and1));
+        s.emplace(meta_it, std::move(xor1));
+        s.emplace(meta_it, std::move(y));
+
+        enumerator en(s, meta);
+        assert(en.get_ins_width() == 18);
+        assert(en.get_outs_width() == 6);
+        auto right = [](const uint64_t &row){
+            return ((row & 63) & ((row >> 6) & 63)) ^ (row >> 12);
+        };
+        auto wrong = [](const uint64_t &row){
+            return ((row & 63) | ((row >> 6) & 63)) ^ (row >> 12);
+        };
+        assert(en.verify(right).empty());
+        std::vector<enumerator::mismatch> expected;
+        for(uint64_t row=0; expected.size()<5; row++){
+            if(right(row) != wrong(row)){
+                expected.emplace_back(enumerator::mismatch{row, wrong(row), right(row)});
+            }
+        }
+        for(size_t threads:{size_t(1), size_t(4)}){
+            auto found = en.verify(wrong, 5, threads);
+            assert(found.size() == 5);
+            for(size_t i=0; i<5; i++){
+                assert(found[i].row == expected[i].row);
+                assert(found[i].expected == expected[i].expected);
+                assert(found[i].actual == expected[i].actual);
+            }
+        }
+        auto table = en.table(3);
+        for(uint64_t row=0; row<en.rows(); row++){
+            assert(table[row] == right(row));
+        }
+        for(size_t threads:{size_t(1), size_t(4)}){
+            uint64_t next = 0;
+            en.stream([&](const uint64_t &row, const uint64_t &value){
+                assert(row == next++);
+                assert(value == right(row));
+            }, threads);
+            assert(next == en.rows());
+        }
+
+        assert(en.get_input_names() == std::vector<std::string>({"a", "b", "c"}));
+        assert(en.get_output_names() == std::vector<std::string>({"y"}));
+        assert(en.verify(en.expected_by({"a & b ^ c"})).empty());
+        auto found = en.verify(en.expected_by({"(a | b) ^ c"}), 5);
+        assert(found.size() == 5 && found[0].row == expected[0].row);
+        bool thrown = false;
+        try{
+            en.expected_by({"a & d"});
+        }catch(std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that expressions follow precedence of C...";
+    {
+        std::vector<std::string> names{"x", "y_1"};
+        std::vector<uint64_t> values{6, 3};
+        assert(expression("x + y_1 * 2", names).evaluate(values) == 12);
+        assert(expression("(x + y_1) * 2", names).evaluate(values) == 18);
+        assert(expression("x & y_1 | 8 ^ 1", names).evaluate(values) == ((6 & 3) | (8 ^ 1)));
+        assert(expression("1 << x >> y_1", names).evaluate(values) == 8);
+        assert(expression("x > y_1 && !(x == 0x6) || ~0 == -1", names).evaluate(values) == 1);
+        assert(expression("x - y_1 - 1", names).evaluate(values) == 2);
+        assert(expression("x / 0 + x % 4 + (x << 64)", names).evaluate(values) == 2);
+        for(auto bad:{"x +", "(x", "x y_1", "z", "x $ 1", ""}){
+            bool thrown = false;
+            try{
+                expression(bad, names);
+            }catch(std::runtime_error&){
+                thrown = true;
+            }
+            assert(thrown);
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that wide inputs are streamed, not tabulated...";
+    {
+        //x = a ^ b and y = a & b on 12 bit inputs, c unused, 2^25 rows
+        class sim s;
+        auto a = std::make_unique<elem_in>("a", 12);
+        auto b = std::make_unique<elem_in>("b", 12);
+        auto c = std::make_unique<elem_in>("c");
+        auto xor1 = std::make_unique<elem_xor>("xor1", 12);
+        auto and1 = std::make_unique<elem_and>("and1", 12);
+        auto x = std::make_unique<elem_out>("x", 12);
+        auto y = std::make_unique<elem_out>("y", 12);
+        a->get_out(0)->tie_input(xor1->get_in(0));
+        b->get_out(0)->tie_input(xor1->get_in(1));
+        a->get_out(0)->tie_input(and1->get_in(0));
+        b->get_out(0)->tie_input(and1->get_in(1));
+        xor1->get_out(0)->tie_input(x->get_in(0));
+        and1->get_out(0)->tie_input(y->get_in(0));
+        s.emplace(std::move(a));
+        s.emplace(std::move(b));
+        s.emplace(std::move(c));
+        s.emplace(std::move(xor1));
+        s.emplace(std::move(and1));
+        s.emplace(std::move(x));
+        s.emplace(std::move(y));
+        enumerator en(s);
+        assert(en.get_ins_width() > enumerator::max_table_width);
+        bool thrown = false;
+        try{
+            en.table();
+        }catch(std::runtime_error&){
+            thrown = true;
+        }
+        assert(thrown);
+        uint64_t next = 0;
+        bool in_order = true;
+        en.stream([&](const uint64_t &row, const uint64_t &value){
+            auto lo = row & 0xfff, hi = (row >> 12) & 0xfff;
+            in_order = in_order && row == next++ && value == ((lo ^ hi) | (lo & hi) << 12);
+        });
+        assert(in_order && next == en.rows());
+        assert(en.verify(en.expected_by({"a ^ b", "a & b"})).empty());
+        assert(en.verify(en.expected_by({"a ^ b", "0"}), 1)[0].row == (uint64_t(1) << 12)+1);
+    }
+    std::cout<<" done\n";
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include "sim/sim.h"
+#include "sim/file_ops.h"
+#include "sim/equivalence.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <filesystem>
+
+//n bit ripple carry adder a+b+cin to s and cout; xors built of four nands
+//when "nands" is set, bit "broken" gets an or for its carry and instead of an or
+void build_adder(class sim &s, const size_t &n, bool nands, const size_t &broken = ~size_t(0)){
+    auto a = std::make_unique<elem_in>("a", n);
+    auto b = std::make_unique<elem_in>("b", n);
+    auto cin = std::make_unique<elem_in>("cin");
+    auto split_a = std::make_unique<elem_splitter>("split_a", std::vector<size_t>(n, 1));
+    auto split_b = std::make_unique<elem_splitter>("split_b", std::vector<size_t>(n, 1));
+    auto merge = std::make_unique<elem_merger>("merge", std::vector<size_t>(n, 1));
+    auto sum = std::make_unique<elem_out>("s", n);
+    auto cout = std::make_unique<elem_out>("cout");
+    a->get_out(0)->tie_input(split_a->get_in(0));
+    b->get_out(0)->tie_input(split_b->get_in(0));
+    merge->get_out(0)->tie_input(sum->get_in(0));
+    gate_out* carry = cin->get_out(0).get();
+    auto add_xor = [&](gate_out* x, gate_out* y, const std::string &name){
+        if(!nands){
+            auto x1 = std::make_unique<elem_xor>(name);
+            x->tie_input(x1->get_in(0));
+            y->tie_input(x1->get_in(1));
+            auto out = x1->get_out(0).get();
+            s.emplace(std::move(x1));
+            return out;
+        }
+        auto n1 = std::make_unique<elem_nand>(name+"_1");
+        auto n2 = std::make_unique<elem_nand>(name+"_2");
+        auto n3 = std::make_unique<elem_nand>(name+"_3");
+        auto n4 = std::make_unique<elem_nand>(name+"_4");
+        x->tie_input(n1->get_in(0));
+        y->tie_input(n1->get_in(1));
+        x->tie_input(n2->get_in(0));
+        n1->get_out(0)->tie_input(n2->get_in(1));
+        y->tie_input(n3->get_in(0));
+        n1->get_out(0)->tie_input(n3->get_in(1));
+        n2->get_out(0)->tie_input(n4->get_in(0));
+        n3->get_out(0)->tie_input(n4->get_in(1));
+        auto out = n4->get_out(0).get();
+        s.emplace(std::move(n1));
+        s.emplace(std::move(n2));
+        s.emplace(std::move(n3));
+        s.emplace(std::move(n4));
+        return out;
+    };
+    for(size_t i=0; i<n; i++){
+        auto name = std::to_string(i);
+        auto x1 = add_xor(split_a->get_out(i).get(), split_b->get_out(i).get(), "x1_"+name);
+        auto x2 = add_xor(x1, carry, "x2_"+name);
+        x2->tie_input(merge->get_in(i));
+        auto and1 = std::make_unique<elem_and>("and1_"+name);
+        split_a->get_out(i)->tie_input(and1->get_in(0));
+        split_b->get_out(i)->tie_input(and1->get_in(1));
+        std::unique_ptr<element> and2;
+        if(i == broken){
+            and2 = std::make_unique<elem_or>("or2_"+name);
+        }else{
+            and2 = std::make_unique<elem_and>("and2_"+name);
+        }
+        x1->tie_input(and2->get_in(0));
+        carry->tie_input(and2->get_in(1));
+        auto or1 = std::make_unique<elem_or>("or1_"+name);
+        and1->get_out(0)->tie_input(or1->get_in(0));
+        and2->get_out(0)->tie_input(or1->get_in(1));
+        carry = or1->get_out(0).get();
+        s.emplace(std::move(and1));
+        s.emplace(std::move(and2));
+        s.emplace(std::move(or1));
+    }
+    carry->tie_input(cout->get_in(0));
+    s.emplace(std::move(a));
+    s.emplace(std::move(b));
+    s.emplace(std::move(cin));
+    s.emplace(std::move(split_a));
+    s.emplace(std::move(split_b));
+    s.emplace(std::move(merge));
+    s.emplace(std::move(sum));
+    s.emplace(std::move(cout));
+}
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that SAT solver tells pigeonholes from random satisfiable sets...";
+    {
+        //4 pigeons in 3 holes
+        sat_solver pigeons;
+        auto var = [](const size_t &p, const size_t &h){
+            return sat_solver::literal((p*3+h) << 1);
+        };
+        for(size_t i=0; i<12; i++){
+            pigeons.new_var();
+        }
+        for(size_t p=0; p<4; p++){
+            pigeons.add_clause({var(p, 0), var(p, 1), var(p, 2)});
+        }
+        for(size_t h=0; h<3; h++){
+            for(size_t p=0; p<4; p++){
+                for(size_t q=p+1; q<4; q++){
+                    pigeons.add_clause({var(p, h)^1, var(q, h)^1});
+                }
+            }
+        }
+        assert(pigeons.solve() == sat_solver::results::r_unsat);
+
+        //3-SAT planted on a hidden assignment
+        std::mt19937 rng(48);
+        sat_solver planted;
+        std::vector<bool> hidden;
+        for(size_t i=0; i<60; i++){
+            planted.new_var();
+            hidden.emplace_back(rng() & 1);
+        }
+        std::vector<std::vector<sat_solver::literal>> clauses;
+        while(clauses.size() < 250){
+            std::vector<sat_solver::literal> c;
+            bool holds = false;
+            for(int k=0; k<3; k++){
+                auto v = rng() % 60;
+                bool negated = rng() & 1;
+                c.emplace_back(sat_solver::literal(v << 1) | negated);
+                holds = holds || (hidden[v] != negated);
+            }
+            if(holds){
+                clauses.emplace_back(c);
+                planted.add_clause(c);
+            }
+        }
+        assert(planted.solve() == sat_solver::results::r_sat);
+        for(auto &c:clauses){
+            bool holds = false;
+            for(auto &lit:c){
+                holds = holds || (planted.model_value(lit >> 1) != bool(lit & 1));
+            }
+            assert(holds);
+        }
+        assert(planted.solve({sat_solver::literal(0), sat_solver::literal(1)}) == sat_solver::results::r_unsat);
+        assert(planted.solve() == sat_solver::results::r_sat);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that small adders are checked over every input...";
+    {
+        class sim plain, nanded, broken;
+        build_adder(plain, 4, false);
+        build_adder(nanded, 4, true);
+        build_adder(broken, 4, true, 2);
+        auto same = equivalence::check(plain, plain);
+        assert(same.verdict == equivalence::verdicts::v_equivalent);
+        assert(same.by_structure == 5);
+        auto r = equivalence::check(plain, nanded);
+        assert(r.verdict == equivalence::verdicts::v_equivalent);
+        assert(r.by_simulation+r.by_structure == 5);
+        r = equivalence::check(plain, broken);
+        assert(r.verdict == equivalence::verdicts::v_different);
+        assert(!r.differing.empty());
+        //the counterexample really tells them apart
+        auto a = r.counterexample.at("a"), b = r.counterexample.at("b"), cin = r.counterexample.at("cin");
+        auto good = a+b+cin;
+        uint64_t bad_carry = cin, bad = 0;
+        for(size_t i=0; i<4; i++){
+            auto x = ((a >> i) ^ (b >> i)) & 1;
+            bad |= (x ^ bad_carry) << i;
+            auto and2 = (i == 2)? (x | bad_carry) : (x & bad_carry);
+            bad_carry = (((a >> i) & (b >> i)) & 1) | and2;
+        }
+        bad |= bad_carry << 4;
+        assert(good != bad);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that wide adders in files are proven or refuted by SAT...";
+    {
+        class sim plain, nanded, broken;
+        build_adder(plain, 24, false);
+        build_adder(nanded, 24, true);
+        build_adder(broken, 24, true, 17);
+        auto dir = std::filesystem::temp_directory_path();
+        elem_file_saver saver;
+        saver.save_json(saver.to_json(plain.begin(), plain.end()), dir/"eq_plain.json");
+        saver.save_json(saver.to_json(nanded.begin(), nanded.end()), dir/"eq_nanded.json");
+        auto r = equivalence::check_files((dir/"eq_plain.json").string(), (dir/"eq_nanded.json").string());
+        assert(r.verdict == equivalence::verdicts::v_equivalent);
+        assert(r.by_sat > 0);
+        assert(r.by_sat+r.by_structure == 25);
+        r = equivalence::check(plain, broken);
+        assert(r.verdict == equivalence::verdicts::v_different);
+        std::filesystem::remove(dir/"eq_plain.json");
+        std::filesystem::remove(dir/"eq_nanded.json");
+    }
+    std::cout<<" done\n";
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/fault_sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <sstream>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that stuck-at faults of an and need every input pattern but 00...";
+    {
+        class sim s;
+        auto a = std::make_unique<elem_in>("a");
+        auto b = std::make_unique<elem_in>("b");
+        auto and1 = std::make_unique<elem_and>("and1");
+        auto y = std::make_unique<elem_out>("y");
+        a->get_out(0)->tie_input(and1->get_in(0));
+        b->get_out(0)->tie_input(and1->get_in(1));
+        and1->get_out(0)->tie_input(y->get_in(0));
+        s.emplace(std::move(a));
+        s.emplace(std::move(b));
+        s.emplace(std::move(and1));
+        s.emplace(std::move(y));
+
+        netlist nl(s);
+        fault_sim fs(nl);
+        std::istringstream ones("a b  # header\n1 1\n");
+        auto r = fs.run(stimulus::parse(ones, nl));
+        assert(r.faults == fs.get_faults().size());
+        assert(r.unobservable == 0);
+        assert(r.detected*2 == r.faults);
+        for(auto &f:fs.get_faults()){
+            assert(f.detected == !f.stuck);
+        }
+        std::istringstream all("a b\n1 1\n0 1\n0x1 0x0\n");
+        r = fs.run(stimulus::parse(all, nl));
+        assert(r.detected == r.faults);
+        assert(r.coverage() == 1.0);
+
+        bool thrown = false;
+        try{
+            std::istringstream bad("a c\n1 1\n");
+            stimulus::parse(bad, nl);
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that faults behind a flip-flop show a cycle later...";
+    {
+        class sim s;
+        //flip-flop placed before its input, whose variable comes after
+        auto d = std::make_unique<elem_in>("d");
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto dff = std::make_unique<elem_dff>("dff");
+        auto q = std::make_unique<elem_out>("q");
+        d->get_out(0)->tie_input(dff->get_in(0));
+        clk->get_out(0)->tie_input(dff->get_in(1));
+        dff->get_out(0)->tie_input(q->get_in(0));
+        auto d_id = d->get_out(0)->get_id();
+        s.emplace(std::move(dff));
+        s.emplace(std::move(d));
+        s.emplace(std::move(clk));
+        s.emplace(std::move(q));
+
+        netlist nl(s);
+        fault_sim fs(nl);
+        std::istringstream rows("d\n1\n0\n");
+        auto r = fs.run(stimulus::parse(rows, nl));
+        //inverted output of the flip-flop is observed by nothing
+        assert(r.unobservable == 2);
+        auto d_net = nl.find_net(d_id);
+        for(auto &f:fs.get_faults()){
+            if(f.net == d_net){
+                assert(f.detected == !f.stuck);
+                assert(!f.detected || f.cycle == 1);
+            }
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that observed bits of a partly read net are simulated...";
+    {
+        //only bit 0 of an 8 bit register reaches an output
+        class sim s;
+        auto d = std::make_unique<elem_in>("d", 8);
+        auto en = std::make_unique<elem_in>("en");
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto reg = std::make_unique<elem_register>("reg", 8);
+        auto split = std::make_unique<elem_splitter>("split", 8);
+        auto q = std::make_unique<elem_out>("q");
+        d->get_out(0)->tie_input(reg->get_in(0));
+        en->get_out(0)->tie_input(reg->get_in(1));
+        clk->get_out(0)->tie_input(reg->get_in(2));
+        reg->get_out(0)->tie_input(split->get_in(0));
+        split->get_out(0)->tie_input(q->get_in(0));
+        auto reg_id = reg->get_out(0)->get_id();
+        s.emplace(std::move(d));
+        s.emplace(std::move(en));
+        s.emplace(std::move(clk));
+        s.emplace(std::move(reg));
+        s.emplace(std::move(split));
+        s.emplace(std::move(q));
+
+        netlist nl(s);
+        fault_sim fs(nl);
+        std::istringstream rows("d en\n0xff 1\n0 1\n");
+        auto r = fs.run(stimulus::parse(rows, nl));
+        auto reg_net = nl.find_net(reg_id);
+        size_t reg_detected = 0;
+        for(auto &f:fs.get_faults()){
+            if(f.net == reg_net){
+                assert(f.detected == (f.bit == 0));
+                reg_detected += f.detected;
+            }
+        }
+        assert(reg_detected == 2);
+        //bits 1 to 7 of d and of the register
+        //bits 1 to 7 of the register; d still feeds its next state
+        assert(r.unobservable == 14);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that adder faults are covered the same on any number of threads...";
+    {
+        class sim s;
+        std::vector<elem_in*> ins;
+        auto add_in = [&](const std::string &name){
+            auto in = std::make_unique<elem_in>(name);
+            auto ptr = in->get_out(0).get();
+            ins.emplace_back(in.get());
+            s.emplace(std::move(in));
+            return ptr;
+        };
+        gate_out* carry = add_in("cin");
+        for(int i=0; i<8; i++){
+            auto n = std::to_string(i);
+            auto a = add_in("a"+n);
+            auto b = add_in("b"+n);
+            auto x1 = std::make_unique<elem_xor>("x1_"+n);
+            auto x2 = std::make_unique<elem_xor>("x2_"+n);
+            auto and1 = std::make_unique<elem_and>("and1_"+n);
+            auto and2 = std::make_unique<elem_and>("and2_"+n);
+            auto or1 = std::make_unique<elem_or>("or1_"+n);
+            auto sum = std::make_unique<elem_out>("s"+n);
+            a->tie_input(x1->get_in(0));
+            b->tie_input(x1->get_in(1));
+            x1->get_out(0)->tie_input(x2->get_in(0));
+            carry->tie_input(x2->get_in(1));
+            a->tie_input(and1->get_in(0));
+            b->tie_input(and1->get_in(1));
+            x1->get_out(0)->tie_input(and2->get_in(0));
+            carry->tie_input(and2->get_in(1));
+            and1->get_out(0)->tie_input(or1->get_in(0));
+            and2->get_out(0)->tie_input(or1->get_in(1));
+            x2->get_out(0)->tie_input(sum->get_in(0));
+            carry = or1->get_out(0).get();
+            s.emplace(std::move(x1));
+            s.emplace(std::move(x2));
+            s.emplace(std::move(and1));
+            s.emplace(std::move(and2));
+            s.emplace(std::move(or1));
+            s.emplace(std::move(sum));
+        }
+        auto cout = std::make_unique<elem_out>("cout");
+        carry->tie_input(cout->get_in(0));
+        s.emplace(std::move(cout));
+
+        netlist nl(s);
+        stimulus stim;
+        for(auto &in:ins){
+            stim.nets.emplace_back(nl.find_net(in->get_out(0)->get_id()));
+        }
+        std::mt19937 rng(46);
+        for(size_t c=0; c<100; c++){
+            std::vector<uint64_t> row;
+            for(size_t i=0; i<ins.size(); i++){
+                row.emplace_back(rng() & 1);
+            }
+            stim.cycles.emplace_back(row);
+        }
+        fault_sim one(nl), many(nl);
+        auto r_one = one.run(stim, 1);
+        auto r_many = many.run(stim, 4);
+        assert(r_one.faults > 64);
+        assert(r_one.detected == r_many.detected);
+        assert(r_one.coverage() == 1.0);
+        for(size_t i=0; i<one.get_faults().size(); i++){
+            assert(one.get_faults()[i].cycle == many.get_faults()[i].cycle);
+        }
+    }
+    std::cout<<" done\n";
+    return 0;
+}
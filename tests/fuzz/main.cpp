@@ -0,0 +1,132 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/cycle_sim.h"
+#include "sim/fault_sim.h"
+#include "sim/native_sim.h"
+#include "sim/diff_fuzz.h"
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <filesystem>
+
+#ifndef NATIVE_CXX
+#define NATIVE_CXX "c++"
+#endif
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv){
+    logger::get_instance().set_enabled(false);
+    //designs per run, more can be asked for on the command line
+    size_t designs = (argc > 1)? std::strtoull(argv[1], nullptr, 10) : 200;
+
+    std::cout<<"asserting that a broken engine is caught and shrunk to a small reproducer...";
+    {
+        //cycle_sim that gets every and of two or more items wrong by
+        //inverting its output, seen through anything that reads a net
+        diff_fuzzer::engine broken{"broken", [](const fuzz_design &d){
+            auto bad = d;
+            for(auto &it:bad.items){
+                if(it.kind == fuzz_design::kinds::k_and){
+                    it.kind = fuzz_design::kinds::k_nand;
+                }
+            }
+            return diff_fuzzer::stepped<cycle_sim>(bad, [](const netlist &nl){
+                return std::make_unique<cycle_sim>(nl);
+            });
+        }};
+        diff_fuzzer fuzzer({broken});
+        auto found = fuzzer.run(7, 50);
+        assert(found.size() == 1);
+        auto &d = found[0].first;
+        auto &m = found[0].second;
+        assert(m.engine == "broken");
+        //an and fed straight by inputs, one cycle
+        assert(d.stimulus.size() == 1);
+        assert(d.outputs.size() == 1);
+        size_t ands = 0;
+        for(auto &it:d.items){
+            ands += it.kind == fuzz_design::kinds::k_and;
+            assert(it.kind == fuzz_design::kinds::k_and || it.kind == fuzz_design::kinds::k_in);
+        }
+        assert(ands == 1);
+        assert(d.items.size() <= 4);
+        assert(m.expected != m.actual);
+        assert(!diff_fuzzer::compare({broken}, d).empty());
+
+        //reproducer replays from its files
+        auto dir = fs::temp_directory_path();
+        auto path = (dir/"fuzz_repro.sim").string();
+        diff_fuzzer::save(d, path);
+        assert(fs::exists(dir/"fuzz_repro.stim"));
+        elem_file_saver saver;
+        class sim s(saver.from_json(saver.load_json(path)));
+        netlist nl(s);
+        auto stim = stimulus::load((dir/"fuzz_repro.stim").string(), nl);
+        assert(stim.cycles.size() == 1);
+        cycle_sim cs(nl);
+        for(size_t i=0; i<stim.nets.size(); i++){
+            cs.set_input(stim.nets[i], stim.cycles[0][i]);
+        }
+        cs.evaluate();
+        assert(nl.get_outputs().size() == 1);
+        auto out = nl.get_nodes()[nl.get_outputs()[0]].outs[0];
+        assert(cs.get_value(out) == m.expected);
+        fs::remove(path);
+        fs::remove(dir/"fuzz_repro.stim");
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that random designs nest metas, some of them tabulated...";
+    {
+        std::mt19937_64 rng(3);
+        size_t nested = 0, tabulated = 0;
+        for(size_t n=0; n<50; n++){
+            auto d = fuzz_design::generate(rng);
+            class sim s;
+            d.build(s);
+            s.set_truth_tables(true);
+            nested += std::any_of(d.metas.begin(), d.metas.end(), [](const size_t &parent){
+                return parent != 0;
+            });
+            tabulated += s.tabulated_blocks() > 0;
+        }
+        assert(nested > 0);
+        assert(tabulated > 0);
+        std::vector<std::string> names;
+        for(auto &e:diff_fuzzer::default_engines()){
+            names.emplace_back(e.name);
+        }
+        for(auto name:{"scoped", "truth_tables", "lut_mapped", "pattern_sim", "timing_sim", "cone_eval"}){
+            assert(std::find(names.begin(), names.end(), name) != names.end());
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that every engine agrees with tick on random designs...";
+    {
+        diff_fuzzer fuzzer;
+        auto found = fuzzer.run(1, designs);
+        for(auto &f:found){
+            auto path = (fs::temp_directory_path()/("fuzz_"+f.second.engine+".sim")).string();
+            diff_fuzzer::save(f.first, path);
+            std::cout<<"\n"<<f.second.engine<<" differs at cycle "<<f.second.cycle<<
+                " output "<<f.second.output<<": "<<f.second.expected<<" expected, "<<
+                f.second.actual<<" seen "<<f.second.what<<", reproducer in "<<path;
+        }
+        assert(found.empty());
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that compiled native code agrees with tick on random designs...";
+    {
+        diff_fuzzer fuzzer({{"native", [](const fuzz_design &d){
+            return diff_fuzzer::stepped<native_sim>(d, [](const netlist &nl){
+                return std::make_unique<native_sim>(nl, NATIVE_CXX);
+            });
+        }}});
+        assert(fuzzer.run(2, 4).empty());
+    }
+    std::cout<<" done\n";
+    return 0;
+}
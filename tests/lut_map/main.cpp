@@ -0,0 +1,176 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/lut_map.h"
+#include "sim/cycle_sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that lut applies its table to every bit...";
+    {
+        //majority of three
+        elem_lut lut("maj", 4, 3, 0xe8);
+        lut.get_in(0)->set_values({true, true, false, false});
+        lut.get_in(1)->set_values({true, false, true, false});
+        lut.get_in(2)->set_values({false, true, true, true});
+        lut.process();
+        assert(lut.get_out(0)->get_values() == bits::bit_vector({true, true, true, false}));
+        elem_lut wide("wide", 1, 6, ~uint64_t(0));
+        wide.process();
+        assert(wide.get_out(0)->get_value(0));
+        bool thrown = false;
+        try{
+            elem_lut("too_wide", 1, 7);
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    //8 bit ripple carry adder of and, or and xor gates
+    class sim s;
+    std::vector<size_t> a_ids, b_ids, sum_ids;
+    gate_out* carry = nullptr;
+    for(int i=0; i<8; i++){
+        auto n = std::to_string(i);
+        auto a = std::make_unique<elem_in>("a"+n);
+        auto b = std::make_unique<elem_in>("b"+n);
+        auto x1 = std::make_unique<elem_xor>("x1_"+n);
+        auto and1 = std::make_unique<elem_and>("and1_"+n);
+        a->get_out(0)->tie_input(x1->get_in(0));
+        b->get_out(0)->tie_input(x1->get_in(1));
+        a->get_out(0)->tie_input(and1->get_in(0));
+        b->get_out(0)->tie_input(and1->get_in(1));
+        a_ids.emplace_back(a->get_out(0)->get_id());
+        b_ids.emplace_back(b->get_out(0)->get_id());
+        if(!carry){
+            sum_ids.emplace_back(x1->get_out(0)->get_id());
+            carry = and1->get_out(0).get();
+        }else{
+            auto x2 = std::make_unique<elem_xor>("x2_"+n);
+            auto and2 = std::make_unique<elem_and>("and2_"+n);
+            auto or1 = std::make_unique<elem_or>("or1_"+n);
+            x1->get_out(0)->tie_input(x2->get_in(0));
+            carry->tie_input(x2->get_in(1));
+            x1->get_out(0)->tie_input(and2->get_in(0));
+            carry->tie_input(and2->get_in(1));
+            and1->get_out(0)->tie_input(or1->get_in(0));
+            and2->get_out(0)->tie_input(or1->get_in(1));
+            sum_ids.emplace_back(x2->get_out(0)->get_id());
+            carry = or1->get_out(0).get();
+            s.emplace(std::move(x2));
+            s.emplace(std::move(and2));
+            s.emplace(std::move(or1));
+        }
+        s.emplace(std::move(a));
+        s.emplace(std::move(b));
+        s.emplace(std::move(x1));
+        s.emplace(std::move(and1));
+    }
+    auto carry_id = carry->get_id();
+
+    std::cout<<"asserting that mapping packs gates into fewer luts...";
+    netlist nl(s);
+    auto mapped = lut_mapper::map(nl);
+    size_t luts = 0;
+    for(auto &nd:mapped.get_nodes()){
+        if(nd.type == netlist::types_node::t_lut){
+            luts++;
+            assert(nd.ins.size() <= elem_lut::max_ins);
+        }
+    }
+    assert(luts > 0);
+    assert(mapped.get_nodes().size() < nl.get_nodes().size());
+    //sums and inputs stay visible
+    for(int i=0; i<8; i++){
+        assert(mapped.find_net(a_ids[i]) != netlist::npos);
+        assert(mapped.find_net(sum_ids[i]) != netlist::npos);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that mapped netlist computes the same...";
+    for(size_t k=2; k<=elem_lut::max_ins; k++){
+        auto mapped = lut_mapper::map(nl, k);
+        cycle_sim plain(nl), packed(mapped);
+        std::mt19937 gen(k);
+        for(int t=0; t<200; t++){
+            unsigned x = gen() & 0xff, y = gen() & 0xff;
+            for(int i=0; i<8; i++){
+                plain.set_input(nl.find_net(a_ids[i]), (x >> i) & 1);
+                plain.set_input(nl.find_net(b_ids[i]), (y >> i) & 1);
+                packed.set_input(mapped.find_net(a_ids[i]), (x >> i) & 1);
+                packed.set_input(mapped.find_net(b_ids[i]), (y >> i) & 1);
+            }
+            plain.evaluate();
+            packed.evaluate();
+            unsigned sum_plain = 0, sum_packed = 0;
+            for(int i=0; i<8; i++){
+                sum_plain |= unsigned(plain.get_value(nl.find_net(sum_ids[i]))) << i;
+                sum_packed |= unsigned(packed.get_value(mapped.find_net(sum_ids[i]))) << i;
+            }
+            sum_plain |= unsigned(plain.get_value(nl.find_net(carry_id))) << 8;
+            sum_packed |= unsigned(packed.get_value(mapped.find_net(carry_id))) << 8;
+            assert(sum_plain == x+y);
+            assert(sum_packed == x+y);
+        }
+        assert(packed.get_order().size() <= plain.get_order().size());
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that a clock passed into a meta stays a clock...";
+    {
+        //dff in a meta nested in another, clock and inverted d come in
+        //through ports of both
+        class sim seq;
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto d = std::make_unique<elem_in>("d");
+        auto outer_it = seq.emplace(std::make_unique<elem_meta>("outer"));
+        auto inner_it = seq.emplace(outer_it, std::make_unique<elem_meta>("inner"));
+        auto clk_outer = std::make_unique<elem_in>("clk");
+        auto clk_inner = std::make_unique<elem_in>("clk");
+        auto d_outer = std::make_unique<elem_in>("d");
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto d_inner = std::make_unique<elem_in>("d");
+        auto dff = std::make_unique<elem_dff>("dff");
+        auto q_inner = std::make_unique<elem_out>("q");
+        auto q_outer = std::make_unique<elem_out>("q");
+        auto out = std::make_unique<elem_out>("out");
+        clk->get_out(0)->tie_input(clk_outer->get_outer());
+        clk_outer->get_out(0)->tie_input(clk_inner->get_outer());
+        clk_inner->get_out(0)->tie_input(dff->get_in(1));
+        d->get_out(0)->tie_input(d_outer->get_outer());
+        d_outer->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(d_inner->get_outer());
+        d_inner->get_out(0)->tie_input(dff->get_in(0));
+        dff->get_out(0)->tie_input(q_inner->get_in(0));
+        q_inner->get_outer()->tie_input(q_outer->get_in(0));
+        q_outer->get_outer()->tie_input(out->get_in(0));
+        auto d_id = d->get_out(0)->get_id();
+        auto out_id = out->get_outer()->get_id();
+        seq.emplace(std::move(clk));
+        seq.emplace(std::move(d));
+        seq.emplace(outer_it, std::move(clk_outer));
+        seq.emplace(outer_it, std::move(d_outer));
+        seq.emplace(outer_it, std::move(not1));
+        seq.emplace(inner_it, std::move(clk_inner));
+        seq.emplace(inner_it, std::move(d_inner));
+        seq.emplace(inner_it, std::move(dff));
+        seq.emplace(inner_it, std::move(q_inner));
+        seq.emplace(outer_it, std::move(q_outer));
+        seq.emplace(std::move(out));
+        netlist seq_nl(seq);
+        auto mapped = lut_mapper::map(seq_nl);
+        assert(cycle_sim::check(mapped).empty());
+        cycle_sim cs(mapped);
+        for(uint64_t v:{0, 1, 1, 0}){
+            cs.set_input(mapped.find_net(d_id), v);
+            cs.step();
+            assert(cs.get_value(mapped.find_net(out_id)) == !v);
+        }
+    }
+    std::cout<<" done\n";
+}
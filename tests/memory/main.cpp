@@ -0,0 +1,163 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/timing_sim.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    auto bus = [](const size_t &width, const uint64_t &value){
+        bits::bit_vector result(width);
+        result.set_word(0, value);
+        return result;
+    };
+
+    std::cout<<"asserting that 64 KiB ram writes and reads any address...";
+    {
+        elem_ram ram("ram", 16, 8);
+        assert(ram.get_contents().size() == 65536*8);
+        for(size_t a:{0, 1, 7, 8, 4095, 65535}){
+            ram.get_in(0)->set_values(bus(16, a));
+            ram.get_in(1)->set_values(bus(8, (a*7+3) & 0xff));
+            ram.get_in(2)->set_values({true});
+            ram.reset_processed();
+            ram.process();
+        }
+        ram.get_in(2)->set_values({false});
+        for(size_t a:{0, 1, 7, 8, 4095, 65535}){
+            ram.get_in(0)->set_values(bus(16, a));
+            ram.get_in(1)->set_values(bus(8, 0));
+            ram.reset_processed();
+            ram.process();
+            assert(ram.get_out(0)->get_values().word(0) == ((a*7+3) & 0xff));
+            assert(ram.read_word(a) == ((a*7+3) & 0xff));
+        }
+        assert(ram.read_word(2) == 0);
+    }
+    std::cout<<" done\n";
+
+    auto path = std::filesystem::path("/tmp/sim_rom.bin");
+    {
+        //12 bit words, so every other word straddles a byte
+        std::ofstream file(path, std::ios::binary);
+        for(int i=0; i<300; i++){
+            char byte = static_cast<char>(i*37);
+            file.write(&byte, 1);
+        }
+    }
+    auto expected = [](const size_t &word){
+        size_t bit = word*12;
+        uint64_t result = 0;
+        for(size_t i=0; i<12; i++){
+            auto byte = static_cast<uint8_t>(((bit+i)/8)*37);
+            result |= uint64_t((byte >> ((bit+i)%8)) & 1) << i;
+        }
+        return result;
+    };
+
+    std::cout<<"asserting that rom reads its mapped image...";
+    {
+        elem_rom rom("rom", 8, 12, path.string());
+        assert(rom.get_image_path() == path.string());
+        for(size_t a:{0, 1, 2, 3, 100, 199}){
+            rom.get_in(0)->set_values(bus(8, a));
+            rom.reset_processed();
+            rom.process();
+            assert(rom.get_out(0)->get_values().word(0) == expected(a));
+        }
+        //image ends in word 200
+        assert(rom.read_word(255) == 0);
+        bool thrown = false;
+        try{
+            rom.load_image("/tmp/no_such_rom_image.bin");
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that a widened address gate stays inside memory...";
+    {
+        elem_ram ram("ram", 4, 8);
+        assert(ram.has_fixed_shape());
+        //as a file holding a wider address gate would do
+        ram.get_in(0)->set_width(20);
+        assert(ram.get_addr_width() == 4 && ram.get_words_count() == 16);
+        ram.get_in(0)->set_values(bus(20, 0xfffff));
+        ram.get_in(1)->set_values(bus(8, 0x5a));
+        ram.get_in(2)->set_values({true});
+        ram.reset_processed();
+        ram.process();
+        assert(ram.get_contents().size() == 16*8);
+        assert(ram.read_word(15) == 0x5a);
+        elem_rom rom("rom", 4, 12, path.string());
+        rom.get_in(0)->set_width(20);
+        rom.get_in(0)->set_values(bus(20, 0x10003));
+        rom.process();
+        assert(rom.get_out(0)->get_values().word(0) == expected(3));
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that rom is saved by reference to its image...";
+    {
+        class sim s;
+        s.emplace(std::make_unique<elem_rom>("rom", 8, 12, path.string()));
+        s.emplace(std::make_unique<elem_ram>("ram", 10, 16));
+        elem_file_saver saver;
+        auto json = saver.to_json(s.begin(), s.end());
+        assert(json.dump().find(path.string()) != std::string::npos);
+        class sim loaded(saver.from_json(json));
+        auto rom = loaded.get_by_predicate([](const auto &el){
+            return el->get_name() == "rom";
+        })->get();
+        assert(dynamic_cast<elem_rom*>(rom)->read_word(3) == expected(3));
+        assert(saver.to_json(loaded.begin(), loaded.end()) == json);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that timing_sim reads and writes memories...";
+    {
+        class sim s;
+        auto addr = std::make_unique<elem_in>("addr", 8);
+        auto data = std::make_unique<elem_in>("data", 12);
+        auto we = std::make_unique<elem_in>("we", 1);
+        auto rom = std::make_unique<elem_rom>("rom", 8, 12, path.string());
+        auto ram = std::make_unique<elem_ram>("ram", 8, 12);
+        addr->get_out(0)->tie_input(rom->get_in(0));
+        addr->get_out(0)->tie_input(ram->get_in(0));
+        rom->get_out(0)->tie_input(ram->get_in(1));
+        we->get_out(0)->tie_input(ram->get_in(2));
+        auto addr_id = addr->get_out(0)->get_id();
+        auto we_id = we->get_out(0)->get_id();
+        auto ram_id = ram->get_out(0)->get_id();
+        s.emplace(std::move(addr));
+        s.emplace(std::move(data));
+        s.emplace(std::move(we));
+        s.emplace(std::move(rom));
+        s.emplace(std::move(ram));
+        netlist nl(s);
+        timing_sim ts(nl);
+        auto addr_net = nl.find_net(addr_id);
+        auto we_net = nl.find_net(we_id);
+        auto ram_net = nl.find_net(ram_id);
+        //copy rom word 5 into ram word 5, then look at it again from word 6
+        ts.set_input(addr_net, 5, 10);
+        ts.set_input(we_net, 1, 20);
+        ts.set_input(we_net, 0, 30);
+        ts.run_until(40);
+        assert(ts.get_value(ram_net) == expected(5));
+        ts.set_input(addr_net, 6, 50);
+        ts.run_until(60);
+        assert(ts.get_value(ram_net) == 0);
+        ts.set_input(addr_net, 5, 70);
+        ts.run_until(80);
+        assert(ts.get_value(ram_net) == expected(5));
+    }
+    std::cout<<" done\n";
+
+    std::filesystem::remove(path);
+}
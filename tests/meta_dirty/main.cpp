@@ -0,0 +1,152 @@
+#include "sim/sim.h"
+#include <iostream>
+#include <cassert>
+
+//block of a meta with one input and one output, inverted `depth` times inside
+struct block{
+    elem_in* in;
+    elem_out* out;
+};
+
+block add_block(class sim &sim, const std::string &name, const size_t &depth, elem_out* &meta_out){
+    auto meta_it = sim.emplace(std::make_unique<elem_meta>(name));
+    auto in = std::make_unique<elem_in>(name+"_in");
+    auto out = std::make_unique<elem_out>(name+"_out");
+    block result{in.get(), out.get()};
+    gate_out* prev = in->get_out(0).get();
+    sim.emplace(meta_it, std::move(in));
+    for(size_t i=0; i<depth; i++){
+        auto not1 = std::make_unique<elem_not>(name+"_not"+std::to_string(i));
+        prev->tie_input(not1->get_in(0));
+        prev = not1->get_out(0).get();
+        sim.emplace(meta_it, std::move(not1));
+    }
+    prev->tie_input(out->get_in(0));
+    meta_out = out.get();
+    sim.emplace(meta_it, std::move(out));
+    return result;
+}
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that untouched metas are skipped...";
+    {
+        class sim sim;
+        std::vector<elem_in*> ins;
+        std::vector<elem_out*> outs;
+        for(int b=0; b<10; b++){
+            auto in = std::make_unique<elem_in>("in"+std::to_string(b));
+            ins.emplace_back(in.get());
+            elem_out* meta_out;
+            auto blk = add_block(sim, "m"+std::to_string(b), 9, meta_out);
+            in->get_out(0)->tie_input(blk.in->get_outer());
+            outs.emplace_back(meta_out);
+            sim.emplace(std::move(in));
+        }
+        while(sim.tick());
+        for(auto &out:outs){
+            assert(out->get_outer()->get_value(0) == true);
+        }
+        ins[3]->set_values({true});
+        assert(sim.tick());
+        assert(outs[3]->get_outer()->get_value(0) == false);
+        for(int b=0; b<10; b++){
+            assert(outs[b]->get_outer()->get_value(0) == (b != 3));
+        }
+        //root with its inputs and metas, plus one block of 11 per pass
+        auto &settle = sim.get_last_settle();
+        assert(settle.processed <= settle.passes*(1+20+11));
+        assert(settle.processed < 110);
+        ins[3]->set_values({false});
+        ins[7]->set_values({true});
+        sim.tick();
+        assert(outs[3]->get_outer()->get_value(0) == true);
+        assert(outs[7]->get_outer()->get_value(0) == false);
+        assert(sim.get_last_settle().processed <= sim.get_last_settle().passes*(1+20+22));
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that nested metas are marked up to root...";
+    {
+        class sim sim;
+        auto in = std::make_unique<elem_in>("in");
+        auto in_ptr = in.get();
+        auto outer_it = sim.emplace(std::make_unique<elem_meta>("outer"));
+        auto outer_in = std::make_unique<elem_in>("outer_in");
+        auto outer_out = std::make_unique<elem_out>("outer_out");
+        auto outer_out_ptr = outer_out.get();
+        in->get_out(0)->tie_input(outer_in->get_outer());
+        auto inner_it = sim.emplace(outer_it, std::make_unique<elem_meta>("inner"));
+        auto inner_in = std::make_unique<elem_in>("inner_in");
+        auto inner_out = std::make_unique<elem_out>("inner_out");
+        auto not1 = std::make_unique<elem_not>("not1");
+        outer_in->get_out(0)->tie_input(inner_in->get_outer());
+        inner_in->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(inner_out->get_in(0));
+        inner_out->get_outer()->tie_input(outer_out->get_in(0));
+        sim.emplace(inner_it, std::move(inner_in));
+        sim.emplace(inner_it, std::move(not1));
+        sim.emplace(inner_it, std::move(inner_out));
+        sim.emplace(outer_it, std::move(outer_in));
+        sim.emplace(outer_it, std::move(outer_out));
+        sim.emplace(std::move(in));
+        for(int i=0; i<4; i++){
+            in_ptr->set_values({i % 2 == 1});
+            while(sim.tick());
+            assert(outer_out_ptr->get_outer()->get_value(0) == (i % 2 == 0));
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that ties bypassing elem_in keep meta evaluated...";
+    {
+        class sim sim;
+        auto in = std::make_unique<elem_in>("in");
+        auto in_ptr = in.get();
+        auto meta_it = sim.emplace(std::make_unique<elem_meta>("m"));
+        auto not1 = std::make_unique<elem_not>("not1");
+        auto not1_ptr = not1.get();
+        in->get_out(0)->tie_input(not1->get_in(0));
+        sim.emplace(meta_it, std::move(not1));
+        sim.emplace(std::move(in));
+        for(int i=0; i<4; i++){
+            in_ptr->set_values({i % 2 == 1});
+            while(sim.tick());
+            assert(not1_ptr->get_out(0)->get_value(0) == (i % 2 == 0));
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that metas are all evaluated with scoping off...";
+    {
+        class sim sim;
+        std::vector<elem_in*> ins;
+        std::vector<elem_out*> outs;
+        for(int b=0; b<10; b++){
+            auto in = std::make_unique<elem_in>("in"+std::to_string(b));
+            ins.emplace_back(in.get());
+            elem_out* meta_out;
+            auto blk = add_block(sim, "m"+std::to_string(b), 9, meta_out);
+            in->get_out(0)->tie_input(blk.in->get_outer());
+            outs.emplace_back(meta_out);
+            sim.emplace(std::move(in));
+        }
+        sim.set_scoping(false);
+        assert(!sim.get_scoping());
+        while(sim.tick());
+        ins[3]->set_values({true});
+        assert(sim.tick());
+        for(int b=0; b<10; b++){
+            assert(outs[b]->get_outer()->get_value(0) == (b != 3));
+        }
+        //root, its inputs and every meta with its 11 elements on each pass
+        auto &settle = sim.get_last_settle();
+        assert(settle.processed == settle.passes*(1+10+10*12));
+        sim.set_scoping(true);
+        ins[3]->set_values({false});
+        sim.tick();
+        assert(outs[3]->get_outer()->get_value(0) == true);
+    }
+    std::cout<<" done\n";
+}
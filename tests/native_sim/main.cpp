@@ -0,0 +1,181 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/cycle_sim.h"
+#include "sim/native_sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+#ifndef NATIVE_CXX
+#define NATIVE_CXX "c++"
+#endif
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that compiled circuit steps like cycle based run...";
+    {
+        //acc = acc ^ count ^ (acc with swapped nibbles)
+        class sim s;
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto en = std::make_unique<elem_in>("en");
+        auto clr = std::make_unique<elem_in>("clr");
+        auto cnt = std::make_unique<elem_counter>("cnt", 8);
+        auto acc = std::make_unique<elem_register>("acc", 8);
+        auto split = std::make_unique<elem_splitter>("split", std::vector<size_t>{4, 4});
+        auto merge = std::make_unique<elem_merger>("merge", std::vector<size_t>{4, 4});
+        auto xor3 = std::make_unique<elem_xor>("xor3", 8, 3);
+        clk->get_out(0)->tie_input(cnt->get_in(2));
+        clk->get_out(0)->tie_input(acc->get_in(2));
+        en->get_out(0)->tie_input(cnt->get_in(0));
+        en->get_out(0)->tie_input(acc->get_in(1));
+        clr->get_out(0)->tie_input(cnt->get_in(1));
+        acc->get_out(0)->tie_input(xor3->get_in(0));
+        cnt->get_out(0)->tie_input(xor3->get_in(1));
+        acc->get_out(0)->tie_input(split->get_in(0));
+        split->get_out(0)->tie_input(merge->get_in(1));
+        split->get_out(1)->tie_input(merge->get_in(0));
+        merge->get_out(0)->tie_input(xor3->get_in(2));
+        xor3->get_out(0)->tie_input(acc->get_in(0));
+        auto en_id = en->get_out(0)->get_id();
+        auto clr_id = clr->get_out(0)->get_id();
+        auto acc_id = acc->get_out(0)->get_id();
+        s.emplace(std::move(clk));
+        s.emplace(std::move(en));
+        s.emplace(std::move(clr));
+        s.emplace(std::move(cnt));
+        s.emplace(std::move(acc));
+        s.emplace(std::move(split));
+        s.emplace(std::move(merge));
+        s.emplace(std::move(xor3));
+
+        netlist nl(s);
+        cycle_sim cs(nl);
+        native_sim ns(nl, NATIVE_CXX);
+        auto acc_net = nl.find_net(acc_id);
+        cs.set_input(nl.find_net(en_id), 1);
+        ns.set_input(nl.find_net(en_id), 1);
+        for(size_t cycle=0; cycle<60; cycle++){
+            uint64_t clear = cycle % 13 == 12;
+            cs.set_input(nl.find_net(clr_id), clear);
+            ns.set_input(nl.find_net(clr_id), clear);
+            cs.step();
+            ns.step();
+            assert(ns.get_value(acc_net) == cs.get_value(acc_net));
+        }
+        assert(ns.get_cycle() == 60);
+        assert(ns.get_source().find("circuit_step") != std::string::npos);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that compiled muxes, luts and rams match cycle based run...";
+    {
+        //ram addressed by a mux of two inputs, written with a lut of them
+        class sim s;
+        auto a = std::make_unique<elem_in>("a", 4);
+        auto b = std::make_unique<elem_in>("b", 4);
+        auto sel = std::make_unique<elem_in>("sel");
+        auto we = std::make_unique<elem_in>("we");
+        auto mux = std::make_unique<elem_mux>("mux", 4, 1);
+        auto lut = std::make_unique<elem_lut>("lut", 4, 2, 0x6);
+        auto ext = std::make_unique<elem_merger>("ext", std::vector<size_t>{4, 4});
+        auto ram = std::make_unique<elem_ram>("ram", 4, 8);
+        auto enc = std::make_unique<elem_priority_encoder>("enc", 8);
+        auto dec = std::make_unique<elem_decoder>("dec", 3);
+        a->get_out(0)->tie_input(mux->get_in(0));
+        b->get_out(0)->tie_input(mux->get_in(1));
+        sel->get_out(0)->tie_input(mux->get_in(2));
+        a->get_out(0)->tie_input(lut->get_in(0));
+        b->get_out(0)->tie_input(lut->get_in(1));
+        lut->get_out(0)->tie_input(ext->get_in(0));
+        a->get_out(0)->tie_input(ext->get_in(1));
+        mux->get_out(0)->tie_input(ram->get_in(0));
+        ext->get_out(0)->tie_input(ram->get_in(1));
+        we->get_out(0)->tie_input(ram->get_in(2));
+        ram->get_out(0)->tie_input(enc->get_in(0));
+        enc->get_out(0)->tie_input(dec->get_in(0));
+        std::vector<size_t> in_ids = {a->get_out(0)->get_id(), b->get_out(0)->get_id(),
+            sel->get_out(0)->get_id(), we->get_out(0)->get_id()};
+        std::vector<size_t> out_ids = {ram->get_out(0)->get_id(), enc->get_out(1)->get_id(),
+            dec->get_out(0)->get_id()};
+        s.emplace(std::move(a));
+        s.emplace(std::move(b));
+        s.emplace(std::move(sel));
+        s.emplace(std::move(we));
+        s.emplace(std::move(mux));
+        s.emplace(std::move(lut));
+        s.emplace(std::move(ext));
+        s.emplace(std::move(ram));
+        s.emplace(std::move(enc));
+        s.emplace(std::move(dec));
+
+        netlist nl(s);
+        cycle_sim cs(nl);
+        native_sim ns(nl, NATIVE_CXX);
+        std::mt19937_64 rng(43);
+        for(size_t round=0; round<300; round++){
+            for(auto &id:in_ids){
+                auto value = rng();
+                cs.set_input(nl.find_net(id), value);
+                ns.set_input(nl.find_net(id), value);
+            }
+            cs.evaluate();
+            ns.evaluate();
+            for(auto &id:out_ids){
+                assert(ns.get_value(nl.find_net(id)) == cs.get_value(nl.find_net(id)));
+            }
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that names ending in a backslash don't swallow code...";
+    {
+        class sim s;
+        auto a = std::make_unique<elem_in>("a\\");
+        auto not1 = std::make_unique<elem_not>("not\\");
+        auto not2 = std::make_unique<elem_not>("not2\\");
+        a->get_out(0)->tie_input(not1->get_in(0));
+        not1->get_out(0)->tie_input(not2->get_in(0));
+        auto a_id = a->get_out(0)->get_id();
+        auto out_id = not2->get_out(0)->get_id();
+        s.emplace(std::move(a));
+        s.emplace(std::move(not1));
+        s.emplace(std::move(not2));
+
+        netlist nl(s);
+        native_sim ns(nl, NATIVE_CXX);
+        assert(ns.get_source().find("\\\n") == std::string::npos);
+        for(uint64_t v=0; v<2; v++){
+            ns.set_input(nl.find_net(a_id), v);
+            ns.evaluate();
+            assert(ns.get_value(nl.find_net(out_id)) == v);
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that a failed build leaves no temporary files...";
+    {
+        class sim s;
+        s.emplace(std::make_unique<elem_not>("not"));
+        netlist nl(s);
+        auto count = [](){
+            size_t result = 0;
+            std::string prefix = "native_sim_";
+            for(auto &entry:std::filesystem::directory_iterator(std::filesystem::temp_directory_path())){
+                result += entry.path().filename().string().rfind(prefix, 0) == 0;
+            }
+            return result;
+        };
+        auto before = count();
+        bool thrown = false;
+        try{
+            native_sim ns(nl, "false");
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+        assert(count() == before);
+    }
+    std::cout<<" done\n";
+    return 0;
+}
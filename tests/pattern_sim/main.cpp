@@ -0,0 +1,181 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/aig.h"
+#include "sim/pattern_sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    //8 bit ripple carry adder, inputs and sum as merged buses
+    class sim s;
+    auto a = std::make_unique<elem_in>("a", 8);
+    auto b = std::make_unique<elem_in>("b", 8);
+    auto split_a = std::make_unique<elem_splitter>("split_a", std::vector<size_t>(8, 1));
+    auto split_b = std::make_unique<elem_splitter>("split_b", std::vector<size_t>(8, 1));
+    auto merge = std::make_unique<elem_merger>("merge", std::vector<size_t>(8, 1));
+    auto sum = std::make_unique<elem_out>("sum", 8);
+    a->get_out(0)->tie_input(split_a->get_in(0));
+    b->get_out(0)->tie_input(split_b->get_in(0));
+    merge->get_out(0)->tie_input(sum->get_in(0));
+    gate_out* carry = nullptr;
+    for(int i=0; i<8; i++){
+        auto n = std::to_string(i);
+        auto x1 = std::make_unique<elem_xor>("x1_"+n);
+        auto and1 = std::make_unique<elem_and>("and1_"+n);
+        split_a->get_out(i)->tie_input(x1->get_in(0));
+        split_b->get_out(i)->tie_input(x1->get_in(1));
+        split_a->get_out(i)->tie_input(and1->get_in(0));
+        split_b->get_out(i)->tie_input(and1->get_in(1));
+        if(!carry){
+            x1->get_out(0)->tie_input(merge->get_in(i));
+            carry = and1->get_out(0).get();
+        }else{
+            auto x2 = std::make_unique<elem_xor>("x2_"+n);
+            auto and2 = std::make_unique<elem_and>("and2_"+n);
+            auto or1 = std::make_unique<elem_or>("or1_"+n);
+            x1->get_out(0)->tie_input(x2->get_in(0));
+            carry->tie_input(x2->get_in(1));
+            x1->get_out(0)->tie_input(and2->get_in(0));
+            carry->tie_input(and2->get_in(1));
+            and1->get_out(0)->tie_input(or1->get_in(0));
+            and2->get_out(0)->tie_input(or1->get_in(1));
+            x2->get_out(0)->tie_input(merge->get_in(i));
+            carry = or1->get_out(0).get();
+            s.emplace(std::move(x2));
+            s.emplace(std::move(and2));
+            s.emplace(std::move(or1));
+        }
+        s.emplace(std::move(x1));
+        s.emplace(std::move(and1));
+    }
+    auto a_id = a->get_out(0)->get_id();
+    auto b_id = b->get_out(0)->get_id();
+    auto sum_id = sum->get_in(0)->get_id();
+    s.emplace(std::move(a));
+    s.emplace(std::move(b));
+    s.emplace(std::move(split_a));
+    s.emplace(std::move(split_b));
+    s.emplace(std::move(merge));
+    s.emplace(std::move(sum));
+
+    netlist nl(s);
+    aig g(nl);
+    auto a_net = nl.find_net(a_id);
+    auto b_net = nl.find_net(b_id);
+    auto sum_net = nl.find_net(sum_id);
+
+    std::cout<<"asserting that every kernel adds all patterns at once...";
+    {
+        std::mt19937_64 rng(45);
+        for(size_t words:{size_t(8), size_t(3)}){
+            pattern_sim ps(g, words);
+            assert(ps.patterns() == words*64);
+            assert(pattern_sim::supported(ps.get_kernel()));
+            std::vector<uint64_t> as, bs;
+            for(size_t p=0; p<ps.patterns(); p++){
+                as.emplace_back(rng() & 0xff);
+                bs.emplace_back(rng() & 0xff);
+                ps.set_input(a_net, p, as.back());
+                ps.set_input(b_net, p, bs.back());
+            }
+            for(auto k:{pattern_sim::kernels::k_scalar, pattern_sim::kernels::k_sse2,
+                pattern_sim::kernels::k_avx2, pattern_sim::kernels::k_avx512})
+            {
+                if(!pattern_sim::supported(k)){
+                    continue;
+                }
+                ps.set_kernel(k);
+                ps.evaluate();
+                for(size_t p=0; p<ps.patterns(); p++){
+                    assert(ps.get_value(sum_net, p) == ((as[p]+bs[p]) & 0xff));
+                }
+            }
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that lanes are set and read a bit at a time...";
+    {
+        pattern_sim ps(g, 4);
+        //pattern p adds p to 1, so sum bit 0 is the inverted bit 0 of p
+        std::vector<uint64_t> lane(4), result(4);
+        for(size_t i=0; i<8; i++){
+            for(size_t w=0; w<4; w++){
+                uint64_t word = 0;
+                for(size_t bit=0; bit<64; bit++){
+                    word |= (((w*64+bit) >> i) & 1) << bit;
+                }
+                lane[w] = word;
+            }
+            ps.set_input_lane(a_net, i, lane.data());
+            std::fill(lane.begin(), lane.end(), (i == 0)? ~uint64_t(0) : 0);
+            ps.set_input_lane(b_net, i, lane.data());
+        }
+        ps.evaluate();
+        ps.get_lane(sum_net, 0, result.data());
+        for(size_t w=0; w<4; w++){
+            assert(result[w] == 0x5555555555555555);
+        }
+        for(size_t p=0; p<ps.patterns(); p++){
+            assert(ps.get_value(sum_net, p) == ((p+1) & 0xff));
+        }
+        bool thrown = false;
+        try{
+            ps.set_input_lane(sum_net, 0, lane.data());
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that every pattern keeps state of its own...";
+    {
+        //counter enabled by bit c%6 of p in cycle c of pattern p
+        class sim seq;
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto en = std::make_unique<elem_in>("en");
+        auto clr = std::make_unique<elem_in>("clr");
+        auto cnt = std::make_unique<elem_counter>("cnt", 8);
+        auto q = std::make_unique<elem_out>("q", 8);
+        clk->get_out(0)->tie_input(cnt->get_in(2));
+        en->get_out(0)->tie_input(cnt->get_in(0));
+        clr->get_out(0)->tie_input(cnt->get_in(1));
+        cnt->get_out(0)->tie_input(q->get_in(0));
+        auto en_id = en->get_out(0)->get_id();
+        auto q_id = q->get_outer()->get_id();
+        seq.emplace(std::move(clk));
+        seq.emplace(std::move(en));
+        seq.emplace(std::move(clr));
+        seq.emplace(std::move(cnt));
+        seq.emplace(std::move(q));
+        netlist seq_nl(seq);
+        aig seq_g(seq_nl);
+        auto en_net = seq_nl.find_net(en_id);
+        auto q_net = seq_nl.find_net(q_id);
+        pattern_sim ps(seq_g, 2);
+        std::vector<uint64_t> lane(2);
+        for(size_t c=0; c<10; c++){
+            for(size_t w=0; w<2; w++){
+                lane[w] = 0;
+                for(size_t bit=0; bit<64; bit++){
+                    lane[w] |= (((w*64+bit) >> (c%6)) & 1) << bit;
+                }
+            }
+            ps.set_input_lane(en_net, 0, lane.data());
+            ps.step();
+            for(size_t p=0; p<ps.patterns(); p++){
+                size_t count = 0;
+                for(size_t k=0; k<=c; k++){
+                    count += (p >> (k%6)) & 1;
+                }
+                assert(ps.get_value(q_net, p) == count);
+            }
+        }
+    }
+    std::cout<<" done\n";
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "sim/sim.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+    class sim sim;
+    auto in = std::make_unique<elem_in>("in1");
+    auto not_elem = std::make_unique<elem_not>("not1");
+    auto out = std::make_unique<elem_out>("out1");
+    in->get_out(0)->tie_input(not_elem->get_in(0));
+    not_elem->get_out(0)->tie_input(out->get_in(0));
+    auto in_ptr = in.get();
+    auto out_ptr = out.get();
+    sim.emplace(std::move(in));
+    sim.emplace(std::move(not_elem));
+    sim.emplace(std::move(out));
+
+    std::cout<<"asserting that stable circuit becomes quiescent...";
+    assert(!sim.is_quiescent());
+    assert(sim.tick());
+    assert(out_ptr->get_value(0) == true);
+    while(sim.tick());
+    assert(sim.is_quiescent());
+    assert(!sim.tick());
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that input change wakes it...";
+    in_ptr->set_values({true});
+    assert(!sim.is_quiescent());
+    assert(sim.tick());
+    assert(out_ptr->get_value(0) == false);
+    while(sim.tick());
+    assert(sim.is_quiescent());
+    in_ptr->set_values({true}); //same value, nothing to do
+    assert(!sim.tick());
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that edits and clocks wake it...";
+    sim.emplace(std::make_unique<elem_clock>("clk1"));
+    assert(!sim.is_quiescent());
+    for(int i=0; i<10; i++){
+        assert(sim.tick());
+    }
+    assert(!sim.is_quiescent());
+    std::cout<<" done\n";
+}
@@ -109,4 +109,98 @@ int main(){
         std::cout<<".";
     }
     std::cout<<" done\n";
-};
\ No newline at end of file
+
+    std::cout<<"asserting that loaded sim works like saved one...";
+    {
+        //meta with 3 input xor behind an input and an output, plus a mux outside
+        class sim sim3;
+        auto meta_it = sim3.emplace(std::make_unique<elem_meta>("meta"));
+        auto in = std::make_unique<elem_in>("in", 4);
+        auto xor_elem = std::make_unique<elem_xor>("xor", 4, 3);
+        auto out = std::make_unique<elem_out>("out", 4);
+        in->get_out(0)->tie_input(xor_elem->get_in(0));
+        in->get_out(0)->tie_input(xor_elem->get_in(2));
+        xor_elem->get_out(0)->tie_input(out->get_in(0));
+        auto top_in = std::make_unique<elem_in>("top_in", 4);
+        auto sel = std::make_unique<elem_in>("sel", 1);
+        auto mux = std::make_unique<elem_mux>("mux", 4, 1);
+        auto top_out = std::make_unique<elem_out>("top_out", 4);
+        top_in->get_out(0)->tie_input(in->get_outer());
+        top_in->get_out(0)->tie_input(mux->get_in(0));
+        out->get_outer()->tie_input(mux->get_in(1));
+        sel->get_out(0)->tie_input(mux->get_in(2));
+        mux->get_out(0)->tie_input(top_out->get_in(0));
+        sim3.emplace(meta_it, std::move(in));
+        sim3.emplace(meta_it, std::move(xor_elem));
+        sim3.emplace(meta_it, std::move(out));
+        sim3.emplace(std::move(top_in));
+        sim3.emplace(std::move(sel));
+        sim3.emplace(std::move(mux));
+        sim3.emplace(std::move(top_out));
+        sim3.emplace(std::make_unique<elem_clock>("clk", 3));
+
+        auto json = saver.to_json(sim3.begin(), sim3.end());
+        class sim sim4(saver.from_json(json));
+        assert(saver.to_json(sim4.begin(), sim4.end()) == json);
+
+        auto find = [&sim4](const std::string &name){
+            return sim4.get_by_predicate([&name](const auto &el){
+                return el->get_name() == name;
+            })->get();
+        };
+        auto clk = dynamic_cast<elem_clock*>(find("clk"));
+        assert(clk && clk->get_half_period() == 3);
+        assert(find("in")->get_parent_id() == find("meta")->get_id());
+        assert(find("meta")->get_ins_size() == 1);
+        assert(find("meta")->get_outs_size() == 1);
+        //elements made after loading get fresh ids
+        elem_not fresh("fresh");
+        assert(fresh.get_id() > find("top_out")->get_id());
+
+        auto in4 = dynamic_cast<elem_in*>(find("top_in"));
+        auto sel4 = dynamic_cast<elem_in*>(find("sel"));
+        auto out4 = dynamic_cast<elem_out*>(find("top_out"));
+        in4->set_values({true, false, true, true});
+        sel4->set_values({true});
+        sim4.tick();
+        //xor of in, nothing and in again gives zero
+        assert(out4->get_values() == bits::bit_vector(4));
+        sel4->set_values({false});
+        sim4.tick();
+        assert(out4->get_values() == bits::bit_vector({true, false, true, true}));
+
+        //select of the mux widened by hand can't be loaded
+        for(auto &j_elem:json){
+            if(j_elem.at("name") == "mux"){
+                j_elem.at("ins").at(2)["width"] = 3;
+            }
+        }
+        bool thrown = false;
+        try{
+            class sim sim5(saver.from_json(json));
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that files saved without shapes still load...";
+    {
+        //written by the format without element parameters, where the and
+        //had its inputs widened one by one and a fixed shape was not known
+        auto json = nlohmann::json::parse(R"([{"id":0,"ins":[],"name":"root","outs":[],"parent_id":0,"type":0},{"id":1,"ins":[],"name":"meta1","outs":[],"parent_id":0,"type":0},{"id":2,"ins":[{"id":3,"name":"and1+in_0","parent_id":2,"type":0,"width":4},{"id":4,"name":"and1+in_1","parent_id":2,"type":0,"width":4}],"name":"and1","outs":[{"id":5,"name":"and1+out_1","parent_id":2,"tied":[[7,6]],"type":1,"width":1}],"parent_id":0,"type":1},{"id":6,"ins":[{"id":7,"name":"not1+in_0","parent_id":6,"type":0,"width":1}],"name":"not1","outs":[{"id":8,"name":"not1+out_1","parent_id":6,"tied":[],"type":1,"width":1}],"parent_id":0,"type":3}])");
+        class sim sim6(saver.from_json(json));
+        auto and6 = sim6.get_by_predicate([](const auto &el){
+            return el->get_name() == "and1";
+        })->get();
+        assert(and6->get_id() == 2);
+        assert(and6->get_ins_size() == 2);
+        assert(and6->get_in(0)->get_id() == 3);
+        assert(and6->get_in(0)->get_width() == 1);
+        assert(and6->get_in(1)->get_width() == 1);
+        assert(and6->get_out(0)->get_tied().size() == 1);
+        assert(and6->get_out(0)->get_tied()[0]->get_id() == 7);
+    }
+    std::cout<<" done\n";
+};
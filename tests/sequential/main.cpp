@@ -0,0 +1,224 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/timing_sim.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that flip-flops sample before any of them updates...";
+    {
+        //three stage shift register, every edge moves data one stage only
+        class sim s;
+        auto clk = std::make_unique<elem_in>("clk");
+        auto din = std::make_unique<elem_in>("din");
+        std::vector<elem_dff*> ffs;
+        std::vector<std::unique_ptr<elem_dff>> owned;
+        for(int i=0; i<3; i++){
+            owned.emplace_back(std::make_unique<elem_dff>("ff"+std::to_string(i)));
+            ffs.emplace_back(owned.back().get());
+            clk->get_out(0)->tie_input(owned.back()->get_in(1));
+        }
+        din->get_out(0)->tie_input(ffs[0]->get_in(0));
+        ffs[0]->get_out(0)->tie_input(ffs[1]->get_in(0));
+        ffs[1]->get_out(0)->tie_input(ffs[2]->get_in(0));
+        auto clk_ptr = clk.get();
+        auto din_ptr = din.get();
+        s.emplace(std::move(clk));
+        s.emplace(std::move(din));
+        for(auto &ff:owned){
+            s.emplace(std::move(ff));
+        }
+        auto pulse = [&](){
+            clk_ptr->set_values({true});
+            s.tick();
+            clk_ptr->set_values({false});
+            s.tick();
+        };
+        auto q = [&](const size_t &i){
+            return ffs[i]->get_out(0)->get_value(0);
+        };
+        s.tick();
+        assert(ffs[0]->get_out(1)->get_value(0));
+        din_ptr->set_values({true});
+        pulse();
+        assert(q(0) && !q(1) && !q(2));
+        din_ptr->set_values({false});
+        pulse();
+        assert(!q(0) && q(1) && !q(2));
+        pulse();
+        assert(!q(0) && !q(1) && q(2));
+        assert(s.get_last_settle().stable);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that disabled register keeps its state...";
+    {
+        elem_register reg("reg", 16);
+        bits::bit_vector d(16);
+        d.set_word(0, 0xbeef);
+        reg.get_in(0)->set_values(d);
+        reg.get_in(2)->set_values({true});
+        assert(!reg.sample());
+        assert(reg.get_state().word(0) == 0);
+        reg.get_in(2)->set_values({false});
+        assert(!reg.sample());
+        reg.get_in(1)->set_values({true});
+        reg.get_in(2)->set_values({true});
+        assert(reg.sample());
+        reg.update();
+        assert(reg.get_out(0)->get_values() == d);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that set_width resizes state and data gates together...";
+    {
+        elem_dff ff("ff");
+        assert(ff.has_fixed_shape());
+        ff.set_width(4);
+        assert(ff.get_width() == 4 && ff.get_state().size() == 4);
+        assert(ff.get_in(0)->get_width() == 4 && ff.get_in(1)->get_width() == 1);
+        assert(ff.get_out(0)->get_width() == 4 && ff.get_out(1)->get_width() == 4);
+        ff.get_in(0)->set_values({true, false, true, true});
+        ff.get_in(1)->set_values({true});
+        assert(ff.sample());
+        ff.update();
+        assert(ff.get_out(0)->get_values() == bits::bit_vector({true, false, true, true}));
+        assert(ff.get_out(1)->get_values() == bits::bit_vector({false, true, false, false}));
+
+        elem_register reg("reg", 8);
+        reg.set_width(70);
+        assert(reg.get_in(0)->get_width() == 70 && reg.get_out(0)->get_width() == 70);
+        assert(reg.get_in(1)->get_width() == 1 && reg.get_in(2)->get_width() == 1);
+        elem_counter cnt("cnt", 3);
+        cnt.set_width(65);
+        assert(cnt.get_out(0)->get_width() == 65 && cnt.get_in(1)->get_width() == 1);
+        bool thrown = false;
+        try{
+            cnt.set_width(0);
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that counter counts clock edges and wraps...";
+    {
+        class sim s;
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto en = std::make_unique<elem_in>("en");
+        auto clr = std::make_unique<elem_in>("clr");
+        auto cnt = std::make_unique<elem_counter>("cnt", 3);
+        clk->get_out(0)->tie_input(cnt->get_in(2));
+        en->get_out(0)->tie_input(cnt->get_in(0));
+        clr->get_out(0)->tie_input(cnt->get_in(1));
+        auto en_ptr = en.get();
+        auto clr_ptr = clr.get();
+        auto cnt_ptr = cnt.get();
+        s.emplace(std::move(clk));
+        s.emplace(std::move(en));
+        s.emplace(std::move(clr));
+        s.emplace(std::move(cnt));
+        for(int i=0; i<6; i++){
+            s.tick();
+        }
+        assert(cnt_ptr->get_state().word(0) == 0);
+        en_ptr->set_values({true});
+        //a rising edge every other tick
+        for(int i=0; i<20; i++){
+            s.tick();
+        }
+        assert(cnt_ptr->get_out(0)->get_values().word(0) == 10 % 8);
+        clr_ptr->set_values({true});
+        s.tick();
+        s.tick();
+        assert(cnt_ptr->get_state().word(0) == 0);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that ripple counter settles within one tick...";
+    {
+        //each stage toggles and clocks next one with its inverted output
+        class sim s;
+        auto clk = std::make_unique<elem_in>("clk");
+        auto clk_ptr = clk.get();
+        std::vector<elem_dff*> ffs;
+        gate_out* prev = clk->get_out(0).get();
+        s.emplace(std::move(clk));
+        for(int i=0; i<4; i++){
+            auto ff = std::make_unique<elem_dff>("ff"+std::to_string(i));
+            ff->get_out(1)->tie_input(ff->get_in(0));
+            prev->tie_input(ff->get_in(1));
+            prev = ff->get_out(1).get();
+            ffs.emplace_back(ff.get());
+            s.emplace(std::move(ff));
+        }
+        auto value = [&](){
+            size_t result = 0;
+            for(size_t i=0; i<ffs.size(); i++){
+                result |= size_t(ffs[i]->get_out(0)->get_value(0)) << i;
+            }
+            return result;
+        };
+        //power up raises inverted outputs, which already clocks later stages
+        s.tick();
+        auto start = value();
+        for(size_t i=1; i<=20; i++){
+            clk_ptr->set_values({true});
+            s.tick();
+            assert(s.get_last_settle().stable);
+            clk_ptr->set_values({false});
+            s.tick();
+        }
+        //next stage sees a rising edge when q falls, so q counts up
+        assert(value() == (start+20)%16);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that timing_sim clocks sequential nodes...";
+    {
+        class sim s;
+        auto clk = std::make_unique<elem_clock>("clk", 1);
+        auto en = std::make_unique<elem_in>("en");
+        auto cnt = std::make_unique<elem_counter>("cnt", 8);
+        auto ff = std::make_unique<elem_dff>("ff");
+        clk->get_out(0)->tie_input(cnt->get_in(2));
+        clk->get_out(0)->tie_input(ff->get_in(1));
+        en->get_out(0)->tie_input(cnt->get_in(0));
+        auto en_id = en->get_out(0)->get_id();
+        auto cnt_id = cnt->get_out(0)->get_id();
+        auto nq_id = ff->get_out(1)->get_id();
+        s.emplace(std::move(clk));
+        s.emplace(std::move(en));
+        s.emplace(std::move(cnt));
+        s.emplace(std::move(ff));
+        netlist nl(s);
+        assert(nl.get_comb_loops().empty());
+        timing_sim ts(nl);
+        ts.run_until(1);
+        assert(ts.get_value(nl.find_net(nq_id)) == 1);
+        ts.set_input(nl.find_net(en_id), 1, 50);
+        //clock rises at 100, 300, 500...
+        ts.run_until(1050);
+        assert(ts.get_value(nl.find_net(cnt_id)) == 5);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that sequential elements are saved...";
+    {
+        class sim s;
+        s.emplace(std::make_unique<elem_dff>("ff"));
+        auto wide = std::make_unique<elem_dff>("wide_ff");
+        wide->set_width(3);
+        s.emplace(std::move(wide));
+        s.emplace(std::make_unique<elem_register>("reg", 12));
+        s.emplace(std::make_unique<elem_counter>("cnt", 5));
+        elem_file_saver saver;
+        auto json = saver.to_json(s.begin(), s.end());
+        class sim loaded(saver.from_json(json));
+        assert(saver.to_json(loaded.begin(), loaded.end()) == json);
+    }
+    std::cout<<" done\n";
+}
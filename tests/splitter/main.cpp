@@ -0,0 +1,102 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/timing_sim.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that bit_vector slices cross word boundaries...";
+    {
+        bits::bit_vector bus(130);
+        bits::bit_vector part(70, true);
+        bus.set_slice(60, part);
+        for(size_t i=0; i<130; i++){
+            assert(bus[i] == (i >= 60 && i < 130));
+        }
+        bits::bit_vector out;
+        bus.get_slice(58, 8, out);
+        assert(out.size() == 8);
+        assert(out.word(0) == 0b11111100);
+        bus.set_slice(62, bits::bit_vector(3));
+        bus.get_slice(58, 8, out);
+        assert(out.word(0) == 0b10001100);
+    }
+    std::cout<<" done\n";
+
+    //8 bit bus split into nibbles, low one inverted and merged back
+    class sim sim;
+    auto in = std::make_unique<elem_in>("in1", 8);
+    auto split = std::make_unique<elem_splitter>("split", std::vector<size_t>{4, 4});
+    auto not1 = std::make_unique<elem_not>("not1", 4);
+    auto merge = std::make_unique<elem_merger>("merge", std::vector<size_t>{4, 4});
+    auto out = std::make_unique<elem_out>("out1", 8);
+    in->get_out(0)->tie_input(split->get_in(0));
+    split->get_out(0)->tie_input(not1->get_in(0));
+    not1->get_out(0)->tie_input(merge->get_in(0));
+    split->get_out(1)->tie_input(merge->get_in(1));
+    merge->get_out(0)->tie_input(out->get_in(0));
+    auto in_ptr = in.get();
+    auto out_ptr = out.get();
+    auto in_id = in->get_out(0)->get_id();
+    auto out_id = merge->get_out(0)->get_id();
+    auto high_id = split->get_out(1)->get_id();
+    sim.emplace(std::move(in));
+    sim.emplace(std::move(split));
+    sim.emplace(std::move(not1));
+    sim.emplace(std::move(merge));
+    sim.emplace(std::move(out));
+
+    auto to_byte = [](const bits::bit_vector &v){ return v.word(0); };
+    auto from_byte = [](const uint64_t &v){
+        bits::bit_vector result(8);
+        result.set_word(0, v);
+        return result;
+    };
+
+    std::cout<<"asserting that split and merge follow input without processing...";
+    {
+        in_ptr->set_values(from_byte(0xa5));
+        sim.tick();
+        assert(to_byte(out_ptr->get_outer()->get_values()) == 0xaa);
+        in_ptr->set_values(from_byte(0x3c));
+        sim.tick();
+        assert(to_byte(out_ptr->get_outer()->get_values()) == 0x33);
+        bool thrown = false;
+        try{
+            elem_splitter empty("empty", std::vector<size_t>{2, 0});
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that netlist turns them into slices of one storage...";
+    {
+        netlist nl(sim);
+        auto &nets = nl.get_nets();
+        auto in_net = nl.find_net(in_id);
+        auto out_net = nl.find_net(out_id);
+        auto high_net = nl.find_net(high_id);
+        assert(nets[high_net].storage == in_net);
+        assert(nets[high_net].offset == 4);
+        assert(nets[out_net].storage == out_net);
+        //a splitter or merger gets no node, but high nibble is already a slice
+        //of input bus and goes to the merger through a buffer
+        assert(nl.get_nodes().size() == 4);
+        assert(nl.get_nodes().back().type == netlist::types_node::t_buf);
+        assert(nl.get_comb_loops().empty());
+
+        timing_sim ts(nl);
+        ts.set_input(in_net, 0xa5, 10);
+        ts.run_until(100);
+        assert(ts.get_value(out_net) == 0xaa);
+        assert(ts.get_value(high_net) == 0xa);
+        ts.set_input(in_net, 0x3c, 200);
+        ts.run_until(300);
+        assert(ts.get_value(out_net) == 0x33);
+    }
+    std::cout<<" done\n";
+}
@@ -0,0 +1,179 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include "sim/timing_sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that timing wheel hands out events in time order...";
+    {
+        timing_wheel<size_t> wheel;
+        std::mt19937_64 gen(42);
+        std::vector<uint64_t> times;
+        for(size_t i=0; i<1000000; i++){
+            auto t = gen() >> ((i%4 == 0)? 20 : 40); //some beyond 2^32
+            times.emplace_back(t);
+            wheel.schedule(t, i);
+        }
+        assert(wheel.size() == times.size());
+        uint64_t last = 0;
+        size_t taken = 0;
+        while(wheel.advance()){
+            assert(wheel.now() >= last);
+            last = wheel.now();
+            wheel.take_due([&](const size_t &i){
+                assert(times[i] == last);
+                taken++;
+            });
+        }
+        assert(taken == times.size());
+        assert(wheel.empty());
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that advance stops at limit...";
+    {
+        timing_wheel<int> wheel;
+        wheel.schedule(70000, 1);
+        assert(!wheel.advance(66000));
+        assert(wheel.now() == 66000);
+        wheel.schedule(66001, 2);
+        assert(wheel.advance(70000));
+        assert(wheel.now() == 66001);
+        int val = 0;
+        wheel.take_due([&](const int &v){ val = v; });
+        assert(val == 2);
+        assert(wheel.advance(70000));
+        assert(wheel.now() == 70000);
+    }
+    std::cout<<" done\n";
+
+    //out = in & !in, delayed not lets a pulse through when in rises
+    class sim sim;
+    auto in = std::make_unique<elem_in>("in1");
+    auto not1 = std::make_unique<elem_not>("not1");
+    auto and1 = std::make_unique<elem_and>("and1");
+    auto out = std::make_unique<elem_out>("out1");
+    in->get_out(0)->tie_input(not1->get_in(0));
+    in->get_out(0)->tie_input(and1->get_in(0));
+    not1->get_out(0)->tie_input(and1->get_in(1));
+    and1->get_out(0)->tie_input(out->get_in(0));
+    auto in_id = in->get_out(0)->get_id();
+    auto and_id = and1->get_out(0)->get_id();
+    auto not_ptr = not1.get();
+    sim.emplace(std::move(in));
+    sim.emplace(std::move(not1));
+    sim.emplace(std::move(and1));
+    sim.emplace(std::move(out));
+    netlist nl(sim);
+    auto in_net = nl.find_net(in_id);
+    auto and_net = nl.find_net(and_id);
+
+    std::cout<<"asserting that static hazard shows as a glitch...";
+    {
+        timing_sim ts(nl);
+        ts.set_delay(not_ptr, 3);
+        ts.set_tracing(true);
+        ts.run_until(10);
+        ts.clear_trace();
+        ts.set_input(in_net, 1, 20);
+        ts.run_until(100);
+        std::vector<std::pair<uint64_t, uint64_t>> pulses;
+        for(auto &ch:ts.get_trace()){
+            if(ch.net == and_net){
+                pulses.emplace_back(ch.time, ch.value);
+            }
+        }
+        assert(pulses.size() == 2);
+        assert(pulses[0] == std::make_pair(uint64_t(21), uint64_t(1)));
+        assert(pulses[1] == std::make_pair(uint64_t(24), uint64_t(0)));
+        assert(ts.get_value(and_net) == 0);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that inertial delay swallows short pulse...";
+    {
+        timing_sim ts(nl, timing_sim::delay_model::inertial);
+        ts.set_delay(not_ptr, 3);
+        ts.set_delay(netlist::types_node::t_and, 5);
+        ts.set_tracing(true);
+        ts.run_until(10);
+        ts.clear_trace();
+        ts.set_input(in_net, 1, 20);
+        ts.run_until(100);
+        for(auto &ch:ts.get_trace()){
+            assert(ch.net != and_net);
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that looped not oscillates with its delay...";
+    {
+        class sim sim;
+        auto not_elem = std::make_unique<elem_not>("not1");
+        not_elem->get_out(0)->tie_input(not_elem->get_in(0));
+        auto out_id = not_elem->get_out(0)->get_id();
+        sim.emplace(std::move(not_elem));
+        netlist nl(sim);
+        timing_sim ts(nl);
+        ts.set_delay(netlist::types_node::t_not, 5);
+        ts.set_tracing(true);
+        ts.run_until(100);
+        //delay of 1 was in effect at power up
+        auto &trace = ts.get_trace();
+        assert(trace.size() == 20);
+        assert(trace.back().time == 96);
+        assert(trace.back().net == nl.find_net(out_id));
+
+        ts.set_delay(netlist::types_node::t_not, 0);
+        bool thrown = false;
+        try{
+            ts.run_until(300);
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that clock flips every scaled half period...";
+    {
+        class sim sim;
+        sim.emplace(std::make_unique<elem_clock>("clk", 2));
+        netlist nl(sim);
+        timing_sim ts(nl);
+        ts.set_tracing(true);
+        ts.run_until(1000);
+        auto &trace = ts.get_trace();
+        assert(trace.size() == 5);
+        assert(trace.front().time == 200);
+        assert(trace.front().value == 1);
+        assert(trace.back().time == 1000);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that a new clock scale applies to the running clock...";
+    {
+        class sim sim;
+        sim.emplace(std::make_unique<elem_clock>("clk", 2));
+        netlist nl(sim);
+        timing_sim ts(nl);
+        ts.set_tracing(true);
+        ts.set_clock_scale(10);
+        ts.run_until(50);
+        //next flip is a new half period after the one at 40
+        ts.set_clock_scale(50);
+        ts.run_until(300);
+        auto &trace = ts.get_trace();
+        assert(trace.size() == 4);
+        std::vector<timing_sim::time_type> times{20, 40, 140, 240};
+        for(size_t i=0; i<trace.size(); i++){
+            assert(trace[i].time == times[i]);
+            assert(trace[i].value == (i+1)%2);
+        }
+    }
+    std::cout<<" done\n";
+}
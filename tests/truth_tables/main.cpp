@@ -0,0 +1,175 @@
+#include "sim/sim.h"
+#include <iostream>
+#include <cassert>
+#include <random>
+
+//eight full adder metas in a ripple chain, inputs and outputs are at root
+struct adder{
+    class sim sim;
+    std::vector<elem_in*> a, b;
+    std::vector<elem_out*> sum;
+    elem_out* carry;
+    sim::k_tree_it last_meta;
+
+    adder(const bool &tables){
+        sim.set_truth_tables(tables);
+        gate_out* carry_in = nullptr;
+        for(int i=0; i<8; i++){
+            auto n = std::to_string(i);
+            auto meta_it = sim.emplace(std::make_unique<elem_meta>("fa"+n));
+            last_meta = meta_it;
+            auto in_a = std::make_unique<elem_in>("a");
+            auto in_b = std::make_unique<elem_in>("b");
+            auto in_c = std::make_unique<elem_in>("c");
+            auto xor3 = std::make_unique<elem_xor>("xor3", 1, 3);
+            auto xor2 = std::make_unique<elem_xor>("xor2");
+            auto and1 = std::make_unique<elem_and>("and1");
+            auto and2 = std::make_unique<elem_and>("and2");
+            auto or1 = std::make_unique<elem_or>("or1");
+            auto out_s = std::make_unique<elem_out>("s");
+            auto out_c = std::make_unique<elem_out>("co");
+            in_a->get_out(0)->tie_input(xor3->get_in(0));
+            in_b->get_out(0)->tie_input(xor3->get_in(1));
+            in_c->get_out(0)->tie_input(xor3->get_in(2));
+            in_a->get_out(0)->tie_input(xor2->get_in(0));
+            in_b->get_out(0)->tie_input(xor2->get_in(1));
+            in_a->get_out(0)->tie_input(and1->get_in(0));
+            in_b->get_out(0)->tie_input(and1->get_in(1));
+            in_c->get_out(0)->tie_input(and2->get_in(0));
+            xor2->get_out(0)->tie_input(and2->get_in(1));
+            and1->get_out(0)->tie_input(or1->get_in(0));
+            and2->get_out(0)->tie_input(or1->get_in(1));
+            xor3->get_out(0)->tie_input(out_s->get_in(0));
+            or1->get_out(0)->tie_input(out_c->get_in(0));
+
+            auto root_a = std::make_unique<elem_in>("a"+n);
+            auto root_b = std::make_unique<elem_in>("b"+n);
+            root_a->get_out(0)->tie_input(in_a->get_outer());
+            root_b->get_out(0)->tie_input(in_b->get_outer());
+            if(carry_in){
+                carry_in->tie_input(in_c->get_outer());
+            }
+            carry_in = out_c->get_outer().get();
+            a.emplace_back(root_a.get());
+            b.emplace_back(root_b.get());
+            sum.emplace_back(out_s.get());
+            carry = out_c.get();
+            sim.emplace(std::move(root_a));
+            sim.emplace(std::move(root_b));
+            sim.emplace(meta_it, std::move(in_a));
+            sim.emplace(meta_it, std::move(in_b));
+            sim.emplace(meta_it, std::move(in_c));
+            sim.emplace(meta_it, std::move(xor3));
+            sim.emplace(meta_it, std::move(xor2));
+            sim.emplace(meta_it, std::move(and1));
+            sim.emplace(meta_it, std::move(and2));
+            sim.emplace(meta_it, std::move(or1));
+            sim.emplace(meta_it, std::move(out_s));
+            sim.emplace(meta_it, std::move(out_c));
+        }
+    }
+
+    unsigned add(const unsigned &x, const unsigned &y){
+        for(int i=0; i<8; i++){
+            a[i]->set_values({bool((x >> i) & 1)});
+            b[i]->set_values({bool((y >> i) & 1)});
+        }
+        while(sim.tick());
+        unsigned result = 0;
+        for(int i=0; i<8; i++){
+            result |= unsigned(sum[i]->get_outer()->get_value(0)) << i;
+        }
+        result |= unsigned(carry->get_outer()->get_value(0)) << 8;
+        return result;
+    }
+};
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that tabulated metas compute the same...";
+    {
+        adder plain(false), tabulated(true);
+        assert(plain.sim.tabulated_blocks() == 0);
+        assert(tabulated.sim.tabulated_blocks() == 8);
+        //every instance shares one table of 3 input bits
+        assert(tabulated.sim.get_tables().size() == 1);
+        std::mt19937 gen(7);
+        for(int i=0; i<200; i++){
+            unsigned x = gen() & 0xff, y = gen() & 0xff;
+            assert(plain.add(x, y) == x+y);
+            assert(tabulated.add(x, y) == x+y);
+        }
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that a warm table takes fewer evaluations...";
+    {
+        adder plain(false), tabulated(true);
+        for(unsigned x=0; x<16; x++){
+            tabulated.add(x*17, 255-x);
+        }
+        size_t plain_count = 0, tabulated_count = 0;
+        for(unsigned x=0; x<16; x++){
+            plain.add(x, x*3);
+            plain_count += plain.sim.get_last_settle().processed;
+            tabulated.add(x, x*3);
+            tabulated_count += tabulated.sim.get_last_settle().processed;
+        }
+        assert(tabulated_count < plain_count);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that editing a meta gives it a table of its own...";
+    {
+        adder tabulated(true);
+        tabulated.add(1, 2);
+        tabulated.sim.emplace(tabulated.last_meta, std::make_unique<elem_not>("spare"));
+        assert(tabulated.sim.tabulated_blocks() == 8);
+        assert(tabulated.sim.get_tables().size() == 2);
+        assert(tabulated.add(100, 155) == 255);
+        assert(tabulated.add(200, 100) == 300);
+        tabulated.sim.set_truth_tables(false);
+        assert(tabulated.sim.tabulated_blocks() == 0);
+        assert(tabulated.sim.get_tables().size() == 0);
+        assert(tabulated.add(3, 4) == 7);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that metas with state are not tabulated...";
+    {
+        class sim sim;
+        sim.set_truth_tables(true);
+        auto meta_it = sim.emplace(std::make_unique<elem_meta>("m"));
+        auto d = std::make_unique<elem_in>("d");
+        auto clk = std::make_unique<elem_in>("clk");
+        auto dff = std::make_unique<elem_dff>("dff");
+        auto q = std::make_unique<elem_out>("q");
+        d->get_out(0)->tie_input(dff->get_in(0));
+        clk->get_out(0)->tie_input(dff->get_in(1));
+        dff->get_out(0)->tie_input(q->get_in(0));
+        sim.emplace(meta_it, std::move(d));
+        sim.emplace(meta_it, std::move(clk));
+        sim.emplace(meta_it, std::move(dff));
+        sim.emplace(meta_it, std::move(q));
+        assert(sim.tabulated_blocks() == 0);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that metas with a rom are not tabulated...";
+    {
+        class sim sim;
+        sim.set_truth_tables(true);
+        auto meta_it = sim.emplace(std::make_unique<elem_meta>("m"));
+        auto addr = std::make_unique<elem_in>("addr", 2);
+        auto rom = std::make_unique<elem_rom>("rom", 2, 4);
+        auto q = std::make_unique<elem_out>("q", 4);
+        addr->get_out(0)->tie_input(rom->get_in(0));
+        rom->get_out(0)->tie_input(q->get_in(0));
+        sim.emplace(meta_it, std::move(addr));
+        sim.emplace(meta_it, std::move(rom));
+        sim.emplace(meta_it, std::move(q));
+        assert(sim.tabulated_blocks() == 0);
+    }
+    std::cout<<" done\n";
+}
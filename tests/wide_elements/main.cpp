@@ -0,0 +1,140 @@
+#include "sim/sim.h"
+#include "sim/netlist.h"
+#include <iostream>
+#include <cassert>
+
+int main(){
+    logger::get_instance().set_enabled(false);
+
+    std::cout<<"asserting that n-input gates reduce all inputs...";
+    {
+        elem_and and5("and5", 70, 5);
+        elem_or or5("or5", 70, 5);
+        elem_xor xor5("xor5", 70, 5);
+        assert(and5.get_ins_size() == 5);
+        for(size_t i=0; i<5; i++){
+            bits::bit_vector val(70, true);
+            val.set(i, false);
+            and5.get_in(i)->set_values(val);
+            or5.get_in(i)->set_values(val);
+            xor5.get_in(i)->set_values(val);
+        }
+        and5.process();
+        or5.process();
+        xor5.process();
+        auto and_res = and5.get_out(0)->get_values();
+        auto xor_res = xor5.get_out(0)->get_values();
+        for(size_t i=0; i<70; i++){
+            assert(and_res[i] == (i >= 5));
+            //five ones give one, four ones and a zero give zero
+            assert(xor_res[i] == (i >= 5));
+        }
+        assert(or5.get_out(0)->get_values() == bits::bit_vector(70, true));
+        bool thrown = false;
+        try{
+            elem_or or0("or0", 1, 0);
+        }catch(std::runtime_error &e){
+            thrown = true;
+        }
+        assert(thrown);
+        //an input wider than the rest, as from a hand edited file, is cut
+        or5.get_in(4)->set_width(200);
+        or5.get_in(4)->set_values(bits::bit_vector(200, true));
+        or5.reset_processed();
+        or5.process();
+        assert(or5.get_out(0)->get_values() == bits::bit_vector(70, true));
+        xor5.get_in(0)->set_width(200);
+        xor5.get_in(0)->set_values(bits::bit_vector(200));
+        xor5.reset_processed();
+        xor5.process();
+        assert(xor5.get_out(0)->get_values().size() == 70);
+        and5.set_width(200);
+        assert(and5.get_width() == 200 && and5.get_in(3)->get_width() == 200);
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that mux passes selected input...";
+    {
+        elem_mux mux("mux", 8, 2);
+        assert(mux.get_ins_size() == 5);
+        for(size_t i=0; i<4; i++){
+            bits::bit_vector val(8);
+            val.set(i, true);
+            mux.get_in(i)->set_values(val);
+        }
+        for(size_t sel=0; sel<4; sel++){
+            mux.get_in(4)->set_values({bool(sel&1), bool(sel&2)});
+            mux.reset_processed();
+            mux.process();
+            auto res = mux.get_out(0)->get_values();
+            for(size_t i=0; i<8; i++){
+                assert(res[i] == (i == sel));
+            }
+        }
+        //select widened past the data inputs gives zero, as in netlist
+        assert(mux.has_fixed_shape());
+        mux.get_in(4)->set_width(3);
+        mux.get_in(4)->set_values({false, false, true});
+        mux.reset_processed();
+        mux.process();
+        assert(mux.get_out(0)->get_values() == bits::bit_vector(8));
+        assert(elem_splitter("split", 4).has_fixed_shape());
+        assert(elem_merger("merge", 4).has_fixed_shape());
+        assert(elem_xor("xor1").has_fixed_shape());
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that decoder and priority encoder are inverse...";
+    {
+        elem_decoder dec("dec", 7);
+        elem_priority_encoder enc("enc", 128);
+        assert(dec.get_out(0)->get_width() == 128);
+        assert(enc.get_out(0)->get_width() == 7);
+        dec.get_out(0)->tie_input(enc.get_in(0));
+        for(size_t v:{0, 1, 63, 64, 100, 127}){
+            bits::bit_vector sel(7);
+            for(size_t b=0; b<7; b++){
+                sel.set(b, (v >> b) & 1);
+            }
+            dec.get_in(0)->set_values(sel);
+            dec.reset_processed();
+            enc.reset_processed();
+            dec.process();
+            enc.process();
+            assert(enc.get_out(0)->get_values() == sel);
+            assert(enc.get_out(1)->get_value(0));
+        }
+        enc.get_in(0)->set_values(bits::bit_vector(128));
+        enc.reset_processed();
+        enc.process();
+        assert(!enc.get_out(1)->get_value(0));
+        //select widened past the outputs sets no bit, like the mux
+        assert(dec.has_fixed_shape() && enc.has_fixed_shape());
+        dec.get_in(0)->set_width(9);
+        dec.get_in(0)->set_values(bits::bit_vector(9, true));
+        dec.reset_processed();
+        dec.process();
+        assert(dec.get_out(0)->get_values() == bits::bit_vector(128));
+    }
+    std::cout<<" done\n";
+
+    std::cout<<"asserting that netlist evaluates them the same way...";
+    {
+        using types = netlist::types_node;
+        uint64_t ins[3] = {0b01, 0b10, 1};
+        auto in = [&ins](const size_t &i){ return ins[i]; };
+        assert(netlist::eval(types::t_mux, 3, in) == 0b10);
+        assert(netlist::eval(types::t_decoder, 1, in) == 0b10);
+        ins[0] = 0b10110;
+        assert(netlist::eval(types::t_encoder, 1, in, 0) == 4);
+        assert(netlist::eval(types::t_encoder, 1, in, 1) == 1);
+        assert(netlist::eval(types::t_and, 3, in) == 0);
+
+        class sim sim;
+        sim.emplace(std::make_unique<elem_priority_encoder>("enc", 16));
+        netlist nl(sim);
+        assert(nl.get_nodes().at(0).type == types::t_encoder);
+        assert(nl.get_nodes().at(0).outs.size() == 2);
+    }
+    std::cout<<" done\n";
+}
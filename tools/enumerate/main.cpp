@@ -0,0 +1,152 @@
+#include "sim/sim.h"
+#include "sim/file_ops.h"
+#include "sim/enumerator.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <thread>
+#include <cctype>
+
+//enumerates every input combination of a saved circuit or of one of its
+//metas; prints the table, or checks it against one expected value per row or
+//against expressions over the inputs
+static void usage(){
+    std::cerr<<"usage: logicsim_enumerate <circuit.json> [--meta name] [--expect table | --expr e...]"
+        " [--limit n] [--threads n]\n"
+        "  table holds one expected output value per row, decimal or 0x hex, '#' starts a comment\n"
+        "  e is a C like expression over input names, one for all outputs packed or one per output\n";
+}
+
+//bad command line, reported along with usage
+struct usage_error:std::runtime_error{
+    using std::runtime_error::runtime_error;
+};
+
+static size_t read_count(const std::string &option, const std::string &text){
+    size_t used = 0;
+    unsigned long long value = 0;
+    try{
+        if(!text.empty() && std::isdigit(static_cast<unsigned char>(text[0]))){
+            value = std::stoull(text, &used, 10);
+        }
+    }catch(std::logic_error&){
+        used = 0;
+    }
+    if(used == 0 || used != text.size()){
+        throw usage_error(option+" takes a number, \""+text+"\" is not one");
+    }
+    return value;
+}
+
+static std::vector<uint64_t> read_table(const std::string &path){
+    std::ifstream file(path, std::ios::in);
+    if(!file){
+        throw std::runtime_error("attempt to open table "+path+", which can't be read");
+    }
+    std::vector<uint64_t> result;
+    std::string line;
+    while(std::getline(file, line)){
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::string token;
+        while(words >> token){
+            size_t used = 0;
+            try{
+                result.emplace_back(std::stoull(token, &used, 0));
+            }catch(std::logic_error&){
+                used = 0;
+            }
+            if(used == 0 || used != token.size()){
+                throw std::runtime_error("attempt to read table "+path+", \""+token+"\" is not a number");
+            }
+        }
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]){
+    logger::get_instance().set_enabled(false);
+    std::string circuit, meta_name, expect, limit_text, threads_text;
+    std::vector<std::string> exprs;
+    for(int i=1; i<argc; i++){
+        std::string arg = argv[i];
+        bool has_value = i+1 < argc;
+        if(arg == "--meta" && has_value){
+            meta_name = argv[++i];
+        }else if(arg == "--expect" && has_value){
+            expect = argv[++i];
+        }else if(arg == "--expr" && has_value){
+            exprs.emplace_back(argv[++i]);
+        }else if(arg == "--limit" && has_value){
+            limit_text = argv[++i];
+        }else if(arg == "--threads" && has_value){
+            threads_text = argv[++i];
+        }else if(circuit.empty() && arg.rfind("--", 0) != 0){
+            circuit = arg;
+        }else{
+            usage();
+            return 2;
+        }
+    }
+    if(circuit.empty() || (!expect.empty() && !exprs.empty())){
+        usage();
+        return 2;
+    }
+    try{
+        size_t limit = 16, threads = 0;
+        if(!limit_text.empty()){
+            limit = read_count("--limit", limit_text);
+        }
+        if(!threads_text.empty()){
+            //0 is left to mean one per core, and is what leaving it out does
+            auto most = std::max<size_t>(1, std::thread::hardware_concurrency())*4;
+            threads = read_count("--threads", threads_text);
+            if(threads == 0 || threads > most){
+                throw usage_error("--threads takes 1 to "+std::to_string(most)+", not "+threads_text);
+            }
+        }
+        elem_file_saver saver;
+        class sim s(saver.from_json(saver.load_json(circuit)));
+        std::unique_ptr<enumerator> en;
+        if(meta_name.empty()){
+            en = std::make_unique<enumerator>(s);
+        }else{
+            const elem_meta* meta = nullptr;
+            for(auto it=s.begin(); it!=s.end() && !meta; ++it){
+                auto cast = dynamic_cast<const elem_meta*>(it->get());
+                if(cast && cast->get_name() == meta_name){
+                    meta = cast;
+                }
+            }
+            if(!meta){
+                throw std::runtime_error("attempt to enumerate meta "+meta_name+", which is not in circuit");
+            }
+            en = std::make_unique<enumerator>(s, meta);
+        }
+        if(expect.empty() && exprs.empty()){
+            en->stream([](const uint64_t &row, const uint64_t &value){
+                std::printf("0x%llx 0x%llx\n", static_cast<unsigned long long>(row),
+                    static_cast<unsigned long long>(value));
+            }, threads);
+            return 0;
+        }
+        auto mismatches = exprs.empty()? en->verify(read_table(expect), limit, threads) :
+            en->verify(en->expected_by(exprs), limit, threads);
+        for(auto &m:mismatches){
+            std::printf("row 0x%llx: expected 0x%llx, got 0x%llx\n", static_cast<unsigned long long>(m.row),
+                static_cast<unsigned long long>(m.expected), static_cast<unsigned long long>(m.actual));
+        }
+        if(mismatches.empty()){
+            std::printf("all %llu rows match\n", static_cast<unsigned long long>(en->rows()));
+            return 0;
+        }
+        return 1;
+    }catch(usage_error &e){
+        std::cerr<<e.what()<<"\n";
+        usage();
+        return 2;
+    }catch(std::exception &e){
+        std::cerr<<e.what()<<"\n";
+        return 2;
+    }
+}
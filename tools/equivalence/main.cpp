@@ -0,0 +1,45 @@
+#include "sim/sim.h"
+#include "sim/equivalence.h"
+#include <iostream>
+#include <cstdio>
+
+//checks that two saved circuits compute the same function of their inputs;
+//exits 0 if they do, 1 if they differ, 3 if that could not be decided
+int main(int argc, char *argv[]){
+    logger::get_instance().set_enabled(false);
+    if(argc != 3){
+        std::cerr<<"usage: logicsim_equivalence <first.json> <second.json>\n";
+        return 2;
+    }
+    try{
+        auto r = equivalence::check_files(argv[1], argv[2]);
+        std::printf("proven by structure %zu, by simulation %zu, by SAT %zu output bits\n",
+            r.by_structure, r.by_simulation, r.by_sat);
+        switch(r.verdict){
+        case equivalence::verdicts::v_equivalent:
+            std::printf("equivalent\n");
+            return 0;
+        case equivalence::verdicts::v_different:
+            std::printf("different at");
+            for(auto &name:r.differing){
+                std::printf(" %s", name.c_str());
+            }
+            std::printf("\ncounterexample:");
+            for(auto &[name, value]:r.counterexample){
+                std::printf(" %s=0x%llx", name.c_str(), static_cast<unsigned long long>(value));
+            }
+            std::printf("\n");
+            return 1;
+        default:
+            std::printf("undecided at");
+            for(auto &name:r.unresolved){
+                std::printf(" %s", name.c_str());
+            }
+            std::printf("\n");
+            return 3;
+        }
+    }catch(std::exception &e){
+        std::cerr<<e.what()<<"\n";
+        return 2;
+    }
+}